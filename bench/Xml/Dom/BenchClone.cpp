@@ -0,0 +1,106 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file BenchClone.cpp
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief Per request copies of a template: parse vs clone
+ *
+ * Usage: BenchClone [file]. Without a file a generated template is used.
+ */
+
+#include <Xml/Dom/Document.h>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+using namespace un::Xml::Dom;
+
+namespace
+{
+
+std::string make_template(std::size_t count)
+{
+  std::string result = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<response>\n";
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    std::string id = std::to_string(i);
+    result += "  <item id=\"it" + id + "\" state=\"empty\">\n"
+              "    <name>Item " + id + "</name>\n"
+              "    <value unit=\"ms\">0</value>\n"
+              "  </item>\n";
+  }
+  return result + "</response>\n";
+}
+
+template <class F>
+double measure(F function, int rounds)
+{
+  double best = 1e100;
+  for (int round = 0; round < rounds; ++round)
+  {
+    auto start = std::chrono::steady_clock::now();
+    function();
+    best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+  }
+  return best;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+  std::string text = make_template(2000);
+  if (argc > 1)
+  {
+    std::ifstream file(argv[1], std::ios::binary);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    text = buffer.str();
+  }
+
+  const int copies = 100;
+  std::size_t checksum = 0;
+
+  double results[4];
+  const char *names[4] = {"parse libxml2", "parse native", "clone", "clone shared"};
+  Document::Parser parsers[2] = {Document::Parser::libxml2, Document::Parser::native};
+  for (int p = 0; p < 2; ++p)
+  {
+    results[p] = measure([&]() {
+      for (int i = 0; i < copies; ++i)
+      {
+        Document document(parsers[p]);
+        document.parse(text);
+        checksum += document.root_node.count;
+      }
+    }, 3);
+  }
+
+  Document source;
+  source.parse(text);
+  source.freeze();
+  results[2] = measure([&]() {
+    for (int i = 0; i < copies; ++i)
+    {
+      Document document = source.clone();
+      checksum += document.root_node.count;
+    }
+  }, 3);
+  results[3] = measure([&]() {
+    for (int i = 0; i < copies; ++i)
+    {
+      Document document = source.clone(true);
+      checksum += document.root_node.count;
+    }
+  }, 3);
+
+  for (int i = 0; i < 4; ++i)
+  {
+    std::printf("%-14s %8.3f ms/copy  speedup %6.1f\n", names[i], results[i] * 1000 / copies,
+                results[0] / results[i]);
+  }
+  std::printf("(%zu)\n", checksum);
+  return 0;
+}
@@ -0,0 +1,114 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file BenchJson.cpp
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief Throughput of xml to JSON and JSON to xml conversion
+ *
+ * Usage: BenchJson [file]. Without a file generated records are used.
+ * Throughput is given in MB of xml text per second for all directions.
+ */
+
+#include <Xml/Dom/Document.h>
+#include <Xml/Dom/Json.h>
+#include <Xml/Dom/Pipeline.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+using namespace un::Xml::Dom;
+
+namespace
+{
+
+std::string make_records(std::size_t count)
+{
+  std::string result = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<records>\n";
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    std::string id = std::to_string(i);
+    result += "  <record id=\"r" + id + "\" state=\"active\">\n"
+              "    <name>Record " + id + "</name>\n"
+              "    <value unit=\"ms\">" + std::to_string(i * 7 % 1000) + "</value>\n"
+              "    <tag>a</tag><tag>b</tag>\n"
+              "  </record>\n";
+  }
+  return result + "</records>\n";
+}
+
+template <class F>
+double measure(F function, int rounds)
+{
+  double best = 1e100;
+  for (int round = 0; round < rounds; ++round)
+  {
+    auto start = std::chrono::steady_clock::now();
+    function();
+    best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+  }
+  return best;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+  std::string text = make_records(50000);
+  if (argc > 1)
+  {
+    std::ifstream file(argv[1], std::ios::binary);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    text = buffer.str();
+  }
+
+  std::size_t checksum = 0;
+  Document document;
+  document.parse(text);
+  JsonConvention convention;
+  convention.array_elements = {"record", "tag"};
+
+  // Output buffer is reused between rounds
+  std::string json;
+  double results[5];
+  const char *names[5] = {"parse xml", "tree to json", "events to json", "json to tree", "tree to xml"};
+
+  results[0] = measure([&]() {
+    Document parsed;
+    parsed.parse(text);
+    checksum += parsed.root_node.count;
+  }, 5);
+
+  results[1] = measure([&]() {
+    to_json(document, json, convention);
+    checksum += json.size();
+  }, 5);
+
+  Pipeline pipeline;
+  results[2] = measure([&]() {
+    json.clear();
+    JsonWriter writer(json, convention);
+    pipeline.run(text, writer);
+    checksum += json.size();
+  }, 5);
+
+  to_json(document, json, convention);
+  results[3] = measure([&]() {
+    Document built = from_json(json, convention);
+    checksum += built.root_node.count;
+  }, 5);
+
+  results[4] = measure([&]() { checksum += document.to_string().size(); }, 5);
+
+  double megabytes = static_cast<double>(text.size()) / (1024 * 1024);
+  std::printf("%.1f MB xml, %.1f MB json\n", megabytes, static_cast<double>(json.size()) / (1024 * 1024));
+  for (int i = 0; i < 5; ++i)
+  {
+    std::printf("%-16s %8.3f ms  %8.1f MB/s\n", names[i], results[i] * 1000, megabytes / results[i]);
+  }
+  std::printf("(%zu)\n", checksum);
+  return 0;
+}
@@ -0,0 +1,84 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file BenchParse.cpp
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief Parse throughput of libxml2 and native parsers
+ *
+ * Usage: BenchParse [file...]. Without files a generated corpus is used.
+ */
+
+#include <Xml/Dom/Document.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace un::Xml::Dom;
+
+namespace
+{
+
+// Record oriented document with attributes, text, entities and some nesting
+std::string make_records(std::size_t count)
+{
+  std::string result = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<catalog>\n";
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    std::string id = std::to_string(i);
+    result += "  <book id=\"bk" + id + "\" lang=\"en\" available=\"true\">\n"
+              "    <author>Author " + id + "</author>\n"
+              "    <title>Title &amp; subtitle of book " + id + "</title>\n"
+              "    <price currency=\"USD\">" + std::to_string(i % 100) + ".95</price>\n"
+              "    <description>Some longer description text for book " + id +
+              " which is here to make text nodes a bit more realistic in size.</description>\n"
+              "  </book>\n";
+  }
+  return result + "</catalog>\n";
+}
+
+double measure(Document::Parser parser, const std::string &data)
+{
+  Document document(parser);
+  auto start = std::chrono::steady_clock::now();
+  document.parse(data);
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void run(const char *label, const std::string &data)
+{
+  double mb = data.size() / (1024.0 * 1024.0);
+  // Rounds alternate between parsers so load changes on the machine hit both alike
+  double libxml2 = 1e100;
+  double native = 1e100;
+  for (int round = 0; round < 7; ++round)
+  {
+    libxml2 = std::min(libxml2, measure(Document::Parser::libxml2, data));
+    native = std::min(native, measure(Document::Parser::native, data));
+  }
+  std::printf("%-24s %8.1f MB  libxml2 %7.1f MB/s  native %7.1f MB/s  speedup %5.2f\n",
+              label, mb, mb / libxml2, mb / native, libxml2 / native);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+  if (argc < 2)
+  {
+    run("generated records", make_records(200000));
+    return 0;
+  }
+
+  for (int i = 1; i < argc; ++i)
+  {
+    std::ifstream file(argv[i], std::ios::binary);
+    std::ostringstream content;
+    content << file.rdbuf();
+    run(argv[i], content.str());
+  }
+  return 0;
+}
@@ -0,0 +1,91 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file BenchSnapshot.cpp
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief Cold start: parse_file vs load_snapshot
+ *
+ * Usage: BenchSnapshot [file]. Without a file a generated corpus is used.
+ */
+
+#include <Xml/Dom/Document.h>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+using namespace un::Xml::Dom;
+
+namespace
+{
+
+std::string make_records(std::size_t count)
+{
+  std::string result = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<catalog>\n";
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    std::string id = std::to_string(i);
+    result += "  <book id=\"bk" + id + "\" lang=\"en\">\n"
+              "    <author>Author " + id + "</author>\n"
+              "    <title>Title of book " + id + "</title>\n"
+              "    <price currency=\"USD\">" + std::to_string(i % 100) + ".95</price>\n"
+              "  </book>\n";
+  }
+  return result + "</catalog>\n";
+}
+
+template <class F>
+double measure(F function, int rounds)
+{
+  double best = 1e100;
+  for (int round = 0; round < rounds; ++round)
+  {
+    auto start = std::chrono::steady_clock::now();
+    function();
+    best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+  }
+  return best;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+  std::string path = "bench_snapshot.xml";
+  if (argc > 1)
+  {
+    path = argv[1];
+  }
+  else
+  {
+    std::ofstream file(path, std::ios::binary);
+    file << make_records(300000);
+  }
+  std::string snapshot = path + ".snapshot";
+
+  Document source;
+  source.parse_file(path);
+  source.save_snapshot(snapshot);
+
+  std::size_t checksum = 0;
+  double parse = measure([&]() {
+    Document document;
+    document.parse_file(path);
+    checksum += document.root_node.count;
+  }, 3);
+  double load = measure([&]() {
+    Document document;
+    document.load_snapshot(snapshot);
+    checksum += document.root_node.count;
+  }, 3);
+
+  std::printf("parse_file     %8.3f s\nload_snapshot  %8.3f s  speedup %6.1f  (%zu)\n", parse, load,
+              parse / load, checksum);
+
+  std::remove(snapshot.c_str());
+  if (argc < 2)
+  {
+    std::remove(path.c_str());
+  }
+  return 0;
+}
@@ -0,0 +1,120 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file BenchVisit.cpp
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief Sequential vs parallel Node::visit on wide and deep trees, libxml2 and
+ *        compact
+ */
+
+#include <Xml/Dom/Document.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+using namespace un::Xml::Dom;
+
+namespace
+{
+
+// <root> with `count` flat <item> children
+std::string make_wide(std::size_t count)
+{
+  std::string result = "<root>";
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    result += "<item id=\"" + std::to_string(i) + "\">" + std::to_string(i * 7) + "</item>";
+  }
+  return result + "</root>";
+}
+
+// Complete binary tree of given depth
+void append_deep(std::string &out, int depth, std::size_t &counter)
+{
+  out += "<n>";
+  out += std::to_string(counter++);
+  if (depth > 0)
+  {
+    append_deep(out, depth - 1, counter);
+    append_deep(out, depth - 1, counter);
+  }
+  out += "</n>";
+}
+
+std::string make_deep(int depth)
+{
+  std::string result;
+  std::size_t counter = 0;
+  append_deep(result, depth, counter);
+  return result;
+}
+
+// Some per element work so the visitor is not just a pointer chase
+std::size_t work(const Node &node)
+{
+  std::string content = node.content;
+  std::size_t result = 0;
+  for (int round = 0; round < 8; ++round)
+  {
+    result = result * 31 + std::hash<std::string>()(content) + round;
+  }
+  return result;
+}
+
+void run(const char *label, Document &document)
+{
+  std::atomic<std::size_t> checksum(0);
+  Node::Visitor visitor = [&checksum](const Node &node) {
+    checksum.fetch_add(work(node) & 0xff, std::memory_order_relaxed);
+  };
+
+  // Warm up, first pass pays for growing the heap
+  document.root_node.visit(visitor);
+  checksum.store(0);
+
+  auto start = std::chrono::steady_clock::now();
+  document.root_node.visit(visitor);
+  double sequential = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  std::size_t expected = checksum.exchange(0);
+
+  std::printf("%-6s sequential       %8.3f s\n", label, sequential);
+
+  unsigned max_threads = std::thread::hardware_concurrency();
+  for (unsigned threads = 1; threads <= max_threads; threads *= 2)
+  {
+    start = std::chrono::steady_clock::now();
+    document.root_node.visit(visitor, Node::ExecutionPolicy::parallel, threads);
+    double parallel = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("%-6s parallel x%-4u   %8.3f s  speedup %5.2f%s\n", label, threads,
+                parallel, sequential / parallel,
+                checksum.exchange(0) == expected ? "" : "  CHECKSUM MISMATCH");
+  }
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+  std::size_t wide_count = argc > 1 ? std::strtoul(argv[1], NULL, 10) : 1000000;
+  int deep_depth = argc > 2 ? std::atoi(argv[2]) : 19;
+
+  Document wide;
+  wide.parse(make_wide(wide_count));
+  wide.freeze();
+  run("wide", wide);
+  wide.compact();
+  run("wide-c", wide);
+
+  Document deep;
+  deep.parse(make_deep(deep_depth));
+  deep.freeze();
+  run("deep", deep);
+  deep.compact();
+  run("deep-c", deep);
+
+  return 0;
+}
@@ -0,0 +1,168 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file Async.h
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief Awaitable parse and save (C++20)
+ *
+ * Blocking file work runs on an executor and the awaiting coroutine is
+ * resumed on the executor thread that finished it:
+ *
+ *   Document document = co_await async_parse_file("big.xml");
+ *   co_await async_save(document, "big.xml.gz");
+ *
+ * Executor is pluggable, the default is a process wide thread pool. An event
+ * loop can pass an executor posting to its own workers. Plain files parsed by
+ * libxml2 are read in chunks with the next chunk read while the current one
+ * is parsed.
+ */
+
+#pragma once
+
+#include "Document.h"
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+
+namespace un::Xml::Dom
+{
+
+/// Runs tasks of async operations
+class Executor
+{
+public:
+  typedef std::function<void()> Task;
+
+  virtual ~Executor() {}
+
+  /// Run task on some thread, tasks do not throw
+  virtual void execute(Task task) = 0;
+};
+
+/// Fixed size thread pool, queued tasks finish before it is destroyed
+struct ThreadPoolExecutor : public Executor
+{
+public: // To allow dependency injection change this to protected
+  class Handler;
+  std::shared_ptr<ThreadPoolExecutor::Handler> handler;
+
+  /**
+   * @param thread_count Number of threads, 0 for hardware concurrency
+   */
+  explicit ThreadPoolExecutor(std::size_t thread_count = 0);
+
+  void execute(Task task);
+
+  std::size_t get_thread_count() const;
+};
+
+/// Process wide thread pool used when no executor is given
+Executor &default_executor();
+
+/**
+ * Awaitable running work on an executor when awaited. Await it once, result
+ * or exception of work is returned from co_await.
+ */
+template <class T>
+class Awaitable
+{
+private:
+  std::function<T()> _work;
+  Executor &_executor;
+  std::optional<T> _result;
+  std::exception_ptr _error;
+
+public:
+  Awaitable(std::function<T()> work, Executor &executor) : _work(std::move(work)), _executor(executor) {}
+
+  bool await_ready() const noexcept { return false; }
+
+  void await_suspend(std::coroutine_handle<> coroutine)
+  {
+    this->_executor.execute([this, coroutine]() {
+      try
+      {
+        this->_result.emplace(this->_work());
+      }
+      catch (...)
+      {
+        this->_error = std::current_exception();
+      }
+      coroutine.resume();
+    });
+  }
+
+  T await_resume()
+  {
+    if (this->_error)
+    {
+      std::rethrow_exception(this->_error);
+    }
+    return std::move(*this->_result);
+  }
+};
+
+template <>
+class Awaitable<void>
+{
+private:
+  std::function<void()> _work;
+  Executor &_executor;
+  std::exception_ptr _error;
+
+public:
+  Awaitable(std::function<void()> work, Executor &executor) : _work(std::move(work)), _executor(executor) {}
+
+  bool await_ready() const noexcept { return false; }
+
+  void await_suspend(std::coroutine_handle<> coroutine)
+  {
+    this->_executor.execute([this, coroutine]() {
+      try
+      {
+        this->_work();
+      }
+      catch (...)
+      {
+        this->_error = std::current_exception();
+      }
+      coroutine.resume();
+    });
+  }
+
+  void await_resume()
+  {
+    if (this->_error)
+    {
+      std::rethrow_exception(this->_error);
+    }
+  }
+};
+
+/**
+ * Parse file into a new document, see Document::parse_file
+ *
+ * @throw std::runtime_error from co_await if file cannot be read or parsed
+ */
+Awaitable<Document> async_parse_file(const std::string &path,
+                                     Document::Parser parser = Document::Parser::libxml2,
+                                     Executor &executor = default_executor());
+
+/**
+ * Save document, see Document::save_file. Document must stay alive and
+ * unchanged until the operation completes.
+ */
+Awaitable<void> async_save(const Document &document, const std::string &path, bool pretty_print = false,
+                           Document::Compression compression = Document::Compression::by_extension,
+                           Executor &executor = default_executor());
+
+/// Serialize document, see Document::to_string
+Awaitable<std::string> async_to_string(const Document &document, bool pretty_print = false,
+                                       bool skip_headers = true, Executor &executor = default_executor());
+
+}
@@ -0,0 +1,358 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file Binding.h
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief Declarative mapping of C++ structs to xml elements
+ *
+ * Fields of a struct are described once with a constexpr field list:
+ *
+ *   struct Book
+ *   {
+ *     std::string id;
+ *     std::string title;
+ *     double price;
+ *     std::vector<std::string> authors;
+ *   };
+ *
+ *   template <>
+ *   struct un::Xml::Dom::Binding<Book>
+ *   {
+ *     static constexpr auto fields = std::make_tuple(
+ *         field("@id", &Book::id), UN_XML_FIELD(Book, title),
+ *         UN_XML_FIELD(Book, price), field("author", &Book::authors));
+ *   };
+ *
+ *   Book book = extract<Book>(node);
+ *   Node copy = serialize(book, "book");
+ *
+ * Names starting with '@' are attributes, others are child elements. Field
+ * types are int32_t, int64_t, uint32_t, uint64_t, float, double, bool,
+ * std::string, other bound structs and std::vector of those for repeated
+ * elements.
+ *
+ * Extraction is a single pass over the attributes and children of the node
+ * (see Node::scan), children are matched against the field list instead of
+ * being looked up by name one field at a time. Only the name table is built at
+ * compile time, matching compares names at run time starting after the last
+ * matched field, so fields in declaration order cost one compare each.
+ * Elements without a field are skipped, fields without an element keep their
+ * value.
+ */
+
+#pragma once
+
+#include "Node.h"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace un::Xml::Dom
+{
+
+/// Specialize with a static constexpr tuple of fields named fields
+template <class T>
+struct Binding;
+
+/// Binding of one struct member to an attribute or child element
+template <class Owner, class Member>
+struct Field
+{
+  std::string_view name;
+  bool is_attribute;
+  Member Owner::*member;
+};
+
+template <class Owner, class Member, std::size_t size>
+constexpr Field<Owner, Member> field(const char (&name)[size], Member Owner::*member)
+{
+  return name[0] == '@' ? Field<Owner, Member>{std::string_view(name + 1, size - 2), true, member}
+                        : Field<Owner, Member>{std::string_view(name, size - 1), false, member};
+}
+
+/// Field named after the member
+#define UN_XML_FIELD(Type, member) ::un::Xml::Dom::field(#member, &Type::member)
+
+namespace BindingDetail
+{
+
+// Conversions, defined in Binding.cpp. Parsing throws std::runtime_error.
+void parse(std::string_view text, int32_t &value);
+void parse(std::string_view text, int64_t &value);
+void parse(std::string_view text, uint32_t &value);
+void parse(std::string_view text, uint64_t &value);
+void parse(std::string_view text, float &value);
+void parse(std::string_view text, double &value);
+void parse(std::string_view text, bool &value);
+void parse(std::string_view text, std::string &value);
+
+std::string format(int32_t value);
+std::string format(int64_t value);
+std::string format(uint32_t value);
+std::string format(uint64_t value);
+std::string format(float value);
+std::string format(double value);
+std::string format(bool value);
+const std::string &format(const std::string &value);
+
+/// Escape '&' for Node content, where it starts an entity or character reference
+std::string escape(const std::string &text);
+
+template <class T, class = void>
+struct is_bound : std::false_type
+{
+};
+
+template <class T>
+struct is_bound<T, std::void_t<decltype(Binding<T>::fields)>> : std::true_type
+{
+};
+
+template <class T>
+struct is_vector : std::false_type
+{
+};
+
+template <class T>
+struct is_vector<std::vector<T>> : std::true_type
+{
+};
+
+template <class T>
+struct element_type
+{
+  typedef T type;
+};
+
+template <class T>
+struct element_type<std::vector<T>>
+{
+  typedef T type;
+};
+
+template <class T>
+constexpr std::size_t field_count()
+{
+  return std::tuple_size<std::decay_t<decltype(Binding<T>::fields)>>::value;
+}
+
+/// Calls function with field number index of T
+template <class T, class F, std::size_t... I>
+inline void with_field(std::size_t index, F &&function, std::index_sequence<I...>)
+{
+  ((index == I ? (function(std::get<I>(Binding<T>::fields)), 0) : 0), ...);
+}
+
+template <class T, class F>
+inline void with_field(std::size_t index, F &&function)
+{
+  with_field<T>(index, std::forward<F>(function), std::make_index_sequence<field_count<T>()>());
+}
+
+struct FieldInfo
+{
+  std::string_view name;
+  bool is_attribute;
+  bool is_node;
+};
+
+template <class T, std::size_t... I>
+constexpr std::array<FieldInfo, sizeof...(I)> make_field_infos(std::index_sequence<I...>)
+{
+  return {{FieldInfo{std::get<I>(Binding<T>::fields).name, std::get<I>(Binding<T>::fields).is_attribute,
+                     is_bound<typename element_type<std::decay_t<decltype(
+                         std::declval<T &>().*(std::get<I>(Binding<T>::fields).member))>>::type>::value}...}};
+}
+
+/// Name table of T, built at compile time
+template <class T>
+struct FieldTable
+{
+  static constexpr std::array<FieldInfo, field_count<T>()> infos =
+      make_field_infos<T>(std::make_index_sequence<field_count<T>()>());
+};
+
+template <class T>
+void extract_into(const Node &node, T &value);
+
+template <class Member>
+inline void assign_content(Member &member, std::string_view content)
+{
+  if constexpr (is_vector<Member>::value)
+  {
+    member.emplace_back();
+    parse(content, member.back());
+  }
+  else
+  {
+    parse(content, member);
+  }
+}
+
+template <class Member>
+inline void assign_node(Member &member, const Node &child)
+{
+  if constexpr (is_vector<Member>::value)
+  {
+    member.emplace_back();
+    extract_into(child, member.back());
+  }
+  else
+  {
+    extract_into(child, member);
+  }
+}
+
+template <class T>
+class Sink : public Node::ScanSink
+{
+private:
+  T &_value;
+
+  /// Fields usually come in declaration order, search starts after last match
+  std::size_t _next;
+
+  int find(const char *name, bool is_attribute)
+  {
+    const std::array<FieldInfo, field_count<T>()> &infos = FieldTable<T>::infos;
+    std::string_view key(name);
+    for (std::size_t n = 0; n < infos.size(); ++n)
+    {
+      std::size_t i = (this->_next + n) % infos.size();
+      if (infos[i].is_attribute == is_attribute && infos[i].name == key)
+      {
+        this->_next = i;
+        return static_cast<int>(i);
+      }
+    }
+    return -1;
+  }
+
+public:
+  explicit Sink(T &value) : _value(value), _next(0) {}
+
+  int find_attribute(const char *name) { return this->find(name, true); }
+
+  int find_element(const char *name) { return this->find(name, false); }
+
+  bool is_node_field(int field) const { return FieldTable<T>::infos[field].is_node; }
+
+  void on_content(int field, std::string_view content)
+  {
+    with_field<T>(field, [this, content](const auto &binding) {
+      if constexpr (!is_bound<typename element_type<
+                        std::decay_t<decltype(this->_value.*(binding.member))>>::type>::value)
+      {
+        assign_content(this->_value.*(binding.member), content);
+      }
+    });
+  }
+
+  void on_node(int field, const Node &child)
+  {
+    with_field<T>(field, [this, &child](const auto &binding) {
+      if constexpr (is_bound<typename element_type<
+                        std::decay_t<decltype(this->_value.*(binding.member))>>::type>::value)
+      {
+        assign_node(this->_value.*(binding.member), child);
+      }
+    });
+  }
+};
+
+template <class T>
+void extract_into(const Node &node, T &value)
+{
+  Sink<T> sink(value);
+  node.scan(sink);
+}
+
+template <class T>
+void serialize_into(const T &value, Node &node);
+
+template <class Item>
+inline void serialize_item(const Item &item, std::string_view name, Node &parent)
+{
+  if constexpr (is_bound<Item>::value)
+  {
+    Node child(std::string(name).c_str());
+    serialize_into(item, child);
+    parent.push_back(child);
+  }
+  else
+  {
+    parent.push_back(Node(std::string(name), escape(format(item))));
+  }
+}
+
+template <class T>
+void serialize_into(const T &value, Node &node)
+{
+  std::apply(
+      [&value, &node](const auto &...binding) {
+        (
+            [&value, &node](const auto &field) {
+              const auto &member = value.*(field.member);
+              if (field.is_attribute)
+              {
+                if constexpr (!is_vector<std::decay_t<decltype(member)>>::value &&
+                              !is_bound<std::decay_t<decltype(member)>>::value)
+                {
+                  node.attributes.push_back(std::string(field.name), format(member));
+                }
+              }
+              else if constexpr (is_vector<std::decay_t<decltype(member)>>::value)
+              {
+                for (const auto &item : member)
+                {
+                  serialize_item(item, field.name, node);
+                }
+              }
+              else
+              {
+                serialize_item(member, field.name, node);
+              }
+            }(binding),
+            ...);
+      },
+      Binding<T>::fields);
+}
+
+}
+
+/**
+ * Fill value from attributes and children of node
+ *
+ * @throw std::runtime_error if a content cannot be converted to its field
+ */
+template <class T>
+inline void extract(const Node &node, T &value)
+{
+  static_assert(BindingDetail::is_bound<T>::value, "Type has no Binding specialization");
+  BindingDetail::extract_into(node, value);
+}
+
+template <class T>
+inline T extract(const Node &node)
+{
+  T value{};
+  extract(node, value);
+  return value;
+}
+
+/// New element with given name holding value
+template <class T>
+inline Node serialize(const T &value, const char *name)
+{
+  static_assert(BindingDetail::is_bound<T>::value, "Type has no Binding specialization");
+  Node node(name);
+  BindingDetail::serialize_into(value, node);
+  return node;
+}
+
+}
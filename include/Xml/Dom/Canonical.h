@@ -0,0 +1,111 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file Canonical.h
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief Canonical XML output and hashing
+ *
+ * Canonical form (C14N) is the byte exact serialization used to sign and
+ * compare documents: attributes are sorted, empty elements are written with
+ * end tags, namespace declarations are normalized, entity references are
+ * replaced by their text and so on. Output goes to a sink in chunks as
+ * libxml2 produces it, so a document can be hashed without holding its
+ * canonical text:
+ *
+ *   Sha256 sha;
+ *   canonicalize(document, [&](const char *data, std::size_t size) { sha.update(data, size); });
+ *   std::string digest = Sha256::to_hex(sha.finish());
+ *
+ * or simply canonical_sha256(document).
+ */
+
+#pragma once
+
+#include "Document.h"
+#include "Node.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace un::Xml::Dom
+{
+
+struct Canonicalization
+{
+  enum class Method
+  {
+    c14n_1_0,      ///< Canonical XML 1.0
+    exclusive_1_0, ///< Exclusive XML Canonicalization 1.0, only used namespaces are written
+    c14n_1_1       ///< Canonical XML 1.1
+  };
+
+  Method method;
+
+  /// Keep comments
+  bool with_comments;
+
+  /// Prefixes written as in inclusive canonicalization, exclusive method only
+  std::vector<std::string> inclusive_prefixes;
+
+  Canonicalization(Method method = Method::c14n_1_0, bool with_comments = false)
+      : method(method), with_comments(with_comments) {}
+};
+
+/// Receives canonical output in order, chunk by chunk
+typedef std::function<void(const char *data, std::size_t size)> CanonicalSink;
+
+/**
+ * Write canonical form of document to sink. Compact documents are expanded
+ * into a temporary copy first.
+ *
+ * @throw std::runtime_error if libxml2 fails, exceptions of sink are rethrown
+ */
+void canonicalize(const Document &document, const CanonicalSink &sink,
+                  const Canonicalization &options = Canonicalization());
+
+/**
+ * Write canonical form of the subtree of node to sink. Namespaces and xml:
+ * attributes inherited from ancestors are written as the method requires.
+ */
+void canonicalize(const Node &node, const CanonicalSink &sink,
+                  const Canonicalization &options = Canonicalization());
+
+std::string to_canonical_string(const Document &document,
+                                const Canonicalization &options = Canonicalization());
+
+std::string to_canonical_string(const Node &node, const Canonicalization &options = Canonicalization());
+
+/// Incremental SHA-256
+class Sha256
+{
+public:
+  typedef std::array<uint8_t, 32> Digest;
+
+  Sha256();
+
+  void update(const char *data, std::size_t size);
+
+  /// Digest of everything updated so far, starts over afterwards
+  Digest finish();
+
+  /// Lower case hex form of digest
+  static std::string to_hex(const Digest &digest);
+
+private:
+  uint32_t _state[8];
+  uint64_t _size;
+  unsigned char _block[64];
+
+  void reset();
+  void transform(const unsigned char *block);
+};
+
+/// Hex SHA-256 of canonical form, computed while canonicalizing
+std::string canonical_sha256(const Document &document, const Canonicalization &options = Canonicalization());
+
+std::string canonical_sha256(const Node &node, const Canonicalization &options = Canonicalization());
+
+}
@@ -0,0 +1,99 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file ColumnExtractor.h
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief Extracts repeated records into typed column buffers
+ *
+ * Record path selects the records below a node ("rows/row"), column paths are
+ * relative to a record: "price" (child content), "@id" (attribute),
+ * "item/@sku" or "item/name" (nested). Every record adds one row to every
+ * column, so columns stay aligned and can be handed to vectorized code as is.
+ *
+ * Numbers are parsed straight from the document text and string cells are
+ * appended to one arena per column, nothing is allocated per cell. Records are
+ * found and columns filled in one pass (see Node::scan).
+ *
+ * Input is a node of a parsed libxml2 or compact document, so the whole input
+ * is in memory. Events of a Pipeline are not extracted.
+ */
+
+#pragma once
+
+#include "Node.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace un::Xml::Dom
+{
+
+struct ColumnExtractor
+{
+public: // To allow dependency injection change this to protected
+  class Handler;
+  std::shared_ptr<ColumnExtractor::Handler> handler;
+
+  enum class Type
+  {
+    int64,
+    float64,
+    string
+  };
+
+  /// Values of one column, one entry per row in the buffer of its type
+  struct Column
+  {
+    std::string path;
+    Type type;
+
+    std::vector<int64_t> int64_values;
+    std::vector<double> float64_values;
+
+    /// String cells back to back, cell i is arena[offsets[i], offsets[i + 1])
+    std::string arena;
+    std::vector<uint64_t> offsets;
+
+    /// 0 where the record has no value, buffer then holds 0 or empty string
+    std::vector<uint8_t> valid;
+
+    inline std::string_view get_string(std::size_t row) const
+    {
+      return std::string_view(arena.data() + offsets[row], offsets[row + 1] - offsets[row]);
+    }
+  };
+
+  struct Table
+  {
+    std::vector<Column> columns;
+    std::size_t row_count;
+
+    /// Column by path
+    const Column &operator[](const std::string &path) const;
+  };
+
+  /**
+   * @param record_path Path of record elements below extracted node, segments
+   * separated by '/'
+   */
+  explicit ColumnExtractor(const std::string &record_path);
+
+  /**
+   * Add column. When a record has the value more than once, first one is used.
+   *
+   * @param path Path relative to record, last segment may be an attribute
+   * @param type Column type
+   */
+  ColumnExtractor &add_column(const std::string &path, Type type);
+
+  /**
+   * Extract every record below node
+   *
+   * @throw std::runtime_error if a value cannot be converted to its column type
+   */
+  Table extract(const Node &node) const;
+};
+
+}
@@ -0,0 +1,92 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file Diff.h
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief Edit scripts between documents
+ *
+ * diff compares two trees and returns the edits turning the first into the
+ * second, patch (or Document::apply) replays them on another copy of the
+ * first:
+ *
+ *   EditScript script = diff(old_config, new_config);
+ *   std::string delta = script.to_string(); // Send this
+ *   replica.apply(EditScript::from_string(delta));
+ *
+ * Every subtree is hashed once and children are aligned by the longest common
+ * subsequence of their hashes, so a small change in a large document gives a
+ * small script; a moved child is removed and inserted again. Subtrees with
+ * equal hashes are compared once more before they are skipped.
+ */
+
+#pragma once
+
+#include "Document.h"
+#include "Node.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace un::Xml::Dom
+{
+
+struct EditScript
+{
+  enum class Type
+  {
+    insert,           ///< Insert value (markup) before path, last index may be one past the end
+    remove,           ///< Remove node at path
+    replace,          ///< Replace node at path with value (markup)
+    set_attribute,    ///< Set attribute name of element at path to value
+    remove_attribute, ///< Remove attribute name of element at path
+    set_text,         ///< Set text of text, CDATA, comment or PI node at path to value
+    rename            ///< Rename element at path to name
+  };
+
+  /**
+   * One edit. Path holds child positions starting below the diffed node,
+   * counting every child node (text and comments too) as the tree is right
+   * before the edit. Empty path is the diffed node itself.
+   */
+  struct Edit
+  {
+    Type type;
+    std::vector<std::size_t> path;
+    std::string name;
+    std::string value;
+  };
+
+  /// Edits in the order they must be applied
+  std::vector<Edit> edits;
+
+  inline bool empty() const { return this->edits.empty(); }
+
+  /// Script as an xml document
+  std::string to_string() const;
+
+  /**
+   * Read script written by to_string
+   *
+   * @throw std::runtime_error if text is not a valid script
+   */
+  static EditScript from_string(const std::string &text);
+};
+
+/**
+ * Edits turning from into to. Only the subtrees are compared, so diffing
+ * documents compares their root elements.
+ */
+EditScript diff(const Node &from, const Node &to);
+
+EditScript diff(const Document &from, const Document &to);
+
+/**
+ * Apply edits to node. Node is rebound when the script replaces it. Node
+ * objects bound to removed or replaced nodes become invalid.
+ *
+ * @throw std::runtime_error if an edit does not fit the tree, edits before
+ * it stay applied
+ */
+void patch(Node &node, const EditScript &script);
+
+}
@@ -15,12 +15,16 @@
 #pragma once
 
 #include "Node.h"
+#include "Observer.h"
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace un::Xml::Dom
 {
 
+struct EditScript;
+
 struct Document
 {
 public: // To allow dependency injection change this to protected
@@ -49,6 +53,19 @@ public: // To allow dependency injection change this to protected
   /// Root node property object. Just an interface to node class
   RootNodePropertyType root_node;
 
+  /**
+   * Parser used by parse and parse_file.
+   *
+   * Native parser locates markup with SIMD instructions and links the tree
+   * directly. It handles UTF-8 documents without DOCTYPE, other documents are
+   * parsed by libxml2 regardless of the choice.
+   */
+  enum class Parser
+  {
+    libxml2,
+    native
+  };
+
   /**
    * Parse document from raw data (UTF-8 Encoding will be used)
    *
@@ -70,7 +87,9 @@ public: // To allow dependency injection change this to protected
   }
 
   /**
-   * Parse xml document from xml file
+   * Parse xml document from xml file. Gzip, zstd and xz compressed files are
+   * recognized by their magic bytes and decompressed while parsing, without a
+   * temporary file.
    *
    * @param path Xml document file path
    */
@@ -81,6 +100,243 @@ public: // To allow dependency injection change this to protected
     this->parse_file(path.c_str());
   }
 
+  /// Compression of files written by save_file
+  enum class Compression
+  {
+    by_extension, ///< Chosen by file extension: .gz, .zst, .xz or none
+    none,
+    gzip,
+    zstd,
+    xz
+  };
+
+  /**
+   * Save document to file, compressing while serializing. File is written to
+   * a temporary file and renamed.
+   *
+   * @param path Xml document file path
+   * @param pretty_print Indent output
+   * @param compression Compression of file
+   * @throw std::runtime_error if file cannot be written or the compression
+   * library was not available at build time
+   */
+  void save_file(const char *path, bool pretty_print = false,
+                 Compression compression = Compression::by_extension) const;
+
+  inline void save_file(const std::string &path, bool pretty_print = false,
+                        Compression compression = Compression::by_extension) const
+  {
+    this->save_file(path.c_str(), pretty_print, compression);
+  }
+
+  /**
+   * Freeze document. Frozen document is read-only, every mutating call
+   * (including parse) throws. Lookups on a frozen document do not touch any
+   * shared state, so one frozen document can be read from any number of
+   * threads at the same time without locking.
+   *
+   * Freeze before sharing the document with other threads. Freezing cannot be
+   * undone.
+   */
+  void freeze();
+
+  /**
+   * Returns true if document is frozen
+   */
+  bool is_frozen() const;
+
+  /**
+   * Convert document into compact read-only arrays. Nodes are stored in
+   * document order with index links, names are interned and text lives in one
+   * string pool, which takes a fraction of the memory of the libxml2 tree and
+   * makes lookups and visits cache friendly. Node read API stays the same.
+   *
+   * Compacting implies freeze. Node objects taken from the document before
+   * compacting become invalid. DTD is dropped and entity references are
+   * replaced by their content.
+   */
+  void compact();
+
+  /**
+   * Returns true if document is compacted
+   */
+  bool is_compact() const;
+
+  /**
+   * Deep copy of document. Copy is mutable even if this document is frozen or
+   * compact and keeps parser and index settings. Copying a parsed template
+   * skips tokenizing, see bench/Xml/Dom/BenchClone.cpp for the numbers.
+   *
+   * Copies get their own name dictionary unless share_dictionary is set.
+   * libxml2 dictionaries are not thread safe, so shared copies must not be
+   * changed from different threads at the same time.
+   */
+  Document clone(bool share_dictionary = false) const;
+
+  /**
+   * Apply edit script made by diff (see Diff.h) to root element. Root node is
+   * rebound when the script replaces it.
+   *
+   * @throw std::runtime_error if an edit does not fit the document, edits
+   * before it stay applied
+   */
+  void apply(const EditScript &script);
+
+  /**
+   * Build element by id and element by name indexes in one pass. Indexes are
+   * kept up to date by node and attribute mutations and rebuilt by parse, so
+   * lookups stay O(1) without walking the tree. Enable before sharing a frozen
+   * document with other threads.
+   *
+   * @param id_attribute Name of the attribute holding element ids
+   */
+  void enable_indexes(const std::string &id_attribute = "id");
+
+  /// Drop indexes
+  void disable_indexes();
+
+  bool has_indexes() const;
+
+  /**
+   * Element with given id, null node if there is none. With duplicate ids
+   * the first indexed element wins.
+   *
+   * @throw std::runtime_error if indexes are not enabled
+   */
+  Node get_element_by_id(const std::string &id) const;
+
+  /**
+   * Elements with given name, in document order until elements are removed
+   *
+   * @throw std::runtime_error if indexes are not enabled
+   */
+  std::vector<Node> get_elements_by_name(const std::string &name) const;
+
+  /**
+   * Merge adjacent text nodes and, if remove_blank_text is set, remove
+   * whitespace only text nodes outside xml:space="preserve" and outside mixed
+   * content (elements that also have other text). Those are the nodes child
+   * iteration skips anyway, so iteration of a document without them leaves
+   * out the blank node check per step until a mutation inserts nodes or
+   * changes text. Whitespace between inline elements, as in
+   * <p><b>Hello</b> <i>world</i></p>, is blank text too, so removal is opt-in.
+   * Changes are one undo step. Node objects bound to merged or removed text
+   * nodes become invalid.
+   *
+   * @throw std::runtime_error if document is frozen
+   */
+  void normalize(bool remove_blank_text = false);
+
+  /// True after normalize until a mutation may have added blank text, false
+  /// while blank text nodes are left
+  bool is_normalized() const;
+
+  /**
+   * Normalize every document parsed from now on, removing blank text. libxml2
+   * then drops blank text nodes while parsing (XML_PARSE_NOBLANKS) and the
+   * pass after it merges and removes what is left.
+   */
+  void set_normalize_on_parse(bool normalize);
+
+  bool get_normalize_on_parse() const;
+
+  /**
+   * Start recording mutations for undo and redo. Each mutation call is one
+   * step, transactions group several calls into one. The journal keeps the
+   * removed subtrees and previous values only, not copies of the document.
+   * History is dropped by parse and by disable_journal.
+   *
+   * Nodes taken out of the document by undo or redo belong to the journal,
+   * Node objects bound to them must not be used anymore.
+   *
+   * @throw std::runtime_error if document is frozen or compact
+   */
+  void enable_journal();
+
+  /**
+   * Drop journal and its history
+   *
+   * @throw std::runtime_error if a transaction is open
+   */
+  void disable_journal();
+
+  bool has_journal() const;
+
+  /**
+   * Mutations until the matching commit_transaction form one undo step.
+   * Transactions nest, the outermost one closes the step.
+   *
+   * @throw std::runtime_error if journal is not enabled
+   */
+  void begin_transaction();
+
+  /// @throw std::runtime_error if no transaction is open
+  void commit_transaction();
+
+  /**
+   * Undo mutations of the open outermost transaction and close it. Rolled
+   * back mutations cannot be redone.
+   *
+   * @throw std::runtime_error if no transaction or a nested one is open
+   */
+  void rollback_transaction();
+
+  bool can_undo() const;
+
+  bool can_redo() const;
+
+  /**
+   * Undo last step. A new mutation after undo drops the steps that could be
+   * redone. Root node is rebound when the step replaced it.
+   *
+   * @return false if there is nothing to undo
+   * @throw std::runtime_error if journal is not enabled or a transaction is
+   * open
+   */
+  bool undo();
+
+  /// Redo last undone step, see undo
+  bool redo();
+
+  /**
+   * Call observer on every mutation of this document until it is removed,
+   * see Observer.h. Observer is not owned and must outlive its registration.
+   * Copies made by clone do not take observers. Callbacks may add and remove
+   * observers, removed ones get no further calls and added ones start with
+   * the next notification.
+   */
+  void add_observer(Observer &observer);
+
+  void remove_observer(Observer &observer);
+
+  /**
+   * Save binary snapshot of document. Snapshot is the compact form of the
+   * document, see compact().
+   *
+   * @param path Snapshot file path, replaced atomically
+   */
+  void save_snapshot(const char *path) const;
+
+  inline void save_snapshot(const std::string &path) const
+  {
+    this->save_snapshot(path.c_str());
+  }
+
+  /**
+   * Load document from binary snapshot. File is memory mapped and used in
+   * place, nothing is parsed or allocated per node and processes loading the
+   * same snapshot share its pages. Loaded document is compact.
+   *
+   * @param path Snapshot file path
+   * @throw std::runtime_error if file is not a valid snapshot
+   */
+  void load_snapshot(const char *path);
+
+  inline void load_snapshot(const std::string &path)
+  {
+    this->load_snapshot(path.c_str());
+  }
+
   /**
    * Create new xml document
    */
@@ -88,6 +344,11 @@ public: // To allow dependency injection change this to protected
 
   Document(const std::string &version = "1.0");
 
+  /**
+   * Create new xml document parsing with given parser
+   */
+  explicit Document(Document::Parser parser, const std::string &version = "1.0");
+
   operator std::string() const;
   std::string to_string(bool pretty_print = false, bool skip_headers = true) const;
 
@@ -0,0 +1,85 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file DocumentCache.h
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief Cache of parsed documents keyed by file path
+ *
+ * Repeated loads of an unchanged file cost a stat() instead of a parse. A
+ * cached document is reused while the file keeps its inode, size and
+ * modification time, otherwise it is parsed again.
+ *
+ * Cached documents are compacted (see Document::compact), so they are
+ * read-only, can be shared between threads and their memory usage is known
+ * exactly. Least recently used documents are dropped once the memory budget is
+ * exceeded; documents still referenced by callers stay valid.
+ */
+
+#pragma once
+
+#include "Document.h"
+#include <memory>
+#include <string>
+
+namespace un::Xml::Dom
+{
+
+struct DocumentCache
+{
+public: // To allow dependency injection change this to protected
+  class Handler;
+  std::shared_ptr<DocumentCache::Handler> handler;
+
+  /// Default memory budget of the process wide cache
+  static const std::size_t default_memory_budget = 256 * 1024 * 1024;
+
+  /**
+   * Create cache
+   *
+   * @param memory_budget Upper bound of memory held by cached documents
+   * @param parser Parser used to load files
+   */
+  explicit DocumentCache(std::size_t memory_budget = default_memory_budget,
+                         Document::Parser parser = Document::Parser::native);
+
+  /// Process wide cache
+  static DocumentCache &instance();
+
+  /**
+   * Get document of file, parsing it if it is not cached or changed since.
+   * Safe to call from multiple threads.
+   *
+   * @param path Xml document file path
+   * @throw std::runtime_error if file cannot be read or parsed
+   */
+  std::shared_ptr<const Document> get(const char *path);
+
+  inline std::shared_ptr<const Document> get(const std::string &path)
+  {
+    return this->get(path.c_str());
+  }
+
+  /// Drop cached document of given path
+  void remove(const char *path);
+
+  inline void remove(const std::string &path)
+  {
+    this->remove(path.c_str());
+  }
+
+  /// Drop every cached document
+  void clear();
+
+  /// Change memory budget, evicts right away if needed
+  void set_memory_budget(std::size_t memory_budget);
+
+  std::size_t get_memory_budget() const;
+
+  /// Memory held by cached documents
+  std::size_t get_memory_usage() const;
+
+  /// Number of cached documents
+  std::size_t get_count() const;
+};
+
+}
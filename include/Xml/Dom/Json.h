@@ -0,0 +1,136 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file Json.h
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief Conversion between xml and JSON without intermediate trees
+ *
+ * JSON is written straight from the libxml2 tree or from pipeline events, and
+ * documents are built straight from JSON text. Two layouts are supported:
+ *
+ * objects: {"order": {"@id": "7", "item": ["a", "b"], "#text": "..."}}
+ *   Attributes are members with attribute_prefix, text is the text_key
+ *   member, child elements are members named after them. Elements with
+ *   neither attributes nor child elements are strings. All children with the
+ *   same name are one array member, placed where the first of them is.
+ *   Comments and processing instructions are dropped and mixed content loses
+ *   the order of text and elements.
+ *
+ * ordered: ["order", {"id": "7"}, ["item", "a"], ["item", "b"]]
+ *   JsonML: name, optional attribute object, then children in order. Only
+ *   comments and processing instructions are dropped.
+ *
+ * Whitespace only text next to elements is dropped in both layouts.
+ *
+ * Converting a document looks ahead for repeated siblings. Pipeline events
+ * cannot be looked ahead, so with JsonWriter as pipeline sink only elements
+ * listed in array_elements become arrays in objects layout; other repeated
+ * siblings become repeated members:
+ *
+ *   JsonConvention convention;
+ *   convention.array_elements = {"record"};
+ *   JsonWriter writer(output, convention);
+ *   Pipeline().run_file("records.xml", writer);
+ *
+ * See bench/Xml/Dom/BenchJson.cpp for throughput.
+ */
+
+#pragma once
+
+#include "Document.h"
+#include "Node.h"
+#include "Pipeline.h"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace un::Xml::Dom
+{
+
+struct JsonConvention
+{
+  enum class Layout
+  {
+    objects, ///< Attributes, text and children as object members
+    ordered  ///< JsonML arrays keeping document order
+  };
+
+  Layout layout;
+
+  /// Prefix of attribute members, objects layout only
+  std::string attribute_prefix;
+
+  /// Name of the text member, objects layout only
+  std::string text_key;
+
+  /// Elements always written as arrays, objects layout only
+  std::vector<std::string> array_elements;
+
+  JsonConvention(Layout layout = Layout::objects)
+      : layout(layout), attribute_prefix("@"), text_key("#text") {}
+};
+
+/**
+ * Writes elements as JSON values. Each root element is one value, values of
+ * several documents are separated by new lines (JSON lines).
+ */
+class JsonWriter : public Pipeline::Sink
+{
+public: // To allow dependency injection change this to protected
+  class Handler;
+  std::shared_ptr<JsonWriter::Handler> handler;
+
+  /// Append to output
+  explicit JsonWriter(std::string &output, const JsonConvention &convention = JsonConvention());
+
+  /// Write through callback whenever buffer_size bytes are collected
+  JsonWriter(const Pipeline::Serializer::Write &write, const JsonConvention &convention = JsonConvention(),
+             std::size_t buffer_size = Pipeline::Serializer::default_buffer_size);
+
+  void on_event(Pipeline::Event &event);
+
+  /// Flush
+  void on_end();
+
+  /**
+   * Write root element of document. Compact documents are expanded into a
+   * copy first.
+   *
+   * @throw std::runtime_error if document has no root element
+   */
+  void write(const Document &document);
+
+  /// Write subtree of element
+  void write(const Node &node);
+
+  /// Write out buffered data
+  void flush();
+};
+
+std::string to_json(const Document &document, const JsonConvention &convention = JsonConvention());
+
+std::string to_json(const Node &node, const JsonConvention &convention = JsonConvention());
+
+/// Replace content of output, its capacity is reused
+void to_json(const Document &document, std::string &output, const JsonConvention &convention = JsonConvention());
+
+void to_json(const Node &node, std::string &output, const JsonConvention &convention = JsonConvention());
+
+/**
+ * Build document from JSON in given layout. In objects layout the top level
+ * object must have exactly one member, the root element. Numbers, true and
+ * false become text, null an empty element. xmlns attributes declare
+ * namespaces like in xml.
+ *
+ * @throw std::runtime_error if JSON is malformed, does not fit the layout or
+ * holds characters xml does not allow
+ */
+Document from_json(const char *data, std::size_t size, const JsonConvention &convention = JsonConvention());
+
+inline Document from_json(const std::string &json, const JsonConvention &convention = JsonConvention())
+{
+  return from_json(json.data(), json.size(), convention);
+}
+
+}
@@ -8,15 +8,29 @@
 
 #pragma once
 
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <cstring>
+#include <vector>
 
 namespace un::Xml::Dom
 {
 
 struct Document;
 
+/// Namespace of an element or attribute, prefix is only used to declare it
+struct Namespace
+{
+  std::string uri;
+  std::string prefix;
+
+  Namespace(const std::string &uri, const std::string &prefix = std::string()) : uri(uri), prefix(prefix) {}
+};
+
 /**
  * Xml Node class.
  *
@@ -67,6 +81,20 @@ struct Node
      */
     operator const std::string() const;
 
+    /**
+     * Parse content as T without copying it. T is one of int32_t, int64_t,
+     * uint32_t, uint64_t, float, double and bool. White space around the value
+     * is ignored, parsing does not depend on locale.
+     *
+     * @throw std::runtime_error if content is not a valid T
+     */
+    template <class T>
+    T as() const;
+
+    /// Parse content as T, empty if content is not a valid T
+    template <class T>
+    std::optional<T> try_as() const;
+
     template <std::size_t strsize>
     inline auto operator=(const char (&rhs)[strsize]) -> decltype(rhs)
     {
@@ -216,8 +244,38 @@ struct Node
     {
       return !this->get()->is_equal(rhs.get());
     }
+
+    /// Address of current node, NULL at end
+    inline const void *get_address() const { return this->get()->get_address(); }
   };
 
+  /// Execution policy of Node::visit
+  enum class ExecutionPolicy
+  {
+    sequential,
+    parallel
+  };
+
+  typedef std::function<void(const Node &)> Visitor;
+
+  /**
+   * Calls visitor for this node and every element below it.
+   *
+   * Sequential visit walks the tree in document order on the calling thread.
+   * Parallel visit splits sibling ranges between worker threads of a work
+   * stealing scheduler and calls visitor concurrently in no particular order.
+   * Parallel visit needs a frozen document (see Document::freeze). First
+   * exception thrown by visitor stops the visit and is rethrown.
+   *
+   * @param visitor Called once for each element
+   * @param policy Execution policy
+   * @param thread_count Number of threads for parallel visit, 0 for hardware
+   * concurrency
+   */
+  void visit(const Visitor &visitor,
+             ExecutionPolicy policy = ExecutionPolicy::sequential,
+             std::size_t thread_count = 0) const;
+
   /// Get node by name
   Node operator[](const char *const key) const;
 
@@ -227,6 +285,62 @@ struct Node
   /// Get node by index
   Node operator[](int index) const;
 
+  /**
+   * First child element with given namespace URI (empty for no namespace)
+   * and local name, null node if there is none. See QualifiedPath for paths.
+   */
+  Node get_child(const std::string &uri, const std::string &name) const;
+
+  /// Namespace URI of this element, empty if it has none
+  std::string get_namespace_uri() const;
+
+  /**
+   * Parse content of every child element with given name as T and append them
+   * to values in document order. See Node::ContentPropertyType::as for T.
+   *
+   * @return Number of values appended
+   * @throw std::runtime_error if a content is not a valid T, values is left
+   * as it was
+   */
+  template <class T>
+  std::size_t children_as(const char *name, std::vector<T> &values) const;
+
+  template <class T>
+  inline std::size_t children_as(const std::string &name, std::vector<T> &values) const
+  {
+    return this->children_as(name.c_str(), values);
+  }
+
+  /**
+   * Receiver of Node::scan. Sink maps names to its own field numbers, only
+   * attributes and children with a field are converted.
+   */
+  class ScanSink
+  {
+  public:
+    virtual ~ScanSink() {}
+
+    /// Field of attribute with given local name, -1 to skip it
+    virtual int find_attribute(const char *name) = 0;
+
+    /// Field of child element with given local name, -1 to skip it
+    virtual int find_element(const char *name) = 0;
+
+    /// True if field takes the child node instead of its content
+    virtual bool is_node_field(int field) const = 0;
+
+    /// Attribute value or child content, valid during the call only
+    virtual void on_content(int field, std::string_view content) = 0;
+
+    virtual void on_node(int field, const Node &child) = 0;
+  };
+
+  /**
+   * Single pass over attributes and then child elements in document order.
+   * Content of matched fields is passed without copying where possible.
+   */
+  void scan(ScanSink &sink) const;
+
   /**
    * Remove node from childs list. This will just unbind from this node and will
    * make it free.
@@ -243,6 +357,58 @@ struct Node
    */
   void push_front(const Node &node);
 
+  /**
+   * Deep copy of this node with its attributes and children. Copy is free,
+   * it belongs to no document until it is inserted somewhere. Nodes of compact
+   * documents are copied into regular mutable nodes.
+   */
+  Node clone() const;
+
+  /**
+   * Structural hash of this subtree: names, namespace URIs, attributes and
+   * text. Attribute order and namespace prefixes do not change it. Hashes
+   * are cached per element and dropped when the subtree changes, so hashing
+   * again after a small change only walks the changed path.
+   */
+  uint64_t hash() const;
+
+  /**
+   * True if both subtrees have the same structure and content. Nodes with
+   * different hashes are rejected without walking the trees.
+   *
+   * @param ordered_attributes Attributes must also be in the same order
+   */
+  bool deep_equal(const Node &rhs, bool ordered_attributes = false) const;
+
+  /**
+   * Appends nodes in order. Nodes are linked as one sibling chain instead of
+   * one by one, adjacent text nodes are not merged. Nodes stay valid as
+   * bindings to the new children.
+   *
+   * @throw std::runtime_error if a node is owned by another document or node,
+   * nothing is inserted then
+   */
+  void append_range(const std::vector<Node> &nodes);
+
+  /// Inserts node before position, end() appends
+  void insert_before(const iterator &position, const Node &node);
+
+  /// Inserts nodes before position in order, see append_range
+  void insert_before(const iterator &position, const std::vector<Node> &nodes);
+
+  /// Inserts node after position, which must not be end()
+  void insert_after(const iterator &position, const Node &node);
+
+  /// Inserts nodes after position in order, see append_range
+  void insert_after(const iterator &position, const std::vector<Node> &nodes);
+
+  /**
+   * Moves every child of source before position (end() appends) in one
+   * operation. Source stays empty. Source may belong to another document,
+   * which the moved children then no longer depend on.
+   */
+  void splice(const iterator &position, const Node &source);
+
   /// Unbind last element
   Node pop_back();
 
@@ -329,6 +495,18 @@ struct Node
     /// Value property object. Just an interface to node class
     ValuePropertyType value;
 
+    /**
+     * Parse value as T, see Node::ContentPropertyType::as
+     *
+     * @throw std::runtime_error if value is not a valid T
+     */
+    template <class T>
+    T as() const;
+
+    /// Parse value as T, empty if value is not a valid T
+    template <class T>
+    std::optional<T> try_as() const;
+
     bool operator==(decltype(nullptr)) const;
 
     inline bool operator!=(decltype(nullptr)) const
@@ -380,6 +558,9 @@ struct Node
     /// Get attribute from name
     Node::Attribute operator[](const std::string &name) const;
 
+    /// Get attribute by namespace URI (empty for no namespace) and local name
+    Node::Attribute get(const std::string &uri, const std::string &name) const;
+
     /// Node::Attributes::IsEmpty property class
     struct IsEmptyPropertyType
     {
@@ -403,6 +584,16 @@ struct Node
     void push_back(const char *name, std::size_t name_size, const char *value, std::size_t value_size);
     void push_back(const char *name, const char *value);
 
+    /**
+     * Add attribute in namespace. Namespace is declared on this element with
+     * its prefix unless a prefixed declaration of it is in scope already. If
+     * the prefix is bound to another namespace here a number is appended.
+     *
+     * @throw std::runtime_error if prefix is empty, attributes have no default
+     * namespace
+     */
+    void push_back(const Namespace &ns, const std::string &name, const std::string &value);
+
     template <std::size_t namesize, std::size_t valuesize>
     void push_back(const char (&name)[namesize], const char (&value)[valuesize])
     {
@@ -516,6 +707,12 @@ struct Node
    */
   Node(const std::string &name);
 
+  /**
+   * New element in namespace, the namespace is declared on it with the
+   * prefix of ns ("" declares the default namespace)
+   */
+  Node(const Namespace &ns, const std::string &name);
+
   /**
    * Binds another node to this object
    */
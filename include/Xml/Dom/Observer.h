@@ -0,0 +1,52 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file Observer.h
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief Change notifications of a document
+ *
+ * Observers registered with Document::add_observer are called synchronously
+ * from node and attribute mutations, undo and redo, so data derived from the
+ * document can be updated per change instead of recomputed. Documents without
+ * observers pay one empty check per mutation.
+ *
+ * Callbacks run in the middle of the mutation: they may read the document but
+ * must not change it and must not throw.
+ */
+
+#pragma once
+
+#include "Node.h"
+#include <string>
+
+namespace un::Xml::Dom
+{
+
+class Observer
+{
+public:
+  virtual ~Observer() {}
+
+  /**
+   * Child was linked below parent. Child is the top of the inserted subtree,
+   * nodes below it are not reported one by one. Parent is a null node when
+   * child became the root element.
+   */
+  virtual void on_child_inserted(const Node &/*parent*/, const Node &/*child*/) {}
+
+  /// Child is about to be unlinked from parent, its subtree can still be read
+  virtual void on_child_removing(const Node &/*parent*/, const Node &/*child*/) {}
+
+  /// Content of a text, CDATA, comment or processing instruction node changed
+  virtual void on_content_changed(const Node &/*node*/) {}
+
+  /// Attribute was added or got a new value, name is qualified with its prefix
+  virtual void on_attribute_set(const Node &/*element*/, const std::string &/*name*/,
+                                const std::string &/*value*/) {}
+
+  virtual void on_attribute_removed(const Node &/*element*/, const std::string &/*name*/) {}
+
+  virtual void on_name_changed(const Node &/*element*/, const std::string &/*old_name*/) {}
+};
+
+}
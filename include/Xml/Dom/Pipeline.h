@@ -0,0 +1,219 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file Pipeline.h
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief Streaming transforms of xml events from source through stages to sink
+ *
+ * Input is parsed by the libxml2 push parser into events, events go through
+ * the stages in the order they were added and whatever is left reaches the
+ * sink. No tree is built, memory use is bounded by the longest text node and
+ * the element depth instead of the document size:
+ *
+ *   Pipeline pipeline;
+ *   pipeline.drop("debug").rename("old", "new").map([](Pipeline::Event &event) {
+ *     ...
+ *   });
+ *   Pipeline::Serializer output("out.xml.gz");
+ *   pipeline.run_file("in.xml", output);
+ *
+ * Names are qualified names as written in the document. Namespace
+ * declarations are xmlns attributes of their element, so renaming or dropping
+ * elements keeps prefixes bound. References to internal entities are replaced
+ * by their text and DOCTYPE is not passed on. External entities and the
+ * external DTD subset are never loaded, neither from the network nor from
+ * local files; referencing an external entity fails the pass.
+ */
+
+#pragma once
+
+#include "Document.h"
+#include <cstddef>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace un::Xml::Dom
+{
+
+struct Pipeline
+{
+public: // To allow dependency injection change this to protected
+  class Handler;
+  std::shared_ptr<Pipeline::Handler> handler;
+
+  struct Attribute
+  {
+    std::string name;
+    std::string value;
+  };
+
+  /**
+   * One piece of the document. Event objects are reused for the following
+   * events, copy what has to outlive the call.
+   */
+  struct Event
+  {
+    enum class Type
+    {
+      start_element,
+      end_element,
+      text,
+      cdata,
+      comment,
+      processing_instruction
+    };
+
+    Type type;
+
+    /// Element name or processing instruction target
+    std::string name;
+
+    /// Attributes of start_element in document order
+    std::vector<Attribute> attributes;
+
+    /// Text, CDATA, comment or processing instruction data
+    std::string content;
+
+    /// Number of elements the event is in, 0 for the root element
+    std::size_t depth;
+
+    /// Attribute value, NULL if element has no such attribute
+    const std::string *get_attribute(const std::string &name) const;
+
+    /// Replace value of attribute or add it
+    void set_attribute(const std::string &name, const std::string &value);
+
+    void remove_attribute(const std::string &name);
+  };
+
+  /// Receives events
+  class Sink
+  {
+  public:
+    virtual ~Sink() {}
+
+    /// Sink may change or move from event
+    virtual void on_event(Event &event) = 0;
+
+    /// Called once after the last event of a pass
+    virtual void on_end() {}
+  };
+
+  /// Transform step, passes zero or more events on to next for each event
+  class Stage
+  {
+  public:
+    virtual ~Stage() {}
+
+    virtual void on_event(Event &event, Sink &next) = 0;
+
+    /// Forget state of an interrupted pass, called when a pass begins
+    virtual void reset() {}
+  };
+
+  /**
+   * Sink writing events as xml text through a buffer. Empty elements are
+   * written as <name/>. No xml declaration is written.
+   */
+  class Serializer : public Sink
+  {
+  public: // To allow dependency injection change this to protected
+    class Handler;
+    std::shared_ptr<Serializer::Handler> handler;
+
+    typedef std::function<void(const char *data, std::size_t size)> Write;
+
+    static const std::size_t default_buffer_size = 64 * 1024;
+
+    /// Write through callback whenever buffer_size bytes are collected
+    explicit Serializer(const Write &write, std::size_t buffer_size = default_buffer_size);
+
+    /// Append to output
+    explicit Serializer(std::string &output);
+
+    explicit Serializer(std::ostream &output, std::size_t buffer_size = default_buffer_size);
+
+    /**
+     * Write file, compressing it like Document::save_file
+     *
+     * @throw std::runtime_error if file cannot be created
+     */
+    Serializer(const char *path, Document::Compression compression = Document::Compression::by_extension);
+
+    void on_event(Event &event);
+
+    /// Flush, files are closed
+    void on_end();
+
+    /// Write out buffered data
+    void flush();
+  };
+
+  Pipeline();
+
+  /// Add stage, events go through stages in the order they were added
+  Pipeline &add(const std::shared_ptr<Stage> &stage);
+
+  /**
+   * Keep events keep returns true for. When a start_element is dropped the
+   * whole element goes with it. end_element events are not tested, they
+   * follow their start_element.
+   */
+  Pipeline &filter(const std::function<bool(const Event &event)> &keep);
+
+  /**
+   * Change events in place. end_element events are not passed to change,
+   * they get the name their start_element was changed to.
+   */
+  Pipeline &map(const std::function<void(Event &event)> &change);
+
+  /// Drop elements of given name with everything inside them
+  Pipeline &drop(const std::string &name);
+
+  /// Rename elements
+  Pipeline &rename(const std::string &from, const std::string &to);
+
+  /**
+   * Run a pass over data
+   *
+   * @throw std::runtime_error if data is not well formed. Events before the
+   * error already reached the sink, on_end is not called.
+   */
+  void run(const char *data, std::size_t size, Sink &sink);
+
+  inline void run(const std::string &data, Sink &sink)
+  {
+    this->run(data.data(), data.size(), sink);
+  }
+
+  /**
+   * Run a pass over file, reading it in chunks. Gzip, zstd and xz compressed
+   * files are decompressed while reading.
+   *
+   * @throw std::runtime_error if file cannot be read or is not well formed
+   */
+  void run_file(const char *path, Sink &sink);
+
+  inline void run_file(const std::string &path, Sink &sink)
+  {
+    this->run_file(path.c_str(), sink);
+  }
+
+  /// Start a pass fed by push, previous unfinished pass is dropped
+  void begin(Sink &sink);
+
+  /**
+   * Feed next chunk, events are passed on as soon as they are complete
+   *
+   * @throw std::runtime_error if data is not well formed or no pass began
+   */
+  void push(const char *data, std::size_t size);
+
+  /// Finish pass
+  void end();
+};
+
+}
@@ -0,0 +1,81 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file QualifiedPath.h
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief Namespace qualified element paths compiled once
+ *
+ * Segments are "prefix:name" with prefixes bound to URIs when compiling, so
+ * documents may use any prefixes for the same namespace:
+ *
+ *   QualifiedPath path("s:Body/m:GetPrice",
+ *                      {{"s", "http://www.w3.org/2003/05/soap-envelope"}, {"m", "urn:m"}});
+ *   Node price = path.select(envelope);
+ *
+ * A segment without prefix matches elements in no namespace, or in the
+ * default namespace when prefix "" is bound. "*" matches any element and
+ * "p:*" any element of a namespace.
+ *
+ * Each URI is stored once in the path. While selecting, every namespace
+ * declaration met is compared with them once and elements are then matched by
+ * declaration pointer; compact documents intern URIs already and compare ids.
+ */
+
+#pragma once
+
+#include "Node.h"
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace un::Xml::Dom
+{
+
+struct QualifiedPath
+{
+  /// Namespace of a step when it is not an index into uris
+  static const std::size_t no_namespace = static_cast<std::size_t>(-1);
+  static const std::size_t any_namespace = static_cast<std::size_t>(-2);
+
+  struct Step
+  {
+    std::size_t uri;
+
+    /// Local name, empty for any name
+    std::string name;
+  };
+
+  /// Prefix and URI pairs
+  typedef std::vector<std::pair<std::string, std::string>> Prefixes;
+
+  std::vector<std::string> uris;
+  std::vector<Step> steps;
+
+  /// Empty path, see append
+  QualifiedPath();
+
+  /**
+   * @param path Segments separated by '/'
+   * @param prefixes Prefix bindings, "" binds the default namespace
+   * @throw std::runtime_error if a segment is empty or uses an unbound prefix
+   */
+  QualifiedPath(const std::string &path, const Prefixes &prefixes);
+
+  /**
+   * Add step matching elements with given namespace URI (empty for no
+   * namespace) and local name (empty for any)
+   */
+  QualifiedPath &append(const std::string &uri, const std::string &name);
+
+  /// Add step matching any namespace
+  QualifiedPath &append_any_namespace(const std::string &name);
+
+  /// First matching element below node in document order, null node if none
+  Node select(const Node &node) const;
+
+  /// Every matching element below node in document order
+  std::vector<Node> select_all(const Node &node) const;
+};
+
+}
@@ -0,0 +1,86 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file RecordSplitter.h
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief Splits flat record files and parses records in parallel
+ *
+ * Files of the form <root><rec/>...<rec/></root> are scanned once for the
+ * boundaries of root's child elements, then every record is parsed as a
+ * separate document on worker threads.
+ *
+ * Each record is parsed on its own, so declarations made on the root element
+ * (e.g. namespace prefixes) and entities from the DTD are not visible inside
+ * the records.
+ */
+
+#pragma once
+
+#include "Document.h"
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace un::Xml::Dom
+{
+
+struct RecordSplitter
+{
+public: // To allow dependency injection change this to protected
+  class Handler;
+  std::shared_ptr<RecordSplitter::Handler> handler;
+
+  /// Raw record data, points into the scanned buffer
+  struct Record
+  {
+    const char *data;
+    std::size_t size;
+
+    inline operator std::string() const { return std::string(data, size); }
+  };
+
+  typedef std::function<void(std::size_t index, Document &record)> Callback;
+
+  /**
+   * Map and scan file
+   *
+   * @param path Xml file path
+   */
+  explicit RecordSplitter(const char *path);
+
+  explicit RecordSplitter(const std::string &path);
+
+  /**
+   * Scan memory. Data is not copied and must outlive the splitter.
+   *
+   * @param data Xml data
+   * @param size Size of data
+   */
+  RecordSplitter(const char *data, std::size_t size);
+
+  /// Number of records found
+  std::size_t get_count() const;
+
+  /// Get record by index
+  Record operator[](std::size_t index) const;
+
+  /**
+   * Parse every record on worker threads and call callback with its document.
+   * Callback is called concurrently, from any worker, in no particular order.
+   *
+   * @param callback Called once for each parsed record
+   * @param thread_count Number of threads, 0 for hardware concurrency
+   */
+  void parse(const Callback &callback, std::size_t thread_count = 0) const;
+
+  /**
+   * Parse every record on worker threads.
+   *
+   * @param thread_count Number of threads, 0 for hardware concurrency
+   * @return Documents in record order
+   */
+  std::vector<Document> parse(std::size_t thread_count = 0) const;
+};
+
+}
@@ -0,0 +1,107 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file Schema.h
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief XSD and RelaxNG schemas compiled once and validated against many times
+ *
+ * The schema language is taken from the namespace of the schema root element.
+ * A compiled schema is never changed by validation, so one Schema can be
+ * copied to and used from any number of threads. Every validation running at
+ * the same time takes its own validation context from a pool of the schema,
+ * contexts are created on first use and reused afterwards.
+ *
+ *   Schema schema("message.xsd");
+ *   schema.validate(document);        // Parsed document
+ *   schema.validate_file("in.xml");   // Streaming, no tree is built
+ */
+
+#pragma once
+
+#include "Document.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace un::Xml::Dom
+{
+
+struct Schema
+{
+public: // To allow dependency injection change this to protected
+  class Handler;
+  std::shared_ptr<Schema::Handler> handler;
+
+  enum class Language
+  {
+    xsd,
+    relaxng
+  };
+
+  /**
+   * Compile schema file. Includes and imports are resolved relative to it.
+   *
+   * @param path Schema file path
+   * @throw std::runtime_error if file cannot be parsed or is not a schema
+   */
+  explicit Schema(const char *path);
+
+  explicit Schema(const std::string &path);
+
+  /**
+   * Compile schema from memory
+   *
+   * @param data Schema document
+   * @param size Size of data
+   * @throw std::runtime_error if data cannot be parsed or is not a schema
+   */
+  Schema(const char *data, std::size_t size);
+
+  /// Compile schema from a parsed document, document is not changed
+  explicit Schema(const Document &document);
+
+  Language get_language() const;
+
+  /**
+   * Validate document. Compact documents are expanded into a copy first.
+   *
+   * @param errors Receives one message per validation error
+   * @return true if document is valid
+   */
+  bool validate(const Document &document, std::vector<std::string> &errors) const;
+
+  /// @throw std::runtime_error with the validation errors if document is invalid
+  void validate(const Document &document) const;
+
+  /**
+   * Validate while reading data with a streaming reader, only the current
+   * node is held in memory. Malformed data is reported like invalid data.
+   *
+   * @param errors Receives one message per parse or validation error
+   * @return true if data is well formed and valid
+   */
+  bool validate(const char *data, std::size_t size, std::vector<std::string> &errors) const;
+
+  void validate(const char *data, std::size_t size) const;
+
+  /**
+   * Validate file while reading it, see validate(data, size, errors)
+   *
+   * @throw std::runtime_error if file cannot be opened
+   */
+  bool validate_file(const char *path, std::vector<std::string> &errors) const;
+
+  void validate_file(const char *path) const;
+
+  inline bool validate_file(const std::string &path, std::vector<std::string> &errors) const
+  {
+    return this->validate_file(path.c_str(), errors);
+  }
+
+  inline void validate_file(const std::string &path) const
+  {
+    this->validate_file(path.c_str());
+  }
+};
+
+}
@@ -0,0 +1,134 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file Async.cpp
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief Awaitable parse and save (C++20)
+ */
+
+#include <Xml/Dom/Async.h>
+#include "DocumentHandlerLibxml2.h"
+#include <deque>
+#include <mutex>
+#include <semaphore>
+#include <thread>
+#include <vector>
+
+namespace un::Xml::Dom
+{
+
+class ThreadPoolExecutor::Handler
+{
+private:
+  std::mutex _lock;
+  std::deque<Executor::Task> _tasks;
+  std::vector<std::thread> _threads;
+
+  /// One count per queued task, plus one per thread when stopping
+  std::counting_semaphore<> _ready;
+
+  void run()
+  {
+    while (true)
+    {
+      this->_ready.acquire();
+      Executor::Task task;
+      {
+        std::lock_guard<std::mutex> guard(this->_lock);
+        if (this->_tasks.empty())
+        {
+          return;
+        }
+        task = std::move(this->_tasks.front());
+        this->_tasks.pop_front();
+      }
+      task();
+    }
+  }
+
+public:
+  explicit Handler(std::size_t thread_count) : _ready(0)
+  {
+    if (thread_count == 0)
+    {
+      thread_count = std::thread::hardware_concurrency();
+    }
+    if (thread_count == 0)
+    {
+      thread_count = 1;
+    }
+
+    for (std::size_t i = 0; i < thread_count; ++i)
+    {
+      this->_threads.emplace_back([this]() { this->run(); });
+    }
+  }
+
+  ~Handler()
+  {
+    this->_ready.release(static_cast<std::ptrdiff_t>(this->_threads.size()));
+    for (std::thread &thread : this->_threads)
+    {
+      thread.join();
+    }
+  }
+
+  Handler(const Handler &) = delete;
+  Handler &operator=(const Handler &) = delete;
+
+  void execute(Executor::Task task)
+  {
+    {
+      std::lock_guard<std::mutex> guard(this->_lock);
+      this->_tasks.push_back(std::move(task));
+    }
+    this->_ready.release();
+  }
+
+  std::size_t get_thread_count() const { return this->_threads.size(); }
+};
+
+ThreadPoolExecutor::ThreadPoolExecutor(std::size_t thread_count)
+    : handler(new ThreadPoolExecutor::Handler(thread_count)) {}
+
+void ThreadPoolExecutor::execute(Task task) { this->handler->execute(std::move(task)); }
+
+std::size_t ThreadPoolExecutor::get_thread_count() const { return this->handler->get_thread_count(); }
+
+Executor &default_executor()
+{
+  static ThreadPoolExecutor executor;
+  return executor;
+}
+
+Awaitable<Document> async_parse_file(const std::string &path, Document::Parser parser, Executor &executor)
+{
+  Document::Handler::initialize_threads();
+  return Awaitable<Document>(
+      [path, parser]() {
+        Document document(parser);
+        document.handler->parse_file_read_ahead(path.c_str());
+        document.root_node.handler.reset();
+        document.handler->get_root_node(document.root_node);
+        return document;
+      },
+      executor);
+}
+
+Awaitable<void> async_save(const Document &document, const std::string &path, bool pretty_print,
+                           Document::Compression compression, Executor &executor)
+{
+  return Awaitable<void>(
+      [&document, path, pretty_print, compression]() { document.save_file(path, pretty_print, compression); },
+      executor);
+}
+
+Awaitable<std::string> async_to_string(const Document &document, bool pretty_print, bool skip_headers,
+                                       Executor &executor)
+{
+  return Awaitable<std::string>(
+      [&document, pretty_print, skip_headers]() { return document.to_string(pretty_print, skip_headers); },
+      executor);
+}
+
+}
@@ -0,0 +1,95 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file Binding.cpp
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief Value conversions of struct bindings
+ */
+
+#include <Xml/Dom/Binding.h>
+#include "ValueParser.h"
+#include <charconv>
+#include <stdexcept>
+
+namespace un::Xml::Dom::BindingDetail
+{
+
+namespace
+{
+
+template <class T>
+void parse_value(std::string_view text, T &value)
+{
+  if (!ValueParser::parse(text, value))
+  {
+    throw std::runtime_error("Cannot convert '" + std::string(text) + "' to " +
+                             ValueParser::get_type_name<T>());
+  }
+}
+
+template <class T>
+std::string format_value(T value)
+{
+  char buffer[64];
+  std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  return std::string(buffer, result.ptr);
+}
+
+} // namespace
+
+void parse(std::string_view text, int32_t &value) { parse_value(text, value); }
+
+void parse(std::string_view text, int64_t &value) { parse_value(text, value); }
+
+void parse(std::string_view text, uint32_t &value) { parse_value(text, value); }
+
+void parse(std::string_view text, uint64_t &value) { parse_value(text, value); }
+
+void parse(std::string_view text, float &value) { parse_value(text, value); }
+
+void parse(std::string_view text, double &value) { parse_value(text, value); }
+
+void parse(std::string_view text, bool &value) { parse_value(text, value); }
+
+void parse(std::string_view text, std::string &value) { value.assign(text.data(), text.size()); }
+
+std::string format(int32_t value) { return format_value(value); }
+
+std::string format(int64_t value) { return format_value(value); }
+
+std::string format(uint32_t value) { return format_value(value); }
+
+std::string format(uint64_t value) { return format_value(value); }
+
+std::string format(float value) { return format_value(value); }
+
+std::string format(double value) { return format_value(value); }
+
+std::string format(bool value) { return value ? "true" : "false"; }
+
+const std::string &format(const std::string &value) { return value; }
+
+std::string escape(const std::string &text)
+{
+  if (text.find('&') == std::string::npos)
+  {
+    return text;
+  }
+
+  std::string result;
+  result.reserve(text.size() + 16);
+  for (char c : text)
+  {
+    if (c == '&')
+    {
+      result += "&amp;";
+    }
+    else
+    {
+      result += c;
+    }
+  }
+  return result;
+}
+
+}
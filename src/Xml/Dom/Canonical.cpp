@@ -0,0 +1,381 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file Canonical.cpp
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief Canonical XML output and hashing
+ */
+
+#include <Xml/Dom/Canonical.h>
+#include "DocumentHandlerLibxml2.h"
+#include "NodeHandlerLibxml2.h"
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <libxml/c14n.h>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace un::Xml::Dom
+{
+
+namespace
+{
+
+/// Output buffer context, exceptions of sink are kept until libxml2 returns
+struct SinkContext
+{
+  const CanonicalSink &sink;
+  std::exception_ptr error;
+};
+
+int write_to_sink(void *context, const char *buffer, int size)
+{
+  SinkContext *sink_context = static_cast<SinkContext *>(context);
+  try
+  {
+    sink_context->sink(buffer, static_cast<std::size_t>(size));
+  }
+  catch (...)
+  {
+    sink_context->error = std::current_exception();
+    return -1;
+  }
+  return size;
+}
+
+/// Node set of c14n is the subtree of root, namespace nodes are checked by their element
+int is_in_subtree(void *root, xmlNodePtr node, xmlNodePtr parent)
+{
+  xmlNodePtr i = node == NULL || node->type == XML_NAMESPACE_DECL ? parent : node;
+  for (; i != NULL; i = i->parent)
+  {
+    if (i == root)
+    {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/// Next node after node inside top in document order, contents of entity references are skipped
+xmlNodePtr next_node(xmlNodePtr node, xmlNodePtr top)
+{
+  if ((node->type == XML_ELEMENT_NODE || node->type == XML_DOCUMENT_NODE) && node->children != NULL)
+  {
+    return node->children;
+  }
+  while (node != top && node->next == NULL)
+  {
+    node = node->parent;
+  }
+  return node == top ? NULL : node->next;
+}
+
+bool has_entity_references(xmlNodePtr top)
+{
+  for (xmlNodePtr i = top; i != NULL; i = next_node(i, top))
+  {
+    if (i->type == XML_ENTITY_REF_NODE)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Replace entity references in copy of source with their text, as compact
+ * trees store them. Text is taken from source because copied declarations
+ * lack the parsed content of entities.
+ */
+void substitute_entities(xmlNodePtr source_top, xmlNodePtr top)
+{
+  for (xmlNodePtr source = source_top, i = top; i != NULL;
+       source = next_node(source, source_top), i = next_node(i, top))
+  {
+    if (i->type == XML_ENTITY_REF_NODE)
+    {
+      xmlChar *content = xmlNodeGetContent(source);
+      xmlNodePtr text = xmlNewDocText(i->doc, content == NULL ? BAD_CAST "" : content);
+      xmlFree(content);
+      if (text == NULL)
+      {
+        throw std::runtime_error("xmlNewDocText failed");
+      }
+      xmlReplaceNode(i, text);
+      xmlFreeNode(i);
+      i = text;
+    }
+  }
+}
+
+void execute(xmlDocPtr doc, xmlNodePtr root, const CanonicalSink &sink, const Canonicalization &options)
+{
+  // c14n rejects entity references anywhere in the document, even outside
+  // of root, canonicalize a copy without them
+  std::shared_ptr<xmlDoc> copy;
+  xmlNodePtr top = reinterpret_cast<xmlNodePtr>(doc);
+  if (has_entity_references(top))
+  {
+    std::vector<std::size_t> path;
+    for (xmlNodePtr i = root; i != NULL && i != top; i = i->parent)
+    {
+      std::size_t index = 0;
+      for (xmlNodePtr sibling = i->prev; sibling != NULL; sibling = sibling->prev)
+      {
+        ++index;
+      }
+      path.push_back(index);
+    }
+
+    copy.reset(xmlCopyDoc(doc, 1), xmlFreeDoc);
+    if (copy == nullptr)
+    {
+      throw std::runtime_error("xmlCopyDoc failed");
+    }
+    substitute_entities(top, reinterpret_cast<xmlNodePtr>(copy.get()));
+    doc = copy.get();
+
+    // Same position in the copy, substituting keeps the number of siblings
+    if (root != NULL)
+    {
+      root = reinterpret_cast<xmlNodePtr>(doc);
+      for (auto i = path.rbegin(); i != path.rend(); ++i)
+      {
+        root = root->children;
+        for (std::size_t j = 0; j < *i; ++j)
+        {
+          root = root->next;
+        }
+      }
+    }
+  }
+
+  int mode = XML_C14N_1_0;
+  if (options.method == Canonicalization::Method::exclusive_1_0)
+  {
+    mode = XML_C14N_EXCLUSIVE_1_0;
+  }
+  else if (options.method == Canonicalization::Method::c14n_1_1)
+  {
+    mode = XML_C14N_1_1;
+  }
+
+  std::vector<xmlChar *> prefixes;
+  if (mode == XML_C14N_EXCLUSIVE_1_0 && !options.inclusive_prefixes.empty())
+  {
+    for (const std::string &prefix : options.inclusive_prefixes)
+    {
+      prefixes.push_back(BAD_CAST prefix.c_str());
+    }
+    prefixes.push_back(NULL);
+  }
+
+  SinkContext context{sink, nullptr};
+  xmlOutputBufferPtr buffer = xmlOutputBufferCreateIO(write_to_sink, NULL, &context, NULL);
+  if (buffer == NULL)
+  {
+    throw std::runtime_error("xmlOutputBufferCreateIO failed");
+  }
+
+  int result = xmlC14NExecute(doc, root == NULL ? NULL : is_in_subtree, root, mode,
+                              prefixes.empty() ? NULL : prefixes.data(), options.with_comments ? 1 : 0, buffer);
+  if (xmlOutputBufferClose(buffer) < 0 && result >= 0)
+  {
+    result = -1;
+  }
+
+  if (context.error != nullptr)
+  {
+    std::rethrow_exception(context.error);
+  }
+  if (result < 0)
+  {
+    throw std::runtime_error("xmlC14NExecute failed");
+  }
+}
+
+inline uint32_t rotate(uint32_t value, int bits)
+{
+  return (value >> bits) | (value << (32 - bits));
+}
+
+const uint32_t round_constants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+}
+
+void canonicalize(const Document &document, const CanonicalSink &sink, const Canonicalization &options)
+{
+  std::shared_ptr<xmlDoc> doc = document.handler->get_output_doc();
+  execute(doc.get(), NULL, sink, options);
+}
+
+void canonicalize(const Node &node, const CanonicalSink &sink, const Canonicalization &options)
+{
+  if (node.handler == nullptr || node.handler->get_pointer() == NULL)
+  {
+    throw std::runtime_error("Null object");
+  }
+
+  xmlNodePtr root = NULL;
+  std::shared_ptr<xmlDoc> doc = node.handler->get_output_tree(root);
+  execute(doc.get(), root, sink, options);
+}
+
+std::string to_canonical_string(const Document &document, const Canonicalization &options)
+{
+  std::string result;
+  canonicalize(document, [&result](const char *data, std::size_t size) { result.append(data, size); }, options);
+  return result;
+}
+
+std::string to_canonical_string(const Node &node, const Canonicalization &options)
+{
+  std::string result;
+  canonicalize(node, [&result](const char *data, std::size_t size) { result.append(data, size); }, options);
+  return result;
+}
+
+std::string canonical_sha256(const Document &document, const Canonicalization &options)
+{
+  Sha256 sha;
+  canonicalize(document, [&sha](const char *data, std::size_t size) { sha.update(data, size); }, options);
+  return Sha256::to_hex(sha.finish());
+}
+
+std::string canonical_sha256(const Node &node, const Canonicalization &options)
+{
+  Sha256 sha;
+  canonicalize(node, [&sha](const char *data, std::size_t size) { sha.update(data, size); }, options);
+  return Sha256::to_hex(sha.finish());
+}
+
+Sha256::Sha256()
+{
+  this->reset();
+}
+
+void Sha256::reset()
+{
+  static const uint32_t initial[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                      0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+  std::memcpy(this->_state, initial, sizeof(initial));
+  this->_size = 0;
+}
+
+void Sha256::transform(const unsigned char *block)
+{
+  uint32_t w[64];
+  for (int i = 0; i < 16; ++i)
+  {
+    w[i] = (uint32_t(block[i * 4]) << 24) | (uint32_t(block[i * 4 + 1]) << 16) |
+           (uint32_t(block[i * 4 + 2]) << 8) | uint32_t(block[i * 4 + 3]);
+  }
+  for (int i = 16; i < 64; ++i)
+  {
+    uint32_t s0 = rotate(w[i - 15], 7) ^ rotate(w[i - 15], 18) ^ (w[i - 15] >> 3);
+    uint32_t s1 = rotate(w[i - 2], 17) ^ rotate(w[i - 2], 19) ^ (w[i - 2] >> 10);
+    w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+  }
+
+  uint32_t a = _state[0], b = _state[1], c = _state[2], d = _state[3];
+  uint32_t e = _state[4], f = _state[5], g = _state[6], h = _state[7];
+  for (int i = 0; i < 64; ++i)
+  {
+    uint32_t t1 = h + (rotate(e, 6) ^ rotate(e, 11) ^ rotate(e, 25)) + ((e & f) ^ (~e & g)) +
+                  round_constants[i] + w[i];
+    uint32_t t2 = (rotate(a, 2) ^ rotate(a, 13) ^ rotate(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+    h = g;
+    g = f;
+    f = e;
+    e = d + t1;
+    d = c;
+    c = b;
+    b = a;
+    a = t1 + t2;
+  }
+
+  _state[0] += a;
+  _state[1] += b;
+  _state[2] += c;
+  _state[3] += d;
+  _state[4] += e;
+  _state[5] += f;
+  _state[6] += g;
+  _state[7] += h;
+}
+
+void Sha256::update(const char *data, std::size_t size)
+{
+  const unsigned char *bytes = reinterpret_cast<const unsigned char *>(data);
+  std::size_t used = static_cast<std::size_t>(this->_size % 64);
+  this->_size += size;
+
+  if (used != 0)
+  {
+    std::size_t fill = std::min(size, 64 - used);
+    std::memcpy(this->_block + used, bytes, fill);
+    bytes += fill;
+    size -= fill;
+    if (used + fill < 64)
+    {
+      return;
+    }
+    this->transform(this->_block);
+  }
+
+  for (; size >= 64; bytes += 64, size -= 64)
+  {
+    this->transform(bytes);
+  }
+  std::memcpy(this->_block, bytes, size);
+}
+
+Sha256::Digest Sha256::finish()
+{
+  uint64_t bits = this->_size * 8;
+  unsigned char padding[128] = {0x80};
+  std::size_t used = static_cast<std::size_t>(this->_size % 64);
+  std::size_t padding_size = (used < 56 ? 56 : 120) - used;
+  for (int i = 0; i < 8; ++i)
+  {
+    padding[padding_size + i] = static_cast<unsigned char>(bits >> (56 - i * 8));
+  }
+  this->update(reinterpret_cast<const char *>(padding), padding_size + 8);
+
+  Digest digest;
+  for (int i = 0; i < 8; ++i)
+  {
+    digest[i * 4] = static_cast<uint8_t>(_state[i] >> 24);
+    digest[i * 4 + 1] = static_cast<uint8_t>(_state[i] >> 16);
+    digest[i * 4 + 2] = static_cast<uint8_t>(_state[i] >> 8);
+    digest[i * 4 + 3] = static_cast<uint8_t>(_state[i]);
+  }
+  this->reset();
+  return digest;
+}
+
+std::string Sha256::to_hex(const Digest &digest)
+{
+  static const char digits[] = "0123456789abcdef";
+  std::string result;
+  result.reserve(digest.size() * 2);
+  for (uint8_t byte : digest)
+  {
+    result += digits[byte >> 4];
+    result += digits[byte & 0x0f];
+  }
+  return result;
+}
+
+}
@@ -0,0 +1,371 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file ColumnExtractor.cpp
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief Extracts repeated records into typed column buffers
+ */
+
+#include <Xml/Dom/ColumnExtractor.h>
+#include "NodeHandlerLibxml2.h"
+#include "ValueParser.h"
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace un::Xml::Dom
+{
+
+namespace
+{
+
+std::vector<std::string> split_path(const std::string &path)
+{
+  std::vector<std::string> result;
+  std::size_t start = 0;
+  for (;;)
+  {
+    std::size_t end = path.find('/', start);
+    std::string segment = path.substr(start, end == std::string::npos ? std::string::npos : end - start);
+    if (segment.empty())
+    {
+      throw std::runtime_error("Empty segment in path: " + path);
+    }
+    result.push_back(segment);
+    if (end == std::string::npos)
+    {
+      return result;
+    }
+    start = end + 1;
+  }
+}
+
+} // namespace
+
+class ColumnExtractor::Handler
+{
+private:
+  static const std::size_t none = static_cast<std::size_t>(-1);
+
+  /// Column paths as a tree, level 0 is the record
+  struct Level
+  {
+    std::vector<std::pair<std::string, std::size_t>> attributes; // Name, column
+    std::vector<std::pair<std::string, std::size_t>> elements;   // Name, level
+    std::size_t text_column = none;
+
+    bool is_leaf() const { return attributes.empty() && elements.empty(); }
+  };
+
+  std::vector<std::string> _record_path;
+  std::vector<Level> _levels;
+  std::vector<std::pair<std::string, ColumnExtractor::Type>> _columns;
+
+  /// State of one extract call
+  struct State
+  {
+    ColumnExtractor::Table table;
+    std::vector<uint8_t> filled;
+
+    /// Content of nested elements made of more than one text node
+    std::string storage;
+
+    void set_value(std::size_t index, std::string_view text)
+    {
+      if (this->filled[index])
+      {
+        return;
+      }
+      this->filled[index] = 1;
+
+      ColumnExtractor::Column &column = this->table.columns[index];
+      bool is_valid = true;
+      switch (column.type)
+      {
+      case ColumnExtractor::Type::int64:
+      {
+        int64_t value = 0;
+        is_valid = ValueParser::parse(text, value);
+        column.int64_values.push_back(value);
+        break;
+      }
+      case ColumnExtractor::Type::float64:
+      {
+        double value = 0;
+        is_valid = ValueParser::parse(text, value);
+        column.float64_values.push_back(value);
+        break;
+      }
+      case ColumnExtractor::Type::string:
+        column.arena.append(text.data(), text.size());
+        column.offsets.push_back(column.arena.size());
+        break;
+      }
+
+      if (!is_valid)
+      {
+        throw std::runtime_error("Cannot convert '" + std::string(text) + "' in column " + column.path +
+                                 " at row " + std::to_string(this->table.row_count));
+      }
+      column.valid.push_back(1);
+    }
+
+    void start_row()
+    {
+      std::fill(this->filled.begin(), this->filled.end(), 0);
+    }
+
+    /// Pads columns the record had no value for
+    void finish_row()
+    {
+      for (std::size_t i = 0; i < this->filled.size(); ++i)
+      {
+        if (this->filled[i])
+        {
+          continue;
+        }
+
+        ColumnExtractor::Column &column = this->table.columns[i];
+        switch (column.type)
+        {
+        case ColumnExtractor::Type::int64:
+          column.int64_values.push_back(0);
+          break;
+        case ColumnExtractor::Type::float64:
+          column.float64_values.push_back(0);
+          break;
+        case ColumnExtractor::Type::string:
+          column.offsets.push_back(column.arena.size());
+          break;
+        }
+        column.valid.push_back(0);
+      }
+      ++this->table.row_count;
+    }
+  };
+
+  /// Fills columns of one level from a record or an element below it
+  class LevelSink : public Node::ScanSink
+  {
+  private:
+    const Handler &_owner;
+    const Level &_level;
+    State &_state;
+
+  public:
+    LevelSink(const Handler &owner, const Level &level, State &state)
+      : _owner(owner), _level(level), _state(state) {}
+
+    int find_attribute(const char *name)
+    {
+      for (std::size_t i = 0; i < _level.attributes.size(); ++i)
+      {
+        if (_level.attributes[i].first == name)
+        {
+          return static_cast<int>(i);
+        }
+      }
+      return -1;
+    }
+
+    int find_element(const char *name)
+    {
+      for (std::size_t i = 0; i < _level.elements.size(); ++i)
+      {
+        if (_level.elements[i].first == name)
+        {
+          return static_cast<int>(_level.attributes.size() + i);
+        }
+      }
+      return -1;
+    }
+
+    const Level &get_child_level(int field) const
+    {
+      return _owner._levels[_level.elements[field - _level.attributes.size()].second];
+    }
+
+    bool is_node_field(int field) const
+    {
+      return static_cast<std::size_t>(field) >= _level.attributes.size() && !this->get_child_level(field).is_leaf();
+    }
+
+    void on_content(int field, std::string_view content)
+    {
+      if (static_cast<std::size_t>(field) < _level.attributes.size())
+      {
+        _state.set_value(_level.attributes[field].second, content);
+      }
+      else
+      {
+        _state.set_value(this->get_child_level(field).text_column, content);
+      }
+    }
+
+    void on_node(int field, const Node &child)
+    {
+      const Level &level = this->get_child_level(field);
+      LevelSink sink(_owner, level, _state);
+      child.scan(sink);
+
+      if (level.text_column != none)
+      {
+        _state.set_value(level.text_column, child.handler->get_content_view(_state.storage));
+      }
+    }
+  };
+
+  /// Walks record path, depth is the index of the segment being matched
+  class RecordSink : public Node::ScanSink
+  {
+  private:
+    const Handler &_owner;
+    std::size_t _depth;
+    State &_state;
+
+  public:
+    RecordSink(const Handler &owner, std::size_t depth, State &state)
+      : _owner(owner), _depth(depth), _state(state) {}
+
+    int find_attribute(const char *) { return -1; }
+
+    int find_element(const char *name)
+    {
+      return _owner._record_path[_depth] == name ? 0 : -1;
+    }
+
+    bool is_node_field(int) const { return true; }
+
+    void on_content(int, std::string_view) {}
+
+    void on_node(int, const Node &child)
+    {
+      if (_depth + 1 < _owner._record_path.size())
+      {
+        RecordSink sink(_owner, _depth + 1, _state);
+        child.scan(sink);
+        return;
+      }
+
+      _state.start_row();
+      LevelSink sink(_owner, _owner._levels[0], _state);
+      child.scan(sink);
+      _state.finish_row();
+    }
+  };
+
+public:
+  explicit Handler(const std::string &record_path)
+    : _record_path(split_path(record_path)), _levels(1) {}
+
+  void add_column(const std::string &path, ColumnExtractor::Type type)
+  {
+    std::vector<std::string> segments = split_path(path);
+    for (std::size_t i = 0; i + 1 < segments.size(); ++i)
+    {
+      if (segments[i][0] == '@')
+      {
+        throw std::runtime_error("Attribute must be last segment of column path: " + path);
+      }
+    }
+
+    std::size_t column = this->_columns.size();
+    std::size_t level = 0;
+
+    for (std::size_t i = 0; i < segments.size(); ++i)
+    {
+      const std::string &segment = segments[i];
+      bool is_last = i + 1 == segments.size();
+
+      if (segment[0] == '@')
+      {
+        for (const auto &attribute : this->_levels[level].attributes)
+        {
+          if (attribute.first == segment.substr(1))
+          {
+            throw std::runtime_error("Duplicate column: " + path);
+          }
+        }
+        this->_levels[level].attributes.emplace_back(segment.substr(1), column);
+        break;
+      }
+
+      std::size_t next = none;
+      for (const auto &element : this->_levels[level].elements)
+      {
+        if (element.first == segment)
+        {
+          next = element.second;
+        }
+      }
+      if (next == none)
+      {
+        next = this->_levels.size();
+        this->_levels.emplace_back();
+        this->_levels[level].elements.emplace_back(segment, next);
+      }
+      level = next;
+
+      if (is_last)
+      {
+        if (this->_levels[level].text_column != none)
+        {
+          throw std::runtime_error("Duplicate column: " + path);
+        }
+        this->_levels[level].text_column = column;
+      }
+    }
+
+    this->_columns.emplace_back(path, type);
+  }
+
+  ColumnExtractor::Table extract(const Node &node) const
+  {
+    State state;
+    state.table.row_count = 0;
+    state.filled.assign(this->_columns.size(), 0);
+    for (const auto &definition : this->_columns)
+    {
+      ColumnExtractor::Column column;
+      column.path = definition.first;
+      column.type = definition.second;
+      if (column.type == ColumnExtractor::Type::string)
+      {
+        column.offsets.push_back(0);
+      }
+      state.table.columns.push_back(std::move(column));
+    }
+
+    RecordSink sink(*this, 0, state);
+    node.scan(sink);
+    return std::move(state.table);
+  }
+};
+
+ColumnExtractor::ColumnExtractor(const std::string &record_path)
+  : handler(new ColumnExtractor::Handler(record_path)) {}
+
+ColumnExtractor &ColumnExtractor::add_column(const std::string &path, ColumnExtractor::Type type)
+{
+  this->handler->add_column(path, type);
+  return *this;
+}
+
+ColumnExtractor::Table ColumnExtractor::extract(const Node &node) const
+{
+  return this->handler->extract(node);
+}
+
+const ColumnExtractor::Column &ColumnExtractor::Table::operator[](const std::string &path) const
+{
+  for (const Column &column : this->columns)
+  {
+    if (column.path == path)
+    {
+      return column;
+    }
+  }
+  throw std::runtime_error("No such column: " + path);
+}
+
+}
@@ -0,0 +1,798 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file CompactTree.cpp
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief Read-only structure-of-arrays xml tree
+ */
+
+#include "CompactTree.h"
+#include "StructuralHash.h"
+#include <cstring>
+#include <libxml/parserInternals.h>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+namespace un::Xml::Dom
+{
+
+namespace
+{
+
+inline std::size_t align(std::size_t size)
+{
+  return (size + 7) & ~static_cast<std::size_t>(7);
+}
+
+template <class T>
+void place(CompactTree::Array<T> &array, const char *buffer, std::size_t &offset, uint64_t count)
+{
+  array.data = buffer == NULL ? NULL : reinterpret_cast<const T *>(buffer + offset);
+  array.size = static_cast<std::size_t>(count);
+  offset += align(static_cast<std::size_t>(count) * sizeof(T));
+}
+
+template <class T>
+void copy(const CompactTree::Array<T> &array, const std::vector<T> &values)
+{
+  if (!values.empty())
+  {
+    std::memcpy(const_cast<T *>(array.data), values.data(), values.size() * sizeof(T));
+  }
+}
+
+inline void link(xmlNodePtr parent, xmlNodePtr node)
+{
+  node->parent = parent;
+  if (parent->last == NULL)
+  {
+    parent->children = node;
+  }
+  else
+  {
+    parent->last->next = node;
+    node->prev = parent->last;
+  }
+  parent->last = node;
+}
+
+class Builder
+{
+public:
+  std::vector<uint32_t> parent;
+  std::vector<uint32_t> first_child;
+  std::vector<uint32_t> last_child;
+  std::vector<uint32_t> next_sibling;
+  std::vector<uint32_t> previous_sibling;
+  std::vector<uint32_t> name;
+  std::vector<uint32_t> ns;
+  std::vector<uint32_t> data;
+  std::vector<uint32_t> data_size;
+  std::vector<uint8_t> type;
+  std::vector<uint8_t> flags;
+
+  std::vector<uint32_t> attribute_name;
+  std::vector<uint32_t> attribute_ns;
+  std::vector<uint32_t> attribute_value;
+  std::vector<uint32_t> attribute_value_size;
+
+  std::vector<uint32_t> namespace_prefix;
+  std::vector<uint32_t> namespace_href;
+
+  std::vector<uint32_t> names;
+  std::string pool;
+
+private:
+  std::unordered_map<const xmlChar *, uint32_t> _name_pointers;
+  std::unordered_map<std::string, uint32_t> _name_ids;
+  std::unordered_map<uint64_t, uint32_t> _namespace_ids;
+
+  uint32_t add_string(const char *value, std::size_t size)
+  {
+    std::size_t offset = this->pool.size();
+    if (offset + size + 1 > CompactTree::none)
+    {
+      throw std::runtime_error("Document is too large for compact form");
+    }
+    this->pool.append(value, size);
+    this->pool += '\0';
+    return static_cast<uint32_t>(offset);
+  }
+
+  uint32_t intern(const xmlChar *value)
+  {
+    if (value == NULL)
+    {
+      return CompactTree::none;
+    }
+
+    // Names mostly come from the document dictionary, try the pointer first
+    auto pointer = this->_name_pointers.find(value);
+    if (pointer != this->_name_pointers.end())
+    {
+      return pointer->second;
+    }
+
+    std::string key(reinterpret_cast<const char *>(value));
+    auto found = this->_name_ids.find(key);
+    uint32_t id;
+    if (found == this->_name_ids.end())
+    {
+      id = static_cast<uint32_t>(this->names.size());
+      this->names.push_back(this->add_string(key.data(), key.size()));
+      this->_name_ids.emplace(key, id);
+    }
+    else
+    {
+      id = found->second;
+    }
+
+    this->_name_pointers.emplace(value, id);
+    return id;
+  }
+
+  uint32_t add_namespace(xmlNsPtr value)
+  {
+    if (value == NULL)
+    {
+      return CompactTree::none;
+    }
+
+    uint32_t prefix = this->intern(value->prefix);
+    uint32_t href = this->intern(value->href);
+    uint64_t key = (static_cast<uint64_t>(prefix) << 32) | href;
+
+    auto found = this->_namespace_ids.find(key);
+    if (found != this->_namespace_ids.end())
+    {
+      return found->second;
+    }
+
+    uint32_t id = static_cast<uint32_t>(this->namespace_prefix.size());
+    this->namespace_prefix.push_back(prefix);
+    this->namespace_href.push_back(href);
+    this->_namespace_ids.emplace(key, id);
+    return id;
+  }
+
+  void add_attribute(uint32_t attribute_name_id, uint32_t attribute_ns_id, const xmlChar *value)
+  {
+    const char *text = value == NULL ? "" : reinterpret_cast<const char *>(value);
+    std::size_t size = std::strlen(text);
+    this->attribute_name.push_back(attribute_name_id);
+    this->attribute_ns.push_back(attribute_ns_id);
+    this->attribute_value.push_back(this->add_string(text, size));
+    this->attribute_value_size.push_back(static_cast<uint32_t>(size));
+  }
+
+public:
+  uint32_t add_node(xmlNodePtr node, uint32_t parent_index)
+  {
+    if (this->parent.size() >= CompactTree::declaration)
+    {
+      throw std::runtime_error("Document is too large for compact form");
+    }
+
+    uint32_t index = static_cast<uint32_t>(this->parent.size());
+    uint32_t previous = parent_index == CompactTree::none ? CompactTree::none
+                                                          : this->last_child[parent_index];
+
+    this->parent.push_back(parent_index);
+    this->first_child.push_back(CompactTree::none);
+    this->last_child.push_back(CompactTree::none);
+    this->next_sibling.push_back(CompactTree::none);
+    this->previous_sibling.push_back(previous);
+
+    if (parent_index != CompactTree::none)
+    {
+      if (previous == CompactTree::none)
+      {
+        this->first_child[parent_index] = index;
+      }
+      else
+      {
+        this->next_sibling[previous] = index;
+      }
+      this->last_child[parent_index] = index;
+    }
+
+    xmlElementType node_type = node->type;
+    uint8_t node_flags = 0;
+    uint32_t node_data = 0;
+    uint32_t node_data_size = 0;
+
+    switch (node_type)
+    {
+    case XML_DOCUMENT_NODE:
+      this->name.push_back(CompactTree::none);
+      this->ns.push_back(CompactTree::none);
+      break;
+
+    case XML_ELEMENT_NODE:
+      this->name.push_back(this->intern(node->name));
+      this->ns.push_back(this->add_namespace(node->ns));
+      node_data = static_cast<uint32_t>(this->attribute_name.size());
+
+      for (xmlAttrPtr i = node->properties; i != NULL; i = i->next)
+      {
+        xmlChar *value = xmlNodeGetContent(reinterpret_cast<xmlNodePtr>(i));
+        this->add_attribute(this->intern(i->name), this->add_namespace(i->ns), value);
+        xmlFree(value);
+      }
+
+      for (xmlNsPtr i = node->nsDef; i != NULL; i = i->next)
+      {
+        this->add_attribute(this->intern(i->prefix), CompactTree::declaration, i->href);
+      }
+
+      node_data_size = static_cast<uint32_t>(this->attribute_name.size() - node_data);
+      break;
+
+    default:
+    {
+      // Entity references are stored as plain text
+      xmlChar *content = xmlNodeGetContent(node);
+      const char *text = content == NULL ? "" : reinterpret_cast<const char *>(content);
+      std::size_t size = std::strlen(text);
+
+      if (node_type == XML_ENTITY_REF_NODE)
+      {
+        node_type = XML_TEXT_NODE;
+        this->name.push_back(this->intern(xmlStringText));
+      }
+      else
+      {
+        this->name.push_back(this->intern(node->name));
+      }
+      this->ns.push_back(CompactTree::none);
+
+      if ((node_type == XML_TEXT_NODE || node_type == XML_CDATA_SECTION_NODE) &&
+          xmlIsBlankNode(node))
+      {
+        node_flags |= CompactTree::blank;
+      }
+
+      node_data = this->add_string(text, size);
+      node_data_size = static_cast<uint32_t>(size);
+      xmlFree(content);
+      break;
+    }
+    }
+
+    this->type.push_back(static_cast<uint8_t>(node_type));
+    this->flags.push_back(node_flags);
+    this->data.push_back(node_data);
+    this->data_size.push_back(node_data_size);
+
+    return index;
+  }
+
+  static bool is_supported(xmlNodePtr node)
+  {
+    switch (node->type)
+    {
+    case XML_ELEMENT_NODE:
+    case XML_TEXT_NODE:
+    case XML_CDATA_SECTION_NODE:
+    case XML_ENTITY_REF_NODE:
+    case XML_PI_NODE:
+    case XML_COMMENT_NODE:
+      return true;
+    default:
+      return false;
+    }
+  }
+
+  void add_document(xmlDocPtr doc)
+  {
+    xmlNodePtr document = reinterpret_cast<xmlNodePtr>(doc);
+    uint32_t parent_index = this->add_node(document, CompactTree::none);
+
+    xmlNodePtr i = document->children;
+    while (i != NULL)
+    {
+      if (is_supported(i))
+      {
+        uint32_t index = this->add_node(i, parent_index);
+        if (i->type == XML_ELEMENT_NODE && i->children != NULL)
+        {
+          parent_index = index;
+          i = i->children;
+          continue;
+        }
+      }
+
+      while (i != document && i->next == NULL)
+      {
+        i = i->parent;
+        parent_index = this->parent[parent_index];
+      }
+
+      if (i == document)
+      {
+        break;
+      }
+      i = i->next;
+    }
+  }
+
+  CompactTree::Counts get_counts() const
+  {
+    return CompactTree::Counts{this->parent.size(), this->attribute_name.size(),
+                               this->namespace_prefix.size(), this->names.size(),
+                               this->pool.size()};
+  }
+};
+
+} // namespace
+
+std::size_t CompactTree::get_buffer_size(const CompactTree::Counts &counts)
+{
+  CompactTree dummy;
+  return dummy.layout(counts, NULL);
+}
+
+std::size_t CompactTree::layout(const CompactTree::Counts &counts, const char *buffer)
+{
+  std::size_t offset = 0;
+
+  place(this->parent, buffer, offset, counts.nodes);
+  place(this->first_child, buffer, offset, counts.nodes);
+  place(this->last_child, buffer, offset, counts.nodes);
+  place(this->next_sibling, buffer, offset, counts.nodes);
+  place(this->previous_sibling, buffer, offset, counts.nodes);
+  place(this->name, buffer, offset, counts.nodes);
+  place(this->ns, buffer, offset, counts.nodes);
+  place(this->data, buffer, offset, counts.nodes);
+  place(this->data_size, buffer, offset, counts.nodes);
+  place(this->type, buffer, offset, counts.nodes);
+  place(this->flags, buffer, offset, counts.nodes);
+
+  place(this->attribute_name, buffer, offset, counts.attributes);
+  place(this->attribute_ns, buffer, offset, counts.attributes);
+  place(this->attribute_value, buffer, offset, counts.attributes);
+  place(this->attribute_value_size, buffer, offset, counts.attributes);
+
+  place(this->namespace_prefix, buffer, offset, counts.namespaces);
+  place(this->namespace_href, buffer, offset, counts.namespaces);
+
+  place(this->names, buffer, offset, counts.names);
+  place(this->pool, buffer, offset, counts.pool);
+
+  this->_counts = counts;
+  this->_buffer = buffer;
+  return offset;
+}
+
+std::shared_ptr<CompactTree> CompactTree::bind(const CompactTree::Counts &counts,
+                                               const char *buffer, std::size_t size,
+                                               std::shared_ptr<const void> storage)
+{
+  if (size < get_buffer_size(counts))
+  {
+    throw std::runtime_error("Compact tree buffer is too small");
+  }
+
+  std::shared_ptr<CompactTree> result(new CompactTree());
+  result->layout(counts, buffer);
+  result->_storage = storage;
+  return result;
+}
+
+std::shared_ptr<CompactTree> CompactTree::build(xmlDocPtr doc)
+{
+  Builder builder;
+  builder.add_document(doc);
+
+  CompactTree::Counts counts = builder.get_counts();
+  std::size_t size = get_buffer_size(counts);
+
+  // uint64_t keeps every section 8 byte aligned
+  std::shared_ptr<std::vector<uint64_t>> storage(new std::vector<uint64_t>(size / 8 + 1, 0));
+  const char *buffer = reinterpret_cast<const char *>(storage->data());
+
+  std::shared_ptr<CompactTree> result = bind(counts, buffer, size, storage);
+
+  copy(result->parent, builder.parent);
+  copy(result->first_child, builder.first_child);
+  copy(result->last_child, builder.last_child);
+  copy(result->next_sibling, builder.next_sibling);
+  copy(result->previous_sibling, builder.previous_sibling);
+  copy(result->name, builder.name);
+  copy(result->ns, builder.ns);
+  copy(result->data, builder.data);
+  copy(result->data_size, builder.data_size);
+  copy(result->type, builder.type);
+  copy(result->flags, builder.flags);
+  copy(result->attribute_name, builder.attribute_name);
+  copy(result->attribute_ns, builder.attribute_ns);
+  copy(result->attribute_value, builder.attribute_value);
+  copy(result->attribute_value_size, builder.attribute_value_size);
+  copy(result->namespace_prefix, builder.namespace_prefix);
+  copy(result->namespace_href, builder.namespace_href);
+  copy(result->names, builder.names);
+  std::memcpy(const_cast<char *>(result->pool.data), builder.pool.data(), builder.pool.size());
+
+  return result;
+}
+
+void CompactTree::validate() const
+{
+  auto fail = [](const char *what) { throw std::runtime_error(std::string("Corrupt compact tree: ") + what); };
+  const std::size_t nodes = this->parent.size;
+  const std::size_t pool_size = this->pool.size;
+  auto is_text_in_pool = [pool_size](uint64_t offset, uint64_t size) { return offset + size < pool_size; };
+
+  if (nodes == 0 || nodes >= declaration || this->type[0] != XML_DOCUMENT_NODE || this->parent[0] != none)
+  {
+    fail("document node");
+  }
+  // Strings are zero terminated, so any offset inside the pool ends in it
+  if (pool_size != 0 && this->pool[pool_size - 1] != '\0')
+  {
+    fail("string pool");
+  }
+  for (std::size_t i = 0; i < this->names.size; ++i)
+  {
+    if (this->names[i] >= pool_size)
+    {
+      fail("name");
+    }
+  }
+  for (std::size_t i = 0; i < this->namespace_prefix.size; ++i)
+  {
+    if ((this->namespace_prefix[i] != none && this->namespace_prefix[i] >= this->names.size) ||
+        this->namespace_href[i] >= this->names.size)
+    {
+      fail("namespace");
+    }
+  }
+  for (std::size_t i = 0; i < this->attribute_name.size; ++i)
+  {
+    uint32_t attribute_ns = this->attribute_ns[i];
+    bool is_declaration = attribute_ns == declaration;
+    if ((this->attribute_name[i] >= this->names.size && !(is_declaration && this->attribute_name[i] == none)) ||
+        (attribute_ns != none && !is_declaration && attribute_ns >= this->namespace_prefix.size) ||
+        !is_text_in_pool(this->attribute_value[i], this->attribute_value_size[i]))
+    {
+      fail("attribute");
+    }
+  }
+
+  // Parents come before their children, children of a node are visited while it is on the stack
+  struct Open
+  {
+    uint32_t node;
+    uint32_t last_child; // Seen so far
+  };
+  std::vector<Open> stack;
+  auto close = [&]() {
+    const Open &open = stack.back();
+    uint32_t last = open.last_child;
+    if (this->last_child[open.node] != last || (last == none ? this->first_child[open.node] != none
+                                                             : this->next_sibling[last] != none))
+    {
+      fail("child links");
+    }
+    stack.pop_back();
+  };
+
+  for (uint32_t i = 0; i < nodes; ++i)
+  {
+    uint8_t node_type = this->type[i];
+    if (i != 0)
+    {
+      while (!stack.empty() && stack.back().node != this->parent[i])
+      {
+        close();
+      }
+      if (stack.empty())
+      {
+        fail("parent link");
+      }
+
+      uint32_t previous = stack.back().last_child;
+      if (this->previous_sibling[i] != previous ||
+          (previous == none ? this->first_child[stack.back().node] : this->next_sibling[previous]) != i)
+      {
+        fail("sibling links");
+      }
+      stack.back().last_child = i;
+    }
+
+    switch (node_type)
+    {
+    case XML_DOCUMENT_NODE:
+      if (i != 0)
+      {
+        fail("document node");
+      }
+      break;
+    case XML_ELEMENT_NODE:
+      if (this->name[i] >= this->names.size || (this->ns[i] != none && this->ns[i] >= this->namespace_prefix.size) ||
+          uint64_t(this->data[i]) + this->data_size[i] > this->attribute_name.size)
+      {
+        fail("element");
+      }
+      break;
+    case XML_TEXT_NODE:
+    case XML_CDATA_SECTION_NODE:
+    case XML_COMMENT_NODE:
+    case XML_PI_NODE:
+      if (this->name[i] >= this->names.size || this->first_child[i] != none ||
+          !is_text_in_pool(this->data[i], this->data_size[i]))
+      {
+        fail("node");
+      }
+      break;
+    default:
+      fail("node type");
+    }
+    stack.push_back(Open{i, none});
+  }
+  while (!stack.empty())
+  {
+    close();
+  }
+}
+
+uint32_t CompactTree::get_root() const
+{
+  if (this->parent.size == 0)
+  {
+    return none;
+  }
+
+  for (uint32_t i = this->first_child[0]; i != none; i = this->next_sibling[i])
+  {
+    if (this->type[i] == XML_ELEMENT_NODE)
+    {
+      return i;
+    }
+  }
+  return none;
+}
+
+uint32_t CompactTree::subtree_end(uint32_t index) const
+{
+  while (this->last_child[index] != none)
+  {
+    index = this->last_child[index];
+  }
+  return index + 1;
+}
+
+std::size_t CompactTree::get_attribute_count(uint32_t index) const
+{
+  std::size_t result = 0;
+  for (uint32_t i = this->data[index]; i < this->data[index] + this->data_size[index]; ++i)
+  {
+    result += this->attribute_ns[i] != declaration;
+  }
+  return result;
+}
+
+std::string CompactTree::get_content(uint32_t index) const
+{
+  switch (this->type[index])
+  {
+  case XML_ELEMENT_NODE:
+  case XML_DOCUMENT_NODE:
+  {
+    std::string result;
+    uint32_t end = this->subtree_end(index);
+    for (uint32_t i = index + 1; i < end; ++i)
+    {
+      if (this->type[i] == XML_TEXT_NODE || this->type[i] == XML_CDATA_SECTION_NODE)
+      {
+        result.append(this->get_text(i), this->data_size[i]);
+      }
+    }
+    return result;
+  }
+  default:
+    return std::string(this->get_text(index), this->data_size[index]);
+  }
+}
+
+std::string_view CompactTree::get_content_view(uint32_t index, std::string &storage) const
+{
+  uint32_t text = index;
+  if (this->type[index] == XML_ELEMENT_NODE)
+  {
+    text = this->first_child[index];
+    if (text == none)
+    {
+      return std::string_view();
+    }
+  }
+
+  if ((this->type[text] == XML_TEXT_NODE || this->type[text] == XML_CDATA_SECTION_NODE) &&
+      (text == index || this->next_sibling[text] == none))
+  {
+    return std::string_view(this->get_text(text), this->data_size[text]);
+  }
+
+  storage = this->get_content(index);
+  return storage;
+}
+
+uint64_t CompactTree::get_hash(uint32_t index) const
+{
+  std::call_once(this->_hash_once, [this]() {
+    // Children come after their parent, so walking backwards finds them hashed
+    std::vector<uint64_t> hashes(this->parent.size, 0);
+    for (std::size_t n = this->parent.size; n-- > 1;)
+    {
+      uint32_t i = static_cast<uint32_t>(n);
+      int node_type = this->type[i];
+      bool is_element = node_type == XML_ELEMENT_NODE;
+      const char *href =
+          is_element && this->ns[i] != none ? this->get_string(this->namespace_href[this->ns[i]]) : NULL;
+      const char *node_name = is_element || node_type == XML_PI_NODE ? this->get_name(i) : NULL;
+      uint64_t hash = StructuralHash::start(node_type, node_name, href);
+
+      if (is_element)
+      {
+        uint64_t attributes = 0;
+        for (uint32_t a = this->data[i]; a < this->data[i] + this->data_size[i]; ++a)
+        {
+          uint32_t attribute_ns = this->attribute_ns[a];
+          if (attribute_ns == declaration)
+          {
+            continue;
+          }
+          attributes += StructuralHash::attribute(
+              this->get_string(this->attribute_name[a]),
+              attribute_ns == none ? NULL : this->get_string(this->namespace_href[attribute_ns]),
+              std::string_view(this->pool.data + this->attribute_value[a], this->attribute_value_size[a]));
+        }
+        hash = StructuralHash::combine(hash, attributes);
+
+        for (uint32_t child = this->first_child[i]; child != none; child = this->next_sibling[child])
+        {
+          hash = StructuralHash::combine(hash, hashes[child]);
+        }
+      }
+      else
+      {
+        hash = StructuralHash::combine(hash, StructuralHash::bytes(this->get_text(i), this->data_size[i]));
+      }
+      hashes[i] = StructuralHash::finish(hash);
+    }
+    this->_hashes.swap(hashes);
+  });
+  return this->_hashes[index];
+}
+
+xmlNodePtr CompactTree::expand(xmlDocPtr doc, uint32_t index) const
+{
+  std::vector<xmlNodePtr> created(this->parent.size, NULL);
+  if (created.empty())
+  {
+    return NULL;
+  }
+  created[0] = reinterpret_cast<xmlNodePtr>(doc);
+
+  for (uint32_t i = 1; i < this->parent.size; ++i)
+  {
+    created[i] = this->create_node(doc, i, created[this->parent[i]]);
+  }
+  return created[index];
+}
+
+xmlNodePtr CompactTree::expand_node(uint32_t index) const
+{
+  uint32_t end = this->subtree_end(index);
+  std::vector<xmlNodePtr> created(end - index, NULL);
+  created[0] = this->create_node(NULL, index, NULL);
+
+  try
+  {
+    for (uint32_t i = index + 1; i < end; ++i)
+    {
+      created[i - index] = this->create_node(NULL, i, created[this->parent[i] - index]);
+    }
+  }
+  catch (...)
+  {
+    xmlFreeNode(created[0]);
+    throw;
+  }
+  return created[0];
+}
+
+xmlNodePtr CompactTree::create_node(xmlDocPtr doc, uint32_t i, xmlNodePtr parent_node) const
+{
+  const xmlChar *node_name = BAD_CAST this->get_name(i);
+  const xmlChar *text = BAD_CAST this->get_text(i);
+  xmlNodePtr node = NULL;
+
+  switch (this->type[i])
+  {
+  case XML_ELEMENT_NODE:
+  {
+    node = xmlNewDocNode(doc, NULL, node_name, NULL);
+    if (node != NULL && parent_node != NULL)
+    {
+      link(parent_node, node);
+    }
+
+    uint32_t first = this->data[i];
+    uint32_t last = first + this->data_size[i];
+    for (uint32_t a = first; a < last; ++a)
+    {
+      if (this->attribute_ns[a] == declaration)
+      {
+        uint32_t prefix = this->attribute_name[a];
+        xmlNewNs(node, BAD_CAST(this->pool.data + this->attribute_value[a]),
+                 prefix == none ? NULL : BAD_CAST this->get_string(prefix));
+      }
+    }
+
+    if (this->ns[i] != none)
+    {
+      xmlSetNs(node, this->find_namespace(doc, node, this->ns[i]));
+    }
+
+    for (uint32_t a = first; a < last; ++a)
+    {
+      if (this->attribute_ns[a] == declaration)
+      {
+        continue;
+      }
+
+      xmlNsPtr attribute_ns = this->attribute_ns[a] == none
+                                  ? NULL
+                                  : this->find_namespace(doc, node, this->attribute_ns[a]);
+      xmlNewNsProp(node, attribute_ns, BAD_CAST this->get_string(this->attribute_name[a]),
+                   BAD_CAST(this->pool.data + this->attribute_value[a]));
+    }
+    break;
+  }
+  case XML_TEXT_NODE:
+    node = xmlNewDocTextLen(doc, text, static_cast<int>(this->data_size[i]));
+    break;
+  case XML_CDATA_SECTION_NODE:
+    node = xmlNewCDataBlock(doc, text, static_cast<int>(this->data_size[i]));
+    break;
+  case XML_COMMENT_NODE:
+    node = xmlNewDocComment(doc, text);
+    break;
+  case XML_PI_NODE:
+    node = xmlNewDocPI(doc, node_name, this->data_size[i] == 0 ? NULL : text);
+    break;
+  default:
+    throw std::runtime_error("Unknown node type in compact tree");
+  }
+
+  if (node == NULL)
+  {
+    throw std::runtime_error("Cannot create node");
+  }
+
+  if (node->parent == NULL && parent_node != NULL)
+  {
+    link(parent_node, node);
+  }
+  return node;
+}
+
+xmlNsPtr CompactTree::find_namespace(xmlDocPtr doc, xmlNodePtr node, uint32_t index) const
+{
+  uint32_t prefix = this->namespace_prefix[index];
+  const xmlChar *href = BAD_CAST this->get_string(this->namespace_href[index]);
+  const xmlChar *prefix_name = prefix == none ? NULL : BAD_CAST this->get_string(prefix);
+
+  xmlNsPtr result = xmlSearchNs(doc, node, prefix_name);
+  if (result != NULL && xmlStrEqual(result->href, href))
+  {
+    return result;
+  }
+
+  // Namespace is used without a declaration in scope, declare it here
+  return xmlNewNs(node, href, prefix_name);
+}
+
+}
@@ -0,0 +1,182 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file CompactTree.h
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief Read-only structure-of-arrays xml tree
+ *
+ * Nodes are numbered in document order (pre-order) and every node property is
+ * stored in its own array, links between nodes are indices. Names and
+ * namespace URIs are interned, text and attribute values live in one string
+ * pool. Subtree of node i is the index range [i, subtree_end(i)).
+ *
+ * All arrays share one contiguous buffer whose layout only depends on the
+ * element counts, so the buffer can be written to disk and used in place.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <libxml/tree.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace un::Xml::Dom
+{
+
+class CompactTree
+{
+public:
+  static constexpr uint32_t none = 0xffffffff;
+
+  /// Attribute namespace marking a namespace declaration (xmlns)
+  static constexpr uint32_t declaration = 0xfffffffe;
+
+  /// Node flags
+  enum Flags : uint8_t
+  {
+    blank = 1 // Text node with only white space
+  };
+
+  template <class T>
+  struct Array
+  {
+    const T *data;
+    std::size_t size;
+
+    inline const T &operator[](std::size_t index) const { return data[index]; }
+  };
+
+  /// Number of elements in each section, buffer layout follows from these
+  struct Counts
+  {
+    uint64_t nodes;
+    uint64_t attributes;
+    uint64_t namespaces;
+    uint64_t names;
+    uint64_t pool;
+  };
+
+  // Node arrays
+  Array<uint32_t> parent;
+  Array<uint32_t> first_child;
+  Array<uint32_t> last_child;
+  Array<uint32_t> next_sibling;
+  Array<uint32_t> previous_sibling;
+  Array<uint32_t> name;      // Name id, local name for elements
+  Array<uint32_t> ns;        // Namespace index
+  Array<uint32_t> data;      // First attribute for elements, pool offset for others
+  Array<uint32_t> data_size; // Attribute count for elements, content size for others
+  Array<uint8_t> type;       // xmlElementType
+  Array<uint8_t> flags;
+
+  // Attribute arrays, namespace declarations come after attributes of an element
+  Array<uint32_t> attribute_name;
+  Array<uint32_t> attribute_ns;
+  Array<uint32_t> attribute_value;
+  Array<uint32_t> attribute_value_size;
+
+  // Namespace arrays
+  Array<uint32_t> namespace_prefix; // Name id or none
+  Array<uint32_t> namespace_href;   // Name id
+
+  // Interned names, offsets into pool
+  Array<uint32_t> names;
+
+  // Zero terminated strings
+  Array<char> pool;
+
+  /**
+   * Build compact tree from libxml2 document. Entity references are replaced
+   * by their content, DTD is dropped.
+   */
+  static std::shared_ptr<CompactTree> build(xmlDocPtr doc);
+
+  /**
+   * Bind arrays to an existing buffer laid out for given counts. Buffer is kept
+   * alive by storage.
+   */
+  static std::shared_ptr<CompactTree> bind(const Counts &counts, const char *buffer,
+                                           std::size_t size, std::shared_ptr<const void> storage);
+
+  /// Size of buffer needed for given counts
+  static std::size_t get_buffer_size(const Counts &counts);
+
+  /**
+   * Check that links, ids and pool offsets stay inside their arrays and the
+   * nodes form a tree in document order, for buffers bound from files.
+   *
+   * @throw std::runtime_error if the tree is corrupt
+   */
+  void validate() const;
+
+  /// Rebuild libxml2 tree as children of given (empty) document, returns the node built for index
+  xmlNodePtr expand(xmlDocPtr doc, uint32_t index = 0) const;
+
+  /// Rebuild subtree of given node as a free libxml2 node owned by the caller
+  xmlNodePtr expand_node(uint32_t index) const;
+
+  const Counts &get_counts() const { return this->_counts; }
+
+  const char *get_buffer() const { return this->_buffer; }
+
+  std::size_t get_buffer_size() const { return get_buffer_size(this->_counts); }
+
+  /// Index of root element, none if there is none
+  uint32_t get_root() const;
+
+  /// One past the last node of subtree of given node
+  uint32_t subtree_end(uint32_t index) const;
+
+  inline const char *get_name(uint32_t index) const
+  {
+    return this->name[index] == none ? NULL : this->get_string(this->name[index]);
+  }
+
+  /// Interned string by name id
+  inline const char *get_string(uint32_t id) const
+  {
+    return this->pool.data + this->names[id];
+  }
+
+  inline const char *get_text(uint32_t index) const
+  {
+    return this->pool.data + this->data[index];
+  }
+
+  /// Number of attributes excluding namespace declarations
+  std::size_t get_attribute_count(uint32_t index) const;
+
+  /// xmlNodeGetContent equivalent
+  std::string get_content(uint32_t index) const;
+
+  /// Content without copying when it is a single text node, otherwise copied into storage
+  std::string_view get_content_view(uint32_t index, std::string &storage) const;
+
+  /// Structural hash of subtree, see StructuralHash.h. First call hashes every node.
+  uint64_t get_hash(uint32_t index) const;
+
+private:
+  Counts _counts;
+  const char *_buffer;
+  std::shared_ptr<const void> _storage;
+
+  mutable std::once_flag _hash_once;
+  mutable std::vector<uint64_t> _hashes;
+
+  CompactTree() : _counts(), _buffer(NULL) {}
+
+  /// Points arrays into buffer, returns size of the layout
+  std::size_t layout(const Counts &counts, const char *buffer);
+
+  /// Creates node and links it as last child of parent_node unless it is NULL
+  xmlNodePtr create_node(xmlDocPtr doc, uint32_t index, xmlNodePtr parent_node) const;
+
+  xmlNsPtr find_namespace(xmlDocPtr doc, xmlNodePtr node, uint32_t index) const;
+};
+
+}
@@ -0,0 +1,558 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file CompressedFile.cpp
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief Gzip, zstd and xz compressed xml files
+ */
+
+#include "CompressedFile.h"
+#include "NativeParser.h"
+#include "TemporaryFile.h"
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <libxml/parser.h>
+#include <libxml/xmlsave.h>
+#include <stdexcept>
+
+#ifdef UNBOUNDED_WITH_ZLIB
+#include <zlib.h>
+#endif
+#ifdef UNBOUNDED_WITH_ZSTD
+#include <zstd.h>
+#endif
+#ifdef UNBOUNDED_WITH_LZMA
+#include <lzma.h>
+#endif
+
+namespace un::Xml::Dom::CompressedFile
+{
+
+/**
+ * Moves input to output. Pointers and sizes are advanced past what was
+ * consumed and produced. Finish means no more input follows, compressors
+ * then flush. Returns true when a compressed stream ended.
+ */
+class Codec
+{
+public:
+  virtual ~Codec() {}
+
+  virtual bool run(const char *&input, std::size_t &input_size, char *&output, std::size_t &output_size,
+                   bool finish) = 0;
+};
+
+namespace
+{
+
+const std::size_t chunk_size = 64 * 1024;
+
+#ifdef UNBOUNDED_WITH_ZLIB
+class GzipCodec : public Codec
+{
+private:
+  z_stream _stream;
+  bool _is_compressor;
+
+public:
+  explicit GzipCodec(bool is_compressor) : _is_compressor(is_compressor)
+  {
+    std::memset(&this->_stream, 0, sizeof(this->_stream));
+    // Window bits + 16 writes gzip, + 32 reads gzip and zlib
+    int result = is_compressor ? deflateInit2(&this->_stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8,
+                                              Z_DEFAULT_STRATEGY)
+                               : inflateInit2(&this->_stream, 15 + 32);
+    if (result != Z_OK)
+    {
+      throw std::runtime_error("Cannot initialize zlib");
+    }
+  }
+
+  ~GzipCodec()
+  {
+    if (this->_is_compressor)
+    {
+      deflateEnd(&this->_stream);
+    }
+    else
+    {
+      inflateEnd(&this->_stream);
+    }
+  }
+
+  bool run(const char *&input, std::size_t &input_size, char *&output, std::size_t &output_size, bool finish)
+  {
+    this->_stream.next_in = (Bytef *)input;
+    this->_stream.avail_in = static_cast<uInt>(input_size);
+    this->_stream.next_out = (Bytef *)output;
+    this->_stream.avail_out = static_cast<uInt>(output_size);
+
+    int result = this->_is_compressor ? deflate(&this->_stream, finish ? Z_FINISH : Z_NO_FLUSH)
+                                      : inflate(&this->_stream, Z_NO_FLUSH);
+    if (result != Z_OK && result != Z_STREAM_END && result != Z_BUF_ERROR)
+    {
+      throw std::runtime_error("Corrupt gzip data");
+    }
+
+    input += input_size - this->_stream.avail_in;
+    input_size = this->_stream.avail_in;
+    output += output_size - this->_stream.avail_out;
+    output_size = this->_stream.avail_out;
+
+    // Concatenated gzip members are read as one stream
+    if (result == Z_STREAM_END && !this->_is_compressor)
+    {
+      inflateReset(&this->_stream);
+    }
+    return result == Z_STREAM_END;
+  }
+};
+#endif
+
+#ifdef UNBOUNDED_WITH_ZSTD
+class ZstdCodec : public Codec
+{
+private:
+  ZSTD_CCtx *_compressor;
+  ZSTD_DCtx *_decompressor;
+
+public:
+  explicit ZstdCodec(bool is_compressor)
+      : _compressor(is_compressor ? ZSTD_createCCtx() : NULL),
+        _decompressor(is_compressor ? NULL : ZSTD_createDCtx())
+  {
+    if (this->_compressor == NULL && this->_decompressor == NULL)
+    {
+      throw std::runtime_error("Cannot initialize zstd");
+    }
+  }
+
+  ~ZstdCodec()
+  {
+    ZSTD_freeCCtx(this->_compressor);
+    ZSTD_freeDCtx(this->_decompressor);
+  }
+
+  bool run(const char *&input, std::size_t &input_size, char *&output, std::size_t &output_size, bool finish)
+  {
+    ZSTD_inBuffer in = {input, input_size, 0};
+    ZSTD_outBuffer out = {output, output_size, 0};
+
+    std::size_t result = this->_compressor != NULL
+                             ? ZSTD_compressStream2(this->_compressor, &out, &in, finish ? ZSTD_e_end : ZSTD_e_continue)
+                             : ZSTD_decompressStream(this->_decompressor, &out, &in);
+    if (ZSTD_isError(result))
+    {
+      throw std::runtime_error(std::string("Corrupt zstd data: ") + ZSTD_getErrorName(result));
+    }
+
+    input += in.pos;
+    input_size -= in.pos;
+    output += out.pos;
+    output_size -= out.pos;
+    // 0 is a finished frame when reading and a fully flushed end when writing
+    return result == 0 && (this->_compressor == NULL || finish);
+  }
+};
+#endif
+
+#ifdef UNBOUNDED_WITH_LZMA
+class XzCodec : public Codec
+{
+private:
+  lzma_stream _stream;
+
+public:
+  explicit XzCodec(bool is_compressor) : _stream(LZMA_STREAM_INIT)
+  {
+    lzma_ret result = is_compressor ? lzma_easy_encoder(&this->_stream, 6, LZMA_CHECK_CRC64)
+                                    : lzma_stream_decoder(&this->_stream, UINT64_MAX, LZMA_CONCATENATED);
+    if (result != LZMA_OK)
+    {
+      throw std::runtime_error("Cannot initialize lzma");
+    }
+  }
+
+  ~XzCodec() { lzma_end(&this->_stream); }
+
+  bool run(const char *&input, std::size_t &input_size, char *&output, std::size_t &output_size, bool finish)
+  {
+    this->_stream.next_in = reinterpret_cast<const uint8_t *>(input);
+    this->_stream.avail_in = input_size;
+    this->_stream.next_out = reinterpret_cast<uint8_t *>(output);
+    this->_stream.avail_out = output_size;
+
+    lzma_ret result = lzma_code(&this->_stream, finish ? LZMA_FINISH : LZMA_RUN);
+    if (result != LZMA_OK && result != LZMA_STREAM_END && result != LZMA_BUF_ERROR)
+    {
+      throw std::runtime_error("Corrupt xz data");
+    }
+
+    input += input_size - this->_stream.avail_in;
+    input_size = this->_stream.avail_in;
+    output += output_size - this->_stream.avail_out;
+    output_size = this->_stream.avail_out;
+    return result == LZMA_STREAM_END;
+  }
+};
+#endif
+
+std::unique_ptr<Codec> make_codec(Document::Compression compression, bool is_compressor)
+{
+  switch (compression)
+  {
+  case Document::Compression::gzip:
+#ifdef UNBOUNDED_WITH_ZLIB
+    return std::unique_ptr<Codec>(new GzipCodec(is_compressor));
+#else
+    throw std::runtime_error("Built without zlib, gzip files are not supported");
+#endif
+  case Document::Compression::zstd:
+#ifdef UNBOUNDED_WITH_ZSTD
+    return std::unique_ptr<Codec>(new ZstdCodec(is_compressor));
+#else
+    throw std::runtime_error("Built without zstd, zstd files are not supported");
+#endif
+  case Document::Compression::xz:
+#ifdef UNBOUNDED_WITH_LZMA
+    return std::unique_ptr<Codec>(new XzCodec(is_compressor));
+#else
+    throw std::runtime_error("Built without lzma, xz files are not supported");
+#endif
+  default:
+    return std::unique_ptr<Codec>();
+  }
+}
+
+bool ends_with(const char *text, const char *suffix)
+{
+  std::size_t text_size = std::strlen(text);
+  std::size_t suffix_size = std::strlen(suffix);
+  return text_size >= suffix_size && std::strcmp(text + text_size - suffix_size, suffix) == 0;
+}
+
+/// Reader and the first exception it threw inside a libxml2 callback
+struct ReadContext
+{
+  Reader &reader;
+  std::exception_ptr error;
+};
+
+int read_callback(void *context, char *buffer, int size)
+{
+  ReadContext *read_context = static_cast<ReadContext *>(context);
+  try
+  {
+    return static_cast<int>(read_context->reader.read(buffer, static_cast<std::size_t>(size)));
+  }
+  catch (...)
+  {
+    read_context->error = std::current_exception();
+    return -1;
+  }
+}
+
+struct WriteContext
+{
+  Writer &writer;
+  std::exception_ptr error;
+};
+
+int write_callback(void *context, const char *buffer, int size)
+{
+  WriteContext *write_context = static_cast<WriteContext *>(context);
+  try
+  {
+    write_context->writer.write(buffer, static_cast<std::size_t>(size));
+    return size;
+  }
+  catch (...)
+  {
+    write_context->error = std::current_exception();
+    return -1;
+  }
+}
+
+}
+
+Document::Compression detect(const char *path)
+{
+  unsigned char magic[6] = {0};
+  FILE *file = std::fopen(path, "rb");
+  if (file == NULL)
+  {
+    return Document::Compression::none;
+  }
+  std::size_t size = std::fread(magic, 1, sizeof(magic), file);
+  std::fclose(file);
+
+  if (size >= 2 && magic[0] == 0x1f && magic[1] == 0x8b)
+  {
+    return Document::Compression::gzip;
+  }
+  if (size >= 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd)
+  {
+    return Document::Compression::zstd;
+  }
+  if (size >= 6 && std::memcmp(magic, "\xfd" "7zXZ\0", 6) == 0)
+  {
+    return Document::Compression::xz;
+  }
+  return Document::Compression::none;
+}
+
+Document::Compression from_extension(const char *path)
+{
+  if (ends_with(path, ".gz"))
+  {
+    return Document::Compression::gzip;
+  }
+  if (ends_with(path, ".zst"))
+  {
+    return Document::Compression::zstd;
+  }
+  if (ends_with(path, ".xz"))
+  {
+    return Document::Compression::xz;
+  }
+  return Document::Compression::none;
+}
+
+Reader::Reader(const char *path, Document::Compression compression)
+    : _file(NULL), _codec(make_codec(compression, false)), _input(chunk_size), _next(NULL), _available(0),
+      _is_end_of_file(false), _is_end_of_stream(_codec == nullptr)
+{
+  this->_file = std::fopen(path, "rb");
+  if (this->_file == NULL)
+  {
+    throw std::runtime_error(std::string("Cannot open file: ") + path);
+  }
+}
+
+Reader::~Reader()
+{
+  if (this->_file != NULL)
+  {
+    std::fclose(this->_file);
+  }
+}
+
+std::size_t Reader::read(char *buffer, std::size_t size)
+{
+  while (size > 0)
+  {
+    if (this->_available == 0 && !this->_is_end_of_file)
+    {
+      this->_available = std::fread(this->_input.data(), 1, this->_input.size(), this->_file);
+      this->_next = this->_input.data();
+      if (this->_available < this->_input.size())
+      {
+        if (std::ferror(this->_file))
+        {
+          throw std::runtime_error("Cannot read compressed file");
+        }
+        this->_is_end_of_file = true;
+      }
+    }
+
+    if (this->_codec == nullptr)
+    {
+      std::size_t copied = std::min(size, this->_available);
+      std::memcpy(buffer, this->_next, copied);
+      this->_next += copied;
+      this->_available -= copied;
+      return copied;
+    }
+
+    char *output = buffer;
+    std::size_t output_size = size;
+    std::size_t available = this->_available;
+    bool is_end = this->_codec->run(this->_next, this->_available, output, output_size, this->_is_end_of_file);
+    std::size_t produced = size - output_size;
+    if (produced > 0 || available != this->_available)
+    {
+      this->_is_end_of_stream = is_end;
+    }
+
+    if (produced > 0)
+    {
+      return produced;
+    }
+    if (this->_is_end_of_file && this->_available == 0)
+    {
+      if (!this->_is_end_of_stream)
+      {
+        throw std::runtime_error("Compressed file is truncated");
+      }
+      return 0;
+    }
+    if (available == this->_available && this->_available > 0)
+    {
+      throw std::runtime_error("Corrupt compressed data");
+    }
+  }
+  return 0;
+}
+
+std::string Reader::read_all()
+{
+  std::string result;
+  std::size_t size = 0;
+  do
+  {
+    result.resize(size + chunk_size);
+    std::size_t read = this->read(&result[size], chunk_size);
+    size += read;
+    result.resize(size);
+    if (read == 0)
+    {
+      break;
+    }
+  } while (true);
+  return result;
+}
+
+Writer::Writer(const char *path, Document::Compression compression)
+    : _file(NULL), _codec(make_codec(compression, true)), _output(chunk_size)
+{
+  this->_file = std::fopen(path, "wb");
+  if (this->_file == NULL)
+  {
+    throw std::runtime_error(std::string("Cannot open file: ") + path);
+  }
+}
+
+Writer::~Writer()
+{
+  if (this->_file != NULL)
+  {
+    std::fclose(this->_file);
+  }
+}
+
+void Writer::write_file(const char *data, std::size_t size)
+{
+  if (size > 0 && std::fwrite(data, 1, size, this->_file) != size)
+  {
+    throw std::runtime_error("Cannot write file");
+  }
+}
+
+void Writer::write(const char *data, std::size_t size)
+{
+  if (this->_codec == nullptr)
+  {
+    this->write_file(data, size);
+    return;
+  }
+
+  while (size > 0)
+  {
+    char *output = this->_output.data();
+    std::size_t output_size = this->_output.size();
+    this->_codec->run(data, size, output, output_size, false);
+    this->write_file(this->_output.data(), this->_output.size() - output_size);
+  }
+}
+
+void Writer::close()
+{
+  bool is_end = this->_codec == nullptr;
+  while (!is_end)
+  {
+    const char *input = NULL;
+    std::size_t input_size = 0;
+    char *output = this->_output.data();
+    std::size_t output_size = this->_output.size();
+    is_end = this->_codec->run(input, input_size, output, output_size, true);
+    this->write_file(this->_output.data(), this->_output.size() - output_size);
+  }
+
+  FILE *file = this->_file;
+  this->_file = NULL;
+  if (std::fclose(file) != 0)
+  {
+    throw std::runtime_error("Cannot write file");
+  }
+}
+
+xmlDocPtr parse(const char *path, Document::Compression compression, Document::Parser parser, int options)
+{
+  Reader reader(path, compression);
+  xmlDocPtr doc = NULL;
+
+  if (parser == Document::Parser::native)
+  {
+    std::string text = reader.read_all();
+    doc = NativeParser::parse(text.data(), text.size());
+    if (doc == NULL)
+    {
+      doc = xmlReadMemory(text.data(), static_cast<int>(text.size()), path, NULL, options);
+    }
+    else
+    {
+      doc->URL = xmlStrdup(BAD_CAST path);
+    }
+  }
+  else
+  {
+    ReadContext context{reader, nullptr};
+    doc = xmlReadIO(read_callback, NULL, &context, path, NULL, options);
+    if (context.error != nullptr)
+    {
+      xmlFreeDoc(doc);
+      std::rethrow_exception(context.error);
+    }
+  }
+
+  if (doc == NULL)
+  {
+    xmlErrorPtr err = xmlGetLastError();
+    throw std::runtime_error(err == NULL ? std::string("Cannot parse file: ") + path : err->message);
+  }
+  return doc;
+}
+
+void save(const char *path, xmlDocPtr doc, int options, Document::Compression compression)
+{
+  std::string temporary = TemporaryFile::get_path(path);
+  try
+  {
+    Writer writer(temporary.c_str(), compression);
+    WriteContext context{writer, nullptr};
+    xmlSaveCtxtPtr save_context = xmlSaveToIO(write_callback, NULL, &context, "UTF-8", options);
+    if (save_context == NULL)
+    {
+      throw std::runtime_error("xmlSaveToIO failed");
+    }
+
+    long result = xmlSaveDoc(save_context, doc);
+    if (xmlSaveClose(save_context) < 0)
+    {
+      result = -1;
+    }
+    if (context.error != nullptr)
+    {
+      std::rethrow_exception(context.error);
+    }
+    if (result < 0)
+    {
+      throw std::runtime_error(std::string("Cannot serialize document to: ") + path);
+    }
+    writer.close();
+  }
+  catch (...)
+  {
+    std::remove(temporary.c_str());
+    throw;
+  }
+
+  if (std::rename(temporary.c_str(), path) != 0)
+  {
+    std::remove(temporary.c_str());
+    throw std::runtime_error(std::string("Cannot rename file to: ") + path);
+  }
+}
+
+}
@@ -0,0 +1,109 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file CompressedFile.h
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief Gzip, zstd and xz compressed xml files
+ *
+ * Compressed input is recognized by magic bytes and decompressed in chunks
+ * straight into the libxml2 reader. Native parser needs the whole text in one
+ * buffer, so for it the file is decompressed into memory once. Output is
+ * compressed chunk by chunk as libxml2 serializes.
+ *
+ * Each format is available when its library was found at build time
+ * (UNBOUNDED_WITH_ZLIB, UNBOUNDED_WITH_ZSTD, UNBOUNDED_WITH_LZMA), others
+ * throw.
+ */
+
+#pragma once
+
+#include <Xml/Dom/Document.h>
+#include <cstddef>
+#include <cstdio>
+#include <libxml/tree.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace un::Xml::Dom::CompressedFile
+{
+
+/// Compression of file by its magic bytes, none for plain or unreadable files
+Document::Compression detect(const char *path);
+
+/// Compression by file extension, none for other extensions
+Document::Compression from_extension(const char *path);
+
+/// Streaming compressor or decompressor of one format
+class Codec;
+
+/// Reads decompressed content of a file
+class Reader
+{
+private:
+  FILE *_file;
+  std::unique_ptr<Codec> _codec;
+  std::vector<char> _input;
+  const char *_next;
+  std::size_t _available;
+  bool _is_end_of_file;
+  bool _is_end_of_stream;
+
+public:
+  Reader(const char *path, Document::Compression compression);
+  ~Reader();
+
+  Reader(const Reader &) = delete;
+  Reader &operator=(const Reader &) = delete;
+
+  /**
+   * Read up to size decompressed bytes
+   *
+   * @return Number of bytes read, 0 at the end
+   * @throw std::runtime_error if file is corrupt or truncated
+   */
+  std::size_t read(char *buffer, std::size_t size);
+
+  /// Rest of the content
+  std::string read_all();
+};
+
+/// Writes content to a file compressing it
+class Writer
+{
+private:
+  FILE *_file;
+  std::unique_ptr<Codec> _codec;
+  std::vector<char> _output;
+
+  void write_file(const char *data, std::size_t size);
+
+public:
+  Writer(const char *path, Document::Compression compression);
+  ~Writer();
+
+  Writer(const Writer &) = delete;
+  Writer &operator=(const Writer &) = delete;
+
+  void write(const char *data, std::size_t size);
+
+  /// Finish compressed stream and close file
+  void close();
+};
+
+/**
+ * Parse compressed file
+ *
+ * @param options xmlParserOption flags for libxml2
+ * @throw std::runtime_error if file cannot be read or parsed
+ */
+xmlDocPtr parse(const char *path, Document::Compression compression, Document::Parser parser, int options = 0);
+
+/**
+ * Serialize document into file through a temporary file
+ *
+ * @param options xmlSaveOption flags
+ */
+void save(const char *path, xmlDocPtr doc, int options, Document::Compression compression);
+
+}
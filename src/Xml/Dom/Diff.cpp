@@ -0,0 +1,750 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file Diff.cpp
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief Edit scripts between documents
+ */
+
+#include <Xml/Dom/Diff.h>
+#include "DocumentHandlerLibxml2.h"
+#include "ValueParser.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <libxml/parser.h>
+#include <libxml/tree.h>
+#include <stdexcept>
+
+namespace un::Xml::Dom
+{
+
+namespace
+{
+
+const char *const type_names[] = {"insert",           "remove",   "replace", "set-attribute",
+                                  "remove-attribute", "set-text", "rename"};
+
+inline const xmlChar *get_href(xmlNsPtr ns)
+{
+  return ns == NULL ? NULL : ns->href;
+}
+
+std::string get_value(xmlNodePtr node)
+{
+  std::string storage;
+  std::string_view value = Node::Handler::get_content_view(node, storage);
+  return std::string(value.data(), value.size());
+}
+
+std::string dump(xmlNodePtr node)
+{
+  xmlBufferPtr buffer = xmlBufferCreate();
+  if (buffer == NULL)
+  {
+    throw std::runtime_error("xmlBufferCreate failed");
+  }
+  xmlNodeDump(buffer, node->doc, node, 0, 0);
+  std::string result((const char *)xmlBufferContent(buffer), static_cast<std::size_t>(xmlBufferLength(buffer)));
+  xmlBufferFree(buffer);
+  return result;
+}
+
+/// Compares two trees using the cached structural hashes of their nodes
+class Differ
+{
+private:
+  EditScript &_script;
+  std::vector<std::size_t> _path;
+
+  static uint64_t hash(xmlNodePtr node)
+  {
+    return Node::Handler::get_hash(node);
+  }
+
+  void add(EditScript::Type type, const std::string &name, const std::string &value)
+  {
+    this->_script.edits.push_back(EditScript::Edit{type, this->_path, name, value});
+  }
+
+  /// True if namespaces of both elements match so only plain attributes can differ
+  static bool has_same_namespaces(xmlNodePtr from, xmlNodePtr to)
+  {
+    if (!xmlStrEqual(get_href(from->ns), get_href(to->ns)) ||
+        (from->ns != NULL && !xmlStrEqual(from->ns->prefix, to->ns->prefix)))
+    {
+      return false;
+    }
+
+    xmlNsPtr a = from->nsDef;
+    xmlNsPtr b = to->nsDef;
+    for (; a != NULL && b != NULL; a = a->next, b = b->next)
+    {
+      if (!xmlStrEqual(a->prefix, b->prefix) || !xmlStrEqual(a->href, b->href))
+      {
+        return false;
+      }
+    }
+    if (a != b)
+    {
+      return false;
+    }
+
+    // Namespaced attributes are compared as they are, in order
+    xmlAttrPtr x = from->properties;
+    xmlAttrPtr y = to->properties;
+    for (;;)
+    {
+      while (x != NULL && x->ns == NULL)
+      {
+        x = x->next;
+      }
+      while (y != NULL && y->ns == NULL)
+      {
+        y = y->next;
+      }
+      if (x == NULL || y == NULL)
+      {
+        return x == y;
+      }
+      if (!xmlStrEqual(x->name, y->name) || !xmlStrEqual(x->ns->href, y->ns->href) ||
+          !xmlStrEqual(x->ns->prefix, y->ns->prefix) || get_value((xmlNodePtr)x) != get_value((xmlNodePtr)y))
+      {
+        return false;
+      }
+      x = x->next;
+      y = y->next;
+    }
+  }
+
+  void diff_attributes(xmlNodePtr from, xmlNodePtr to)
+  {
+    for (xmlAttrPtr attribute = to->properties; attribute != NULL; attribute = attribute->next)
+    {
+      if (attribute->ns != NULL)
+      {
+        continue;
+      }
+      xmlAttrPtr old = xmlHasNsProp(from, attribute->name, NULL);
+      std::string value = get_value((xmlNodePtr)attribute);
+      if (old == NULL || get_value((xmlNodePtr)old) != value)
+      {
+        this->add(EditScript::Type::set_attribute, (const char *)attribute->name, value);
+      }
+    }
+
+    for (xmlAttrPtr attribute = from->properties; attribute != NULL; attribute = attribute->next)
+    {
+      if (attribute->ns == NULL && xmlHasNsProp(to, attribute->name, NULL) == NULL)
+      {
+        this->add(EditScript::Type::remove_attribute, (const char *)attribute->name, std::string());
+      }
+    }
+  }
+
+  static std::vector<xmlNodePtr> get_children(xmlNodePtr node)
+  {
+    std::vector<xmlNodePtr> result;
+    for (xmlNodePtr child = node->children; child != NULL; child = child->next)
+    {
+      result.push_back(child);
+    }
+    return result;
+  }
+
+  /// Turns a child into another child at the same position
+  void diff_child(xmlNodePtr from, xmlNodePtr to)
+  {
+    bool is_element = from->type == XML_ELEMENT_NODE && to->type == XML_ELEMENT_NODE;
+    if (is_element ? xmlStrEqual(from->name, to->name) : from->type == to->type)
+    {
+      this->diff_node(from, to);
+    }
+    else
+    {
+      this->add(EditScript::Type::replace, std::string(), dump(to));
+    }
+  }
+
+  /**
+   * Longest common subsequence of a and b (Myers' O((n + m) d) algorithm),
+   * as pairs of matching positions. Returns no pairs once more than
+   * max_distance removals and insertions would be needed.
+   */
+  static std::vector<std::pair<std::size_t, std::size_t>> align(const std::vector<uint64_t> &a,
+                                                                const std::vector<uint64_t> &b)
+  {
+    const std::ptrdiff_t max_distance = 1024;
+    const std::ptrdiff_t n = static_cast<std::ptrdiff_t>(a.size());
+    const std::ptrdiff_t m = static_cast<std::ptrdiff_t>(b.size());
+
+    // trace[d][k + d] is the furthest x reached on diagonal k = x - y with d edits
+    std::vector<std::vector<std::ptrdiff_t>> trace;
+    std::ptrdiff_t distance = -1;
+    for (std::ptrdiff_t d = 0; d <= std::min(n + m, max_distance) && distance < 0; ++d)
+    {
+      std::vector<std::ptrdiff_t> current(static_cast<std::size_t>(2 * d + 1));
+      for (std::ptrdiff_t k = -d; k <= d; k += 2)
+      {
+        std::ptrdiff_t x = 0;
+        if (d > 0)
+        {
+          const std::vector<std::ptrdiff_t> &previous = trace.back();
+          bool down = k == -d || (k != d && previous[k - 1 + d - 1] < previous[k + 1 + d - 1]);
+          x = down ? previous[k + 1 + d - 1] : previous[k - 1 + d - 1] + 1;
+        }
+        std::ptrdiff_t y = x - k;
+        while (x < n && y < m && a[x] == b[y])
+        {
+          ++x;
+          ++y;
+        }
+        current[k + d] = x;
+        if (x >= n && y >= m)
+        {
+          distance = d;
+        }
+      }
+      trace.push_back(std::move(current));
+    }
+
+    std::vector<std::pair<std::size_t, std::size_t>> matches;
+    if (distance < 0)
+    {
+      return matches;
+    }
+
+    std::ptrdiff_t x = n;
+    std::ptrdiff_t y = m;
+    for (std::ptrdiff_t d = distance; d >= 0; --d)
+    {
+      std::ptrdiff_t k = x - y;
+      std::ptrdiff_t start = 0;
+      std::ptrdiff_t previous_x = 0;
+      std::ptrdiff_t previous_k = 0;
+      if (d > 0)
+      {
+        const std::vector<std::ptrdiff_t> &previous = trace[d - 1];
+        bool down = k == -d || (k != d && previous[k - 1 + d - 1] < previous[k + 1 + d - 1]);
+        previous_k = down ? k + 1 : k - 1;
+        previous_x = previous[previous_k + d - 1];
+        start = down ? previous_x : previous_x + 1;
+      }
+      for (; x > start; --x, --y)
+      {
+        matches.emplace_back(x - 1, y - 1);
+      }
+      x = previous_x;
+      y = previous_x - previous_k;
+    }
+    std::reverse(matches.begin(), matches.end());
+    return matches;
+  }
+
+  /**
+   * Children are aligned by the longest common subsequence of their hashes,
+   * so a moved child costs one removal and one insertion. Unmatched children
+   * between two matches are diffed pairwise, then removed or inserted.
+   */
+  void diff_children(xmlNodePtr from, xmlNodePtr to)
+  {
+    std::vector<xmlNodePtr> a = get_children(from);
+    std::vector<xmlNodePtr> b = get_children(to);
+
+    std::vector<uint64_t> a_hashes(a.size());
+    std::vector<uint64_t> b_hashes(b.size());
+    std::transform(a.begin(), a.end(), a_hashes.begin(), hash);
+    std::transform(b.begin(), b.end(), b_hashes.begin(), hash);
+
+    std::vector<std::pair<std::size_t, std::size_t>> matches = align(a_hashes, b_hashes);
+    matches.emplace_back(a.size(), b.size());
+
+    std::size_t position = 0;
+    std::size_t i = 0;
+    std::size_t j = 0;
+    this->_path.push_back(0);
+    for (const std::pair<std::size_t, std::size_t> &match : matches)
+    {
+      for (; i < match.first && j < match.second; ++i, ++j, ++position)
+      {
+        this->_path.back() = position;
+        this->diff_child(a[i], b[j]);
+      }
+      for (; i < match.first; ++i)
+      {
+        this->_path.back() = position;
+        this->add(EditScript::Type::remove, std::string(), std::string());
+      }
+      for (; j < match.second; ++j, ++position)
+      {
+        this->_path.back() = position;
+        this->add(EditScript::Type::insert, std::string(), dump(b[j]));
+      }
+      if (i < a.size())
+      {
+        // Hashes matched, diff_node confirms the subtrees are equal
+        this->_path.back() = position;
+        this->diff_child(a[i], b[j]);
+      }
+      ++i;
+      ++j;
+      ++position;
+    }
+    this->_path.pop_back();
+  }
+
+public:
+  explicit Differ(EditScript &script) : _script(script) {}
+
+  void diff_node(xmlNodePtr from, xmlNodePtr to)
+  {
+    // Equal hashes are confirmed by comparing the trees, a collision would drop edits
+    if (hash(from) == hash(to) && Node::Handler::is_equal(from, to, true))
+    {
+      return;
+    }
+
+    switch (from->type)
+    {
+    case XML_ELEMENT_NODE:
+      if (!has_same_namespaces(from, to))
+      {
+        this->add(EditScript::Type::replace, std::string(), dump(to));
+        return;
+      }
+      if (!xmlStrEqual(from->name, to->name))
+      {
+        this->add(EditScript::Type::rename, (const char *)to->name, std::string());
+      }
+      this->diff_attributes(from, to);
+      this->diff_children(from, to);
+      break;
+    case XML_TEXT_NODE:
+    case XML_CDATA_SECTION_NODE:
+    case XML_COMMENT_NODE:
+      this->add(EditScript::Type::set_text, std::string(), to->content == NULL ? "" : (const char *)to->content);
+      break;
+    default:
+      this->add(EditScript::Type::replace, std::string(), dump(to));
+    }
+  }
+};
+
+/// Libxml2 tree of node, compact nodes are expanded into copy
+xmlNodePtr get_tree(const Node &node, Node &copy)
+{
+  if (node.handler == nullptr || node.handler->get_pointer() == NULL)
+  {
+    throw std::runtime_error("Null object");
+  }
+  if (dynamic_cast<const CompactNodeHandler *>(node.handler.get()) != NULL)
+  {
+    copy.handler = node.clone().handler;
+    return (xmlNodePtr)copy.handler->get_pointer();
+  }
+  return (xmlNodePtr)node.handler->get_pointer();
+}
+
+xmlNodePtr find(xmlNodePtr root, const std::vector<std::size_t> &path, std::size_t depth)
+{
+  xmlNodePtr node = root;
+  for (std::size_t level = 0; level < depth; ++level)
+  {
+    xmlNodePtr child = node->type == XML_ELEMENT_NODE ? node->children : NULL;
+    for (std::size_t i = 0; child != NULL && i < path[level]; ++i)
+    {
+      child = child->next;
+    }
+    if (child == NULL)
+    {
+      throw std::runtime_error("Edit path not found");
+    }
+    node = child;
+  }
+  return node;
+}
+
+/// Parse markup into a chain of nodes, parent gives namespaces and document
+xmlNodePtr parse_markup(xmlNodePtr parent, const std::string &markup)
+{
+  xmlNodePtr list = NULL;
+  if (markup.empty())
+  {
+    list = xmlNewDocText(parent->doc, BAD_CAST "");
+  }
+  else if (parent->doc != NULL)
+  {
+    if (xmlParseInNodeContext(parent, markup.data(), static_cast<int>(markup.size()), 0, &list) != XML_ERR_OK)
+    {
+      xmlFreeNodeList(list);
+      list = NULL;
+    }
+  }
+  else
+  {
+    // Node without document, parse in a wrapper element and take its children
+    std::string wrapped = "<edit>" + markup + "</edit>";
+    xmlDocPtr doc = xmlReadMemory(wrapped.data(), static_cast<int>(wrapped.size()), NULL, NULL,
+                                  XML_PARSE_NONET | XML_PARSE_NODICT);
+    if (doc != NULL)
+    {
+      xmlNodePtr wrapper = xmlDocGetRootElement(doc);
+      list = wrapper->children;
+      for (xmlNodePtr i = list; i != NULL; i = i->next)
+      {
+        i->parent = NULL;
+        xmlSetTreeDoc(i, NULL);
+      }
+      wrapper->children = NULL;
+      wrapper->last = NULL;
+      xmlFreeDoc(doc);
+    }
+  }
+
+  if (list == NULL)
+  {
+    throw std::runtime_error("Cannot parse edit value: " + markup);
+  }
+  return list;
+}
+
+/// Link chain before position (NULL appends) without merging text nodes
+void link_before(xmlNodePtr parent, xmlNodePtr position, xmlNodePtr list)
+{
+  while (list != NULL)
+  {
+    xmlNodePtr node = list;
+    list = list->next;
+
+    node->parent = parent;
+    node->next = position;
+    node->prev = position == NULL ? parent->last : position->prev;
+    if (node->prev == NULL)
+    {
+      parent->children = node;
+    }
+    else
+    {
+      node->prev->next = node;
+    }
+    if (position == NULL)
+    {
+      parent->last = node;
+    }
+    else
+    {
+      position->prev = node;
+    }
+    Node::Handler::notify_inserted(node);
+  }
+}
+
+void remove(xmlNodePtr node)
+{
+  Node::Handler::notify_removing(node);
+  xmlUnlinkNode(node);
+  xmlFreeNode(node);
+}
+
+/// Applies one edit, returns the new node if edit replaced root
+xmlNodePtr apply_edit(xmlNodePtr root, const EditScript::Edit &edit)
+{
+  std::size_t depth = edit.path.size();
+  if (edit.type == EditScript::Type::insert)
+  {
+    if (depth == 0)
+    {
+      throw std::runtime_error("Insert needs a child position");
+    }
+
+    xmlNodePtr parent = find(root, edit.path, depth - 1);
+    if (parent->type != XML_ELEMENT_NODE)
+    {
+      throw std::runtime_error("Edit path not found");
+    }
+    xmlNodePtr position = parent->children;
+    for (std::size_t i = 0; i < edit.path.back(); ++i)
+    {
+      if (position == NULL)
+      {
+        throw std::runtime_error("Edit path not found");
+      }
+      position = position->next;
+    }
+    link_before(parent, position, parse_markup(parent, edit.value));
+    return root;
+  }
+
+  xmlNodePtr target = find(root, edit.path, depth);
+  switch (edit.type)
+  {
+  case EditScript::Type::remove:
+    if (target == root)
+    {
+      throw std::runtime_error("Cannot remove node the script is applied to");
+    }
+    remove(target);
+    break;
+  case EditScript::Type::replace:
+  {
+    xmlNodePtr parent = target->parent;
+    if (parent == NULL)
+    {
+      throw std::runtime_error("Cannot replace node without parent");
+    }
+
+    xmlNodePtr list = parse_markup(parent, edit.value);
+    if (target == root && (list->type != XML_ELEMENT_NODE || list->next != NULL))
+    {
+      xmlFreeNodeList(list);
+      throw std::runtime_error("Replacement of root must be one element");
+    }
+    xmlNodePtr first = list;
+    Node::Handler::notify_removing(target);
+    link_before(parent, target, list);
+    xmlUnlinkNode(target);
+    xmlFreeNode(target);
+    return target == root ? first : root;
+  }
+  case EditScript::Type::set_attribute:
+  case EditScript::Type::remove_attribute:
+  case EditScript::Type::rename:
+    if (target->type != XML_ELEMENT_NODE)
+    {
+      throw std::runtime_error("Edit target is not an element");
+    }
+    if (edit.type == EditScript::Type::rename)
+    {
+      Node::Handler::notify_changing(target);
+    }
+    else
+    {
+      // Attribute xmlSetProp and xmlUnsetProp work on, NULL if it is added
+      xmlAttrPtr attribute = xmlHasNsProp(target, BAD_CAST edit.name.c_str(), NULL);
+      Node::Handler::notify_changing(target,
+                                     attribute != NULL && attribute->type == XML_ATTRIBUTE_NODE ? attribute : NULL);
+    }
+    if (edit.type == EditScript::Type::set_attribute)
+    {
+      xmlSetProp(target, BAD_CAST edit.name.c_str(), BAD_CAST edit.value.c_str());
+    }
+    else if (edit.type == EditScript::Type::remove_attribute)
+    {
+      xmlUnsetProp(target, BAD_CAST edit.name.c_str());
+    }
+    else
+    {
+      xmlNodeSetName(target, BAD_CAST edit.name.c_str());
+    }
+    Node::Handler::notify_changed(target);
+    break;
+  case EditScript::Type::set_text:
+    if (target->type != XML_TEXT_NODE && target->type != XML_CDATA_SECTION_NODE &&
+        target->type != XML_COMMENT_NODE && target->type != XML_PI_NODE)
+    {
+      throw std::runtime_error("Edit target is not a text node");
+    }
+    Node::Handler::notify_changing(target);
+    xmlNodeSetContentLen(target, BAD_CAST edit.value.data(), static_cast<int>(edit.value.size()));
+    Node::Handler::notify_changed(target);
+    break;
+  default:
+    break;
+  }
+  return root;
+}
+
+std::string format_path(const std::vector<std::size_t> &path)
+{
+  std::string result;
+  for (std::size_t i = 0; i < path.size(); ++i)
+  {
+    if (i != 0)
+    {
+      result += '/';
+    }
+    result += std::to_string(path[i]);
+  }
+  return result;
+}
+
+std::vector<std::size_t> parse_path(const std::string &text)
+{
+  std::vector<std::size_t> result;
+  std::size_t start = 0;
+  while (start < text.size())
+  {
+    std::size_t end = text.find('/', start);
+    if (end == std::string::npos)
+    {
+      end = text.size();
+    }
+    std::size_t value = 0;
+    if (!ValueParser::parse(std::string_view(text).substr(start, end - start), value))
+    {
+      throw std::runtime_error("Invalid edit path: " + text);
+    }
+    result.push_back(value);
+    start = end + 1;
+  }
+  return result;
+}
+
+std::string get_property(xmlNodePtr node, const char *name)
+{
+  xmlChar *value = xmlGetProp(node, BAD_CAST name);
+  std::string result = value == NULL ? std::string() : (const char *)value;
+  xmlFree(value);
+  return result;
+}
+
+} // namespace
+
+std::string EditScript::to_string() const
+{
+  std::shared_ptr<xmlDoc> doc(xmlNewDoc(BAD_CAST "1.0"), xmlFreeDoc);
+  if (doc == nullptr)
+  {
+    throw std::runtime_error("xmlNewDoc failed");
+  }
+  xmlNodePtr root = xmlNewDocNode(doc.get(), NULL, BAD_CAST "edits", NULL);
+  xmlDocSetRootElement(doc.get(), root);
+
+  for (const Edit &edit : this->edits)
+  {
+    const xmlChar *value = edit.value.empty() ? NULL : BAD_CAST edit.value.c_str();
+    xmlNodePtr node = xmlNewTextChild(root, NULL, BAD_CAST type_names[static_cast<int>(edit.type)], value);
+    xmlNewProp(node, BAD_CAST "path", BAD_CAST format_path(edit.path).c_str());
+    if (!edit.name.empty())
+    {
+      xmlNewProp(node, BAD_CAST "name", BAD_CAST edit.name.c_str());
+    }
+  }
+
+  xmlChar *buffer = NULL;
+  int size = 0;
+  xmlDocDumpMemoryEnc(doc.get(), &buffer, &size, "UTF-8");
+  std::string result((const char *)buffer, static_cast<std::size_t>(size));
+  xmlFree(buffer);
+  return result;
+}
+
+EditScript EditScript::from_string(const std::string &text)
+{
+  std::shared_ptr<xmlDoc> doc(xmlReadMemory(text.data(), static_cast<int>(text.size()), NULL, NULL,
+                                            XML_PARSE_NONET | XML_PARSE_NOERROR | XML_PARSE_NOWARNING),
+                              xmlFreeDoc);
+  xmlNodePtr root = doc == nullptr ? NULL : xmlDocGetRootElement(doc.get());
+  if (root == NULL || !xmlStrEqual(root->name, BAD_CAST "edits"))
+  {
+    throw std::runtime_error("Invalid edit script");
+  }
+
+  EditScript result;
+  for (xmlNodePtr node = root->children; node != NULL; node = node->next)
+  {
+    if (node->type != XML_ELEMENT_NODE)
+    {
+      continue;
+    }
+
+    Edit edit;
+    std::size_t type = 0;
+    while (type < sizeof(type_names) / sizeof(type_names[0]) && !xmlStrEqual(node->name, BAD_CAST type_names[type]))
+    {
+      ++type;
+    }
+    if (type == sizeof(type_names) / sizeof(type_names[0]))
+    {
+      throw std::runtime_error("Unknown edit: " + std::string((const char *)node->name));
+    }
+    edit.type = static_cast<Type>(type);
+    edit.path = parse_path(get_property(node, "path"));
+    edit.name = get_property(node, "name");
+    xmlChar *value = xmlNodeGetContent(node);
+    edit.value = value == NULL ? std::string() : (const char *)value;
+    xmlFree(value);
+    result.edits.push_back(std::move(edit));
+  }
+  return result;
+}
+
+EditScript diff(const Node &from, const Node &to)
+{
+  Node from_copy;
+  Node to_copy;
+  xmlNodePtr a = get_tree(from, from_copy);
+  xmlNodePtr b = get_tree(to, to_copy);
+
+  EditScript script;
+  Differ differ(script);
+  differ.diff_node(a, b);
+  return script;
+}
+
+EditScript diff(const Document &from, const Document &to)
+{
+  std::shared_ptr<xmlDoc> a = from.handler->get_output_doc();
+  std::shared_ptr<xmlDoc> b = to.handler->get_output_doc();
+  xmlNodePtr a_root = xmlDocGetRootElement(a.get());
+  xmlNodePtr b_root = xmlDocGetRootElement(b.get());
+  if (a_root == NULL || b_root == NULL)
+  {
+    throw std::runtime_error("Document does not have root node");
+  }
+
+  EditScript script;
+  Differ differ(script);
+  differ.diff_node(a_root, b_root);
+  return script;
+}
+
+void patch(Node &node, const EditScript &script)
+{
+  if (node.handler == nullptr || node.handler->get_pointer() == NULL)
+  {
+    throw std::runtime_error("Null object");
+  }
+  node.handler->check_mutable();
+
+  xmlNodePtr original = (xmlNodePtr)node.handler->get_pointer();
+  xmlNodePtr root = original;
+  Node::Handler::Batch batch(original->doc);
+  try
+  {
+    for (const EditScript::Edit &edit : script.edits)
+    {
+      root = apply_edit(root, edit);
+    }
+  }
+  catch (...)
+  {
+    if (root != original)
+    {
+      node.handler = Node::Handler::bind(root).handler;
+    }
+    throw;
+  }
+
+  if (root != original)
+  {
+    node.handler = Node::Handler::bind(root).handler;
+  }
+}
+
+void Document::apply(const EditScript &script)
+{
+  Node root = this->root_node;
+  try
+  {
+    patch(root, script);
+  }
+  catch (...)
+  {
+    this->root_node.handler = root.handler;
+    throw;
+  }
+  this->root_node.handler = root.handler;
+}
+
+}
@@ -26,6 +26,9 @@ Document::Document(const char *version)
 Document::Document(const std::string &version)
   : handler(new Document::Handler(version.c_str())) {}
 
+Document::Document(Document::Parser parser, const std::string &version)
+  : handler(new Document::Handler(version.c_str(), parser)) {}
+
 Document::RootNodePropertyType::RootNodePropertyType()
   : ::un::Xml::Dom::Node(std::shared_ptr<::un::Xml::Dom::Node::Handler>(
     new ::un::Xml::Dom::Node::Handler(NULL, true))) {}
@@ -45,6 +48,133 @@ void Document::parse_file(const char *path)
   this->handler->get_root_node(this->root_node);
 }
 
+void Document::save_file(const char *path, bool pretty_print, Compression compression) const
+{
+  this->handler->save_file(path, pretty_print, compression);
+}
+
+void Document::freeze() { this->handler->freeze(); }
+
+bool Document::is_frozen() const { return this->handler->is_frozen(); }
+
+void Document::compact()
+{
+  this->handler->compact();
+  this->root_node.handler.reset(new Node::Handler(NULL, false));
+  if (this->handler->has_root_node())
+  {
+    this->handler->get_root_node(this->root_node);
+  }
+}
+
+bool Document::is_compact() const { return this->handler->is_compact(); }
+
+Document Document::clone(bool share_dictionary) const
+{
+  Document result;
+  this->handler->copy_to(*result.handler, share_dictionary);
+  result.root_node.handler.reset(new Node::Handler(NULL, false));
+  if (result.handler->has_root_node())
+  {
+    result.handler->get_root_node(result.root_node);
+  }
+  return result;
+}
+
+void Document::enable_indexes(const std::string &id_attribute)
+{
+  this->handler->enable_indexes(id_attribute);
+}
+
+void Document::disable_indexes() { this->handler->disable_indexes(); }
+
+bool Document::has_indexes() const { return this->handler->has_indexes(); }
+
+Node Document::get_element_by_id(const std::string &id) const
+{
+  return this->handler->get_element_by_id(id);
+}
+
+std::vector<Node> Document::get_elements_by_name(const std::string &name) const
+{
+  return this->handler->get_elements_by_name(name);
+}
+
+void Document::normalize(bool remove_blank_text) { this->handler->normalize(remove_blank_text); }
+
+bool Document::is_normalized() const { return this->handler->is_normalized(); }
+
+void Document::set_normalize_on_parse(bool normalize) { this->handler->set_normalize_on_parse(normalize); }
+
+bool Document::get_normalize_on_parse() const { return this->handler->get_normalize_on_parse(); }
+
+/// Rebinds root node property if undo or redo replaced the root element
+static void rebind_root_node(Document &document)
+{
+  Node current(std::shared_ptr<Node::Handler>(new Node::Handler(NULL, false)));
+  if (document.handler->has_root_node())
+  {
+    document.handler->get_root_node(current);
+  }
+  if (current.handler->get_pointer() != document.root_node.handler->get_pointer())
+  {
+    document.root_node.handler = current.handler;
+  }
+}
+
+void Document::enable_journal() { this->handler->enable_journal(); }
+
+void Document::disable_journal() { this->handler->disable_journal(); }
+
+bool Document::has_journal() const { return this->handler->has_journal(); }
+
+void Document::begin_transaction() { this->handler->begin_transaction(); }
+
+void Document::commit_transaction() { this->handler->commit_transaction(); }
+
+void Document::rollback_transaction()
+{
+  this->handler->rollback_transaction();
+  rebind_root_node(*this);
+}
+
+bool Document::can_undo() const { return this->handler->can_undo(); }
+
+bool Document::can_redo() const { return this->handler->can_redo(); }
+
+bool Document::undo()
+{
+  bool result = this->handler->undo();
+  rebind_root_node(*this);
+  return result;
+}
+
+bool Document::redo()
+{
+  bool result = this->handler->redo();
+  rebind_root_node(*this);
+  return result;
+}
+
+void Document::add_observer(Observer &observer) { this->handler->add_observer(observer); }
+
+void Document::remove_observer(Observer &observer) { this->handler->remove_observer(observer); }
+
+void Document::save_snapshot(const char *path) const
+{
+  this->handler->save_snapshot(path);
+}
+
+void Document::load_snapshot(const char *path)
+{
+  this->handler->load_snapshot(path);
+  this->root_node.handler.reset(new Node::Handler(NULL, false));
+  if (this->handler->has_root_node())
+  {
+    this->handler->get_root_node(this->root_node);
+  }
+}
+
 Document *Document::RootNodePropertyType::get_parent() const
 {
   static const int offset = offsetof(Document, root_node);
@@ -0,0 +1,234 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file DocumentCache.cpp
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief Cache of parsed documents keyed by file path
+ */
+
+#include <Xml/Dom/DocumentCache.h>
+#include "DocumentHandlerLibxml2.h"
+#include <cerrno>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unordered_map>
+
+namespace un::Xml::Dom
+{
+
+class DocumentCache::Handler
+{
+private:
+  /// Identity of file contents as far as stat can tell
+  struct Stamp
+  {
+    uint64_t device;
+    uint64_t inode;
+    uint64_t size;
+    int64_t mtime_sec;
+    int64_t mtime_nsec;
+
+    bool operator==(const Stamp &rhs) const
+    {
+      return device == rhs.device && inode == rhs.inode && size == rhs.size &&
+             mtime_sec == rhs.mtime_sec && mtime_nsec == rhs.mtime_nsec;
+    }
+  };
+
+  struct Entry
+  {
+    std::string path;
+    Stamp stamp;
+    std::size_t memory_size;
+    std::shared_ptr<const Document> document;
+  };
+
+  typedef std::list<Entry> EntryList;
+
+  Document::Parser _parser;
+  std::size_t _memory_budget;
+  std::size_t _memory_usage;
+
+  // Most recently used first
+  EntryList _entries;
+  std::unordered_map<std::string, EntryList::iterator> _index;
+  mutable std::mutex _mutex;
+
+  static Stamp stat(const char *path)
+  {
+    struct stat info;
+    if (::stat(path, &info) != 0)
+    {
+      throw std::runtime_error(std::string("Cannot stat file: ") + path + ": " + std::strerror(errno));
+    }
+
+    Stamp result;
+    result.device = static_cast<uint64_t>(info.st_dev);
+    result.inode = static_cast<uint64_t>(info.st_ino);
+    result.size = static_cast<uint64_t>(info.st_size);
+    result.mtime_sec = static_cast<int64_t>(info.st_mtime);
+#if defined(__APPLE__)
+    result.mtime_nsec = info.st_mtimespec.tv_nsec;
+#elif defined(_WIN32)
+    result.mtime_nsec = 0;
+#else
+    result.mtime_nsec = info.st_mtim.tv_nsec;
+#endif
+    return result;
+  }
+
+  void erase(EntryList::iterator entry)
+  {
+    this->_memory_usage -= entry->memory_size;
+    this->_index.erase(entry->path);
+    this->_entries.erase(entry);
+  }
+
+  void evict()
+  {
+    while (this->_memory_usage > this->_memory_budget && !this->_entries.empty())
+    {
+      this->erase(std::prev(this->_entries.end()));
+    }
+  }
+
+public:
+  Handler(std::size_t memory_budget, Document::Parser parser)
+    : _parser(parser), _memory_budget(memory_budget), _memory_usage(0) {}
+
+  std::shared_ptr<const Document> get(const char *path)
+  {
+    Stamp stamp = stat(path);
+
+    {
+      std::lock_guard<std::mutex> lock(this->_mutex);
+      auto found = this->_index.find(path);
+      if (found != this->_index.end())
+      {
+        if (found->second->stamp == stamp)
+        {
+          this->_entries.splice(this->_entries.begin(), this->_entries, found->second);
+          return found->second->document;
+        }
+        this->erase(found->second);
+      }
+    }
+
+    // Parse without holding the lock, concurrent misses of one path may parse twice
+    std::shared_ptr<Document> document(new Document(this->_parser));
+    document->parse_file(path);
+    document->compact();
+    std::size_t memory_size = document->handler->get_memory_size();
+
+    // File changed while parsing, do not cache a document of unknown version
+    if (!(stat(path) == stamp))
+    {
+      return document;
+    }
+
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    auto found = this->_index.find(path);
+    if (found != this->_index.end())
+    {
+      if (found->second->stamp == stamp)
+      {
+        this->_entries.splice(this->_entries.begin(), this->_entries, found->second);
+        return found->second->document;
+      }
+      this->erase(found->second);
+    }
+
+    if (memory_size <= this->_memory_budget)
+    {
+      this->_entries.push_front(Entry{path, stamp, memory_size, document});
+      this->_index[path] = this->_entries.begin();
+      this->_memory_usage += memory_size;
+      this->evict();
+    }
+
+    return document;
+  }
+
+  void remove(const char *path)
+  {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    auto found = this->_index.find(path);
+    if (found != this->_index.end())
+    {
+      this->erase(found->second);
+    }
+  }
+
+  void clear()
+  {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    this->_index.clear();
+    this->_entries.clear();
+    this->_memory_usage = 0;
+  }
+
+  void set_memory_budget(std::size_t memory_budget)
+  {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    this->_memory_budget = memory_budget;
+    this->evict();
+  }
+
+  std::size_t get_memory_budget() const
+  {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    return this->_memory_budget;
+  }
+
+  std::size_t get_memory_usage() const
+  {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    return this->_memory_usage;
+  }
+
+  std::size_t get_count() const
+  {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    return this->_entries.size();
+  }
+};
+
+DocumentCache::DocumentCache(std::size_t memory_budget, Document::Parser parser)
+  : handler(new DocumentCache::Handler(memory_budget, parser)) {}
+
+DocumentCache &DocumentCache::instance()
+{
+  static DocumentCache cache;
+  return cache;
+}
+
+std::shared_ptr<const Document> DocumentCache::get(const char *path)
+{
+  return this->handler->get(path);
+}
+
+void DocumentCache::remove(const char *path) { this->handler->remove(path); }
+
+void DocumentCache::clear() { this->handler->clear(); }
+
+void DocumentCache::set_memory_budget(std::size_t memory_budget)
+{
+  this->handler->set_memory_budget(memory_budget);
+}
+
+std::size_t DocumentCache::get_memory_budget() const
+{
+  return this->handler->get_memory_budget();
+}
+
+std::size_t DocumentCache::get_memory_usage() const
+{
+  return this->handler->get_memory_usage();
+}
+
+std::size_t DocumentCache::get_count() const { return this->handler->get_count(); }
+
+}
@@ -9,9 +9,23 @@
 #pragma once
 
 #include <Xml/Dom/Document.h>
+#include "CompactTree.h"
+#include "CompressedFile.h"
+#include "DocumentIndex.h"
+#include "Journal.h"
+#include "MappedFile.h"
+#include "NativeParser.h"
+#include "NodeHandlerCompact.h"
 #include "NodeHandlerLibxml2.h"
+#include "Normalize.h"
+#include "ObserverList.h"
+#include "ReadAheadFile.h"
+#include "Snapshot.h"
+#include <atomic>
 #include <cctype>
+#include <cstring>
 #include <iostream>
+#include <mutex>
 #include <libxml/parser.h>
 #include <libxml/xmlmemory.h>
 #include <libxml/xmlsave.h>
@@ -23,15 +37,147 @@ class Document::Handler
 {
 private:
   xmlDocPtr _doc;
+  std::atomic<bool> _is_frozen;
+  Document::Parser _parser;
+
+  /// Set once document is compacted, _doc is then an empty shell
+  std::shared_ptr<const CompactTree> _compact;
+
+  // Element indexes, enabled by enable_indexes
+  bool _is_indexed;
+  std::string _id_attribute;
+  std::unique_ptr<DocumentIndex<xmlNodePtr>> _index;
+  std::unique_ptr<DocumentIndex<uint32_t>> _compact_index;
+
+  // Undo history, enabled by enable_journal
+  std::unique_ptr<Journal> _journal;
+
+  ObserverList _observers;
+
+  // Set by normalize while no blank text node is left, see normalize
+  bool _is_normalized;
+  bool _normalize_on_parse;
+
+  void index_element(xmlNodePtr element, bool add)
+  {
+    DocumentIndex<xmlNodePtr> &index = *this->_index;
+    xmlAttrPtr id = xmlHasProp(element, BAD_CAST this->_id_attribute.c_str());
+    std::string storage;
+    if (add)
+    {
+      index.add_name((const char *)element->name, element);
+      if (id != NULL)
+      {
+        index.add_id(Node::Handler::get_content_view((xmlNodePtr)id, storage), element);
+      }
+    }
+    else
+    {
+      index.remove_name((const char *)element->name, element);
+      if (id != NULL)
+      {
+        index.remove_id(Node::Handler::get_content_view((xmlNodePtr)id, storage), element);
+      }
+    }
+  }
+
+  void index_subtree(xmlNodePtr node, bool add)
+  {
+    xmlNodePtr i = node;
+    while (i != NULL)
+    {
+      if (i->type == XML_ELEMENT_NODE)
+      {
+        this->index_element(i, add);
+        if (i->children != NULL)
+        {
+          i = i->children;
+          continue;
+        }
+      }
+
+      while (i != node && i->next == NULL)
+      {
+        i = i->parent;
+      }
+      if (i == node)
+      {
+        break;
+      }
+      i = i->next;
+    }
+  }
+
+  void build_index()
+  {
+    this->_index.reset();
+    this->_compact_index.reset();
+    if (!this->_is_indexed)
+    {
+      return;
+    }
+
+    if (this->_compact != nullptr)
+    {
+      const CompactTree &tree = *this->_compact;
+      this->_compact_index.reset(new DocumentIndex<uint32_t>(this->_id_attribute));
+      for (uint32_t i = 0; i < tree.parent.size; ++i)
+      {
+        if (tree.type[i] != XML_ELEMENT_NODE)
+        {
+          continue;
+        }
+
+        this->_compact_index->add_name(tree.get_name(i), i);
+        uint32_t last = tree.data[i] + static_cast<uint32_t>(tree.get_attribute_count(i));
+        for (uint32_t a = tree.data[i]; a < last; ++a)
+        {
+          if (this->_id_attribute == tree.get_string(tree.attribute_name[a]))
+          {
+            this->_compact_index->add_id(std::string_view(tree.pool.data + tree.attribute_value[a],
+                                                          tree.attribute_value_size[a]),
+                                         i);
+          }
+        }
+      }
+      return;
+    }
+
+    this->_index.reset(new DocumentIndex<xmlNodePtr>(this->_id_attribute));
+    for (xmlNodePtr i = this->_doc->children; i != NULL; i = i->next)
+    {
+      this->index_subtree(i, true);
+    }
+  }
 
 public:
-  Handler(const char *version) : _doc(NULL)
+  /// Document to serialize, compact documents are expanded into a copy
+  std::shared_ptr<xmlDoc> get_output_doc() const
+  {
+    if (this->_compact == nullptr)
+    {
+      return std::shared_ptr<xmlDoc>(this->_doc, [](xmlDocPtr) {});
+    }
+
+    std::shared_ptr<xmlDoc> doc(xmlCopyDoc(this->_doc, 0), xmlFreeDoc);
+    if (doc == nullptr)
+    {
+      throw std::runtime_error("xmlCopyDoc failed");
+    }
+    this->_compact->expand(doc.get());
+    return doc;
+  }
+
+  Handler(const char *version, Document::Parser parser = Document::Parser::libxml2)
+    : _doc(NULL), _is_frozen(false), _parser(parser), _is_indexed(false), _is_normalized(false),
+      _normalize_on_parse(false)
   {
     _doc = xmlNewDoc(BAD_CAST version);
     if (_doc == NULL)
     {
       throw std::runtime_error("xmlNewDoc failed");
     }
+    _doc->_private = this;
   }
 
   ~Handler()
@@ -41,6 +187,11 @@ public:
 
   inline void safe_free()
   {
+    // Detached subtrees of the journal use the dictionary of the document
+    if (this->_journal != nullptr)
+    {
+      this->_journal->clear();
+    }
     if (this->_doc != NULL)
     {
       xmlFreeDoc(this->_doc);
@@ -52,10 +203,218 @@ public:
   {
     safe_free();
     this->_doc = doc;
+    this->_doc->_private = this;
+    this->_is_normalized = false;
+    this->build_index();
+  }
+
+  /// Takes a parsed document, normalized first if normalize_on_parse is set
+  inline void adopt(xmlDocPtr doc)
+  {
+    // Not owned yet, so normalizing notifies no index, journal or observer
+    bool is_normalized = this->_normalize_on_parse && Normalize::normalize((xmlNodePtr)doc, true);
+    this->reset(doc);
+    this->_is_normalized = is_normalized;
+  }
+
+  /// libxml2 parser options
+  inline int get_parse_options() const
+  {
+    return this->_normalize_on_parse ? XML_PARSE_NOBLANKS : 0;
+  }
+
+  /**
+   * Document handler of given libxml2 document or NULL if document is not
+   * owned by a Document object.
+   */
+  static inline Handler *from(xmlDocPtr doc)
+  {
+    return doc == NULL ? NULL : static_cast<Handler *>(doc->_private);
+  }
+
+  /**
+   * Sets up global state of libxml2. libxml2 does it lazily on first use,
+   * which races when the first use is on several threads at once, so this
+   * is called before work is handed to other threads.
+   */
+  static inline void initialize_threads()
+  {
+    static std::once_flag once;
+    std::call_once(once, xmlInitParser);
+  }
+
+  inline void freeze()
+  {
+    initialize_threads();
+    this->_is_frozen.store(true, std::memory_order_release);
+  }
+
+  inline bool is_frozen() const
+  {
+    return this->_is_frozen.load(std::memory_order_acquire);
+  }
+
+  inline void check_mutable() const
+  {
+    if (this->is_frozen())
+    {
+      throw std::runtime_error("Document is frozen");
+    }
+  }
+
+  inline void compact()
+  {
+    if (this->_compact != nullptr)
+    {
+      return;
+    }
+
+    this->freeze();
+    std::shared_ptr<const CompactTree> tree = CompactTree::build(this->_doc);
+
+    // Keep version, encoding and url, nodes now live in the compact tree
+    xmlDocPtr shell = xmlCopyDoc(this->_doc, 0);
+    if (shell == NULL)
+    {
+      throw std::runtime_error("xmlCopyDoc failed");
+    }
+    this->reset(shell);
+    this->_compact = tree;
+    this->build_index();
+  }
+
+  inline bool is_compact() const
+  {
+    return this->_compact != nullptr;
+  }
+
+  /**
+   * Deep copy into target, which takes parser and index settings too. With
+   * share_dictionary the copy shares the name dictionary of this document, so
+   * names are looked up instead of duplicated, otherwise it gets its own.
+   * Compact documents are expanded.
+   */
+  inline void copy_to(Handler &target, bool share_dictionary) const
+  {
+    target.check_mutable();
+
+    xmlDocPtr doc = xmlCopyDoc(this->_doc, 0);
+    if (doc == NULL)
+    {
+      throw std::runtime_error("xmlCopyDoc failed");
+    }
+
+    try
+    {
+      if (this->_compact != nullptr)
+      {
+        this->_compact->expand(doc);
+      }
+      else
+      {
+        if (this->_doc->dict != NULL && share_dictionary)
+        {
+          doc->dict = this->_doc->dict;
+          xmlDictReference(doc->dict);
+        }
+        else if (this->_doc->dict != NULL)
+        {
+          doc->dict = xmlDictCreate();
+          if (doc->dict == NULL)
+          {
+            throw std::runtime_error("xmlDictCreate failed");
+          }
+        }
+
+        // DTD comes first so entity references below resolve against the copy
+        for (xmlNodePtr i = this->_doc->children; i != NULL; i = i->next)
+        {
+          xmlNodePtr copy = NULL;
+          if (i->type == XML_DTD_NODE)
+          {
+            copy = (xmlNodePtr)xmlCopyDtd((xmlDtdPtr)i);
+            if (copy != NULL)
+            {
+              xmlSetTreeDoc(copy, doc);
+              doc->intSubset = (xmlDtdPtr)copy;
+            }
+          }
+          else
+          {
+            copy = xmlDocCopyNode(i, doc, 1);
+          }
+
+          if (copy == NULL)
+          {
+            throw std::runtime_error("xmlDocCopyNode failed");
+          }
+          xmlAddChild((xmlNodePtr)doc, copy);
+        }
+      }
+    }
+    catch (...)
+    {
+      xmlFreeDoc(doc);
+      throw;
+    }
+
+    target._parser = this->_parser;
+    target._is_indexed = this->_is_indexed;
+    target._id_attribute = this->_id_attribute;
+    target._normalize_on_parse = this->_normalize_on_parse;
+    target._compact.reset();
+    target.reset(doc);
+    target._is_normalized = this->_is_normalized;
+  }
+
+  /// Memory held by the compact tree, 0 for documents that are not compact
+  inline std::size_t get_memory_size() const
+  {
+    return this->_compact == nullptr ? 0 : sizeof(CompactTree) + this->_compact->get_buffer_size();
+  }
+
+  inline void save_snapshot(const char *path) const
+  {
+    std::shared_ptr<const CompactTree> tree = this->_compact;
+    if (tree == nullptr)
+    {
+      tree = CompactTree::build(this->_doc);
+    }
+
+    Snapshot::Declaration declaration;
+    declaration.version = this->_doc->version == NULL ? "1.0" : (const char *)this->_doc->version;
+    declaration.encoding = this->_doc->encoding == NULL ? "" : (const char *)this->_doc->encoding;
+    Snapshot::save(path, *tree, declaration);
+  }
+
+  inline void load_snapshot(const char *path)
+  {
+    this->check_mutable();
+
+    Snapshot::Declaration declaration;
+    std::shared_ptr<const CompactTree> tree = Snapshot::load(path, declaration);
+
+    xmlDocPtr doc = xmlNewDoc(BAD_CAST declaration.version.c_str());
+    if (doc == NULL)
+    {
+      throw std::runtime_error("xmlNewDoc failed");
+    }
+    if (!declaration.encoding.empty())
+    {
+      doc->encoding = xmlStrdup(BAD_CAST declaration.encoding.c_str());
+    }
+    doc->URL = xmlStrdup(BAD_CAST path);
+
+    this->reset(doc);
+    this->freeze();
+    this->_compact = tree;
+    this->build_index();
   }
 
   inline void set_root_node(Node &rnode, const Node &node)
   {
+    this->check_mutable();
+
     if (!node.handler->is_owner)
     {
       throw std::runtime_error(
@@ -64,7 +423,14 @@ public:
 
     node.handler->is_owner = false;
 
+    xmlNodePtr current = xmlDocGetRootElement(this->_doc);
+    Node::Handler::Batch batch(this->_doc);
+    if (current != NULL)
+    {
+      this->on_removing(current);
+    }
     xmlNodePtr old = xmlDocSetRootElement(this->_doc, node.handler->handler);
+    this->on_inserted(node.handler->handler);
 
     if (rnode.handler != nullptr)
     {
@@ -83,14 +449,15 @@ public:
     int buffersize2;
     xmlChar *xmlbuff;
 
-    xmlDocDumpFormatMemory(_doc, &xmlbuff, &buffersize2, 1);
+    std::shared_ptr<xmlDoc> doc = this->get_output_doc();
+    xmlDocDumpFormatMemory(doc.get(), &xmlbuff, &buffersize2, 1);
 
     _cout.write((const char *)xmlbuff, buffersize2);
 
     xmlFree(xmlbuff);
   }
 
-  inline void write_to_c(FILE *fp) { xmlDocFormatDump(fp, _doc, 1); }
+  inline void write_to_c(FILE *fp) { xmlDocFormatDump(fp, this->get_output_doc().get(), 1); }
 
   inline std::string as_string(bool pretty_print = false, bool skip_headers = false)
   {
@@ -111,7 +478,8 @@ public:
       throw std::runtime_error(err->message);
     }
 
-    int n = xmlSaveDoc(saveCtxt, _doc);
+    std::shared_ptr<xmlDoc> doc = this->get_output_doc();
+    int n = xmlSaveDoc(saveCtxt, doc.get());
     xmlSaveClose(saveCtxt);
     if (n < 0)
     {
@@ -131,11 +499,33 @@ public:
     return std::string(content, trim_end);
   }
 
+  inline void save_file(const char *path, bool pretty_print, Document::Compression compression) const
+  {
+    if (compression == Document::Compression::by_extension)
+    {
+      compression = CompressedFile::from_extension(path);
+    }
+    std::shared_ptr<xmlDoc> doc = this->get_output_doc();
+    CompressedFile::save(path, doc.get(), pretty_print ? XML_SAVE_FORMAT : 0, compression);
+  }
+
   inline void parse(const char *data, std::size_t size)
   {
-    xmlDocPtr doc;
+    this->check_mutable();
+
+    xmlDocPtr doc = NULL;
+
+    if (this->_parser == Document::Parser::native)
+    {
+      doc = NativeParser::parse(data, size);
+    }
 
-    doc = xmlParseMemory(data, size);
+    if (doc == NULL)
+    {
+      doc = this->_normalize_on_parse
+                ? xmlReadMemory(data, static_cast<int>(size), NULL, NULL, this->get_parse_options())
+                : xmlParseMemory(data, size);
+    }
 
     if (doc == NULL)
     {
@@ -143,24 +533,390 @@ public:
       throw std::runtime_error(err->message);
     }
 
-    reset(doc);
+    this->adopt(doc);
   }
 
   inline void parse_file(const char *path)
   {
-    xmlDocPtr doc;
+    this->check_mutable();
+
+    xmlDocPtr doc = NULL;
+
+    Document::Compression compression = CompressedFile::detect(path);
+    if (compression != Document::Compression::none)
+    {
+      this->adopt(CompressedFile::parse(path, compression, this->_parser, this->get_parse_options()));
+      return;
+    }
+
+    if (this->_parser == Document::Parser::native)
+    {
+      MappedFile file(path);
+      doc = NativeParser::parse(file.get_data(), file.get_size());
+      if (doc != NULL)
+      {
+        doc->URL = xmlStrdup(BAD_CAST path);
+      }
+    }
+
+    if (doc == NULL)
+    {
+      doc = this->_normalize_on_parse ? xmlReadFile(path, NULL, this->get_parse_options()) : xmlParseFile(path);
+    }
 
-    doc = xmlParseFile(path);
     if (doc == NULL)
     {
       xmlErrorPtr err = xmlGetLastError();
       throw std::runtime_error(err->message);
     }
-    reset(doc);
+    this->adopt(doc);
+  }
+
+  /**
+   * Parse file like parse_file. Plain files parsed by libxml2 are fed to the
+   * push parser chunk by chunk while the next chunk is read in the background.
+   */
+  inline void parse_file_read_ahead(const char *path)
+  {
+    if (this->_parser == Document::Parser::native || CompressedFile::detect(path) != Document::Compression::none)
+    {
+      this->parse_file(path);
+      return;
+    }
+
+    this->check_mutable();
+
+    ReadAheadFile file(path);
+    xmlParserCtxtPtr context = xmlCreatePushParserCtxt(NULL, NULL, NULL, 0, path);
+    if (context == NULL)
+    {
+      throw std::runtime_error("xmlCreatePushParserCtxt failed");
+    }
+    std::shared_ptr<xmlParserCtxt> guard(context, xmlFreeParserCtxt);
+    if (this->_normalize_on_parse)
+    {
+      xmlCtxtUseOptions(context, this->get_parse_options());
+    }
+
+    try
+    {
+      for (std::string_view chunk = file.next(); !chunk.empty(); chunk = file.next())
+      {
+        if (xmlParseChunk(context, chunk.data(), static_cast<int>(chunk.size()), 0) != 0)
+        {
+          break;
+        }
+      }
+    }
+    catch (...)
+    {
+      xmlFreeDoc(context->myDoc);
+      context->myDoc = NULL;
+      throw;
+    }
+    xmlParseChunk(context, NULL, 0, 1);
+
+    xmlDocPtr doc = context->myDoc;
+    context->myDoc = NULL;
+    if (!context->wellFormed || doc == NULL)
+    {
+      xmlFreeDoc(doc);
+      throw std::runtime_error(context->lastError.message == NULL ? std::string("Cannot parse file: ") + path
+                                                                  : context->lastError.message);
+    }
+    this->adopt(doc);
+  }
+
+  inline void enable_indexes(const std::string &id_attribute)
+  {
+    this->_is_indexed = true;
+    this->_id_attribute = id_attribute;
+    this->build_index();
+  }
+
+  inline void disable_indexes()
+  {
+    this->_is_indexed = false;
+    this->build_index();
+  }
+
+  inline bool has_indexes() const
+  {
+    return this->_is_indexed;
+  }
+
+  Node get_element_by_id(const std::string &id) const
+  {
+    if (!this->_is_indexed)
+    {
+      throw std::runtime_error("Document indexes are not enabled");
+    }
+
+    if (this->_compact_index != nullptr)
+    {
+      uint32_t element;
+      return this->_compact_index->find_id(id, element) ? CompactNodeHandler::make(this->_compact, element)
+                                                        : Node(std::shared_ptr<Node::Handler>());
+    }
+
+    xmlNodePtr element;
+    return this->_index->find_id(id, element) ? Node::Handler::bind(element)
+                                              : Node(std::shared_ptr<Node::Handler>());
+  }
+
+  std::vector<Node> get_elements_by_name(const std::string &name) const
+  {
+    if (!this->_is_indexed)
+    {
+      throw std::runtime_error("Document indexes are not enabled");
+    }
+
+    std::vector<Node> result;
+    if (this->_compact_index != nullptr)
+    {
+      const std::vector<uint32_t> *elements = this->_compact_index->find_name(name);
+      if (elements != NULL)
+      {
+        result.reserve(elements->size());
+        for (uint32_t element : *elements)
+        {
+          result.push_back(CompactNodeHandler::make(this->_compact, element));
+        }
+      }
+      return result;
+    }
+
+    const std::vector<xmlNodePtr> *elements = this->_index->find_name(name);
+    if (elements != NULL)
+    {
+      result.reserve(elements->size());
+      for (xmlNodePtr element : *elements)
+      {
+        result.push_back(Node::Handler::bind(element));
+      }
+    }
+    return result;
+  }
+
+  inline void enable_journal()
+  {
+    this->check_mutable();
+    if (this->_compact != nullptr)
+    {
+      throw std::runtime_error("Compact document cannot be changed");
+    }
+    if (this->_journal == nullptr)
+    {
+      this->_journal.reset(new Journal());
+    }
+  }
+
+  inline void disable_journal()
+  {
+    if (this->_journal != nullptr && this->_journal->get_depth() > 0)
+    {
+      throw std::runtime_error("Transaction is open");
+    }
+    this->_journal.reset();
+  }
+
+  inline bool has_journal() const
+  {
+    return this->_journal != nullptr;
+  }
+
+  inline Journal &get_journal() const
+  {
+    if (this->_journal == nullptr)
+    {
+      throw std::runtime_error("Document journal is not enabled");
+    }
+    return *this->_journal;
+  }
+
+  inline void begin_transaction()
+  {
+    this->get_journal().begin();
+  }
+
+  inline void commit_transaction()
+  {
+    if (!this->get_journal().end())
+    {
+      throw std::runtime_error("No transaction is open");
+    }
+  }
+
+  inline void rollback_transaction()
+  {
+    Journal &journal = this->get_journal();
+    if (journal.get_depth() != 1)
+    {
+      throw std::runtime_error(journal.get_depth() == 0 ? "No transaction is open"
+                                                        : "Only the outermost transaction can be rolled back");
+    }
+
+    bool has_step = journal.is_step_open();
+    journal.end();
+    if (has_step)
+    {
+      journal.discard(this->_doc);
+    }
+  }
+
+  inline bool can_undo() const
+  {
+    return this->_journal != nullptr && this->_journal->can_undo();
+  }
+
+  inline bool can_redo() const
+  {
+    return this->_journal != nullptr && this->_journal->can_redo();
+  }
+
+  inline bool undo()
+  {
+    this->check_mutable();
+    return this->get_journal().undo(this->_doc);
+  }
+
+  inline bool redo()
+  {
+    this->check_mutable();
+    return this->get_journal().redo(this->_doc);
+  }
+
+  inline void normalize(bool remove_blank_text)
+  {
+    this->check_mutable();
+    Node::Handler::Batch batch(this->_doc);
+    this->_is_normalized = Normalize::normalize((xmlNodePtr)this->_doc, remove_blank_text);
+  }
+
+  inline bool is_normalized() const
+  {
+    return this->_is_normalized;
+  }
+
+  inline void set_normalize_on_parse(bool normalize)
+  {
+    this->_normalize_on_parse = normalize;
+  }
+
+  inline bool get_normalize_on_parse() const
+  {
+    return this->_normalize_on_parse;
+  }
+
+  inline void add_observer(Observer &observer)
+  {
+    this->_observers.add(observer);
+  }
+
+  inline void remove_observer(Observer &observer)
+  {
+    this->_observers.remove(observer);
+  }
+
+  // Mutation notifications, see Node::Handler::notify_inserted
+
+  inline void on_inserted(xmlNodePtr node)
+  {
+    this->_is_normalized = false;
+    if (this->_index != nullptr)
+    {
+      this->index_subtree(node, true);
+    }
+    if (this->_journal != nullptr)
+    {
+      this->_journal->on_inserted(node);
+    }
+    if (!this->_observers.empty())
+    {
+      this->_observers.on_inserted(node);
+    }
+  }
+
+  inline void on_removing(xmlNodePtr node)
+  {
+    if (this->_index != nullptr)
+    {
+      this->index_subtree(node, false);
+    }
+    if (this->_journal != nullptr)
+    {
+      this->_journal->on_removing(node);
+    }
+    if (!this->_observers.empty())
+    {
+      this->_observers.on_removing(node);
+    }
+  }
+
+  inline void on_changing(xmlNodePtr element, xmlAttrPtr attribute)
+  {
+    if (this->_index != nullptr && element->type == XML_ELEMENT_NODE)
+    {
+      this->index_element(element, false);
+    }
+    if (this->_journal != nullptr)
+    {
+      this->_journal->on_changing(element, attribute);
+    }
+    if (!this->_observers.empty())
+    {
+      this->_observers.on_changing(element);
+    }
+  }
+
+  inline void on_changed(xmlNodePtr element)
+  {
+    if (element->type != XML_ELEMENT_NODE)
+    {
+      this->_is_normalized = false;
+    }
+    if (this->_index != nullptr && element->type == XML_ELEMENT_NODE)
+    {
+      this->index_element(element, true);
+    }
+    if (this->_journal != nullptr)
+    {
+      this->_journal->on_changed(element);
+    }
+    if (!this->_observers.empty())
+    {
+      this->_observers.on_changed(element);
+    }
+  }
+
+  inline void on_batch(bool is_begin)
+  {
+    if (this->_journal != nullptr)
+    {
+      is_begin ? this->_journal->begin() : (void)this->_journal->end();
+    }
+  }
+
+  inline bool has_root_node() const
+  {
+    return this->_compact != nullptr ? this->_compact->get_root() != CompactTree::none
+                                     : xmlDocGetRootElement(this->_doc) != NULL;
   }
 
   inline Node &get_root_node(Node &rnode)
   {
+    if (this->_compact != nullptr)
+    {
+      uint32_t root = this->_compact->get_root();
+      if (root == CompactTree::none)
+      {
+        throw std::runtime_error("Document does not have root node");
+      }
+
+      rnode.handler = CompactNodeHandler::make(this->_compact, root).handler;
+      return rnode;
+    }
+
     xmlNodePtr root_node = xmlDocGetRootElement(_doc);
     if (root_node == NULL)
     {
@@ -174,4 +930,73 @@ public:
   }
 };
 
+inline bool Node::Handler::is_frozen(xmlDocPtr doc)
+{
+  Document::Handler *owner = Document::Handler::from(doc);
+  return owner != NULL && owner->is_frozen();
+}
+
+inline bool Node::Handler::is_normalized(xmlDocPtr doc)
+{
+  Document::Handler *owner = Document::Handler::from(doc);
+  return owner != NULL && owner->is_normalized();
+}
+
+inline void Node::Handler::notify_inserted(xmlNodePtr node)
+{
+  invalidate_hash(node->parent);
+  Document::Handler *owner = Document::Handler::from(node->doc);
+  if (owner != NULL)
+  {
+    owner->on_inserted(node);
+  }
+}
+
+inline void Node::Handler::notify_removing(xmlNodePtr node)
+{
+  invalidate_hash(node->parent);
+  Document::Handler *owner = Document::Handler::from(node->doc);
+  if (owner != NULL)
+  {
+    owner->on_removing(node);
+  }
+}
+
+inline void Node::Handler::notify_changing(xmlNodePtr element, xmlAttrPtr attribute)
+{
+  Document::Handler *owner = element == NULL ? NULL : Document::Handler::from(element->doc);
+  if (owner != NULL)
+  {
+    owner->on_changing(element, attribute);
+  }
+}
+
+inline void Node::Handler::notify_changed(xmlNodePtr element)
+{
+  invalidate_hash(element);
+  Document::Handler *owner = element == NULL ? NULL : Document::Handler::from(element->doc);
+  if (owner != NULL)
+  {
+    owner->on_changed(element);
+  }
+}
+
+inline Node::Handler::Batch::Batch(xmlDocPtr doc) : _doc(doc)
+{
+  Document::Handler *owner = Document::Handler::from(doc);
+  if (owner != NULL)
+  {
+    owner->on_batch(true);
+  }
+}
+
+inline Node::Handler::Batch::~Batch()
+{
+  Document::Handler *owner = Document::Handler::from(this->_doc);
+  if (owner != NULL)
+  {
+    owner->on_batch(false);
+  }
+}
+
 }
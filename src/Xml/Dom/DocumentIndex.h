@@ -0,0 +1,135 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file DocumentIndex.h
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief Element by id and by name indexes
+ *
+ * Element is a libxml2 node pointer for regular documents and a node index for
+ * compact documents. Ids are expected to be unique; with duplicates the first
+ * indexed element wins and the others are kept aside, so removing the winner
+ * lets one of them take its place. Name lists keep positions of their elements so
+ * removal is O(1), which swaps the last element into the hole.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace un::Xml::Dom
+{
+
+template <class Element>
+class DocumentIndex
+{
+private:
+  std::string _id_attribute;
+  std::unordered_map<std::string, Element> _ids;
+  std::unordered_multimap<std::string, Element> _duplicate_ids;
+  std::unordered_map<std::string, std::vector<Element>> _names;
+  std::unordered_map<Element, std::size_t> _positions; // Position in name list
+
+public:
+  explicit DocumentIndex(const std::string &id_attribute) : _id_attribute(id_attribute) {}
+
+  const std::string &get_id_attribute() const { return this->_id_attribute; }
+
+  void add_id(std::string_view id, Element element)
+  {
+    auto inserted = this->_ids.emplace(std::string(id), element);
+    if (!inserted.second)
+    {
+      this->_duplicate_ids.emplace(inserted.first->first, element);
+    }
+  }
+
+  void remove_id(std::string_view id, Element element)
+  {
+    auto found = this->_ids.find(std::string(id));
+    if (found == this->_ids.end())
+    {
+      return;
+    }
+
+    auto duplicates = this->_duplicate_ids.equal_range(found->first);
+    if (found->second == element)
+    {
+      if (duplicates.first == duplicates.second)
+      {
+        this->_ids.erase(found);
+        return;
+      }
+      found->second = duplicates.first->second;
+      this->_duplicate_ids.erase(duplicates.first);
+      return;
+    }
+
+    for (auto i = duplicates.first; i != duplicates.second; ++i)
+    {
+      if (i->second == element)
+      {
+        this->_duplicate_ids.erase(i);
+        return;
+      }
+    }
+  }
+
+  void add_name(const char *name, Element element)
+  {
+    std::vector<Element> &list = this->_names[name];
+    this->_positions[element] = list.size();
+    list.push_back(element);
+  }
+
+  void remove_name(const char *name, Element element)
+  {
+    auto position = this->_positions.find(element);
+    auto found = this->_names.find(name);
+    if (position == this->_positions.end() || found == this->_names.end())
+    {
+      return;
+    }
+
+    std::vector<Element> &list = found->second;
+    std::size_t index = position->second;
+    this->_positions.erase(position);
+
+    if (index + 1 != list.size())
+    {
+      list[index] = list.back();
+      this->_positions[list[index]] = index;
+    }
+    list.pop_back();
+
+    if (list.empty())
+    {
+      this->_names.erase(found);
+    }
+  }
+
+  /// Returns false if id is not indexed
+  bool find_id(const std::string &id, Element &element) const
+  {
+    auto found = this->_ids.find(id);
+    if (found == this->_ids.end())
+    {
+      return false;
+    }
+    element = found->second;
+    return true;
+  }
+
+  /// Elements with given name, NULL if there are none
+  const std::vector<Element> *find_name(const std::string &name) const
+  {
+    auto found = this->_names.find(name);
+    return found == this->_names.end() ? NULL : &found->second;
+  }
+};
+
+}
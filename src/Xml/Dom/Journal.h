@@ -0,0 +1,683 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file Journal.h
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief Undo and redo journal of document mutations
+ *
+ * Mutation notifications are recorded as entries addressed by child positions
+ * from the document node. Positions are only valid in the tree they were
+ * recorded in, so steps are undone and redone strictly in order. An insert
+ * records its position only, a removal keeps a copy of the removed subtree and
+ * name and text changes keep the previous value, so memory grows with the size
+ * of the changes and not with the document. Attribute changes keep the one
+ * attribute that changed and its position, it is restored in place so
+ * handles to other attributes of the element stay valid.
+ *
+ * Notifications of one operation arrive as if its nodes were linked and
+ * unlinked one at a time: removals of sibling runs are notified last first.
+ */
+
+#pragma once
+
+#include "NodeHandlerLibxml2.h"
+#include <algorithm>
+#include <cstddef>
+#include <libxml/tree.h>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace un::Xml::Dom
+{
+
+class Journal
+{
+public:
+  /// Position of the last child, used so appends do not count siblings
+  static const std::size_t last = static_cast<std::size_t>(-1);
+
+private:
+  struct NodeDeleter
+  {
+    void operator()(xmlNodePtr node) const { xmlFreeNode(node); }
+  };
+
+  struct AttributeState
+  {
+    std::string name;
+    bool has_ns;
+    std::string prefix;
+    std::string href;
+    std::string value;
+  };
+
+  struct Entry
+  {
+    enum class Type
+    {
+      insert,
+      remove,
+      name,
+      attribute,
+      text
+    };
+
+    Type type;
+    std::vector<std::size_t> path;
+
+    /// Subtree while it is out of the document
+    std::unique_ptr<xmlNode, NodeDeleter> node;
+
+    /// Other name or text content, swapped on undo and redo
+    std::string value;
+
+    /// Attribute at position, present or not on the other side of the change
+    std::size_t position;
+    AttributeState attribute;
+    bool is_present;
+    bool is_present_now;
+
+    /// Attribute was added with a namespace declaration of its own
+    bool is_declared;
+
+    Entry() : position(0), is_present(false), is_present_now(false), is_declared(false) {}
+  };
+
+  typedef std::vector<Entry> Step;
+
+  std::vector<Step> _undo;
+  std::vector<Step> _redo;
+
+  std::size_t _depth;   // Open groups
+  bool _is_step_open;   // Last undo step takes further entries
+  bool _is_replaying;   // Notifications come from undo or redo
+
+  // Node between on_changing and on_changed, what it looked like before
+  xmlNodePtr _changing;
+  Entry _pending;
+  xmlAttrPtr _attribute;
+  xmlAttrPtr _last_attribute;
+  xmlNsPtr _last_declaration;
+
+  static bool is_text(xmlNodePtr node)
+  {
+    return node->type == XML_TEXT_NODE || node->type == XML_CDATA_SECTION_NODE ||
+           node->type == XML_COMMENT_NODE || node->type == XML_PI_NODE;
+  }
+
+  static std::string get_string(xmlChar *value)
+  {
+    std::string result = value == NULL ? std::string() : std::string((const char *)value);
+    xmlFree(value);
+    return result;
+  }
+
+  /// Path from the document node, false if node is not in its document
+  static bool get_path(xmlNodePtr node, std::vector<std::size_t> &path)
+  {
+    path.clear();
+    xmlNodePtr i = node;
+    for (; i->parent != NULL; i = i->parent)
+    {
+      std::size_t position = 0;
+      if (i->next == NULL)
+      {
+        position = last;
+      }
+      else
+      {
+        for (xmlNodePtr j = i->prev; j != NULL; j = j->prev)
+        {
+          ++position;
+        }
+      }
+      path.push_back(position);
+    }
+
+    if (i != (xmlNodePtr)node->doc)
+    {
+      return false;
+    }
+    std::reverse(path.begin(), path.end());
+    return true;
+  }
+
+  /// Child at position, NULL for one past the last child
+  static xmlNodePtr get_child(xmlNodePtr parent, std::size_t position)
+  {
+    if (position == last)
+    {
+      if (parent->last == NULL)
+      {
+        throw std::runtime_error("Journal does not match document");
+      }
+      return parent->last;
+    }
+
+    xmlNodePtr child = parent->children;
+    for (std::size_t i = 0; i < position; ++i)
+    {
+      if (child == NULL)
+      {
+        throw std::runtime_error("Journal does not match document");
+      }
+      child = child->next;
+    }
+    return child;
+  }
+
+  static xmlNodePtr find(xmlDocPtr doc, const std::vector<std::size_t> &path, std::size_t depth)
+  {
+    xmlNodePtr node = (xmlNodePtr)doc;
+    for (std::size_t i = 0; i < depth; ++i)
+    {
+      node = get_child(node, path[i]);
+      if (node == NULL)
+      {
+        throw std::runtime_error("Journal does not match document");
+      }
+    }
+    return node;
+  }
+
+  static std::size_t get_position(xmlAttrPtr attribute)
+  {
+    std::size_t position = 0;
+    for (xmlAttrPtr i = attribute->prev; i != NULL; i = i->prev)
+    {
+      ++position;
+    }
+    return position;
+  }
+
+  static xmlAttrPtr get_attribute(xmlNodePtr node, std::size_t position)
+  {
+    xmlAttrPtr attribute = node->properties;
+    for (std::size_t i = 0; i < position && attribute != NULL; ++i)
+    {
+      attribute = attribute->next;
+    }
+    if (attribute == NULL)
+    {
+      throw std::runtime_error("Journal does not match document");
+    }
+    return attribute;
+  }
+
+  static void capture(xmlAttrPtr attribute, AttributeState &state)
+  {
+    state.name = (const char *)attribute->name;
+    state.has_ns = attribute->ns != NULL && attribute->ns->href != NULL;
+    state.prefix.clear();
+    state.href.clear();
+    if (state.has_ns)
+    {
+      state.prefix = attribute->ns->prefix == NULL ? "" : (const char *)attribute->ns->prefix;
+      state.href = (const char *)attribute->ns->href;
+    }
+    state.value = get_string(xmlNodeGetContent((xmlNodePtr)attribute));
+  }
+
+  /// Value is set on the text child so the attribute itself stays
+  static void set_value(xmlAttrPtr attribute, const std::string &value)
+  {
+    xmlNodePtr text = attribute->children;
+    if (text != NULL && text->next == NULL && text->type == XML_TEXT_NODE)
+    {
+      xmlNodeSetContentLen(text, BAD_CAST value.data(), static_cast<int>(value.size()));
+      return;
+    }
+
+    xmlFreeNodeList(attribute->children);
+    attribute->children = NULL;
+    attribute->last = NULL;
+    text = xmlNewDocTextLen(attribute->doc, BAD_CAST value.data(), static_cast<int>(value.size()));
+    if (text == NULL)
+    {
+      throw std::runtime_error("xmlNewDocTextLen failed");
+    }
+    text->parent = (xmlNodePtr)attribute;
+    attribute->children = text;
+    attribute->last = text;
+  }
+
+  static void insert_attribute(xmlNodePtr node, std::size_t position, const AttributeState &state)
+  {
+    xmlNsPtr ns = NULL;
+    if (state.has_ns)
+    {
+      ns = xmlSearchNsByHref(node->doc, node, BAD_CAST state.href.c_str());
+      if (ns == NULL)
+      {
+        ns = xmlNewNs(node, BAD_CAST state.href.c_str(), state.prefix.empty() ? NULL : BAD_CAST state.prefix.c_str());
+      }
+    }
+    xmlAttrPtr attribute = xmlNewNsProp(node, ns, BAD_CAST state.name.c_str(), BAD_CAST state.value.c_str());
+    if (attribute == NULL)
+    {
+      throw std::runtime_error("Can not add new attribute");
+    }
+
+    // Appended as the last one, moved back to where it was
+    xmlAttrPtr next = node->properties;
+    for (std::size_t i = 0; i < position && next != attribute; ++i)
+    {
+      next = next->next;
+    }
+    if (next == attribute)
+    {
+      return;
+    }
+    attribute->prev->next = NULL;
+    attribute->prev = next->prev;
+    attribute->next = next;
+    if (next->prev == NULL)
+    {
+      node->properties = attribute;
+    }
+    else
+    {
+      next->prev->next = attribute;
+    }
+    next->prev = attribute;
+  }
+
+  /// Drops the declaration an attribute was added with
+  static void undeclare(xmlNodePtr node, const AttributeState &state)
+  {
+    xmlNsPtr previous = NULL;
+    for (xmlNsPtr i = node->nsDef; i != NULL; previous = i, i = i->next)
+    {
+      if (i->href != NULL && xmlStrEqual(i->href, BAD_CAST state.href.c_str()) &&
+          xmlStrEqual(i->prefix, state.prefix.empty() ? NULL : BAD_CAST state.prefix.c_str()))
+      {
+        (previous == NULL ? node->nsDef : previous->next) = i->next;
+        i->next = NULL;
+        xmlFreeNs(i);
+        return;
+      }
+    }
+  }
+
+  static void detach(xmlDocPtr doc, Entry &entry)
+  {
+    xmlNodePtr node = find(doc, entry.path, entry.path.size());
+    Node::Handler::notify_removing(node);
+    xmlUnlinkNode(node);
+    entry.node.reset(node);
+  }
+
+  static void attach(xmlDocPtr doc, Entry &entry)
+  {
+    if (entry.path.empty() || entry.node == nullptr)
+    {
+      throw std::runtime_error("Journal does not match document");
+    }
+
+    xmlNodePtr parent = find(doc, entry.path, entry.path.size() - 1);
+    xmlNodePtr position = entry.path.back() == last ? NULL : get_child(parent, entry.path.back());
+    xmlNodePtr node = entry.node.release();
+
+    // Linked by hand, xmlAddPrevSibling would merge adjacent text nodes
+    node->parent = parent;
+    node->next = position;
+    node->prev = position == NULL ? parent->last : position->prev;
+    if (node->prev == NULL)
+    {
+      parent->children = node;
+    }
+    else
+    {
+      node->prev->next = node;
+    }
+    if (position == NULL)
+    {
+      parent->last = node;
+    }
+    else
+    {
+      position->prev = node;
+    }
+    Node::Handler::notify_inserted(node);
+  }
+
+  static void swap(xmlDocPtr doc, Entry &entry)
+  {
+    xmlNodePtr node = find(doc, entry.path, entry.path.size());
+    if (entry.type != Entry::Type::attribute)
+    {
+      std::string current;
+      Node::Handler::notify_changing(node);
+      if (entry.type == Entry::Type::name)
+      {
+        current = (const char *)node->name;
+        xmlNodeSetName(node, BAD_CAST entry.value.c_str());
+      }
+      else
+      {
+        current = get_string(xmlNodeGetContent(node));
+        xmlNodeSetContentLen(node, BAD_CAST entry.value.data(), static_cast<int>(entry.value.size()));
+      }
+      Node::Handler::notify_changed(node);
+      entry.value = std::move(current);
+      return;
+    }
+
+    xmlAttrPtr attribute = entry.is_present_now ? get_attribute(node, entry.position) : NULL;
+    AttributeState current;
+    if (attribute != NULL)
+    {
+      capture(attribute, current);
+    }
+
+    Node::Handler::notify_changing(node, attribute);
+    if (attribute == NULL)
+    {
+      insert_attribute(node, entry.position, entry.attribute);
+    }
+    else if (entry.is_present)
+    {
+      set_value(attribute, entry.attribute.value);
+    }
+    else
+    {
+      xmlRemoveProp(attribute);
+      if (entry.is_declared)
+      {
+        undeclare(node, current);
+      }
+    }
+    Node::Handler::notify_changed(node);
+
+    if (attribute != NULL)
+    {
+      entry.attribute = std::move(current);
+    }
+    std::swap(entry.is_present, entry.is_present_now);
+  }
+
+  static void replay(xmlDocPtr doc, Entry &entry, bool is_undo)
+  {
+    switch (entry.type)
+    {
+    case Entry::Type::insert:
+      is_undo ? detach(doc, entry) : attach(doc, entry);
+      break;
+    case Entry::Type::remove:
+      is_undo ? attach(doc, entry) : detach(doc, entry);
+      break;
+    default:
+      swap(doc, entry);
+      break;
+    }
+  }
+
+  void record(Entry &&entry)
+  {
+    this->_redo.clear();
+    if (!this->_is_step_open)
+    {
+      this->_undo.emplace_back();
+      this->_is_step_open = this->_depth > 0;
+    }
+    this->_undo.back().push_back(std::move(entry));
+  }
+
+  /// Moves last step of from onto to, replaying it
+  void replay(xmlDocPtr doc, std::vector<Step> &from, std::vector<Step> &to, bool is_undo)
+  {
+    if (this->_depth > 0)
+    {
+      throw std::runtime_error("Transaction is open");
+    }
+
+    Step step = std::move(from.back());
+    from.pop_back();
+    this->_is_replaying = true;
+    try
+    {
+      if (is_undo)
+      {
+        for (auto i = step.rbegin(); i != step.rend(); ++i)
+        {
+          replay(doc, *i, true);
+        }
+      }
+      else
+      {
+        for (Entry &entry : step)
+        {
+          replay(doc, entry, false);
+        }
+      }
+    }
+    catch (...)
+    {
+      // Positions of the remaining steps cannot be trusted anymore
+      this->_is_replaying = false;
+      this->clear();
+      throw;
+    }
+    this->_is_replaying = false;
+    to.push_back(std::move(step));
+  }
+
+public:
+  Journal()
+      : _depth(0), _is_step_open(false), _is_replaying(false), _changing(NULL), _attribute(NULL),
+        _last_attribute(NULL), _last_declaration(NULL)
+  {
+  }
+
+  Journal(const Journal &) = delete;
+  Journal &operator=(const Journal &) = delete;
+
+  void clear()
+  {
+    this->_undo.clear();
+    this->_redo.clear();
+    this->_is_step_open = false;
+    this->_changing = NULL;
+  }
+
+  /// Start a group, entries until the outermost end form one step
+  void begin()
+  {
+    if (this->_depth++ == 0)
+    {
+      this->_is_step_open = false;
+    }
+  }
+
+  /// @return false if no group is open
+  bool end()
+  {
+    if (this->_depth == 0)
+    {
+      return false;
+    }
+    if (--this->_depth == 0)
+    {
+      this->_is_step_open = false;
+    }
+    return true;
+  }
+
+  std::size_t get_depth() const { return this->_depth; }
+
+  /// True if the last undo step was recorded inside the open group
+  bool is_step_open() const { return this->_is_step_open; }
+
+  bool can_undo() const { return !this->_undo.empty(); }
+
+  bool can_redo() const { return !this->_redo.empty(); }
+
+  bool undo(xmlDocPtr doc)
+  {
+    if (this->_undo.empty())
+    {
+      return false;
+    }
+    this->replay(doc, this->_undo, this->_redo, true);
+    return true;
+  }
+
+  bool redo(xmlDocPtr doc)
+  {
+    if (this->_redo.empty())
+    {
+      return false;
+    }
+    this->replay(doc, this->_redo, this->_undo, false);
+    return true;
+  }
+
+  /// Undo last step and forget it, used by rollback
+  void discard(xmlDocPtr doc)
+  {
+    this->undo(doc);
+    this->_redo.pop_back();
+  }
+
+  void on_inserted(xmlNodePtr node)
+  {
+    if (this->_is_replaying)
+    {
+      return;
+    }
+
+    Entry entry;
+    entry.type = Entry::Type::insert;
+    if (get_path(node, entry.path))
+    {
+      this->record(std::move(entry));
+    }
+  }
+
+  void on_removing(xmlNodePtr node)
+  {
+    if (this->_is_replaying)
+    {
+      return;
+    }
+
+    Entry entry;
+    entry.type = Entry::Type::remove;
+    if (!get_path(node, entry.path))
+    {
+      return;
+    }
+    entry.node.reset(xmlDocCopyNode(node, node->doc, 1));
+    if (entry.node == nullptr)
+    {
+      throw std::runtime_error("xmlDocCopyNode failed");
+    }
+    this->record(std::move(entry));
+  }
+
+  /// Attribute is the one changed or removed, NULL for a rename or additions
+  void on_changing(xmlNodePtr node, xmlAttrPtr attribute)
+  {
+    if (this->_is_replaying || (node->type != XML_ELEMENT_NODE && !is_text(node)))
+    {
+      return;
+    }
+
+    this->_changing = node;
+    this->_pending = Entry();
+    this->_attribute = attribute;
+    if (node->type != XML_ELEMENT_NODE)
+    {
+      this->_pending.type = Entry::Type::text;
+      this->_pending.value = get_string(xmlNodeGetContent(node));
+    }
+    else if (attribute != NULL)
+    {
+      this->_pending.type = Entry::Type::attribute;
+      this->_pending.position = get_position(attribute);
+      this->_pending.is_present = true;
+      capture(attribute, this->_pending.attribute);
+    }
+    else
+    {
+      this->_pending.type = Entry::Type::name;
+      this->_pending.value = (const char *)node->name;
+      this->_last_attribute = node->properties;
+      while (this->_last_attribute != NULL && this->_last_attribute->next != NULL)
+      {
+        this->_last_attribute = this->_last_attribute->next;
+      }
+      this->_last_declaration = node->nsDef;
+      while (this->_last_declaration != NULL && this->_last_declaration->next != NULL)
+      {
+        this->_last_declaration = this->_last_declaration->next;
+      }
+    }
+  }
+
+  void on_changed(xmlNodePtr node)
+  {
+    if (this->_is_replaying || node != this->_changing)
+    {
+      return;
+    }
+
+    this->_changing = NULL;
+    Entry entry = std::move(this->_pending);
+    this->_pending = Entry();
+    if (!get_path(node, entry.path))
+    {
+      return;
+    }
+
+    if (entry.type == Entry::Type::text)
+    {
+      this->record(std::move(entry));
+    }
+    else if (entry.type == Entry::Type::attribute)
+    {
+      // The attribute is gone if it was removed, only its address is compared
+      for (xmlAttrPtr i = node->properties; i != NULL; i = i->next)
+      {
+        entry.is_present_now = entry.is_present_now || i == this->_attribute;
+      }
+      this->record(std::move(entry));
+    }
+    else
+    {
+      // Rename and additions of one notification form one step
+      this->begin();
+      std::size_t position = 0;
+      xmlAttrPtr added = node->properties;
+      if (this->_last_attribute != NULL)
+      {
+        position = get_position(this->_last_attribute) + 1;
+        added = this->_last_attribute->next;
+      }
+      for (; added != NULL; added = added->next, ++position)
+      {
+        Entry addition;
+        addition.type = Entry::Type::attribute;
+        addition.path = entry.path;
+        addition.position = position;
+        addition.is_present_now = true;
+        xmlNsPtr declaration = this->_last_declaration == NULL ? node->nsDef : this->_last_declaration->next;
+        for (; declaration != NULL && !addition.is_declared; declaration = declaration->next)
+        {
+          addition.is_declared = declaration == added->ns;
+        }
+        this->record(std::move(addition));
+      }
+      if (!xmlStrEqual(node->name, BAD_CAST entry.value.c_str()))
+      {
+        this->record(std::move(entry));
+      }
+      this->end();
+    }
+  }
+};
+
+}
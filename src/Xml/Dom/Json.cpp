@@ -0,0 +1,1263 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file Json.cpp
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief Conversion between xml and JSON without intermediate trees
+ */
+
+#include <Xml/Dom/Json.h>
+#include "DocumentHandlerLibxml2.h"
+#include "NodeHandlerCompact.h"
+#include <algorithm>
+#include <cstring>
+#include <libxml/tree.h>
+#include <stdexcept>
+
+namespace un::Xml::Dom
+{
+
+namespace
+{
+
+bool is_blank(const std::string &text)
+{
+  return text.find_first_not_of(" \t\r\n") == std::string::npos;
+}
+
+bool is_element(xmlNodePtr node)
+{
+  return node != NULL && node->type == XML_ELEMENT_NODE;
+}
+
+xmlNodePtr next_element(xmlNodePtr node)
+{
+  while (node != NULL && node->type != XML_ELEMENT_NODE)
+  {
+    node = node->next;
+  }
+  return node;
+}
+
+bool is_same_name(xmlNodePtr lhs, xmlNodePtr rhs)
+{
+  const xmlChar *lhs_prefix = lhs->ns == NULL ? NULL : lhs->ns->prefix;
+  const xmlChar *rhs_prefix = rhs->ns == NULL ? NULL : rhs->ns->prefix;
+  return xmlStrEqual(lhs->name, rhs->name) && xmlStrEqual(lhs_prefix, rhs_prefix);
+}
+
+/// Orders elements by name, then prefix
+bool is_name_before(xmlNodePtr lhs, xmlNodePtr rhs)
+{
+  int order = xmlStrcmp(lhs->name, rhs->name);
+  if (order != 0)
+  {
+    return order < 0;
+  }
+  return xmlStrcmp(lhs->ns == NULL ? NULL : lhs->ns->prefix, rhs->ns == NULL ? NULL : rhs->ns->prefix) < 0;
+}
+
+void get_qualified_name(const xmlChar *prefix, const xmlChar *name, std::string &result)
+{
+  result.clear();
+  if (prefix != NULL)
+  {
+    result = (const char *)prefix;
+    result += ':';
+  }
+  result += (const char *)name;
+}
+
+}
+
+class JsonWriter::Handler
+{
+private:
+  struct Frame
+  {
+    /// Objects layout: '{' written. Ordered layout: attribute object open
+    bool is_open;
+
+    /// Objects layout: object has members. Ordered layout: element children written
+    bool has_members;
+
+    /// Objects layout: text of element. Ordered layout: text not written yet
+    std::string text;
+
+    /// Objects layout: name of the open array member of children, empty if none
+    std::string run;
+
+    /// Objects layout of trees: element children, grouped by name and ranked by the first of their group
+    std::vector<std::pair<std::size_t, xmlNodePtr>> children;
+  };
+
+  JsonConvention _convention;
+  Pipeline::Serializer::Write _write;
+  std::size_t _buffer_size;
+  std::string _buffer;
+
+  // Output written to directly instead of through the buffer
+  std::string *_target;
+
+  // Frames of open elements, kept after close to reuse their strings
+  std::vector<Frame> _frames;
+  std::size_t _depth;
+  bool _has_value;
+
+  // Scratch strings of keys and the tree walk
+  std::string _key;
+  std::string _name;
+  std::string _attribute_name;
+  std::string _storage;
+
+  std::string &output()
+  {
+    return this->_target == NULL ? this->_buffer : *this->_target;
+  }
+
+  bool is_ordered() const
+  {
+    return this->_convention.layout == JsonConvention::Layout::ordered;
+  }
+
+  bool is_listed(const std::string &name) const
+  {
+    const std::vector<std::string> &names = this->_convention.array_elements;
+    return std::find(names.begin(), names.end(), name) != names.end();
+  }
+
+  void write_string(const char *data, std::size_t size)
+  {
+    static const char hex[] = "0123456789abcdef";
+    std::string &output = this->output();
+    output += '"';
+    std::size_t start = 0;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+      unsigned char c = static_cast<unsigned char>(data[i]);
+      if (c >= 0x20 && c != '"' && c != '\\')
+      {
+        continue;
+      }
+      output.append(data + start, i - start);
+      start = i + 1;
+      switch (c)
+      {
+      case '"':
+        output += "\\\"";
+        break;
+      case '\\':
+        output += "\\\\";
+        break;
+      case '\n':
+        output += "\\n";
+        break;
+      case '\r':
+        output += "\\r";
+        break;
+      case '\t':
+        output += "\\t";
+        break;
+      default:
+        output += "\\u00";
+        output += hex[c >> 4];
+        output += hex[c & 0xf];
+        break;
+      }
+    }
+    output.append(data + start, size - start);
+    output += '"';
+  }
+
+  inline void write_string(const std::string &text)
+  {
+    this->write_string(text.data(), text.size());
+  }
+
+  void write_key(const std::string &prefix, const std::string &name)
+  {
+    if (prefix.empty())
+    {
+      this->write_string(name);
+    }
+    else
+    {
+      this->_key.assign(prefix);
+      this->_key += name;
+      this->write_string(this->_key);
+    }
+    this->output() += ':';
+  }
+
+  Frame &top()
+  {
+    return this->_frames[this->_depth - 1];
+  }
+
+  Frame &push()
+  {
+    if (this->_frames.size() == this->_depth)
+    {
+      this->_frames.emplace_back();
+    }
+    Frame &frame = this->_frames[this->_depth++];
+    frame.is_open = false;
+    frame.has_members = false;
+    frame.text.clear();
+    frame.run.clear();
+    return frame;
+  }
+
+  void begin_value()
+  {
+    if (this->_has_value)
+    {
+      this->output() += '\n';
+    }
+  }
+
+  void end_value()
+  {
+    this->_has_value = true;
+    this->maybe_flush();
+  }
+
+  void maybe_flush()
+  {
+    if (this->_target == NULL && this->_buffer.size() >= this->_buffer_size)
+    {
+      this->flush();
+    }
+  }
+
+  // Objects layout
+
+  void open_object(Frame &frame)
+  {
+    if (!frame.is_open)
+    {
+      this->output() += '{';
+      frame.is_open = true;
+    }
+  }
+
+  void add_member(Frame &frame)
+  {
+    if (frame.has_members)
+    {
+      this->output() += ',';
+    }
+    frame.has_members = true;
+  }
+
+  void close_run(Frame &frame)
+  {
+    if (!frame.run.empty())
+    {
+      this->output() += ']';
+      frame.run.clear();
+    }
+  }
+
+  // Ordered layout
+
+  void close_attributes(Frame &frame)
+  {
+    if (frame.is_open)
+    {
+      this->output() += '}';
+      frame.is_open = false;
+    }
+  }
+
+  void flush_text(Frame &frame, bool is_before_element)
+  {
+    if (frame.text.empty())
+    {
+      return;
+    }
+    if (!is_blank(frame.text) || !(is_before_element || frame.has_members))
+    {
+      this->output() += ',';
+      this->write_string(frame.text);
+    }
+    frame.text.clear();
+  }
+
+public:
+  Handler(std::string &output, const JsonConvention &convention)
+    : _convention(convention), _buffer_size(0), _target(&output), _depth(0), _has_value(false) {}
+
+  Handler(const Pipeline::Serializer::Write &write, const JsonConvention &convention, std::size_t buffer_size)
+    : _convention(convention), _write(write), _buffer_size(buffer_size), _target(NULL), _depth(0),
+      _has_value(false)
+  {
+    this->_buffer.reserve(buffer_size);
+  }
+
+  /// Start element, is_array tells if it starts a run written as array
+  void start_element(const std::string &name, bool is_array)
+  {
+    if (this->is_ordered())
+    {
+      if (this->_depth == 0)
+      {
+        this->begin_value();
+      }
+      else
+      {
+        Frame &parent = this->top();
+        this->close_attributes(parent);
+        this->flush_text(parent, true);
+        parent.has_members = true;
+        this->output() += ',';
+      }
+      this->output() += '[';
+      this->write_string(name);
+      this->push();
+      return;
+    }
+
+    if (this->_depth == 0)
+    {
+      this->begin_value();
+      this->output() += '{';
+      this->write_key(std::string(), name);
+    }
+    else
+    {
+      Frame &parent = this->top();
+      this->open_object(parent);
+      if (!parent.run.empty() && parent.run == name)
+      {
+        this->output() += ',';
+      }
+      else
+      {
+        this->close_run(parent);
+        this->add_member(parent);
+        this->write_key(std::string(), name);
+        if (is_array)
+        {
+          this->output() += '[';
+          parent.run = name;
+        }
+      }
+    }
+    this->push();
+  }
+
+  void add_attribute(const std::string &name, const char *value, std::size_t size)
+  {
+    Frame &frame = this->top();
+    if (this->is_ordered())
+    {
+      this->output() += frame.is_open ? "," : ",{";
+      frame.is_open = true;
+      this->write_key(std::string(), name);
+    }
+    else
+    {
+      this->open_object(frame);
+      this->add_member(frame);
+      this->write_key(this->_convention.attribute_prefix, name);
+    }
+    this->write_string(value, size);
+  }
+
+  void add_text(const char *data, std::size_t size)
+  {
+    if (this->_depth > 0)
+    {
+      this->top().text.append(data, size);
+    }
+  }
+
+  void end_element()
+  {
+    Frame &frame = this->top();
+    if (this->is_ordered())
+    {
+      this->close_attributes(frame);
+      this->flush_text(frame, false);
+      this->output() += ']';
+    }
+    else if (!frame.is_open)
+    {
+      this->write_string(frame.text);
+    }
+    else
+    {
+      this->close_run(frame);
+      if (!is_blank(frame.text))
+      {
+        this->add_member(frame);
+        this->write_key(std::string(), this->_convention.text_key);
+        this->write_string(frame.text);
+      }
+      this->output() += '}';
+    }
+
+    --this->_depth;
+    if (this->_depth == 0)
+    {
+      if (!this->is_ordered())
+      {
+        this->output() += '}';
+      }
+      this->end_value();
+    }
+    else
+    {
+      this->maybe_flush();
+    }
+  }
+
+  void on_event(const Pipeline::Event &event)
+  {
+    switch (event.type)
+    {
+    case Pipeline::Event::Type::start_element:
+      this->start_element(event.name, this->is_listed(event.name));
+      for (const Pipeline::Attribute &attribute : event.attributes)
+      {
+        this->add_attribute(attribute.name, attribute.value.data(), attribute.value.size());
+      }
+      break;
+    case Pipeline::Event::Type::end_element:
+      this->end_element();
+      break;
+    case Pipeline::Event::Type::text:
+    case Pipeline::Event::Type::cdata:
+      this->add_text(event.content.data(), event.content.size());
+      break;
+    default:
+      break;
+    }
+  }
+
+  /// Walk subtree of element
+  void write(xmlNodePtr element, bool is_array)
+  {
+    get_qualified_name(element->ns == NULL ? NULL : element->ns->prefix, element->name, this->_name);
+    this->start_element(this->_name, is_array);
+
+    for (xmlNsPtr ns = element->nsDef; ns != NULL; ns = ns->next)
+    {
+      get_qualified_name(ns->prefix == NULL ? NULL : BAD_CAST "xmlns", ns->prefix == NULL ? BAD_CAST "xmlns" : ns->prefix,
+                         this->_attribute_name);
+      const char *href = ns->href == NULL ? "" : (const char *)ns->href;
+      this->add_attribute(this->_attribute_name, href, std::strlen(href));
+    }
+
+    for (xmlAttrPtr i = element->properties; i != NULL; i = i->next)
+    {
+      get_qualified_name(i->ns == NULL ? NULL : i->ns->prefix, i->name, this->_attribute_name);
+      std::string_view value = Node::Handler::get_content_view((xmlNodePtr)i, this->_storage);
+      this->add_attribute(this->_attribute_name, value.data(), value.size());
+    }
+
+    if (!this->is_ordered())
+    {
+      this->write_grouped_children(element);
+      this->end_element();
+      return;
+    }
+
+    for (xmlNodePtr i = element->children; i != NULL; i = i->next)
+    {
+      switch (i->type)
+      {
+      case XML_ELEMENT_NODE:
+      {
+        xmlNodePtr next = next_element(i->next);
+        this->write(i, next != NULL && is_same_name(i, next));
+        break;
+      }
+      case XML_TEXT_NODE:
+      case XML_CDATA_SECTION_NODE:
+      case XML_ENTITY_REF_NODE:
+        this->add_text(i);
+        break;
+      default:
+        break;
+      }
+    }
+    this->end_element();
+  }
+
+  void add_text(xmlNodePtr node)
+  {
+    std::string_view text = Node::Handler::get_content_view(node, this->_storage);
+    this->add_text(text.data(), text.size());
+  }
+
+  /**
+   * Objects layout: all children with the same name go into one array member,
+   * placed where the first of them is. Text is collected on the way.
+   */
+  void write_grouped_children(xmlNodePtr element)
+  {
+    std::size_t depth = this->_depth;
+    std::vector<std::pair<std::size_t, xmlNodePtr>> &children = this->top().children;
+    children.clear();
+    bool is_grouped = true; // Same names are adjacent already
+    for (xmlNodePtr i = element->children; i != NULL; i = i->next)
+    {
+      if (i->type == XML_TEXT_NODE || i->type == XML_CDATA_SECTION_NODE || i->type == XML_ENTITY_REF_NODE)
+      {
+        this->add_text(i);
+      }
+      else if (i->type == XML_ELEMENT_NODE)
+      {
+        // A name coming back after another one needs grouping, long lists are not searched
+        if (is_grouped && !children.empty() && !is_same_name(children.back().second, i))
+        {
+          is_grouped = children.size() < 16 &&
+                       std::none_of(children.begin(), children.end(),
+                                    [i](const auto &child) { return is_same_name(child.second, i); });
+        }
+        children.emplace_back(children.size(), i);
+      }
+    }
+
+    if (!is_grouped)
+    {
+      // Sort by name keeping document order, rank each group by its first element
+      std::stable_sort(children.begin(), children.end(),
+                       [](const auto &lhs, const auto &rhs) { return is_name_before(lhs.second, rhs.second); });
+      std::size_t rank = 0;
+      for (std::size_t i = 0; i < children.size(); ++i)
+      {
+        if (i == 0 || !is_same_name(children[i - 1].second, children[i].second))
+        {
+          rank = children[i].first;
+        }
+        children[i].first = rank;
+      }
+      std::stable_sort(children.begin(), children.end(),
+                       [](const auto &lhs, const auto &rhs) { return lhs.first < rhs.first; });
+    }
+
+    // Deeper writes reuse frames, so the list is looked up again each time
+    for (std::size_t i = 0; i < this->_frames[depth - 1].children.size(); ++i)
+    {
+      const std::vector<std::pair<std::size_t, xmlNodePtr>> &list = this->_frames[depth - 1].children;
+      xmlNodePtr child = list[i].second;
+      bool is_array = (i > 0 && is_same_name(list[i - 1].second, child)) ||
+                      (i + 1 < list.size() && is_same_name(list[i + 1].second, child));
+      if (!is_array)
+      {
+        get_qualified_name(child->ns == NULL ? NULL : child->ns->prefix, child->name, this->_name);
+        is_array = this->is_listed(this->_name);
+      }
+      this->write(child, is_array);
+    }
+  }
+
+  void flush()
+  {
+    if (this->_target != NULL || this->_buffer.empty())
+    {
+      return;
+    }
+    this->_write(this->_buffer.data(), this->_buffer.size());
+    this->_buffer.clear();
+  }
+
+  /// Forget an unfinished value of an interrupted pass
+  void on_end()
+  {
+    this->_depth = 0;
+    this->flush();
+  }
+};
+
+/// Builds a libxml2 document from JSON text
+class JsonReader
+{
+private:
+  const JsonConvention &_convention;
+  const char *_data;
+  const char *_p;
+  const char *_end;
+  xmlDocPtr _doc;
+  bool _has_namespaces;
+
+  // Element nesting, limited like in the libxml2 parser
+  static const std::size_t max_depth = 256;
+  std::size_t _depth;
+
+  // Scratch strings, reused while reading
+  std::string _key;
+  std::string _value;
+
+  [[noreturn]] void fail(const char *message) const
+  {
+    throw std::runtime_error(std::string("Invalid JSON: ") + message + " at offset " +
+                             std::to_string(this->_p - this->_data));
+  }
+
+  void skip_space()
+  {
+    while (this->_p != this->_end && (*this->_p == ' ' || *this->_p == '\t' || *this->_p == '\n' || *this->_p == '\r'))
+    {
+      ++this->_p;
+    }
+  }
+
+  char peek()
+  {
+    this->skip_space();
+    if (this->_p == this->_end)
+    {
+      this->fail("unexpected end");
+    }
+    return *this->_p;
+  }
+
+  void expect(char c)
+  {
+    if (this->peek() != c)
+    {
+      this->fail((std::string("expected ") + c).c_str());
+    }
+    ++this->_p;
+  }
+
+  /// Consume c if it is next
+  bool accept(char c)
+  {
+    if (this->peek() == c)
+    {
+      ++this->_p;
+      return true;
+    }
+    return false;
+  }
+
+  unsigned read_hex4()
+  {
+    if (this->_end - this->_p < 4)
+    {
+      this->fail("truncated escape");
+    }
+    unsigned value = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+      char c = *this->_p++;
+      value <<= 4;
+      if (c >= '0' && c <= '9')
+      {
+        value |= static_cast<unsigned>(c - '0');
+      }
+      else if (c >= 'a' && c <= 'f')
+      {
+        value |= static_cast<unsigned>(c - 'a' + 10);
+      }
+      else if (c >= 'A' && c <= 'F')
+      {
+        value |= static_cast<unsigned>(c - 'A' + 10);
+      }
+      else
+      {
+        this->fail("invalid escape");
+      }
+    }
+    return value;
+  }
+
+  static void append_utf8(std::string &result, unsigned code)
+  {
+    if (code < 0x80)
+    {
+      result += static_cast<char>(code);
+    }
+    else if (code < 0x800)
+    {
+      result += static_cast<char>(0xc0 | (code >> 6));
+      result += static_cast<char>(0x80 | (code & 0x3f));
+    }
+    else if (code < 0x10000)
+    {
+      result += static_cast<char>(0xe0 | (code >> 12));
+      result += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+      result += static_cast<char>(0x80 | (code & 0x3f));
+    }
+    else
+    {
+      result += static_cast<char>(0xf0 | (code >> 18));
+      result += static_cast<char>(0x80 | ((code >> 12) & 0x3f));
+      result += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+      result += static_cast<char>(0x80 | (code & 0x3f));
+    }
+  }
+
+  /// Char production of xml 1.0
+  static inline bool is_xml_char(unsigned code)
+  {
+    return code >= 0x20 ? (code < 0xd800 || (code >= 0xe000 && code < 0xfffe) || (code >= 0x10000 && code < 0x110000))
+                        : (code == 0x9 || code == 0xa || code == 0xd);
+  }
+
+  /// Decode UTF-8 sequence of a character outside ASCII
+  unsigned read_utf8()
+  {
+    unsigned char lead = static_cast<unsigned char>(*this->_p);
+    int length = lead >= 0xf0 ? 3 : lead >= 0xe0 ? 2 : lead >= 0xc0 ? 1 : 0;
+    unsigned code = lead & (0x3f >> length);
+    if (length == 0 || lead > 0xf4 || this->_end - this->_p <= length)
+    {
+      this->fail("invalid UTF-8");
+    }
+    for (int i = 1; i <= length; ++i)
+    {
+      unsigned char c = static_cast<unsigned char>(this->_p[i]);
+      if ((c & 0xc0) != 0x80)
+      {
+        this->fail("invalid UTF-8");
+      }
+      code = (code << 6) | (c & 0x3f);
+    }
+
+    // Overlong forms
+    static const unsigned minimum[] = {0, 0x80, 0x800, 0x10000};
+    if (code < minimum[length])
+    {
+      this->fail("invalid UTF-8");
+    }
+    this->_p += length + 1;
+    return code;
+  }
+
+  /**
+   * Read string into result. Characters must match the Char production of xml
+   * and raw ones must be valid UTF-8.
+   */
+  void read_string(std::string &result)
+  {
+    this->expect('"');
+    result.clear();
+    for (;;)
+    {
+      const char *start = this->_p;
+      for (;;)
+      {
+        while (this->_p != this->_end && static_cast<unsigned char>(*this->_p) >= 0x20 &&
+               static_cast<unsigned char>(*this->_p) < 0x80 && *this->_p != '"' && *this->_p != '\\')
+        {
+          ++this->_p;
+        }
+        if (this->_p == this->_end || static_cast<unsigned char>(*this->_p) < 0x80)
+        {
+          break;
+        }
+        if (!is_xml_char(this->read_utf8()))
+        {
+          this->fail("character not allowed in xml");
+        }
+      }
+      result.append(start, this->_p);
+      if (this->_p == this->_end)
+      {
+        this->fail("unterminated string");
+      }
+      if (static_cast<unsigned char>(*this->_p) < 0x20)
+      {
+        this->fail("control character in string");
+      }
+      if (*this->_p++ == '"')
+      {
+        return;
+      }
+      if (this->_p == this->_end)
+      {
+        this->fail("unterminated string");
+      }
+
+      char c = *this->_p++;
+      switch (c)
+      {
+      case '"':
+      case '\\':
+      case '/':
+        result += c;
+        break;
+      case 'n':
+        result += '\n';
+        break;
+      case 'r':
+        result += '\r';
+        break;
+      case 't':
+        result += '\t';
+        break;
+      case 'u':
+      {
+        unsigned code = this->read_hex4();
+        if (code >= 0xd800 && code < 0xdc00)
+        {
+          if (this->_end - this->_p < 6 || this->_p[0] != '\\' || this->_p[1] != 'u')
+          {
+            this->fail("unpaired surrogate");
+          }
+          this->_p += 2;
+          unsigned low = this->read_hex4();
+          if (low < 0xdc00 || low >= 0xe000)
+          {
+            this->fail("invalid surrogate pair");
+          }
+          code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+        }
+        else if (code >= 0xdc00 && code < 0xe000)
+        {
+          this->fail("unpaired surrogate");
+        }
+        if (!is_xml_char(code))
+        {
+          this->fail("character not allowed in xml");
+        }
+        append_utf8(result, code);
+        break;
+      }
+      default:
+        this->fail("invalid escape");
+      }
+    }
+  }
+
+  /**
+   * Read string, number, true, false or null as text
+   *
+   * @return false for null
+   */
+  bool read_scalar(std::string &result)
+  {
+    char c = this->peek();
+    if (c == '"')
+    {
+      this->read_string(result);
+      return true;
+    }
+    if (c == '{' || c == '[')
+    {
+      this->fail("expected string, number, true, false or null");
+    }
+
+    const char *start = this->_p;
+    while (this->_p != this->_end && std::strchr(",}] \t\r\n", *this->_p) == NULL)
+    {
+      ++this->_p;
+    }
+    result.assign(start, this->_p);
+    if (result == "null")
+    {
+      result.clear();
+      return false;
+    }
+    if (result != "true" && result != "false" && !is_number(result))
+    {
+      this->fail("invalid literal");
+    }
+    return true;
+  }
+
+  static bool is_number(const std::string &text)
+  {
+    std::size_t i = text[0] == '-' ? 1 : 0;
+    std::size_t digits = i;
+    while (i < text.size() && text[i] >= '0' && text[i] <= '9')
+    {
+      ++i;
+    }
+    if (i == digits)
+    {
+      return false;
+    }
+    if (i < text.size() && text[i] == '.')
+    {
+      digits = ++i;
+      while (i < text.size() && text[i] >= '0' && text[i] <= '9')
+      {
+        ++i;
+      }
+      if (i == digits)
+      {
+        return false;
+      }
+    }
+    if (i < text.size() && (text[i] == 'e' || text[i] == 'E'))
+    {
+      ++i;
+      if (i < text.size() && (text[i] == '+' || text[i] == '-'))
+      {
+        ++i;
+      }
+      digits = i;
+      while (i < text.size() && text[i] >= '0' && text[i] <= '9')
+      {
+        ++i;
+      }
+      if (i == digits)
+      {
+        return false;
+      }
+    }
+    return i == text.size();
+  }
+
+  xmlNodePtr add_element(xmlNodePtr parent, const std::string &name)
+  {
+    if (xmlValidateQName(BAD_CAST name.c_str(), 0) != 0)
+    {
+      this->fail(("invalid element name \"" + name + "\"").c_str());
+    }
+    xmlNodePtr element = xmlNewDocNode(this->_doc, NULL, BAD_CAST name.c_str(), NULL);
+    if (element == NULL)
+    {
+      throw std::runtime_error("xmlNewDocNode failed");
+    }
+    if (parent == NULL)
+    {
+      xmlDocSetRootElement(this->_doc, element);
+    }
+    else
+    {
+      xmlAddChild(parent, element);
+    }
+    return element;
+  }
+
+  void add_attribute(xmlNodePtr element, const std::string &name, const std::string &value)
+  {
+    if (xmlValidateQName(BAD_CAST name.c_str(), 0) != 0)
+    {
+      this->fail(("invalid attribute name \"" + name + "\"").c_str());
+    }
+    if (name == "xmlns" || name.compare(0, 6, "xmlns:") == 0)
+    {
+      this->_has_namespaces = true;
+    }
+    xmlNewProp(element, BAD_CAST name.c_str(), BAD_CAST value.c_str());
+  }
+
+  void add_text(xmlNodePtr element, const std::string &text)
+  {
+    if (!text.empty())
+    {
+      xmlAddChild(element, xmlNewDocTextLen(this->_doc, BAD_CAST text.data(), static_cast<int>(text.size())));
+    }
+  }
+
+  void enter()
+  {
+    if (++this->_depth > max_depth)
+    {
+      this->fail("nesting too deep");
+    }
+  }
+
+  /// Objects layout: value of element
+  void read_value(xmlNodePtr element)
+  {
+    this->enter();
+    if (this->peek() == '[')
+    {
+      this->fail("unexpected array");
+    }
+    if (this->peek() != '{')
+    {
+      this->read_scalar(this->_value);
+      this->add_text(element, this->_value);
+      --this->_depth;
+      return;
+    }
+
+    ++this->_p;
+    if (!this->accept('}'))
+    {
+      this->read_members(element);
+    }
+    --this->_depth;
+  }
+
+  void read_members(xmlNodePtr element)
+  {
+    do
+    {
+      this->read_string(this->_key);
+      this->expect(':');
+      const std::string &prefix = this->_convention.attribute_prefix;
+      if (!prefix.empty() && this->_key.compare(0, prefix.size(), prefix) == 0)
+      {
+        std::string name = this->_key.substr(prefix.size());
+        this->read_scalar(this->_value);
+        this->add_attribute(element, name, this->_value);
+      }
+      else if (this->_key == this->_convention.text_key)
+      {
+        this->read_scalar(this->_value);
+        this->add_text(element, this->_value);
+      }
+      else if (this->peek() == '[')
+      {
+        ++this->_p;
+        std::string name = this->_key;
+        if (!this->accept(']'))
+        {
+          do
+          {
+            this->read_value(this->add_element(element, name));
+          } while (this->accept(','));
+          this->expect(']');
+        }
+      }
+      else
+      {
+        this->read_value(this->add_element(element, this->_key));
+      }
+    } while (this->accept(','));
+    this->expect('}');
+  }
+
+  /// Ordered layout: element array
+  void read_element(xmlNodePtr parent)
+  {
+    this->enter();
+    this->expect('[');
+    this->read_string(this->_key);
+    xmlNodePtr element = this->add_element(parent, this->_key);
+    bool is_first = true;
+    while (this->accept(','))
+    {
+      char c = this->peek();
+      if (c == '[')
+      {
+        this->read_element(element);
+      }
+      else if (c == '{')
+      {
+        if (!is_first)
+        {
+          this->fail("attributes must follow element name");
+        }
+        ++this->_p;
+        if (!this->accept('}'))
+        {
+          do
+          {
+            this->read_string(this->_key);
+            this->expect(':');
+            std::string name = this->_key;
+            this->read_scalar(this->_value);
+            this->add_attribute(element, name, this->_value);
+          } while (this->accept(','));
+          this->expect('}');
+        }
+      }
+      else
+      {
+        this->read_scalar(this->_value);
+        this->add_text(element, this->_value);
+      }
+      is_first = false;
+    }
+    this->expect(']');
+    --this->_depth;
+  }
+
+  /// Turns xmlns attributes into namespace declarations and binds prefixes
+  void resolve_namespaces(xmlNodePtr element)
+  {
+    xmlAttrPtr attribute = element->properties;
+    while (attribute != NULL)
+    {
+      xmlAttrPtr next = attribute->next;
+      const char *name = (const char *)attribute->name;
+      if (std::strcmp(name, "xmlns") == 0 || std::strncmp(name, "xmlns:", 6) == 0)
+      {
+        xmlChar *href = xmlNodeGetContent((xmlNodePtr)attribute);
+        xmlNewNs(element, href, name[5] == ':' ? BAD_CAST(name + 6) : NULL);
+        xmlFree(href);
+        xmlRemoveProp(attribute);
+      }
+      attribute = next;
+    }
+
+    const char *colon = std::strchr((const char *)element->name, ':');
+    std::string prefix = colon == NULL ? std::string() : std::string((const char *)element->name, colon);
+    xmlNsPtr ns = xmlSearchNs(this->_doc, element, colon == NULL ? NULL : BAD_CAST prefix.c_str());
+    if (ns != NULL)
+    {
+      if (colon != NULL)
+      {
+        xmlNodeSetName(element, BAD_CAST(colon + 1));
+      }
+      xmlSetNs(element, ns);
+    }
+
+    for (attribute = element->properties; attribute != NULL; attribute = attribute->next)
+    {
+      colon = std::strchr((const char *)attribute->name, ':');
+      if (colon == NULL)
+      {
+        continue;
+      }
+      prefix.assign((const char *)attribute->name, colon);
+      ns = xmlSearchNs(this->_doc, element, BAD_CAST prefix.c_str());
+      if (ns != NULL)
+      {
+        xmlNodeSetName((xmlNodePtr)attribute, BAD_CAST(colon + 1));
+        attribute->ns = ns;
+      }
+    }
+
+    for (xmlNodePtr i = element->children; i != NULL; i = i->next)
+    {
+      if (is_element(i))
+      {
+        this->resolve_namespaces(i);
+      }
+    }
+  }
+
+public:
+  JsonReader(const JsonConvention &convention, const char *data, std::size_t size)
+    : _convention(convention), _data(data), _p(data), _end(data + size), _doc(NULL), _has_namespaces(false),
+      _depth(0) {}
+
+  /// Read whole input into a new document
+  xmlDocPtr read()
+  {
+    this->_doc = xmlNewDoc(BAD_CAST "1.0");
+    if (this->_doc == NULL)
+    {
+      throw std::runtime_error("xmlNewDoc failed");
+    }
+    std::unique_ptr<xmlDoc, void (*)(xmlDocPtr)> guard(this->_doc, xmlFreeDoc);
+
+    if (this->_convention.layout == JsonConvention::Layout::ordered)
+    {
+      this->read_element(NULL);
+    }
+    else
+    {
+      this->expect('{');
+      this->read_string(this->_key);
+      this->expect(':');
+      std::string name = this->_key;
+      this->read_value(this->add_element(NULL, name));
+      if (!this->accept('}'))
+      {
+        this->fail("expected one root member");
+      }
+    }
+
+    this->skip_space();
+    if (this->_p != this->_end)
+    {
+      this->fail("unexpected data after value");
+    }
+    if (this->_has_namespaces)
+    {
+      this->resolve_namespaces(xmlDocGetRootElement(this->_doc));
+    }
+
+    this->_doc = NULL;
+    return guard.release();
+  }
+};
+
+JsonWriter::JsonWriter(std::string &output, const JsonConvention &convention)
+  : handler(std::make_shared<JsonWriter::Handler>(output, convention)) {}
+
+JsonWriter::JsonWriter(const Pipeline::Serializer::Write &write, const JsonConvention &convention,
+                       std::size_t buffer_size)
+  : handler(std::make_shared<JsonWriter::Handler>(write, convention, buffer_size)) {}
+
+void JsonWriter::on_event(Pipeline::Event &event)
+{
+  this->handler->on_event(event);
+}
+
+void JsonWriter::on_end()
+{
+  this->handler->on_end();
+}
+
+void JsonWriter::write(const Document &document)
+{
+  std::shared_ptr<xmlDoc> doc = document.handler->get_output_doc();
+  xmlNodePtr root = xmlDocGetRootElement(doc.get());
+  if (root == NULL)
+  {
+    throw std::runtime_error("Document has no root element");
+  }
+  this->handler->write(root, false);
+}
+
+void JsonWriter::write(const Node &node)
+{
+  if (node.handler == nullptr || node.handler->get_pointer() == NULL)
+  {
+    throw std::runtime_error("Null object");
+  }
+
+  // Compact nodes are written from an expanded copy
+  Node copy = node;
+  if (dynamic_cast<const CompactNodeHandler *>(node.handler.get()) != NULL)
+  {
+    copy.handler = node.clone().handler;
+  }
+  xmlNodePtr element = (xmlNodePtr)copy.handler->get_pointer();
+  if (!is_element(element))
+  {
+    throw std::runtime_error("Node is not an element");
+  }
+  this->handler->write(element, false);
+}
+
+void JsonWriter::flush()
+{
+  this->handler->flush();
+}
+
+std::string to_json(const Document &document, const JsonConvention &convention)
+{
+  std::string output;
+  to_json(document, output, convention);
+  return output;
+}
+
+std::string to_json(const Node &node, const JsonConvention &convention)
+{
+  std::string output;
+  to_json(node, output, convention);
+  return output;
+}
+
+void to_json(const Document &document, std::string &output, const JsonConvention &convention)
+{
+  output.clear();
+  JsonWriter writer(output, convention);
+  writer.write(document);
+}
+
+void to_json(const Node &node, std::string &output, const JsonConvention &convention)
+{
+  output.clear();
+  JsonWriter writer(output, convention);
+  writer.write(node);
+}
+
+Document from_json(const char *data, std::size_t size, const JsonConvention &convention)
+{
+  JsonReader reader(convention, data, size);
+  Document document;
+  document.handler->adopt(reader.read());
+  document.root_node.handler.reset();
+  document.handler->get_root_node(document.root_node);
+  return document;
+}
+
+}
@@ -0,0 +1,100 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file MappedFile.h
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief Read-only memory mapped file
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
+#ifdef _WIN32
+#include <fstream>
+#include <sstream>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace un::Xml::Dom
+{
+
+class MappedFile
+{
+private:
+  const char *_data;
+  std::size_t _size;
+#ifdef _WIN32
+  std::string _buffer;
+#endif
+
+public:
+  explicit MappedFile(const char *path) : _data(NULL), _size(0)
+  {
+#ifdef _WIN32
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+      throw std::runtime_error(std::string("Cannot open file: ") + path);
+    }
+    std::ostringstream content;
+    content << file.rdbuf();
+    this->_buffer = content.str();
+    this->_data = this->_buffer.data();
+    this->_size = this->_buffer.size();
+#else
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+    {
+      throw std::runtime_error(std::string("Cannot open file: ") + path + ": " + std::strerror(errno));
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0)
+    {
+      ::close(fd);
+      throw std::runtime_error(std::string("Cannot stat file: ") + path);
+    }
+
+    this->_size = static_cast<std::size_t>(info.st_size);
+    if (this->_size > 0)
+    {
+      void *data = ::mmap(NULL, this->_size, PROT_READ, MAP_SHARED, fd, 0);
+      if (data == MAP_FAILED)
+      {
+        ::close(fd);
+        throw std::runtime_error(std::string("Cannot map file: ") + path);
+      }
+      this->_data = static_cast<const char *>(data);
+    }
+    ::close(fd);
+#endif
+  }
+
+  ~MappedFile()
+  {
+#ifndef _WIN32
+    if (this->_data != NULL)
+    {
+      ::munmap(const_cast<char *>(this->_data), this->_size);
+    }
+#endif
+  }
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  const char *get_data() const { return this->_data; }
+
+  std::size_t get_size() const { return this->_size; }
+};
+
+}
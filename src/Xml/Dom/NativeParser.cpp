@@ -0,0 +1,917 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file NativeParser.cpp
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief In-house xml parser building libxml2 trees
+ */
+
+#include "NativeParser.h"
+#include "Scanner.h"
+#include <cstdint>
+#include <cstring>
+#include <libxml/dict.h>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace un::Xml::Dom::NativeParser
+{
+
+namespace
+{
+
+struct NameTable
+{
+  bool start[256];
+  bool part[256];
+
+  NameTable()
+  {
+    for (int c = 0; c < 256; ++c)
+    {
+      start[c] = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' ||
+                 c == ':' || c >= 0x80;
+      part[c] = start[c] || (c >= '0' && c <= '9') || c == '-' || c == '.';
+    }
+  }
+};
+
+const NameTable name_table;
+
+inline bool is_space(char c)
+{
+  return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+}
+
+/// Name span inside input data
+struct Span
+{
+  const char *data;
+  std::size_t size;
+
+  inline bool operator==(const Span &rhs) const
+  {
+    return size == rhs.size && std::memcmp(data, rhs.data, size) == 0;
+  }
+
+  template <std::size_t strsize>
+  inline bool equals(const char (&rhs)[strsize]) const
+  {
+    return size == strsize - 1 && std::memcmp(data, rhs, size) == 0;
+  }
+};
+
+struct Attribute
+{
+  Span name;
+  std::size_t value_offset;
+};
+
+typedef std::unique_ptr<xmlDoc, void (*)(xmlDocPtr)> DocumentGuard;
+
+/// Thrown when a construct is left to libxml2 after parsing started
+struct Decline
+{
+};
+
+class Parser
+{
+private:
+  const char *const _begin;
+  const char *_p;
+  const char *const _end;
+  xmlDocPtr _doc;
+  xmlDictPtr _dict;
+  bool _has_namespaces;
+  bool _is_namespace_valid;
+
+  std::string _text;           // Decoded character data
+  std::string _values;         // Decoded attribute values of current tag
+  std::vector<Attribute> _attributes;
+
+  [[noreturn]] void error(const char *message) const
+  {
+    int line = 1;
+    for (const char *i = this->_begin; i < this->_p && i < this->_end; ++i)
+    {
+      line += *i == '\n';
+    }
+    throw std::runtime_error("Xml parse error at line " + std::to_string(line) + ": " + message);
+  }
+
+  /// Input must be UTF-8 and its characters must match the Char production
+  void check_characters()
+  {
+    const char *i = this->_begin;
+    while ((i = Scanner::find_control_or_non_ascii(i, this->_end)) != this->_end)
+    {
+      unsigned char lead = static_cast<unsigned char>(*i);
+      this->_p = i;
+      if (lead < 0x80)
+      {
+        this->error(("Char 0x" + to_hex(lead) + " out of allowed range").c_str());
+      }
+
+      int length = lead >= 0xf0 ? 3 : lead >= 0xe0 ? 2 : lead >= 0xc0 ? 1 : 0;
+      uint32_t code = lead & (0x3f >> length);
+      bool is_valid = length != 0 && lead <= 0xf4 && this->_end - i > length;
+      for (int j = 1; is_valid && j <= length; ++j)
+      {
+        unsigned char c = static_cast<unsigned char>(i[j]);
+        is_valid = (c & 0xc0) == 0x80;
+        code = (code << 6) | (c & 0x3f);
+      }
+
+      // Overlong forms are not proper UTF-8 either
+      static const uint32_t minimum[] = {0, 0x80, 0x800, 0x10000};
+      if (!is_valid || code < minimum[length])
+      {
+        this->error("Input is not proper UTF-8, indicate encoding !");
+      }
+      if ((code >= 0xd800 && code < 0xe000) || code == 0xfffe || code == 0xffff || code > 0x10ffff)
+      {
+        this->error(("Char 0x" + to_hex(code) + " out of allowed range").c_str());
+      }
+      i += length + 1;
+    }
+  }
+
+  static std::string to_hex(uint32_t value)
+  {
+    static const char digits[] = "0123456789ABCDEF";
+    std::string result;
+    do
+    {
+      result.insert(result.begin(), digits[value & 0xf]);
+      value >>= 4;
+    } while (value != 0);
+    return result;
+  }
+
+  inline const xmlChar *intern(const char *data, std::size_t size)
+  {
+    const xmlChar *result = xmlDictLookup(this->_dict, BAD_CAST data, static_cast<int>(size));
+    if (result == NULL)
+    {
+      throw std::runtime_error("xmlDictLookup failed");
+    }
+    return result;
+  }
+
+  static inline void link(xmlNodePtr parent, xmlNodePtr node)
+  {
+    node->parent = parent;
+    if (parent->last == NULL)
+    {
+      parent->children = node;
+    }
+    else
+    {
+      parent->last->next = node;
+      node->prev = parent->last;
+    }
+    parent->last = node;
+  }
+
+  inline void skip_spaces()
+  {
+    while (this->_p != this->_end && is_space(*this->_p))
+    {
+      ++this->_p;
+    }
+  }
+
+  inline Span read_name()
+  {
+    const char *start = this->_p;
+    if (this->_p == this->_end || !name_table.start[static_cast<unsigned char>(*this->_p)])
+    {
+      return Span{start, 0};
+    }
+
+    for (++this->_p; this->_p != this->_end &&
+                     name_table.part[static_cast<unsigned char>(*this->_p)];
+         ++this->_p)
+    {
+    }
+    return Span{start, static_cast<std::size_t>(this->_p - start)};
+  }
+
+  static void append_utf8(std::string &out, uint32_t code)
+  {
+    if (code < 0x80)
+    {
+      out += static_cast<char>(code);
+    }
+    else if (code < 0x800)
+    {
+      out += static_cast<char>(0xc0 | (code >> 6));
+      out += static_cast<char>(0x80 | (code & 0x3f));
+    }
+    else if (code < 0x10000)
+    {
+      out += static_cast<char>(0xe0 | (code >> 12));
+      out += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+      out += static_cast<char>(0x80 | (code & 0x3f));
+    }
+    else
+    {
+      out += static_cast<char>(0xf0 | (code >> 18));
+      out += static_cast<char>(0x80 | ((code >> 12) & 0x3f));
+      out += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+      out += static_cast<char>(0x80 | (code & 0x3f));
+    }
+  }
+
+  /// Decodes entity or character reference at _p ('&') into out
+  void decode_reference(std::string &out)
+  {
+    const char *start = this->_p + 1;
+    const char *semicolon = Scanner::find(start, std::min(this->_end, start + 32), ';');
+    if (semicolon == this->_end || *semicolon != ';')
+    {
+      this->error("EntityRef: expecting ';'");
+    }
+
+    Span name{start, static_cast<std::size_t>(semicolon - start)};
+    if (name.size > 1 && name.data[0] == '#')
+    {
+      uint32_t code = 0;
+      bool hex = name.data[1] == 'x';
+      const char *i = name.data + (hex ? 2 : 1);
+      if (i == semicolon)
+      {
+        this->error("Invalid character reference");
+      }
+      for (; i != semicolon; ++i)
+      {
+        unsigned digit;
+        if (*i >= '0' && *i <= '9')
+        {
+          digit = *i - '0';
+        }
+        else if (hex && *i >= 'a' && *i <= 'f')
+        {
+          digit = *i - 'a' + 10;
+        }
+        else if (hex && *i >= 'A' && *i <= 'F')
+        {
+          digit = *i - 'A' + 10;
+        }
+        else
+        {
+          this->error("Invalid character reference");
+        }
+        code = code * (hex ? 16 : 10) + digit;
+        if (code > 0x10ffff)
+        {
+          this->error("Invalid character reference");
+        }
+      }
+
+      if (code == 0 || (code < 0x20 && code != 0x9 && code != 0xa && code != 0xd) ||
+          (code >= 0xd800 && code <= 0xdfff) || code == 0xfffe || code == 0xffff)
+      {
+        this->error("Invalid character reference");
+      }
+      append_utf8(out, code);
+    }
+    else if (name.equals("lt"))
+    {
+      out += '<';
+    }
+    else if (name.equals("gt"))
+    {
+      out += '>';
+    }
+    else if (name.equals("amp"))
+    {
+      out += '&';
+    }
+    else if (name.equals("apos"))
+    {
+      out += '\'';
+    }
+    else if (name.equals("quot"))
+    {
+      out += '"';
+    }
+    else
+    {
+      this->error(("Entity '" + std::string(name.data, name.size) + "' not defined").c_str());
+    }
+
+    this->_p = semicolon + 1;
+  }
+
+  /// Character data up to next '<'
+  void parse_text(xmlNodePtr parent)
+  {
+    const char *start = this->_p;
+    const char *stop = Scanner::find(this->_p, this->_end, Scanner::ByteSet('<', '&', '\r', ']'));
+
+    if (stop != this->_end && *stop == '<')
+    {
+      // Fast path, nothing to decode
+      this->_p = stop;
+      link(parent, xmlNewDocTextLen(this->_doc, BAD_CAST start, static_cast<int>(stop - start)));
+      return;
+    }
+
+    this->_text.assign(start, stop);
+    this->_p = stop;
+    while (this->_p != this->_end && *this->_p != '<')
+    {
+      if (*this->_p == '&')
+      {
+        this->decode_reference(this->_text);
+      }
+      else if (*this->_p == ']')
+      {
+        if (Scanner::starts_with(this->_p, this->_end, "]]>"))
+        {
+          this->error("Sequence ']]>' not allowed in content");
+        }
+        this->_text += ']';
+        ++this->_p;
+      }
+      else
+      {
+        // Line ends are normalized to '\n'
+        this->_text += '\n';
+        ++this->_p;
+        if (this->_p != this->_end && *this->_p == '\n')
+        {
+          ++this->_p;
+        }
+      }
+
+      stop = Scanner::find(this->_p, this->_end, Scanner::ByteSet('<', '&', '\r', ']'));
+      this->_text.append(this->_p, stop);
+      this->_p = stop;
+    }
+
+    if (this->_p == this->_end)
+    {
+      this->error("Premature end of data");
+    }
+
+    link(parent, xmlNewDocTextLen(this->_doc, BAD_CAST this->_text.data(),
+                                  static_cast<int>(this->_text.size())));
+  }
+
+  /// Attribute value at _p (opening quote), decoded into _values
+  void parse_attribute_value()
+  {
+    const char quote = *this->_p++;
+    for (;;)
+    {
+      const char *stop = Scanner::find_with_controls(this->_p, this->_end,
+                                                     Scanner::ByteSet(quote, '&', '<'));
+      this->_values.append(this->_p, stop);
+      this->_p = stop;
+
+      if (stop == this->_end)
+      {
+        this->error("AttValue: ' expected");
+      }
+
+      if (*stop == quote)
+      {
+        ++this->_p;
+        break;
+      }
+
+      switch (*stop)
+      {
+      case '&':
+        this->decode_reference(this->_values);
+        break;
+      case '<':
+        this->error("Unescaped '<' not allowed in attributes values");
+      case '\r':
+        // "\r\n" is one line end, normalized to a single space
+        ++this->_p;
+        if (this->_p != this->_end && *this->_p == '\n')
+        {
+          ++this->_p;
+        }
+        this->_values += ' ';
+        break;
+      case '\n':
+      case '\t':
+        ++this->_p;
+        this->_values += ' ';
+        break;
+      default:
+        this->error("Invalid character in attribute value");
+      }
+    }
+
+    this->_values += '\0';
+  }
+
+  static Span prefix_of(Span name, Span &local)
+  {
+    const char *colon = static_cast<const char *>(std::memchr(name.data, ':', name.size));
+    if (colon == NULL || colon == name.data || colon + 1 == name.data + name.size)
+    {
+      local = name;
+      return Span{name.data, 0};
+    }
+    local = Span{colon + 1, static_cast<std::size_t>(name.data + name.size - colon - 1)};
+    return Span{name.data, static_cast<std::size_t>(colon - name.data)};
+  }
+
+  xmlNsPtr search_namespace(xmlNodePtr node, Span prefix)
+  {
+    if (prefix.size == 0)
+    {
+      xmlNsPtr ns = xmlSearchNs(this->_doc, node, NULL);
+      return ns != NULL && ns->href != NULL && ns->href[0] != 0 ? ns : NULL;
+    }
+    std::string name(prefix.data, prefix.size);
+    return xmlSearchNs(this->_doc, node, BAD_CAST name.c_str());
+  }
+
+  /// Start tag at _p ('<'), returns true if element has content
+  bool parse_start_tag(xmlNodePtr parent, xmlNodePtr &node)
+  {
+    ++this->_p;
+    Span name = this->read_name();
+    if (name.size == 0)
+    {
+      this->error("StartTag: invalid element name");
+    }
+
+    this->_attributes.clear();
+    this->_values.clear();
+
+    bool has_content;
+    for (;;)
+    {
+      const char *before = this->_p;
+      this->skip_spaces();
+      if (this->_p == this->_end)
+      {
+        this->error("Premature end of data in tag");
+      }
+
+      if (*this->_p == '>')
+      {
+        ++this->_p;
+        has_content = true;
+        break;
+      }
+
+      if (*this->_p == '/')
+      {
+        if (this->_p + 1 == this->_end || this->_p[1] != '>')
+        {
+          this->error("Couldn't find end of Start Tag");
+        }
+        this->_p += 2;
+        has_content = false;
+        break;
+      }
+
+      if (before == this->_p)
+      {
+        this->error("attributes construct error");
+      }
+
+      Span attribute = this->read_name();
+      if (attribute.size == 0)
+      {
+        this->error("attributes construct error");
+      }
+
+      for (const Attribute &i : this->_attributes)
+      {
+        if (i.name == attribute)
+        {
+          this->error("Attribute redefined");
+        }
+      }
+
+      this->skip_spaces();
+      if (this->_p == this->_end || *this->_p != '=')
+      {
+        this->error("Specification mandates value for attribute");
+      }
+      ++this->_p;
+      this->skip_spaces();
+      if (this->_p == this->_end || (*this->_p != '"' && *this->_p != '\''))
+      {
+        this->error("AttValue: \" or ' expected");
+      }
+
+      this->_attributes.push_back(Attribute{attribute, this->_values.size()});
+      this->parse_attribute_value();
+    }
+
+    Span local;
+    Span prefix = prefix_of(name, local);
+
+    node = xmlNewDocNodeEatName(this->_doc, NULL, const_cast<xmlChar *>(this->intern(local.data, local.size)), NULL);
+    if (node == NULL)
+    {
+      throw std::runtime_error("xmlNewDocNode failed");
+    }
+    link(parent, node);
+
+    // Namespace declarations first, element and attributes may use them.
+    // Reserved prefixes and namespaces and empty prefixed declarations are
+    // skipped with an error by libxml2, they are left to it.
+    for (const Attribute &i : this->_attributes)
+    {
+      const xmlChar *value = BAD_CAST this->_values.data() + i.value_offset;
+      bool is_default = i.name.equals("xmlns");
+      if (!is_default && (i.name.size <= 6 || std::memcmp(i.name.data, "xmlns:", 6) != 0))
+      {
+        continue;
+      }
+
+      if (xmlStrEqual(value, XML_XML_NAMESPACE) || xmlStrEqual(value, BAD_CAST "http://www.w3.org/2000/xmlns/"))
+      {
+        throw Decline();
+      }
+
+      if (is_default)
+      {
+        xmlNewNs(node, value, NULL);
+      }
+      else
+      {
+        std::string ns_prefix(i.name.data + 6, i.name.size - 6);
+        if (value[0] == 0 || ns_prefix == "xml" || ns_prefix == "xmlns")
+        {
+          throw Decline();
+        }
+        xmlNewNs(node, value, BAD_CAST ns_prefix.c_str());
+      }
+      this->_has_namespaces = true;
+    }
+
+    if (prefix.size != 0 || this->_has_namespaces)
+    {
+      xmlNsPtr ns = this->search_namespace(node, prefix);
+      if (ns != NULL)
+      {
+        xmlSetNs(node, ns);
+      }
+      else if (prefix.size != 0)
+      {
+        // Undefined prefix, keep qualified name like libxml2 does
+        node->name = this->intern(name.data, name.size);
+        this->_is_namespace_valid = false;
+      }
+    }
+
+    for (const Attribute &i : this->_attributes)
+    {
+      if (i.name.equals("xmlns") ||
+          (i.name.size > 6 && std::memcmp(i.name.data, "xmlns:", 6) == 0))
+      {
+        continue;
+      }
+
+      const xmlChar *value = BAD_CAST this->_values.data() + i.value_offset;
+      Span attribute_local;
+      Span attribute_prefix = prefix_of(i.name, attribute_local);
+      xmlNsPtr ns = NULL;
+      if (attribute_prefix.size != 0)
+      {
+        ns = this->search_namespace(node, attribute_prefix);
+        if (ns == NULL)
+        {
+          attribute_local = i.name;
+          this->_is_namespace_valid = false;
+        }
+      }
+
+      const xmlChar *attribute_name = this->intern(attribute_local.data, attribute_local.size);
+      if (ns != NULL)
+      {
+        // Same name in the same namespace through different prefixes
+        for (xmlAttrPtr j = node->properties; j != NULL; j = j->next)
+        {
+          if (j->name == attribute_name && j->ns != NULL && xmlStrEqual(j->ns->href, ns->href))
+          {
+            throw Decline();
+          }
+        }
+      }
+
+      if (xmlNewNsPropEatName(node, ns, const_cast<xmlChar *>(attribute_name), value) == NULL)
+      {
+        throw std::runtime_error("xmlNewNsProp failed");
+      }
+    }
+
+    return has_content;
+  }
+
+  /// End tag at _p ("</"), returns parent of closed element
+  xmlNodePtr parse_end_tag(xmlNodePtr node)
+  {
+    this->_p += 2;
+    Span name = this->read_name();
+    this->skip_spaces();
+    if (this->_p == this->_end || *this->_p != '>')
+    {
+      this->error("expected '>'");
+    }
+    ++this->_p;
+
+    const char *local = reinterpret_cast<const char *>(node->name);
+    std::size_t local_size = std::strlen(local);
+    bool matches;
+    if (node->ns != NULL && node->ns->prefix != NULL)
+    {
+      std::size_t prefix_size = std::strlen(reinterpret_cast<const char *>(node->ns->prefix));
+      matches = name.size == prefix_size + 1 + local_size &&
+                std::memcmp(name.data, node->ns->prefix, prefix_size) == 0 &&
+                name.data[prefix_size] == ':' &&
+                std::memcmp(name.data + prefix_size + 1, local, local_size) == 0;
+    }
+    else
+    {
+      matches = name.size == local_size && std::memcmp(name.data, local, local_size) == 0;
+    }
+
+    if (!matches)
+    {
+      this->error("Opening and ending tag mismatch");
+    }
+
+    return node->parent;
+  }
+
+  void parse_comment(xmlNodePtr parent)
+  {
+    const char *start = this->_p + 4;
+    const char *stop = Scanner::find(start, this->_end, "--");
+    if (stop == this->_end || stop + 2 == this->_end)
+    {
+      this->error("Comment not terminated");
+    }
+    if (stop[2] != '>')
+    {
+      this->error("Double hyphen within comment");
+    }
+
+    std::string content(start, stop);
+    link(parent, xmlNewDocComment(this->_doc, BAD_CAST content.c_str()));
+    this->_p = stop + 3;
+  }
+
+  void parse_cdata(xmlNodePtr parent)
+  {
+    const char *start = this->_p + 9;
+    const char *stop = Scanner::find(start, this->_end, "]]>");
+    if (stop == this->_end)
+    {
+      this->error("CData section not finished");
+    }
+
+    link(parent, xmlNewCDataBlock(this->_doc, BAD_CAST start, static_cast<int>(stop - start)));
+    this->_p = stop + 3;
+  }
+
+  void parse_processing_instruction(xmlNodePtr parent)
+  {
+    this->_p += 2;
+    Span target = this->read_name();
+    if (target.size == 0)
+    {
+      this->error("xmlParsePI : no target name");
+    }
+    if (target.size == 3 && (target.data[0] | 0x20) == 'x' &&
+        (target.data[1] | 0x20) == 'm' && (target.data[2] | 0x20) == 'l')
+    {
+      this->error("XML declaration allowed only at the start of the document");
+    }
+
+    this->skip_spaces();
+    const char *stop = Scanner::find(this->_p, this->_end, "?>");
+    if (stop == this->_end)
+    {
+      this->error("PI not terminated");
+    }
+
+    std::string name(target.data, target.size);
+    std::string content(this->_p, stop);
+    link(parent, xmlNewDocPI(this->_doc, BAD_CAST name.c_str(),
+                             content.empty() ? NULL : BAD_CAST content.c_str()));
+    this->_p = stop + 2;
+  }
+
+  /// Value of pseudo attribute inside xml declaration
+  static bool declaration_value(Span declaration, const char *key, std::string &value)
+  {
+    const char *end = declaration.data + declaration.size;
+    const char *i = Scanner::find(declaration.data, end, key, std::strlen(key));
+    if (i == end)
+    {
+      return false;
+    }
+    i = Scanner::find(i, end, Scanner::ByteSet('"', '\''));
+    if (i == end)
+    {
+      return false;
+    }
+    const char *stop = Scanner::find(i + 1, end, *i);
+    value.assign(i + 1, stop);
+    return true;
+  }
+
+public:
+  Parser(const char *data, std::size_t size)
+    : _begin(data), _p(data), _end(data + size), _doc(NULL), _dict(NULL),
+      _has_namespaces(false), _is_namespace_valid(true) {}
+
+  xmlDocPtr parse()
+  {
+    if (Scanner::starts_with(this->_p, this->_end, "\xEF\xBB\xBF"))
+    {
+      this->_p += 3;
+    }
+
+    std::string version = "1.0";
+    std::string encoding;
+    std::string standalone;
+    bool has_encoding = false;
+    bool has_standalone = false;
+
+    if (Scanner::starts_with(this->_p, this->_end, "<?xml") &&
+        this->_p + 5 != this->_end && is_space(this->_p[5]))
+    {
+      const char *stop = Scanner::find(this->_p, this->_end, "?>");
+      if (stop == this->_end)
+      {
+        this->error("parsing XML declaration: '?>' expected");
+      }
+
+      Span declaration{this->_p + 5, static_cast<std::size_t>(stop - this->_p - 5)};
+      declaration_value(declaration, "version", version);
+      has_encoding = declaration_value(declaration, "encoding", encoding);
+      has_standalone = declaration_value(declaration, "standalone", standalone);
+      this->_p = stop + 2;
+
+      if (has_encoding && xmlStrcasecmp(BAD_CAST encoding.c_str(), BAD_CAST "UTF-8") != 0 &&
+          xmlStrcasecmp(BAD_CAST encoding.c_str(), BAD_CAST "UTF8") != 0)
+      {
+        return NULL;
+      }
+    }
+
+    // Anything not looking like UTF-8 markup (compressed, UTF-16 ...) goes to libxml2
+    const char *first = this->_p;
+    this->skip_spaces();
+    if (this->_p == this->_end || *this->_p != '<')
+    {
+      return NULL;
+    }
+    this->check_characters();
+    this->_p = first;
+
+    DocumentGuard guard(xmlNewDoc(BAD_CAST version.c_str()), xmlFreeDoc);
+    if (guard == nullptr)
+    {
+      throw std::runtime_error("xmlNewDoc failed");
+    }
+    this->_doc = guard.get();
+    this->_dict = xmlDictCreate();
+    if (this->_dict == NULL)
+    {
+      throw std::runtime_error("xmlDictCreate failed");
+    }
+    this->_doc->dict = this->_dict;
+    if (has_encoding)
+    {
+      this->_doc->encoding = xmlStrdup(BAD_CAST encoding.c_str());
+    }
+    if (has_standalone)
+    {
+      this->_doc->standalone = standalone == "yes" ? 1 : 0;
+    }
+
+    xmlNodePtr document = reinterpret_cast<xmlNodePtr>(this->_doc);
+    xmlNodePtr parent = document;
+    bool has_root = false;
+
+    for (;;)
+    {
+      if (parent == document)
+      {
+        this->skip_spaces();
+        if (this->_p == this->_end)
+        {
+          break;
+        }
+        if (*this->_p != '<')
+        {
+          this->error(has_root ? "Extra content at the end of the document"
+                               : "Start tag expected, '<' not found");
+        }
+      }
+      else if (*this->_p != '<')
+      {
+        this->parse_text(parent);
+        continue;
+      }
+
+      if (this->_p + 1 == this->_end)
+      {
+        this->error("Premature end of data");
+      }
+
+      switch (this->_p[1])
+      {
+      case '/':
+        if (parent == document)
+        {
+          this->error("Extra content at the end of the document");
+        }
+        parent = this->parse_end_tag(parent);
+        break;
+
+      case '?':
+        this->parse_processing_instruction(parent);
+        break;
+
+      case '!':
+        if (Scanner::starts_with(this->_p, this->_end, "<!--"))
+        {
+          this->parse_comment(parent);
+        }
+        else if (parent != document && Scanner::starts_with(this->_p, this->_end, "<![CDATA["))
+        {
+          this->parse_cdata(parent);
+        }
+        else if (parent == document && !has_root &&
+                 Scanner::starts_with(this->_p, this->_end, "<!DOCTYPE"))
+        {
+          // DTDs and entity declarations are left to libxml2
+          return NULL;
+        }
+        else
+        {
+          this->error("Invalid markup declaration");
+        }
+        break;
+
+      default:
+      {
+        if (parent == document)
+        {
+          if (has_root)
+          {
+            this->error("Extra content at the end of the document");
+          }
+          has_root = true;
+        }
+
+        xmlNodePtr node;
+        if (this->parse_start_tag(parent, node))
+        {
+          parent = node;
+        }
+        break;
+      }
+      }
+
+      if (parent != document && this->_p == this->_end)
+      {
+        this->error("Premature end of data in tag");
+      }
+    }
+
+    if (!has_root)
+    {
+      this->error("Document is empty");
+    }
+
+    this->_doc->properties = XML_DOC_WELLFORMED | (this->_is_namespace_valid ? XML_DOC_NSVALID : 0);
+    return guard.release();
+  }
+};
+
+} // namespace
+
+xmlDocPtr parse(const char *data, std::size_t size)
+{
+  try
+  {
+    return Parser(data, size).parse();
+  }
+  catch (const Decline &)
+  {
+    return NULL;
+  }
+}
+
+}
@@ -0,0 +1,41 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file NativeParser.h
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief In-house xml parser building libxml2 trees
+ *
+ * Markup is located with the SIMD scanner and nodes are linked directly into a
+ * libxml2 tree, names are interned in the document dictionary. Result is the
+ * same tree libxml2 would build (without line numbers), so every Node operation
+ * works on it.
+ *
+ * Only UTF-8 documents without a DOCTYPE are handled. Anything else is declined
+ * and should be handed to libxml2, as are namespace declarations libxml2
+ * skips (reserved prefixes, empty prefixed ones) and attributes repeated
+ * through different prefixes.
+ *
+ * Characters are checked against UTF-8 and the Char production in a separate
+ * SIMD pass before parsing. It skips ASCII text a vector at a time and costs
+ * about 1% of the parse. See bench/Xml/Dom/BenchParse.cpp for throughput.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <libxml/tree.h>
+
+namespace un::Xml::Dom::NativeParser
+{
+
+/**
+ * Parse data into a new document.
+ *
+ * @param data Read data from
+ * @param size Size of data to read from
+ * @return New document or NULL if data needs libxml2 parser
+ * @throw std::runtime_error on malformed data
+ */
+xmlDocPtr parse(const char *data, std::size_t size);
+
+}
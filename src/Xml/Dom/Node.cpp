@@ -7,7 +7,10 @@
 */
 
 #include <Xml/Dom/Node.h>
+#include "DocumentHandlerLibxml2.h"
+#include "NodeHandlerCompact.h"
 #include "NodeHandlerLibxml2.h"
+#include "ValueParser.h"
 #include <cstdlib>
 
 namespace un::Xml::Dom
@@ -27,6 +30,9 @@ Node::Node(const std::string &name, const std::string &content)
 
 Node::Node(const Node &bindFrom) : handler(bindFrom.handler) {}
 
+Node::Node(const Namespace &ns, const std::string &name)
+    : handler(new Node::Handler(ns, name.c_str())) {}
+
 Node::Node(const char *name, const char *content)
     : handler(new Node::Handler(name, content)) {}
 
@@ -160,6 +166,34 @@ Node::iterator Node::end() const
   return this->handler->end();
 }
 
+void Node::scan(Node::ScanSink &sink) const
+{
+  if (this->handler == nullptr)
+  {
+    throw std::runtime_error("Null object");
+  }
+
+  this->handler->scan(sink);
+}
+
+void Node::visit(const Node::Visitor &visitor, Node::ExecutionPolicy policy,
+                 std::size_t thread_count) const
+{
+  if (this->handler == nullptr)
+  {
+    throw std::runtime_error("Null object");
+  }
+
+  if (policy == Node::ExecutionPolicy::parallel)
+  {
+    this->handler->visit_parallel(visitor, thread_count);
+  }
+  else
+  {
+    this->handler->visit(visitor);
+  }
+}
+
 Node Node::operator[](const char *const key) const
 {
   if (this->handler == nullptr)
@@ -190,9 +224,31 @@ Node Node::operator[](int index) const
   return this->handler->get_child(index);
 }
 
+Node Node::get_child(const std::string &uri, const std::string &name) const
+{
+  return QualifiedPath().append(uri, name).select(*this);
+}
+
+std::string Node::get_namespace_uri() const
+{
+  if (this->handler == nullptr)
+  {
+    throw std::runtime_error("Null object");
+  }
+
+  return this->handler->get_namespace_uri();
+}
+
 bool Node::operator==(const Node &rhs) const
 {
-  return this->handler == rhs.handler;
+  if (this->handler == rhs.handler)
+  {
+    return true;
+  }
+
+  // Frozen documents give a new binding on each lookup
+  return this->handler != nullptr && rhs.handler != nullptr &&
+         this->handler->is_equal(rhs);
 }
 
 bool Node::operator==(const void *const rhs) const
@@ -202,7 +258,7 @@ bool Node::operator==(const void *const rhs) const
     return rhs == nullptr;
   }
 
-  return this->handler->handler == rhs;
+  return this->handler->get_pointer() == rhs;
 }
 
 void Node::remove(const Node &node)
@@ -235,6 +291,119 @@ void Node::push_front(const Node &node)
   this->handler->push_front(node);
 }
 
+Node Node::clone() const
+{
+  if (this->handler == nullptr || this->handler->get_pointer() == NULL)
+  {
+    throw std::runtime_error("Null object");
+  }
+
+  xmlNodePtr copy = this->handler->clone();
+  if (copy == NULL)
+  {
+    throw std::runtime_error("xmlDocCopyNode failed");
+  }
+  return Node(std::shared_ptr<Node::Handler>(new Node::Handler(copy, true)));
+}
+
+uint64_t Node::hash() const
+{
+  if (this->handler == nullptr || this->handler->get_pointer() == NULL)
+  {
+    throw std::runtime_error("Null object");
+  }
+
+  return this->handler->get_hash();
+}
+
+bool Node::deep_equal(const Node &rhs, bool ordered_attributes) const
+{
+  if (this->hash() != rhs.hash())
+  {
+    return false;
+  }
+  if (this->handler->get_pointer() == rhs.handler->get_pointer())
+  {
+    return true;
+  }
+
+  // Compact nodes are compared as expanded copies
+  Node lhs_copy = *this;
+  Node rhs_copy = rhs;
+  if (dynamic_cast<const CompactNodeHandler *>(this->handler.get()) != NULL)
+  {
+    lhs_copy.handler = this->clone().handler;
+  }
+  if (dynamic_cast<const CompactNodeHandler *>(rhs.handler.get()) != NULL)
+  {
+    rhs_copy.handler = rhs.clone().handler;
+  }
+  return Node::Handler::is_equal((xmlNodePtr)lhs_copy.handler->get_pointer(),
+                                 (xmlNodePtr)rhs_copy.handler->get_pointer(), ordered_attributes);
+}
+
+void Node::append_range(const std::vector<Node> &nodes)
+{
+  if (this->handler == nullptr)
+  {
+    throw std::runtime_error("Null object");
+  }
+
+  this->handler->insert_range(NULL, nodes.data(), nodes.data() + nodes.size());
+}
+
+void Node::insert_before(const iterator &position, const Node &node)
+{
+  if (this->handler == nullptr)
+  {
+    throw std::runtime_error("Null object");
+  }
+
+  this->handler->insert_range((xmlNodePtr)position.get_address(), &node, &node + 1);
+}
+
+void Node::insert_before(const iterator &position, const std::vector<Node> &nodes)
+{
+  if (this->handler == nullptr)
+  {
+    throw std::runtime_error("Null object");
+  }
+
+  this->handler->insert_range((xmlNodePtr)position.get_address(), nodes.data(), nodes.data() + nodes.size());
+}
+
+void Node::insert_after(const iterator &position, const Node &node)
+{
+  if (this->handler == nullptr)
+  {
+    throw std::runtime_error("Null object");
+  }
+
+  xmlNodePtr next = this->handler->get_position_after((xmlNodePtr)position.get_address());
+  this->handler->insert_range(next, &node, &node + 1);
+}
+
+void Node::insert_after(const iterator &position, const std::vector<Node> &nodes)
+{
+  if (this->handler == nullptr)
+  {
+    throw std::runtime_error("Null object");
+  }
+
+  xmlNodePtr next = this->handler->get_position_after((xmlNodePtr)position.get_address());
+  this->handler->insert_range(next, nodes.data(), nodes.data() + nodes.size());
+}
+
+void Node::splice(const iterator &position, const Node &source)
+{
+  if (this->handler == nullptr || source.handler == nullptr)
+  {
+    throw std::runtime_error("Null object");
+  }
+
+  this->handler->splice((xmlNodePtr)position.get_address(), source);
+}
+
 Node Node::pop_back()
 {
   if (this->handler == nullptr)
@@ -518,6 +687,26 @@ void Node::AttributesPropertyType::push_back(const char *name, const char *value
   this->get_parent()->handler->push_back_attribute(name, value);
 }
 
+Node::Attribute Node::AttributesPropertyType::get(const std::string &uri, const std::string &name) const
+{
+  if (this->get_parent()->handler == nullptr)
+  {
+    throw std::runtime_error("Null object");
+  }
+
+  return this->get_parent()->handler->get_attribute_ns(uri.c_str(), name.c_str());
+}
+
+void Node::AttributesPropertyType::push_back(const Namespace &ns, const std::string &name, const std::string &value)
+{
+  if (this->get_parent()->handler == nullptr)
+  {
+    throw std::runtime_error("Null object");
+  }
+
+  this->get_parent()->handler->push_back_attribute(ns, name, value);
+}
+
 void Node::AttributesPropertyType::remove(const char * const name)
 {
   this->get_parent()->handler->remove_attribute(name);
@@ -569,4 +758,107 @@ Node::AttributesPropertyType::end() const
       this->get_parent()->handler->end_attr());
 }
 
+template <class T>
+std::optional<T> Node::ContentPropertyType::try_as() const
+{
+  if (this->get_parent()->handler == nullptr)
+  {
+    throw std::runtime_error("Null object");
+  }
+
+  std::string storage;
+  T value;
+  if (!ValueParser::parse(this->get_parent()->handler->get_content_view(storage), value))
+  {
+    return std::nullopt;
+  }
+  return value;
+}
+
+template <class T>
+T Node::ContentPropertyType::as() const
+{
+  std::optional<T> value = this->try_as<T>();
+  if (!value)
+  {
+    throw std::runtime_error(std::string("Content is not a valid ") + ValueParser::get_type_name<T>());
+  }
+  return *value;
+}
+
+template <class T>
+std::optional<T> Node::Attribute::try_as() const
+{
+  if (this->handler == nullptr)
+  {
+    throw std::runtime_error("Null object");
+  }
+
+  const char *text = this->handler->get_value();
+  T value;
+  if (!ValueParser::parse(text == NULL ? std::string_view() : std::string_view(text), value))
+  {
+    return std::nullopt;
+  }
+  return value;
+}
+
+template <class T>
+T Node::Attribute::as() const
+{
+  std::optional<T> value = this->try_as<T>();
+  if (!value)
+  {
+    throw std::runtime_error(std::string("Attribute value is not a valid ") +
+                             ValueParser::get_type_name<T>());
+  }
+  return *value;
+}
+
+template <class T>
+std::size_t Node::children_as(const char *name, std::vector<T> &values) const
+{
+  if (this->handler == nullptr)
+  {
+    throw std::runtime_error("Null object");
+  }
+
+  std::size_t size = values.size();
+  try
+  {
+    this->handler->each_child_content(name, [&values](std::string_view text) {
+      T value;
+      if (!ValueParser::parse(text, value))
+      {
+        throw std::runtime_error(std::string("Content is not a valid ") + ValueParser::get_type_name<T>());
+      }
+      values.push_back(value);
+    });
+  }
+  catch (...)
+  {
+    // Values of the children before the invalid one are dropped again
+    values.resize(size);
+    throw;
+  }
+  return values.size() - size;
+}
+
+#define UN_XML_DOM_INSTANTIATE_AS(T)                                                     \
+  template T Node::ContentPropertyType::as<T>() const;                                   \
+  template std::optional<T> Node::ContentPropertyType::try_as<T>() const;                \
+  template T Node::Attribute::as<T>() const;                                             \
+  template std::optional<T> Node::Attribute::try_as<T>() const;                          \
+  template std::size_t Node::children_as<T>(const char *, std::vector<T> &) const;
+
+UN_XML_DOM_INSTANTIATE_AS(int32_t)
+UN_XML_DOM_INSTANTIATE_AS(int64_t)
+UN_XML_DOM_INSTANTIATE_AS(uint32_t)
+UN_XML_DOM_INSTANTIATE_AS(uint64_t)
+UN_XML_DOM_INSTANTIATE_AS(float)
+UN_XML_DOM_INSTANTIATE_AS(double)
+UN_XML_DOM_INSTANTIATE_AS(bool)
+
+#undef UN_XML_DOM_INSTANTIATE_AS
+
 }
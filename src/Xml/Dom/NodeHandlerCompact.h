@@ -0,0 +1,569 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file NodeHandlerCompact.h
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief Read-only node handler over a compact tree
+ */
+
+#pragma once
+
+#include "CompactTree.h"
+#include "NodeHandlerLibxml2.h"
+#include <algorithm>
+#include <cstring>
+
+namespace un::Xml::Dom
+{
+
+class CompactNodeHandler : public Node::Handler
+{
+private:
+  std::shared_ptr<const CompactTree> _tree;
+  uint32_t _index;
+
+  /// Number of nodes a parallel visit task takes at once
+  static constexpr uint32_t visit_chunk_size = 4096;
+
+public:
+  CompactNodeHandler(const std::shared_ptr<const CompactTree> &tree, uint32_t index)
+    : _tree(tree), _index(index) {}
+
+  static Node make(const std::shared_ptr<const CompactTree> &tree, uint32_t index)
+  {
+    return Node(std::shared_ptr<Node::Handler>(new CompactNodeHandler(tree, index)));
+  }
+
+  bool is_frozen() const { return true; }
+
+  void check_mutable() const
+  {
+    throw std::runtime_error("Document is frozen");
+  }
+
+  const void *get_pointer() const
+  {
+    return &this->_tree->parent[this->_index];
+  }
+
+  xmlNodePtr clone() const
+  {
+    return this->_tree->expand_node(this->_index);
+  }
+
+  std::shared_ptr<xmlDoc> get_output_tree(xmlNodePtr &node) const
+  {
+    std::shared_ptr<xmlDoc> doc(xmlNewDoc(BAD_CAST "1.0"), xmlFreeDoc);
+    if (doc == nullptr)
+    {
+      throw std::runtime_error("xmlNewDoc failed");
+    }
+    node = this->_tree->expand(doc.get(), this->_index);
+    return doc;
+  }
+
+  uint64_t get_hash() const
+  {
+    return this->_tree->get_hash(this->_index);
+  }
+
+  const std::string get_content() const
+  {
+    return this->_tree->get_content(this->_index);
+  }
+
+  std::string_view get_content_view(std::string &storage) const
+  {
+    return this->_tree->get_content_view(this->_index, storage);
+  }
+
+  void each_child_content(const char *name,
+                          const std::function<void(std::string_view)> &callback) const
+  {
+    std::string storage;
+    for (uint32_t i = _tree->first_child[_index]; i != CompactTree::none; i = _tree->next_sibling[i])
+    {
+      const char *child_name = _tree->get_name(i);
+      if (_tree->type[i] == XML_ELEMENT_NODE && std::strcmp(child_name, name) == 0)
+      {
+        callback(_tree->get_content_view(i, storage));
+      }
+    }
+  }
+
+  void scan(Node::ScanSink &sink) const
+  {
+    for (uint32_t a = this->get_first_attribute(); a < this->get_last_attribute(); ++a)
+    {
+      int field = sink.find_attribute(_tree->get_string(_tree->attribute_name[a]));
+      if (field >= 0)
+      {
+        sink.on_content(field, std::string_view(_tree->pool.data + _tree->attribute_value[a],
+                                                _tree->attribute_value_size[a]));
+      }
+    }
+
+    std::string storage;
+    for (uint32_t i = _tree->first_child[_index]; i != CompactTree::none; i = _tree->next_sibling[i])
+    {
+      if (_tree->type[i] != XML_ELEMENT_NODE)
+      {
+        continue;
+      }
+
+      int field = sink.find_element(_tree->get_name(i));
+      if (field < 0)
+      {
+        continue;
+      }
+
+      if (sink.is_node_field(field))
+      {
+        sink.on_node(field, make(_tree, i));
+      }
+      else
+      {
+        sink.on_content(field, _tree->get_content_view(i, storage));
+      }
+    }
+  }
+
+  const std::string get_name() const
+  {
+    const char *name = this->_tree->get_name(this->_index);
+    return name == NULL ? std::string() : std::string(name);
+  }
+
+  class iterator : public Node::iterator_base
+  {
+  private:
+    std::shared_ptr<const CompactTree> _tree;
+    uint32_t _parent;
+    uint32_t _current;
+    Node _node;
+
+    void skip_blanks_forward()
+    {
+      while (_current != CompactTree::none && (_tree->flags[_current] & CompactTree::blank))
+      {
+        _current = _tree->next_sibling[_current];
+      }
+    }
+
+  public:
+    iterator(const std::shared_ptr<const CompactTree> &tree, uint32_t parent, uint32_t current)
+      : _tree(tree), _parent(parent), _current(current)
+    {
+      this->skip_blanks_forward();
+    }
+
+    void seek_to_next()
+    {
+      if (_current == CompactTree::none)
+      {
+        throw std::runtime_error("End of nodes reached");
+      }
+      _current = _tree->next_sibling[_current];
+      this->skip_blanks_forward();
+    }
+
+    void seek_to_previous()
+    {
+      do
+      {
+        uint32_t previous = _current == CompactTree::none ? _tree->last_child[_parent]
+                                                          : _tree->previous_sibling[_current];
+        if (previous == CompactTree::none)
+        {
+          throw std::runtime_error("Start of nodes reached");
+        }
+        _current = previous;
+      } while (_tree->flags[_current] & CompactTree::blank);
+    }
+
+    bool is_beginning() const { return _current == _tree->first_child[_parent]; }
+
+    bool is_end() const { return _current == CompactTree::none; }
+
+    Node &get_node()
+    {
+      if (_current == CompactTree::none)
+      {
+        throw std::runtime_error("End of nodes reached");
+      }
+      _node.handler = CompactNodeHandler::make(_tree, _current).handler;
+      return _node;
+    }
+
+    const void *get_address() const
+    {
+      return _current == CompactTree::none ? NULL : &_tree->parent[_current];
+    }
+  };
+
+  Node::iterator begin()
+  {
+    return Node::iterator(
+        new CompactNodeHandler::iterator(_tree, _index, _tree->first_child[_index]));
+  }
+
+  Node::iterator end()
+  {
+    return Node::iterator(new CompactNodeHandler::iterator(_tree, _index, CompactTree::none));
+  }
+
+  Node get_child(int index)
+  {
+    if (index < 0)
+    {
+      throw std::runtime_error("negative index");
+    }
+
+    for (uint32_t i = _tree->first_child[_index]; i != CompactTree::none; i = _tree->next_sibling[i])
+    {
+      if (_tree->type[i] != XML_TEXT_NODE && index-- == 0)
+      {
+        return make(_tree, i);
+      }
+    }
+
+    throw std::runtime_error("Out of range");
+  }
+
+  /// Child by name, nested children are separated by '/'
+  Node get_child(const char *const key)
+  {
+    uint32_t current = _index;
+    const char *segment = key;
+
+    while (current != CompactTree::none)
+    {
+      const char *separator = std::strchr(segment, '/');
+      std::size_t size = separator == NULL ? std::strlen(segment) : separator - segment;
+
+      uint32_t found = CompactTree::none;
+      for (uint32_t i = _tree->first_child[current]; i != CompactTree::none; i = _tree->next_sibling[i])
+      {
+        const char *name = _tree->get_name(i);
+        if (_tree->type[i] != XML_TEXT_NODE && name != NULL &&
+            std::strncmp(name, segment, size) == 0 && name[size] == 0)
+        {
+          found = i;
+          break;
+        }
+      }
+
+      if (separator == NULL || found == CompactTree::none)
+      {
+        current = found;
+        break;
+      }
+      current = found;
+      segment = separator + 1;
+    }
+
+    if (current == CompactTree::none)
+    {
+      return Node(std::shared_ptr<Node::Handler>());
+    }
+    return make(_tree, current);
+  }
+
+  std::string get_namespace_uri() const
+  {
+    uint32_t ns = _tree->ns[_index];
+    return ns == CompactTree::none ? std::string() : std::string(_tree->get_string(_tree->namespace_href[ns]));
+  }
+
+  /// Path URI index of a namespace of the tree, interned hrefs are compared as ids
+  static std::size_t resolve(const CompactTree &tree, const std::vector<std::size_t> &uri_ids, uint32_t ns)
+  {
+    if (ns == CompactTree::none)
+    {
+      return QualifiedPath::no_namespace;
+    }
+    for (std::size_t i = 0; i < uri_ids.size(); ++i)
+    {
+      if (uri_ids[i] == tree.namespace_href[ns])
+      {
+        return i;
+      }
+    }
+    return QualifiedPath::any_namespace;
+  }
+
+  static bool select(const std::shared_ptr<const CompactTree> &tree, uint32_t parent, const QualifiedPath &path,
+                     std::size_t depth, const std::vector<std::size_t> &uri_ids, std::vector<Node> &result,
+                     bool is_first_only)
+  {
+    const QualifiedPath::Step &step = path.steps[depth];
+    for (uint32_t i = tree->first_child[parent]; i != CompactTree::none; i = tree->next_sibling[i])
+    {
+      if (tree->type[i] != XML_ELEMENT_NODE || (!step.name.empty() && step.name != tree->get_name(i)) ||
+          (step.uri != QualifiedPath::any_namespace && resolve(*tree, uri_ids, tree->ns[i]) != step.uri))
+      {
+        continue;
+      }
+
+      if (depth + 1 < path.steps.size())
+      {
+        if (select(tree, i, path, depth + 1, uri_ids, result, is_first_only))
+        {
+          return true;
+        }
+        continue;
+      }
+
+      result.push_back(make(tree, i));
+      if (is_first_only)
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void select(const QualifiedPath &path, std::vector<Node> &result, bool is_first_only) const
+  {
+    if (path.steps.empty())
+    {
+      return;
+    }
+
+    // Name id of each path URI, none if no namespace of the tree has it
+    std::vector<std::size_t> uri_ids(path.uris.size(), CompactTree::none);
+    for (uint32_t ns = 0; ns < _tree->namespace_href.size; ++ns)
+    {
+      for (std::size_t i = 0; i < path.uris.size(); ++i)
+      {
+        if (uri_ids[i] == CompactTree::none && path.uris[i] == _tree->get_string(_tree->namespace_href[ns]))
+        {
+          uri_ids[i] = _tree->namespace_href[ns];
+        }
+      }
+    }
+    select(_tree, _index, path, 0, uri_ids, result, is_first_only);
+  }
+
+  std::size_t get_count() const
+  {
+    std::size_t result = 0;
+    for (uint32_t i = _tree->first_child[_index]; i != CompactTree::none; i = _tree->next_sibling[i])
+    {
+      result += _tree->type[i] != XML_TEXT_NODE;
+    }
+    return result;
+  }
+
+  /// Subtree is a contiguous index range, visiting is a linear scan
+  static void visit_range(const std::shared_ptr<const CompactTree> &tree, uint32_t first,
+                          uint32_t last, const Node::Visitor &visitor)
+  {
+    for (uint32_t i = first; i < last; ++i)
+    {
+      if (tree->type[i] == XML_ELEMENT_NODE)
+      {
+        visitor(make(tree, i));
+      }
+    }
+  }
+
+  void visit(const Node::Visitor &visitor) const
+  {
+    visit_range(_tree, _index, _tree->subtree_end(_index), visitor);
+  }
+
+  void visit_parallel(const Node::Visitor &visitor, std::size_t thread_count) const
+  {
+    WorkStealingScheduler scheduler(thread_count);
+    const std::shared_ptr<const CompactTree> &tree = _tree;
+    uint32_t end = _tree->subtree_end(_index);
+    for (uint32_t first = _index; first < end; first += std::min(visit_chunk_size, end - first))
+    {
+      uint32_t last = first + std::min(visit_chunk_size, end - first);
+      scheduler.submit([&tree, first, last, &visitor]() {
+        visit_range(tree, first, last, visitor);
+      });
+    }
+    scheduler.wait();
+  }
+
+  class Attribute : public Node::AttributeBase
+  {
+  private:
+    std::shared_ptr<const CompactTree> _tree;
+    uint32_t _index;
+
+  public:
+    Attribute(const std::shared_ptr<const CompactTree> &tree, uint32_t index)
+      : _tree(tree), _index(index) {}
+
+    const char *get_name() const
+    {
+      return _tree->get_string(_tree->attribute_name[_index]);
+    }
+
+    const char *get_value() const
+    {
+      return _tree->pool.data + _tree->attribute_value[_index];
+    }
+
+    void set_value(const char *)
+    {
+      throw std::runtime_error("Document is frozen");
+    }
+
+    void set_value(const std::string &)
+    {
+      throw std::runtime_error("Document is frozen");
+    }
+  };
+
+  uint32_t get_first_attribute() const
+  {
+    return _tree->type[_index] == XML_ELEMENT_NODE ? _tree->data[_index] : 0;
+  }
+
+  /// Attributes come before namespace declarations
+  uint32_t get_last_attribute() const
+  {
+    if (_tree->type[_index] != XML_ELEMENT_NODE)
+    {
+      return 0;
+    }
+    return _tree->data[_index] + static_cast<uint32_t>(_tree->get_attribute_count(_index));
+  }
+
+  Node::Attribute get_attribute_from_name(const char *name)
+  {
+    for (uint32_t i = this->get_first_attribute(); i < this->get_last_attribute(); ++i)
+    {
+      if (std::strcmp(_tree->get_string(_tree->attribute_name[i]), name) == 0)
+      {
+        return Node::Attribute(std::shared_ptr<Node::AttributeBase>(new Attribute(_tree, i)));
+      }
+    }
+
+    return Node::Attribute(std::shared_ptr<Node::AttributeBase>());
+  }
+
+  Node::Attribute get_attribute_ns(const char *uri, const char *name)
+  {
+    for (uint32_t i = this->get_first_attribute(); i < this->get_last_attribute(); ++i)
+    {
+      uint32_t ns = _tree->attribute_ns[i];
+      const char *href = ns == CompactTree::none ? "" : _tree->get_string(_tree->namespace_href[ns]);
+      if (std::strcmp(_tree->get_string(_tree->attribute_name[i]), name) == 0 &&
+          std::strcmp(href, uri == NULL ? "" : uri) == 0)
+      {
+        return Node::Attribute(std::shared_ptr<Node::AttributeBase>(new Attribute(_tree, i)));
+      }
+    }
+
+    return Node::Attribute(std::shared_ptr<Node::AttributeBase>());
+  }
+
+  Node::Attribute get_attribute_from_index(int index)
+  {
+    if (index < 0)
+    {
+      throw std::runtime_error("Negative range");
+    }
+
+    uint32_t attribute = this->get_first_attribute() + static_cast<uint32_t>(index);
+    if (attribute >= this->get_last_attribute())
+    {
+      throw std::runtime_error("Out of range");
+    }
+
+    return Node::Attribute(std::shared_ptr<Node::AttributeBase>(new Attribute(_tree, attribute)));
+  }
+
+  bool is_attributes_empty() const
+  {
+    return this->get_attributes_size() == 0;
+  }
+
+  std::size_t get_attributes_size() const
+  {
+    return _tree->type[_index] == XML_ELEMENT_NODE ? _tree->get_attribute_count(_index) : 0;
+  }
+
+  class AttributeIterator : public Node::AttributesPropertyType::iterator_base
+  {
+  private:
+    std::shared_ptr<const CompactTree> _tree;
+    uint32_t _current;
+    uint32_t _begin;
+    uint32_t _end;
+
+  public:
+    AttributeIterator(const std::shared_ptr<const CompactTree> &tree, uint32_t current,
+                      uint32_t begin, uint32_t end)
+      : _tree(tree), _current(current), _begin(begin), _end(end) {}
+
+    Node::Attribute get_node_attr()
+    {
+      return Node::Attribute(std::shared_ptr<Node::AttributeBase>(
+          new CompactNodeHandler::Attribute(_tree, _current)));
+    }
+
+    const Node::Attribute get_node_attr() const
+    {
+      return Node::Attribute(std::shared_ptr<Node::AttributeBase>(
+          new CompactNodeHandler::Attribute(_tree, _current)));
+    }
+
+    void seek_to_next()
+    {
+      if (_current == _end)
+      {
+        throw std::runtime_error("Iterator reached end allready");
+      }
+      ++_current;
+    }
+
+    void seek_to_previous()
+    {
+      if (_current == _begin)
+      {
+        throw std::runtime_error("Cannot seek from first to below first!");
+      }
+      --_current;
+    }
+
+    void *get_pointer() const
+    {
+      return _current == _end ? NULL : const_cast<uint32_t *>(&_tree->attribute_name[_current]);
+    }
+
+    bool is_equal_to(const Node::AttributesPropertyType::iterator_base *rhs) const
+    {
+      return this->get_pointer() == rhs->get_pointer();
+    }
+  };
+
+  std::shared_ptr<Node::AttributesPropertyType::iterator_base> begin_attr()
+  {
+    return std::shared_ptr<Node::AttributesPropertyType::iterator_base>(new AttributeIterator(
+        _tree, this->get_first_attribute(), this->get_first_attribute(), this->get_last_attribute()));
+  }
+
+  const std::shared_ptr<Node::AttributesPropertyType::iterator_base> begin_attr() const
+  {
+    return const_cast<CompactNodeHandler *>(this)->begin_attr();
+  }
+
+  std::shared_ptr<Node::AttributesPropertyType::iterator_base> end_attr()
+  {
+    return std::shared_ptr<Node::AttributesPropertyType::iterator_base>(new AttributeIterator(
+        _tree, this->get_last_attribute(), this->get_first_attribute(), this->get_last_attribute()));
+  }
+
+  const std::shared_ptr<Node::AttributesPropertyType::iterator_base> end_attr() const
+  {
+    return const_cast<CompactNodeHandler *>(this)->end_attr();
+  }
+};
+
+}
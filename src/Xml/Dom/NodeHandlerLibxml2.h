@@ -8,23 +8,25 @@
 
 #pragma once
 
+#include <Xml/Dom/Document.h>
 #include <Xml/Dom/Node.h>
+#include <Xml/Dom/QualifiedPath.h>
+#include "StructuralHash.h"
+#include "WorkStealingScheduler.h"
+#include <atomic>
 #include <cstring>
+#include <deque>
 #include <iostream>
 #include <libxml/parser.h>
 #include <libxml/xmlmemory.h>
 #include <list>
 #include <memory>
 #include <string>
+#include <string_view>
 
 namespace un::Xml::Dom
 {
 
-// TODO: Give option to either throw exception or give ability to create new node
-static Node empty_node;
-
-struct Document;
-
 class Node::Handler
 {
 public:
@@ -100,7 +102,26 @@ private:
     return NULL;
   }
 
-  Node &_get_child(xmlNodePtr node)
+  /**
+   * Returns binding of given child node. Frozen documents are shared between
+   * threads so they get a fresh binding instead of touching the nodes cache.
+   */
+  Node _get_child(xmlNodePtr node)
+  {
+    if (this->is_frozen())
+    {
+      if (node == NULL)
+      {
+        throw std::runtime_error(this->handler->children == NULL ? "Node has no children"
+                                                                 : "Node is not child of this node.");
+      }
+      return bind(node);
+    }
+
+    return this->_get_cached_child(node);
+  }
+
+  Node &_get_cached_child(xmlNodePtr node)
   {
     if (this->handler->children == NULL)
     {
@@ -164,6 +185,17 @@ public:
     this->is_owner = true;
   }
 
+  Handler(const Namespace &ns, const char *name) : Handler(name)
+  {
+    xmlNsPtr declaration =
+        xmlNewNs(handler, BAD_CAST ns.uri.c_str(), ns.prefix.empty() ? NULL : BAD_CAST ns.prefix.c_str());
+    if (declaration == NULL)
+    {
+      throw std::runtime_error("xmlNewNs failed");
+    }
+    xmlSetNs(handler, declaration);
+  }
+
   Handler(const char *name, const char *content)
       : handler(NULL), is_owner(false)
   {
@@ -179,7 +211,7 @@ public:
     this->is_owner = true;
   }
 
-  ~Handler()
+  virtual ~Handler()
   {
     if (this->is_owner && handler != NULL)
     {
@@ -187,7 +219,262 @@ public:
     }
   }
 
-  const std::string get_content() const
+  /// Returns true if node belongs to a frozen document
+  static bool is_frozen(xmlDocPtr doc);
+
+  /// Returns true if document has no blank text nodes, see Document::normalize
+  static bool is_normalized(xmlDocPtr doc);
+
+  virtual bool is_frozen() const
+  {
+    return this->handler != NULL && is_frozen(this->handler->doc);
+  }
+
+  /// Throws if node belongs to a frozen document
+  static void check_mutable(xmlDocPtr doc)
+  {
+    if (is_frozen(doc))
+    {
+      throw std::runtime_error("Document is frozen");
+    }
+  }
+
+  /**
+   * Mutation notifications to the document owning node (see
+   * DocumentHandlerLibxml2.h), no-op for nodes without a document. Subtree
+   * notifications cover node and everything below it, element ones only the
+   * element itself (name and attributes) and text nodes their content. An
+   * attribute that is changed or removed is passed along, it is NULL when
+   * attributes are added or the element is renamed.
+   */
+  static void notify_inserted(xmlNodePtr node);
+  static void notify_removing(xmlNodePtr node);
+  static void notify_changing(xmlNodePtr element, xmlAttrPtr attribute = NULL);
+  static void notify_changed(xmlNodePtr element);
+
+  /**
+   * Groups notifications of one operation into one undo step while alive.
+   * Removals of a sibling run are notified last first so the journal can
+   * replay them one at a time.
+   */
+  class Batch
+  {
+  private:
+    xmlDocPtr _doc;
+
+  public:
+    explicit Batch(xmlDocPtr doc);
+    ~Batch();
+
+    Batch(const Batch &) = delete;
+    Batch &operator=(const Batch &) = delete;
+  };
+
+  virtual void check_mutable() const
+  {
+    if (this->handler != NULL)
+    {
+      check_mutable(this->handler->doc);
+    }
+  }
+
+  /// Unique address of bound node, used for equality
+  virtual const void *get_pointer() const
+  {
+    return this->handler;
+  }
+
+  /// Deep copy of bound node without a document, owned by the caller
+  virtual xmlNodePtr clone() const
+  {
+    return xmlDocCopyNode(this->handler, NULL, 1);
+  }
+
+  /**
+   * Document to write the subtree of bound node from, node is set to the
+   * bound node in it. Nodes not linked under their document are copied into
+   * a temporary one.
+   */
+  virtual std::shared_ptr<xmlDoc> get_output_tree(xmlNodePtr &node) const
+  {
+    xmlNodePtr top = this->handler;
+    while (top->parent != NULL)
+    {
+      top = top->parent;
+    }
+    if (this->handler->doc != NULL && top == (xmlNodePtr)this->handler->doc)
+    {
+      node = this->handler;
+      return std::shared_ptr<xmlDoc>(this->handler->doc, [](xmlDocPtr) {});
+    }
+
+    std::shared_ptr<xmlDoc> doc(xmlNewDoc(BAD_CAST "1.0"), xmlFreeDoc);
+    if (doc == nullptr)
+    {
+      throw std::runtime_error("xmlNewDoc failed");
+    }
+    node = xmlDocCopyNode(this->handler, doc.get(), 1);
+    if (node == NULL)
+    {
+      throw std::runtime_error("xmlDocCopyNode failed");
+    }
+    xmlAddChild((xmlNodePtr)doc.get(), node);
+    return doc;
+  }
+
+  /**
+   * Structural hash of node, see StructuralHash.h. Hashes of elements are
+   * cached in _private of the node; a cached element always has its
+   * descendants cached, so invalidation can stop at the first ancestor
+   * without a cached hash. Frozen documents may be hashed from many threads,
+   * hence the atomic access.
+   */
+  static uint64_t get_hash(xmlNodePtr node)
+  {
+    bool is_element = node->type == XML_ELEMENT_NODE;
+    if (is_element)
+    {
+      uint64_t cached = reinterpret_cast<uintptr_t>(std::atomic_ref<void *>(node->_private).load(std::memory_order_relaxed));
+      if (cached != 0)
+      {
+        return cached;
+      }
+    }
+
+    // Compact trees store entity references as their text
+    int type = node->type == XML_ENTITY_REF_NODE ? XML_TEXT_NODE : node->type;
+    const char *name = is_element || type == XML_PI_NODE ? (const char *)node->name : NULL;
+    const char *href = is_element && node->ns != NULL ? (const char *)node->ns->href : NULL;
+    uint64_t hash = StructuralHash::start(type, name, href);
+
+    if (is_element)
+    {
+      uint64_t attributes = 0;
+      std::string storage;
+      for (xmlAttrPtr attribute = node->properties; attribute != NULL; attribute = attribute->next)
+      {
+        attributes += StructuralHash::attribute((const char *)attribute->name,
+                                                attribute->ns == NULL ? NULL : (const char *)attribute->ns->href,
+                                                get_content_view((xmlNodePtr)attribute, storage));
+      }
+      hash = StructuralHash::combine(hash, attributes);
+
+      for (xmlNodePtr child = node->children; child != NULL; child = child->next)
+      {
+        hash = StructuralHash::combine(hash, get_hash(child));
+      }
+    }
+    else if (node->type == XML_ENTITY_REF_NODE)
+    {
+      xmlChar *content = xmlNodeGetContent(node);
+      hash = StructuralHash::combine(hash, StructuralHash::string(content == NULL ? "" : (const char *)content));
+      xmlFree(content);
+    }
+    else
+    {
+      hash = StructuralHash::combine(hash, StructuralHash::string(node->content == NULL ? "" : (const char *)node->content));
+    }
+
+    hash = StructuralHash::finish(hash);
+    if (is_element && sizeof(void *) >= sizeof(uint64_t))
+    {
+      std::atomic_ref<void *>(node->_private).store(reinterpret_cast<void *>(hash), std::memory_order_relaxed);
+    }
+    return hash;
+  }
+
+  /// Drop cached hashes of node, or its parent if it is not an element, and their ancestors
+  static void invalidate_hash(xmlNodePtr node)
+  {
+    if (node != NULL && node->type != XML_ELEMENT_NODE)
+    {
+      node = node->parent;
+    }
+    for (xmlNodePtr i = node; i != NULL && i->type == XML_ELEMENT_NODE && i->_private != NULL; i = i->parent)
+    {
+      i->_private = NULL;
+    }
+  }
+
+  /// Structural comparison matching get_hash, children with different hashes are not walked
+  static bool is_equal(xmlNodePtr a, xmlNodePtr b, bool ordered_attributes)
+  {
+    if (a == b)
+    {
+      return true;
+    }
+    if (get_hash(a) != get_hash(b))
+    {
+      return false;
+    }
+
+    int a_type = a->type == XML_ENTITY_REF_NODE ? XML_TEXT_NODE : a->type;
+    int b_type = b->type == XML_ENTITY_REF_NODE ? XML_TEXT_NODE : b->type;
+    if (a_type != b_type)
+    {
+      return false;
+    }
+
+    if (a->type != XML_ELEMENT_NODE)
+    {
+      std::string a_storage;
+      std::string b_storage;
+      return (a_type != XML_PI_NODE || xmlStrEqual(a->name, b->name)) &&
+             get_content_view(a, a_storage) == get_content_view(b, b_storage);
+    }
+
+    if (!xmlStrEqual(a->name, b->name) ||
+        !xmlStrEqual(a->ns == NULL ? NULL : a->ns->href, b->ns == NULL ? NULL : b->ns->href))
+    {
+      return false;
+    }
+
+    std::string a_storage;
+    std::string b_storage;
+    xmlAttrPtr i = a->properties;
+    xmlAttrPtr j = b->properties;
+    for (; i != NULL && j != NULL; i = i->next, j = j->next)
+    {
+      xmlAttrPtr match = j;
+      if (!ordered_attributes)
+      {
+        match = xmlHasNsProp(b, i->name, i->ns == NULL ? NULL : i->ns->href);
+      }
+      else if (!xmlStrEqual(i->name, j->name) ||
+               !xmlStrEqual(i->ns == NULL ? NULL : i->ns->href, j->ns == NULL ? NULL : j->ns->href))
+      {
+        return false;
+      }
+
+      if (match == NULL || get_content_view((xmlNodePtr)i, a_storage) !=
+                               get_content_view((xmlNodePtr)match, b_storage))
+      {
+        return false;
+      }
+    }
+    if (i != NULL || j != NULL)
+    {
+      return false;
+    }
+
+    xmlNodePtr x = a->children;
+    xmlNodePtr y = b->children;
+    for (; x != NULL && y != NULL; x = x->next, y = y->next)
+    {
+      if (!is_equal(x, y, ordered_attributes))
+      {
+        return false;
+      }
+    }
+    return x == NULL && y == NULL;
+  }
+
+  virtual uint64_t get_hash() const
+  {
+    return get_hash(this->handler);
+  }
+
+  virtual const std::string get_content() const
   {
     char *_cont = reinterpret_cast<char *>(xmlNodeGetContent(handler));
     if (_cont == NULL)
@@ -201,14 +488,116 @@ public:
     return result;
   }
 
+  /**
+   * Content of node without copying when it is a single text node, otherwise
+   * content is copied into storage.
+   */
+  static std::string_view get_content_view(xmlNodePtr node, std::string &storage)
+  {
+    xmlNodePtr text = node;
+    if (node->type == XML_ELEMENT_NODE || node->type == XML_ATTRIBUTE_NODE)
+    {
+      text = node->children;
+      if (text == NULL)
+      {
+        return std::string_view();
+      }
+    }
+
+    if ((text->type == XML_TEXT_NODE || text->type == XML_CDATA_SECTION_NODE) &&
+        (text == node || text->next == NULL))
+    {
+      return text->content == NULL ? std::string_view() : std::string_view((const char *)text->content);
+    }
+
+    xmlChar *content = xmlNodeGetContent(node);
+    storage = content == NULL ? "" : (const char *)content;
+    xmlFree(content);
+    return storage;
+  }
+
+  virtual std::string_view get_content_view(std::string &storage) const
+  {
+    return get_content_view(this->handler, storage);
+  }
+
+  /// Calls callback with content of every child element with given name
+  virtual void each_child_content(const char *name,
+                                  const std::function<void(std::string_view)> &callback) const
+  {
+    std::string storage;
+    for (xmlNodePtr i = this->handler->children; i != NULL; i = i->next)
+    {
+      if (i->type == XML_ELEMENT_NODE && std::strcmp((const char *)i->name, name) == 0)
+      {
+        callback(get_content_view(i, storage));
+      }
+    }
+  }
+
+  virtual void scan(Node::ScanSink &sink) const
+  {
+    std::string storage;
+    for (xmlAttrPtr attr = this->handler->properties; attr != NULL; attr = attr->next)
+    {
+      int field = sink.find_attribute((const char *)attr->name);
+      if (field >= 0)
+      {
+        sink.on_content(field, get_content_view(reinterpret_cast<xmlNodePtr>(attr), storage));
+      }
+    }
+
+    for (xmlNodePtr i = this->handler->children; i != NULL; i = i->next)
+    {
+      if (i->type != XML_ELEMENT_NODE)
+      {
+        continue;
+      }
+
+      int field = sink.find_element((const char *)i->name);
+      if (field < 0)
+      {
+        continue;
+      }
+
+      if (sink.is_node_field(field))
+      {
+        sink.on_node(field, bind(i));
+      }
+      else
+      {
+        sink.on_content(field, get_content_view(i, storage));
+      }
+    }
+  }
+
   void set_content(const std::string &content)
   {
-    xmlNodeSetContent(handler, BAD_CAST content.c_str());
+    this->set_content(content.c_str());
   }
 
   void set_content(const char *cont)
   {
+    this->check_mutable();
+    if (handler->type != XML_ELEMENT_NODE)
+    {
+      notify_changing(handler);
+      xmlNodeSetContent(handler, BAD_CAST cont);
+      notify_changed(handler);
+      return;
+    }
+
+    // Children of an element are freed, indexes must drop them first
+    Batch batch(handler->doc);
+    for (xmlNodePtr i = handler->last; i != NULL; i = i->prev)
+    {
+      notify_removing(i);
+    }
     xmlNodeSetContent(handler, BAD_CAST cont);
+    for (xmlNodePtr i = handler->children; i != NULL; i = i->next)
+    {
+      notify_inserted(i);
+    }
   }
 
   void set_content(const char *cont, std::size_t size)
@@ -216,7 +605,7 @@ public:
     this->set_content(std::string(cont, size));
   }
 
-  const std::string get_name() const
+  virtual const std::string get_name() const
   {
     if (handler->name != NULL)
     {
@@ -228,7 +617,10 @@ public:
 
   void set_name(const std::string &name)
   {
+    this->check_mutable();
+    notify_changing(handler);
     xmlNodeSetName(handler, BAD_CAST name.c_str());
+    notify_changed(handler);
   }
 
   class iterator : public Node::iterator_base
@@ -239,6 +631,13 @@ public:
     xmlNodePtr _first_ptr;
     xmlNodePtr _last_ptr;
     bool _is_last;
+    bool _has_blanks; // False for normalized documents, blank checks are skipped
+    Node _node; // Binding of current node for frozen documents
+
+    bool is_blank() const
+    {
+      return this->_has_blanks && xmlIsBlankNode(_ptr);
+    }
 
   public:
     iterator(Node::Handler *current_node, xmlNodePtr ptr, xmlNodePtr first_ptr, xmlNodePtr last_ptr, bool is_last)
@@ -246,9 +645,10 @@ public:
         _ptr(ptr),
         _first_ptr(first_ptr),
         _last_ptr(last_ptr),
-        _is_last(is_last)
+        _is_last(is_last),
+        _has_blanks(current_node->handler == NULL || !is_normalized(current_node->handler->doc))
     {
-      if (!is_last && ptr != NULL && xmlIsBlankNode(_ptr))
+      if (!is_last && ptr != NULL && this->is_blank())
       {
         this->seek_to_next();
       }
@@ -273,7 +673,7 @@ public:
         {
           _ptr = _ptr->next;
         }
-      } while (xmlIsBlankNode(_ptr));
+      } while (this->is_blank());
     }
 
     void seek_to_previous()
@@ -296,7 +696,7 @@ public:
             _ptr = _ptr->prev;
           }
         }
-      } while (xmlIsBlankNode(_ptr));
+      } while (this->is_blank());
     }
 
     bool is_beginning() const { return this->_ptr == _first_ptr; }
@@ -309,7 +709,12 @@ public:
       {
         throw std::runtime_error("End of nodes reached");
       }
-      return _current_node->_get_child(this->_ptr);
+      if (_current_node->is_frozen())
+      {
+        _node.handler = _current_node->_get_child(this->_ptr).handler;
+        return _node;
+      }
+      return _current_node->_get_cached_child(this->_ptr);
     }
 
     const void *get_address() const { return (const void *)_ptr; }
@@ -320,19 +725,19 @@ public:
     }
   };
 
-  Node::iterator begin()
+  virtual Node::iterator begin()
   {
     return Node::iterator(new Node::Handler::iterator(
         this, handler->children, handler->children, handler->last, false));
   }
 
-  Node::iterator end()
+  virtual Node::iterator end()
   {
     return Node::iterator(new Node::Handler::iterator(
         this, NULL, handler->children, handler->last, true));
   }
 
-  Node &get_child(int index)
+  virtual Node get_child(int index)
   {
     if (index < 0)
     {
@@ -342,27 +747,211 @@ public:
     return _get_child(node);
   }
 
-  Node &get_child(const char *const key)
+  virtual Node get_child(const char *const key)
   {
     xmlNodePtr node = get_child_rec(this->handler, key);
     if (node == NULL)
     {
-      return empty_node;
+      return Node(std::shared_ptr<Node::Handler>());
     }
     return _get_child(node);
   }
 
-  Node &get_child(const std::string &key)
+  Node get_child(const std::string &key)
   {
-    xmlNodePtr node = get_child_rec(this->handler, key.c_str());
-    if (node == NULL)
+    return this->get_child(key.c_str());
+  }
+
+  virtual std::string get_namespace_uri() const
+  {
+    return handler->ns == NULL || handler->ns->href == NULL ? std::string()
+                                                            : std::string((const char *)handler->ns->href);
+  }
+
+  /// Namespace declarations met while selecting, resolved to path URI indexes
+  class NamespaceResolver
+  {
+  private:
+    const QualifiedPath &_path;
+    std::vector<std::pair<xmlNsPtr, std::size_t>> _resolved;
+
+  public:
+    explicit NamespaceResolver(const QualifiedPath &path) : _path(path) {}
+
+    /// Index into path URIs, no_namespace or any_namespace when none matches
+    std::size_t resolve(xmlNsPtr ns)
     {
-      return empty_node;
+      if (ns == NULL)
+      {
+        return QualifiedPath::no_namespace;
+      }
+      for (const std::pair<xmlNsPtr, std::size_t> &i : this->_resolved)
+      {
+        if (i.first == ns)
+        {
+          return i.second;
+        }
+      }
+
+      std::size_t uri = QualifiedPath::any_namespace;
+      for (std::size_t i = 0; i < this->_path.uris.size(); ++i)
+      {
+        if (xmlStrEqual(ns->href, BAD_CAST this->_path.uris[i].c_str()))
+        {
+          uri = i;
+          break;
+        }
+      }
+      this->_resolved.emplace_back(ns, uri);
+      return uri;
+    }
+  };
+
+  /// Walks steps from depth below parent, returns true to stop
+  static bool select(xmlNodePtr parent, const QualifiedPath &path, std::size_t depth, NamespaceResolver &resolver,
+                     std::vector<Node> &result, bool is_first_only)
+  {
+    const QualifiedPath::Step &step = path.steps[depth];
+    for (xmlNodePtr i = parent->children; i != NULL; i = i->next)
+    {
+      if (i->type != XML_ELEMENT_NODE || (!step.name.empty() && !xmlStrEqual(i->name, BAD_CAST step.name.c_str())) ||
+          (step.uri != QualifiedPath::any_namespace && resolver.resolve(i->ns) != step.uri))
+      {
+        continue;
+      }
+
+      if (depth + 1 < path.steps.size())
+      {
+        if (select(i, path, depth + 1, resolver, result, is_first_only))
+        {
+          return true;
+        }
+        continue;
+      }
+
+      result.push_back(bind(i));
+      if (is_first_only)
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// Elements matching path below this node, see QualifiedPath
+  virtual void select(const QualifiedPath &path, std::vector<Node> &result, bool is_first_only) const
+  {
+    if (path.steps.empty())
+    {
+      return;
+    }
+    NamespaceResolver resolver(path);
+    select(handler, path, 0, resolver, result, is_first_only);
+  }
+
+  /// Range of count siblings starting from first
+  struct SiblingRange
+  {
+    xmlNodePtr first;
+    std::size_t count;
+  };
+
+  /// Number of siblings a parallel visit task takes at once
+  static const std::size_t visit_chunk_size = 64;
+
+  static Node bind(xmlNodePtr node)
+  {
+    return Node(std::shared_ptr<Node::Handler>(new Node::Handler(node, false)));
+  }
+
+  virtual void visit(const Node::Visitor &visitor) const
+  {
+    xmlNodePtr i = this->handler;
+    while (i != NULL)
+    {
+      if (i->type == XML_ELEMENT_NODE)
+      {
+        visitor(bind(i));
+
+        if (i->children != NULL)
+        {
+          i = i->children;
+          continue;
+        }
+      }
+
+      while (i != this->handler && i->next == NULL)
+      {
+        i = i->parent;
+      }
+
+      if (i == this->handler)
+      {
+        break;
+      }
+      i = i->next;
     }
-    return _get_child(node);
   }
 
-  inline std::size_t get_count() const
+  static void visit_range(WorkStealingScheduler &scheduler, SiblingRange range,
+                          const Node::Visitor &visitor)
+  {
+    std::deque<SiblingRange> ranges(1, range);
+
+    while (!ranges.empty())
+    {
+      SiblingRange current = ranges.back();
+      ranges.pop_back();
+
+      xmlNodePtr i = current.first;
+      for (std::size_t n = 0; n < current.count; ++n, i = i->next)
+      {
+        if (i->type != XML_ELEMENT_NODE)
+        {
+          continue;
+        }
+
+        visitor(bind(i));
+
+        for (xmlNodePtr first = i->children; first != NULL;)
+        {
+          SiblingRange children = {first, 0};
+          for (; first != NULL && children.count < visit_chunk_size; first = first->next)
+          {
+            ++children.count;
+          }
+          ranges.push_back(children);
+        }
+      }
+
+      // Keep the most recent range, let other workers steal the rest
+      while (ranges.size() > 1)
+      {
+        SiblingRange shared = ranges.front();
+        ranges.pop_front();
+        scheduler.submit([&scheduler, shared, &visitor]() {
+          visit_range(scheduler, shared, visitor);
+        });
+      }
+    }
+  }
+
+  virtual void visit_parallel(const Node::Visitor &visitor, std::size_t thread_count) const
+  {
+    if (!this->is_frozen())
+    {
+      throw std::runtime_error("Parallel visit needs a frozen document");
+    }
+
+    WorkStealingScheduler scheduler(thread_count);
+    SiblingRange root = {this->handler, 1};
+    scheduler.submit([&scheduler, root, &visitor]() {
+      visit_range(scheduler, root, visitor);
+    });
+    scheduler.wait();
+  }
+
+  virtual std::size_t get_count() const
   {
     std::size_t result = 0;
 
@@ -378,11 +967,13 @@ public:
 
   bool is_equal(const Node &rhs) const
   {
-    return this->handler == rhs.handler->handler;
+    return this->get_pointer() == rhs.handler->get_pointer();
   }
 
   void remove(const Node &node)
   {
+    this->check_mutable();
+
     if (node.handler->is_owner)
     {
       throw std::runtime_error("Node is not belong(child node of) to any document or node");
@@ -393,13 +984,56 @@ public:
       if (node.handler->handler == i)
       {
         node.handler->is_owner = true;
+        notify_removing(i);
         xmlUnlinkNode(i);
+        release(i, i->doc == NULL ? NULL : i->doc->dict);
+        xmlSetTreeDoc(i, NULL);
+        break;
+      }
+    }
+  }
+
+  /**
+   * Copies strings of removed subtree interned in dictionary of its document,
+   * so the subtree can outlive the document.
+   */
+  static void release(xmlNodePtr node, xmlDictPtr dict)
+  {
+    if (dict == NULL)
+    {
+      return;
+    }
+
+    if (node->name != NULL && xmlDictOwns(dict, node->name) == 1)
+    {
+      node->name = xmlStrdup(node->name);
+    }
+    if (node->type != XML_ELEMENT_NODE && node->type != XML_ATTRIBUTE_NODE && node->content != NULL &&
+        xmlDictOwns(dict, node->content) == 1)
+    {
+      node->content = xmlStrdup(node->content);
+    }
+
+    if (node->type == XML_ELEMENT_NODE)
+    {
+      for (xmlAttrPtr i = node->properties; i != NULL; i = i->next)
+      {
+        release(reinterpret_cast<xmlNodePtr>(i), dict);
+      }
+    }
+    if (node->type == XML_ELEMENT_NODE || node->type == XML_ATTRIBUTE_NODE)
+    {
+      for (xmlNodePtr i = node->children; i != NULL; i = i->next)
+      {
+        release(i, dict);
       }
     }
   }
 
   void push_back(const Node &node)
   {
+    this->check_mutable();
+
     if (!node.handler->is_owner)
     {
       throw std::runtime_error("Node is owned by another document or node");
@@ -417,11 +1051,14 @@ public:
       {
         nodes.push_back(node);
       }
+      notify_inserted(node.handler->handler);
     }
   }
 
   void push_front(const Node &node)
   {
+    this->check_mutable();
+
     if (!node.handler->is_owner)
     {
       throw std::runtime_error("Node is owned by another document or node");
@@ -441,6 +1078,7 @@ public:
         {
           nodes.push_back(node);
         }
+        notify_inserted(node.handler->handler);
       }
       else
       {
@@ -449,16 +1087,204 @@ public:
     }
   }
 
+  /**
+   * Links free nodes as one sibling chain before position, which is a child of
+   * this node or NULL for the end. Every node is checked before anything is
+   * linked so a failing call leaves the tree as it was. Unlike push_back,
+   * adjacent text nodes are not merged and bound nodes are not cached, they
+   * stay valid as non owning bindings.
+   *
+   * Unlike splice, no dictionary strings need copying: free nodes are either
+   * new, cloned without a document, or released by remove when unlinked.
+   */
+  void insert_range(xmlNodePtr position, const Node *first, const Node *last)
+  {
+    this->check_mutable();
+
+    if (position != NULL && position->parent != this->handler)
+    {
+      throw std::runtime_error("Position is not a child of this node");
+    }
+
+    xmlNodePtr top = this->handler;
+    while (top->parent != NULL)
+    {
+      top = top->parent;
+    }
+
+    // Ownership is taken while checking so a node listed twice fails too
+    for (const Node *i = first; i != last; ++i)
+    {
+      if (i->handler == nullptr || !i->handler->is_owner || i->handler->handler == top)
+      {
+        for (const Node *j = first; j != i; ++j)
+        {
+          j->handler->is_owner = true;
+        }
+        throw std::runtime_error(i->handler != nullptr && i->handler->handler == top
+                                     ? "Cannot insert node below itself"
+                                     : "Node is owned by another document or node");
+      }
+      i->handler->is_owner = false;
+    }
+
+    if (first == last)
+    {
+      return;
+    }
+
+    xmlNodePtr head = NULL;
+    xmlNodePtr tail = NULL;
+    for (const Node *i = first; i != last; ++i)
+    {
+      xmlNodePtr node = i->handler->handler;
+      node->parent = this->handler;
+      node->prev = tail;
+      node->next = NULL;
+      if (node->doc != this->handler->doc)
+      {
+        xmlSetTreeDoc(node, this->handler->doc);
+      }
+
+      if (tail == NULL)
+      {
+        head = node;
+      }
+      else
+      {
+        tail->next = node;
+      }
+      tail = node;
+    }
+
+    Batch batch(this->handler->doc);
+    this->link_chain(position, head, tail);
+
+    for (xmlNodePtr i = head; i != position; i = i->next)
+    {
+      notify_inserted(i);
+    }
+  }
+
+  /// Position to insert at for inserting after given child
+  xmlNodePtr get_position_after(xmlNodePtr child) const
+  {
+    this->check_mutable();
+
+    if (child == NULL)
+    {
+      throw std::runtime_error("Cannot insert after end");
+    }
+    if (child->parent != this->handler)
+    {
+      throw std::runtime_error("Position is not a child of this node");
+    }
+    return child->next;
+  }
+
+  /// Moves every child of source before position, see insert_range
+  void splice(xmlNodePtr position, const Node &source)
+  {
+    this->check_mutable();
+    source.handler->check_mutable();
+
+    if (position != NULL && position->parent != this->handler)
+    {
+      throw std::runtime_error("Position is not a child of this node");
+    }
+
+    xmlNodePtr parent = source.handler->handler;
+    for (xmlNodePtr i = this->handler; i != NULL; i = i->parent)
+    {
+      if (i == parent)
+      {
+        throw std::runtime_error("Cannot insert node below itself");
+      }
+    }
+
+    bool is_same_doc = parent->doc == this->handler->doc;
+    // Strings interned in the source dictionary must not outlive the source document
+    xmlDictPtr dict = is_same_doc || parent->doc == NULL ? NULL : parent->doc->dict;
+    if (dict != NULL && this->handler->doc != NULL && this->handler->doc->dict == dict)
+    {
+      dict = NULL;
+    }
+
+    xmlNodePtr head = parent->children;
+    xmlNodePtr tail = parent->last;
+    if (head == NULL)
+    {
+      return;
+    }
+
+    Batch batch(this->handler->doc);
+    Batch source_batch(parent->doc);
+    for (xmlNodePtr i = tail; i != NULL; i = i->prev)
+    {
+      notify_removing(i);
+    }
+    parent->children = NULL;
+    parent->last = NULL;
+
+    for (xmlNodePtr i = head; i != NULL; i = i->next)
+    {
+      i->parent = this->handler;
+      if (!is_same_doc)
+      {
+        release(i, dict);
+        xmlSetTreeDoc(i, this->handler->doc);
+      }
+    }
+
+    this->link_chain(position, head, tail);
+
+    for (xmlNodePtr i = head; i != position; i = i->next)
+    {
+      notify_inserted(i);
+    }
+  }
+
+private:
+  /// Links a chain whose nodes already point to this node as parent
+  void link_chain(xmlNodePtr position, xmlNodePtr head, xmlNodePtr tail)
+  {
+    xmlNodePtr previous = position == NULL ? this->handler->last : position->prev;
+
+    head->prev = previous;
+    tail->next = position;
+
+    if (previous == NULL)
+    {
+      this->handler->children = head;
+    }
+    else
+    {
+      previous->next = head;
+    }
+
+    if (position == NULL)
+    {
+      this->handler->last = tail;
+    }
+    else
+    {
+      position->prev = tail;
+    }
+  }
+
+public:
   Node &pop_back()
   {
-    Node &last = this->_get_child(this->handler->last);
+    this->check_mutable();
+    Node &last = this->_get_cached_child(this->handler->last);
     this->remove(last);
     return last;
   }
 
   Node &pop_front()
   {
-    Node &first = this->_get_child(this->handler->children);
+    this->check_mutable();
+    Node &first = this->_get_cached_child(this->handler->children);
     this->remove(first);
     return first;
   }
@@ -494,16 +1320,22 @@ public:
 
     virtual void set_value(const char *val)
     {
+      Node::Handler::check_mutable(this->handler->doc);
+      Node::Handler::notify_changing(this->handler->parent, this->handler);
       xmlNodeSetContent(this->handler->children, BAD_CAST val);
+      Node::Handler::notify_changed(this->handler->parent);
     }
 
     virtual void set_value(const std::string &val)
     {
+      Node::Handler::check_mutable(this->handler->doc);
+      Node::Handler::notify_changing(this->handler->parent, this->handler);
       xmlNodeSetContent(this->handler->children, BAD_CAST val.c_str());
+      Node::Handler::notify_changed(this->handler->parent);
     }
   };
 
-  Node::Attribute get_attribute_from_name(const char *name)
+  virtual Node::Attribute get_attribute_from_name(const char *name)
   {
     for (xmlAttrPtr attr = this->handler->properties; attr != NULL;
          attr = attr->next)
@@ -524,7 +1356,18 @@ public:
     return this->get_attribute_from_name(name.c_str());
   }
 
-  Node::Attribute get_attribute_from_index(int index)
+  /// Attribute by namespace URI, NULL or empty for no namespace
+  virtual Node::Attribute get_attribute_ns(const char *uri, const char *name)
+  {
+    xmlAttrPtr attr = xmlHasNsProp(this->handler, BAD_CAST name, uri == NULL || *uri == 0 ? NULL : BAD_CAST uri);
+    if (attr == NULL || attr->type != XML_ATTRIBUTE_NODE)
+    {
+      return Node::Attribute(std::shared_ptr<AttributeBase>());
+    }
+    return Node::Attribute(std::shared_ptr<Node::Handler::Attribute>(new Node::Handler::Attribute(attr)));
+  }
+
+  virtual Node::Attribute get_attribute_from_index(int index)
   {
     xmlAttrPtr attr = this->handler->properties;
 
@@ -546,12 +1389,12 @@ public:
         new Node::Handler::Attribute(attr)));
   }
 
-  bool is_attributes_empty() const
+  virtual bool is_attributes_empty() const
   {
     return this->handler->properties == NULL;
   }
 
-  std::size_t get_attributes_size() const
+  virtual std::size_t get_attributes_size() const
   {
     std::size_t result = 0;
     for (xmlAttrPtr attr = this->handler->properties; attr != NULL; attr = attr->next)
@@ -564,10 +1407,13 @@ public:
 
   void push_back_attribute(const Node::Attribute &attr)
   {
+    this->check_mutable();
+    notify_changing(this->handler);
     xmlAttrPtr newattr = xmlNewProp(
         this->handler, (const xmlChar *)attr.name.operator const char *(),
         (const xmlChar *)attr.value.operator const char *());
 
+    notify_changed(this->handler);
     if (newattr == NULL)
     {
       throw std::runtime_error("Can not add new attribute");
@@ -576,10 +1422,13 @@ public:
 
   void push_back_attribute(const std::string &name, const std::string &value)
   {
+    this->check_mutable();
+    notify_changing(this->handler);
     xmlAttrPtr newattr =
         xmlNewProp(this->handler, (const xmlChar *)name.c_str(),
                    (const xmlChar *)value.c_str());
 
+    notify_changed(this->handler);
     if (newattr == NULL)
     {
       throw std::runtime_error("Can not add new attribute");
@@ -596,8 +1445,49 @@ public:
 
   void push_back_attribute(const char *name, const char *value)
   {
+    this->check_mutable();
+    notify_changing(this->handler);
     xmlAttrPtr newattr = xmlNewProp(this->handler, (const xmlChar *)name, (const xmlChar *)value);
 
+    notify_changed(this->handler);
+    if (newattr == NULL)
+    {
+      throw std::runtime_error("Can not add new attribute");
+    }
+  }
+
+  void push_back_attribute(const Namespace &ns, const std::string &name, const std::string &value)
+  {
+    this->check_mutable();
+    if (ns.prefix.empty())
+    {
+      throw std::runtime_error("Namespaced attribute needs a prefix");
+    }
+
+    // A new declaration is part of the change, it is created inside the
+    // notifications like the attribute
+    notify_changing(this->handler);
+    xmlNsPtr declaration = xmlSearchNsByHref(this->handler->doc, this->handler, BAD_CAST ns.uri.c_str());
+    if (declaration == NULL || declaration->prefix == NULL)
+    {
+      // Redeclaring a prefix in use would move this element or other
+      // attributes to the new namespace, number it like xmlNewReconciledNs
+      std::string prefix = ns.prefix;
+      for (int i = 1; xmlSearchNs(this->handler->doc, this->handler, BAD_CAST prefix.c_str()) != NULL; ++i)
+      {
+        prefix = ns.prefix + std::to_string(i);
+      }
+
+      declaration = xmlNewNs(this->handler, BAD_CAST ns.uri.c_str(), BAD_CAST prefix.c_str());
+      if (declaration == NULL)
+      {
+        notify_changed(this->handler);
+        throw std::runtime_error("xmlNewNs failed");
+      }
+    }
+
+    xmlAttrPtr newattr = xmlNewNsProp(this->handler, declaration, BAD_CAST name.c_str(), BAD_CAST value.c_str());
+    notify_changed(this->handler);
     if (newattr == NULL)
     {
       throw std::runtime_error("Can not add new attribute");
@@ -606,11 +1496,15 @@ public:
 
   bool remove_attribute(const char * name)
   {
+    this->check_mutable();
     for (auto i = this->handler->properties; i; i = i->next) {
       // TODO: Test against encodings etc
       if (i->type == XML_ATTRIBUTE_NODE
         && xmlStrEqual((const xmlChar *)name, i->name)) {
-        return xmlRemoveProp(i) == 0;
+        notify_changing(this->handler, i);
+        bool result = xmlRemoveProp(i) == 0;
+        notify_changed(this->handler);
+        return result;
       }
     }
     return false;
@@ -697,7 +1591,7 @@ public:
     }
   };
 
-  std::shared_ptr<Node::AttributesPropertyType::iterator_base> begin_attr()
+  virtual std::shared_ptr<Node::AttributesPropertyType::iterator_base> begin_attr()
   {
     return std::shared_ptr<Node::AttributesPropertyType::iterator_base>(
         new Node::Handler::AttributeIterator(
@@ -705,7 +1599,7 @@ public:
             (xmlAttrPtr)this->handler->properties->last, false));
   }
 
-  const std::shared_ptr<Node::AttributesPropertyType::iterator_base>
+  virtual const std::shared_ptr<Node::AttributesPropertyType::iterator_base>
   begin_attr() const
   {
     return std::shared_ptr<Node::AttributesPropertyType::iterator_base>(
@@ -714,7 +1608,7 @@ public:
             (xmlAttrPtr)this->handler->properties->last, false));
   }
 
-  std::shared_ptr<Node::AttributesPropertyType::iterator_base> end_attr()
+  virtual std::shared_ptr<Node::AttributesPropertyType::iterator_base> end_attr()
   {
     return std::shared_ptr<Node::AttributesPropertyType::iterator_base>(
         new Node::Handler::AttributeIterator(
@@ -722,7 +1616,7 @@ public:
             (xmlAttrPtr)this->handler->properties->last, true));
   }
 
-  const std::shared_ptr<Node::AttributesPropertyType::iterator_base>
+  virtual const std::shared_ptr<Node::AttributesPropertyType::iterator_base>
   end_attr() const
   {
     return std::shared_ptr<Node::AttributesPropertyType::iterator_base>(
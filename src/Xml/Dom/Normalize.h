@@ -0,0 +1,148 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file Normalize.h
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief Text node coalescing and blank text removal, see Document::normalize
+ *
+ * Runs of adjacent text nodes are merged into the first node of the run.
+ * Optionally text nodes that are whitespace only afterwards are removed too,
+ * unless an ancestor has xml:space="preserve" or a sibling is text that is not
+ * blank, where the whitespace is part of mixed content. Blank text between
+ * inline elements as in <p><b>Hello</b> <i>world</i></p> cannot be told from
+ * indentation, so removal is left to the caller. Removed nodes are the ones
+ * child iteration skips with xmlIsBlankNode, so iteration sees the same
+ * children before and after. Every change is notified like a node mutation.
+ */
+
+#pragma once
+
+#include "NodeHandlerLibxml2.h"
+#include <libxml/tree.h>
+#include <string>
+
+namespace un::Xml::Dom::Normalize
+{
+
+/// Merge text run starting at first into it, returns the node after the run
+inline xmlNodePtr merge_run(xmlNodePtr first)
+{
+  xmlNodePtr next = first->next;
+  if (next == NULL || next->type != XML_TEXT_NODE)
+  {
+    return next;
+  }
+
+  std::string content;
+  std::string storage;
+  content = Node::Handler::get_content_view(first, storage);
+  for (xmlNodePtr i = next; i != NULL && i->type == XML_TEXT_NODE; i = i->next)
+  {
+    content += Node::Handler::get_content_view(i, storage);
+  }
+
+  while (first->next != NULL && first->next->type == XML_TEXT_NODE)
+  {
+    xmlNodePtr merged = first->next;
+    Node::Handler::notify_removing(merged);
+    xmlUnlinkNode(merged);
+    xmlFreeNode(merged);
+  }
+
+  Node::Handler::notify_changing(first);
+  xmlNodeSetContentLen(first, BAD_CAST content.data(), static_cast<int>(content.size()));
+  Node::Handler::notify_changed(first);
+  return first->next;
+}
+
+/**
+ * Normalize children of top and everything below them
+ *
+ * @return true if no blank text node is left, which is when iteration can
+ * skip the blank node check
+ */
+inline bool normalize(xmlNodePtr top, bool remove_blank_text)
+{
+  bool is_clean = true;
+  xmlNodePtr parent = top;
+  while (parent != NULL)
+  {
+    bool has_blank = false;
+    bool is_mixed = false;
+    for (xmlNodePtr i = parent->children; i != NULL;)
+    {
+      if (i->type != XML_TEXT_NODE && i->type != XML_CDATA_SECTION_NODE)
+      {
+        i = i->next;
+        continue;
+      }
+
+      xmlNodePtr next = i->type == XML_TEXT_NODE ? merge_run(i) : i->next;
+      bool is_blank = xmlIsBlankNode(i);
+      has_blank = has_blank || is_blank;
+      is_mixed = is_mixed || !is_blank;
+      i = next;
+    }
+
+    if (has_blank)
+    {
+      if (!remove_blank_text || is_mixed ||
+          (parent->type == XML_ELEMENT_NODE && xmlNodeGetSpacePreserve(parent) == 1))
+      {
+        is_clean = false;
+      }
+      else
+      {
+        for (xmlNodePtr i = parent->children; i != NULL;)
+        {
+          xmlNodePtr next = i->next;
+          if (i->type == XML_CDATA_SECTION_NODE && xmlIsBlankNode(i))
+          {
+            is_clean = false;
+          }
+          else if (i->type == XML_TEXT_NODE && xmlIsBlankNode(i))
+          {
+            Node::Handler::notify_removing(i);
+            xmlUnlinkNode(i);
+            xmlFreeNode(i);
+          }
+          i = next;
+        }
+      }
+    }
+
+    // Next element in document order below top
+    xmlNodePtr child = parent->children;
+    while (child != NULL && child->type != XML_ELEMENT_NODE)
+    {
+      child = child->next;
+    }
+    if (child != NULL)
+    {
+      parent = child;
+      continue;
+    }
+
+    while (parent != top)
+    {
+      xmlNodePtr sibling = parent->next;
+      while (sibling != NULL && sibling->type != XML_ELEMENT_NODE)
+      {
+        sibling = sibling->next;
+      }
+      if (sibling != NULL)
+      {
+        parent = sibling;
+        break;
+      }
+      parent = parent->parent;
+    }
+    if (parent == top)
+    {
+      break;
+    }
+  }
+  return is_clean;
+}
+
+}
@@ -0,0 +1,207 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file ObserverList.h
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief Dispatch of mutation notifications to document observers
+ *
+ * Element notifications only say that name or attributes changed, so the
+ * element is captured on changing and compared on changed to report which
+ * attributes were set or removed.
+ *
+ * Observers may add or remove observers, themselves included, from a
+ * callback. Removed ones are cleared to NULL and erased when the outermost
+ * dispatch ends, added ones are called from the next notification on.
+ */
+
+#pragma once
+
+#include <Xml/Dom/Observer.h>
+#include "NodeHandlerLibxml2.h"
+#include <algorithm>
+#include <cstddef>
+#include <libxml/tree.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace un::Xml::Dom
+{
+
+class ObserverList
+{
+private:
+  std::vector<Observer *> _observers;
+  std::size_t _depth;  // Dispatches in progress
+  bool _has_removed;   // NULL entries wait for the outermost dispatch to end
+
+  // Element between on_changing and on_changed with its previous state
+  xmlNodePtr _changing;
+  std::string _name;
+  std::vector<std::pair<std::string, std::string>> _attributes;
+
+  static std::string get_qualified_name(xmlAttrPtr attribute)
+  {
+    std::string name;
+    if (attribute->ns != NULL && attribute->ns->prefix != NULL)
+    {
+      name = (const char *)attribute->ns->prefix;
+      name += ':';
+    }
+    return name + (const char *)attribute->name;
+  }
+
+  static void get_attributes(xmlNodePtr element, std::vector<std::pair<std::string, std::string>> &attributes)
+  {
+    attributes.clear();
+    std::string storage;
+    for (xmlAttrPtr i = element->properties; i != NULL; i = i->next)
+    {
+      attributes.emplace_back(get_qualified_name(i),
+                              std::string(Node::Handler::get_content_view((xmlNodePtr)i, storage)));
+    }
+  }
+
+  static Node get_parent(xmlNodePtr node)
+  {
+    return node->parent == NULL || node->parent->type == XML_DOCUMENT_NODE
+               ? Node(std::shared_ptr<Node::Handler>())
+               : Node::Handler::bind(node->parent);
+  }
+
+  void end_dispatch()
+  {
+    if (--this->_depth == 0 && this->_has_removed)
+    {
+      this->_has_removed = false;
+      this->_observers.erase(std::remove(this->_observers.begin(), this->_observers.end(), nullptr),
+                             this->_observers.end());
+    }
+  }
+
+  /// Calls call with every observer added before the dispatch and not removed yet
+  template <class Call>
+  void dispatch(Call call)
+  {
+    ++this->_depth;
+    try
+    {
+      std::size_t size = this->_observers.size();
+      for (std::size_t i = 0; i < size; ++i)
+      {
+        if (this->_observers[i] != NULL)
+        {
+          call(*this->_observers[i]);
+        }
+      }
+    }
+    catch (...)
+    {
+      this->end_dispatch();
+      throw;
+    }
+    this->end_dispatch();
+  }
+
+public:
+  ObserverList() : _depth(0), _has_removed(false), _changing(NULL) {}
+
+  bool empty() const { return this->_observers.empty(); }
+
+  void add(Observer &observer) { this->_observers.push_back(&observer); }
+
+  void remove(Observer &observer)
+  {
+    if (this->_depth == 0)
+    {
+      this->_observers.erase(std::remove(this->_observers.begin(), this->_observers.end(), &observer),
+                             this->_observers.end());
+      return;
+    }
+
+    std::replace(this->_observers.begin(), this->_observers.end(), &observer, (Observer *)NULL);
+    this->_has_removed = true;
+  }
+
+  void on_inserted(xmlNodePtr node)
+  {
+    Node parent = get_parent(node);
+    Node child = Node::Handler::bind(node);
+    this->dispatch([&parent, &child](Observer &observer) { observer.on_child_inserted(parent, child); });
+  }
+
+  void on_removing(xmlNodePtr node)
+  {
+    Node parent = get_parent(node);
+    Node child = Node::Handler::bind(node);
+    this->dispatch([&parent, &child](Observer &observer) { observer.on_child_removing(parent, child); });
+  }
+
+  void on_changing(xmlNodePtr node)
+  {
+    if (node->type != XML_ELEMENT_NODE)
+    {
+      return;
+    }
+
+    this->_changing = node;
+    this->_name = (const char *)node->name;
+    get_attributes(node, this->_attributes);
+  }
+
+  void on_changed(xmlNodePtr node)
+  {
+    Node bound = Node::Handler::bind(node);
+    if (node->type != XML_ELEMENT_NODE)
+    {
+      this->dispatch([&bound](Observer &observer) { observer.on_content_changed(bound); });
+      return;
+    }
+    if (node != this->_changing)
+    {
+      return;
+    }
+    this->_changing = NULL;
+
+    // Callbacks may change the document again, which reuses the members
+    std::string name = std::move(this->_name);
+    std::vector<std::pair<std::string, std::string>> previous = std::move(this->_attributes);
+    this->_attributes.clear();
+    if (name != (const char *)node->name)
+    {
+      this->dispatch([&bound, &name](Observer &observer) { observer.on_name_changed(bound, name); });
+    }
+
+    std::vector<std::pair<std::string, std::string>> attributes;
+    get_attributes(node, attributes);
+    for (const std::pair<std::string, std::string> &attribute : attributes)
+    {
+      auto old = std::find_if(previous.begin(), previous.end(),
+                              [&attribute](const std::pair<std::string, std::string> &i) {
+                                return i.first == attribute.first;
+                              });
+      if (old != previous.end() && old->second == attribute.second)
+      {
+        continue;
+      }
+      this->dispatch([&bound, &attribute](Observer &observer) {
+        observer.on_attribute_set(bound, attribute.first, attribute.second);
+      });
+    }
+    for (const std::pair<std::string, std::string> &attribute : previous)
+    {
+      auto current = std::find_if(attributes.begin(), attributes.end(),
+                                  [&attribute](const std::pair<std::string, std::string> &i) {
+                                    return i.first == attribute.first;
+                                  });
+      if (current != attributes.end())
+      {
+        continue;
+      }
+      this->dispatch(
+          [&bound, &attribute](Observer &observer) { observer.on_attribute_removed(bound, attribute.first); });
+    }
+  }
+};
+
+}
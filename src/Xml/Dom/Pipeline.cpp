@@ -0,0 +1,799 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file Pipeline.cpp
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief Streaming transforms of xml events from source through stages to sink
+ */
+
+#include <Xml/Dom/Pipeline.h>
+#include "CompressedFile.h"
+#include "ReadAheadFile.h"
+#include <algorithm>
+#include <exception>
+#include <libxml/SAX2.h>
+#include <libxml/parser.h>
+#include <ostream>
+#include <stdexcept>
+
+namespace un::Xml::Dom
+{
+
+namespace
+{
+
+std::string get_qualified_name(const xmlChar *prefix, const xmlChar *name)
+{
+  if (prefix == NULL)
+  {
+    return (const char *)name;
+  }
+  std::string result = (const char *)prefix;
+  result += ':';
+  return result + (const char *)name;
+}
+
+class FilterStage : public Pipeline::Stage
+{
+private:
+  std::function<bool(const Pipeline::Event &event)> _keep;
+
+  // Depth inside a dropped element, 0 when not in one
+  std::size_t _skip;
+
+public:
+  explicit FilterStage(const std::function<bool(const Pipeline::Event &event)> &keep) : _keep(keep), _skip(0) {}
+
+  void on_event(Pipeline::Event &event, Pipeline::Sink &next)
+  {
+    if (this->_skip > 0)
+    {
+      if (event.type == Pipeline::Event::Type::start_element)
+      {
+        ++this->_skip;
+      }
+      else if (event.type == Pipeline::Event::Type::end_element)
+      {
+        --this->_skip;
+      }
+      return;
+    }
+
+    if (event.type != Pipeline::Event::Type::end_element && !this->_keep(event))
+    {
+      this->_skip = event.type == Pipeline::Event::Type::start_element ? 1 : 0;
+      return;
+    }
+    next.on_event(event);
+  }
+
+  void reset()
+  {
+    this->_skip = 0;
+  }
+};
+
+class MapStage : public Pipeline::Stage
+{
+private:
+  std::function<void(Pipeline::Event &event)> _change;
+
+  // Names of open elements after the change
+  std::vector<std::string> _names;
+
+public:
+  explicit MapStage(const std::function<void(Pipeline::Event &event)> &change) : _change(change) {}
+
+  void on_event(Pipeline::Event &event, Pipeline::Sink &next)
+  {
+    if (event.type == Pipeline::Event::Type::end_element)
+    {
+      if (!this->_names.empty())
+      {
+        event.name.swap(this->_names.back());
+        this->_names.pop_back();
+      }
+      next.on_event(event);
+      return;
+    }
+
+    this->_change(event);
+    if (event.type == Pipeline::Event::Type::start_element)
+    {
+      this->_names.push_back(event.name);
+    }
+    next.on_event(event);
+  }
+
+  void reset()
+  {
+    this->_names.clear();
+  }
+};
+
+/// Passes events to a stage with the rest of the pipeline as its next sink
+class Link : public Pipeline::Sink
+{
+private:
+  Pipeline::Stage &_stage;
+  Pipeline::Sink &_next;
+
+public:
+  Link(Pipeline::Stage &stage, Pipeline::Sink &next) : _stage(stage), _next(next) {}
+
+  void on_event(Pipeline::Event &event)
+  {
+    this->_stage.on_event(event, this->_next);
+  }
+
+  void on_end()
+  {
+    this->_next.on_end();
+  }
+};
+
+}
+
+const std::string *Pipeline::Event::get_attribute(const std::string &name) const
+{
+  for (const Attribute &attribute : this->attributes)
+  {
+    if (attribute.name == name)
+    {
+      return &attribute.value;
+    }
+  }
+  return NULL;
+}
+
+void Pipeline::Event::set_attribute(const std::string &name, const std::string &value)
+{
+  for (Attribute &attribute : this->attributes)
+  {
+    if (attribute.name == name)
+    {
+      attribute.value = value;
+      return;
+    }
+  }
+  this->attributes.push_back(Attribute{name, value});
+}
+
+void Pipeline::Event::remove_attribute(const std::string &name)
+{
+  this->attributes.erase(std::remove_if(this->attributes.begin(), this->attributes.end(),
+                                        [&name](const Attribute &i) { return i.name == name; }),
+                         this->attributes.end());
+}
+
+class Pipeline::Handler
+{
+private:
+  std::vector<std::shared_ptr<Pipeline::Stage>> _stages;
+
+  // State of the running pass
+  std::vector<std::unique_ptr<Link>> _links;
+  Pipeline::Sink *_first;
+  xmlParserCtxtPtr _context;
+  std::exception_ptr _error;
+  Pipeline::Event _event;
+  std::size_t _depth;
+
+  // Text and CDATA arrive in pieces and are passed on once complete
+  std::string _text;
+  bool _is_text_pending;
+  Pipeline::Event::Type _text_type;
+
+  static const int parse_options = XML_PARSE_NOENT | XML_PARSE_NONET;
+
+  static Handler &from(void *context)
+  {
+    return *static_cast<Handler *>(static_cast<xmlParserCtxtPtr>(context)->_private);
+  }
+
+  /// Run callback, stopping the parser when a stage or sink throws
+  template <typename Callback>
+  static void guard(void *context, const Callback &callback)
+  {
+    Handler &handler = from(context);
+    if (handler._error != nullptr)
+    {
+      return;
+    }
+    try
+    {
+      callback(handler);
+    }
+    catch (...)
+    {
+      handler._error = std::current_exception();
+      xmlStopParser(static_cast<xmlParserCtxtPtr>(context));
+    }
+  }
+
+  void emit()
+  {
+    this->_first->on_event(this->_event);
+  }
+
+  void flush_text()
+  {
+    if (!this->_is_text_pending)
+    {
+      return;
+    }
+    this->_is_text_pending = false;
+    this->_event.type = this->_text_type;
+    this->_event.name.clear();
+    this->_event.attributes.clear();
+    this->_event.content.swap(this->_text);
+    this->_event.depth = this->_depth;
+    this->_text.clear();
+    this->emit();
+  }
+
+  void append_text(Pipeline::Event::Type type, const xmlChar *data, int size)
+  {
+    if (this->_is_text_pending && this->_text_type != type)
+    {
+      this->flush_text();
+    }
+    this->_is_text_pending = true;
+    this->_text_type = type;
+    this->_text.append((const char *)data, static_cast<std::size_t>(size));
+  }
+
+  void emit_content(Pipeline::Event::Type type, const xmlChar *name, const xmlChar *content)
+  {
+    this->flush_text();
+    this->_event.type = type;
+    this->_event.name = name == NULL ? "" : (const char *)name;
+    this->_event.attributes.clear();
+    this->_event.content = content == NULL ? "" : (const char *)content;
+    this->_event.depth = this->_depth;
+    this->emit();
+  }
+
+  static void on_start_element(void *context, const xmlChar *name, const xmlChar *prefix, const xmlChar * /*uri*/,
+                               int namespace_count, const xmlChar **namespaces, int attribute_count,
+                               int /*defaulted_count*/, const xmlChar **attributes)
+  {
+    guard(context, [&](Handler &handler) {
+      handler.flush_text();
+      Pipeline::Event &event = handler._event;
+      event.type = Pipeline::Event::Type::start_element;
+      event.name = get_qualified_name(prefix, name);
+      event.attributes.clear();
+      event.content.clear();
+      event.depth = handler._depth++;
+
+      for (int i = 0; i < namespace_count; ++i)
+      {
+        const xmlChar *declared = namespaces[2 * i];
+        event.attributes.push_back(
+            Pipeline::Attribute{declared == NULL ? "xmlns" : get_qualified_name(BAD_CAST "xmlns", declared),
+                                (const char *)namespaces[2 * i + 1]});
+      }
+      for (int i = 0; i < attribute_count; ++i)
+      {
+        const xmlChar **attribute = attributes + 5 * i;
+        event.attributes.push_back(
+            Pipeline::Attribute{get_qualified_name(attribute[1], attribute[0]),
+                                std::string((const char *)attribute[3], (const char *)attribute[4])});
+      }
+      handler.emit();
+    });
+  }
+
+  static void on_end_element(void *context, const xmlChar *name, const xmlChar *prefix, const xmlChar * /*uri*/)
+  {
+    guard(context, [&](Handler &handler) {
+      handler.flush_text();
+      Pipeline::Event &event = handler._event;
+      event.type = Pipeline::Event::Type::end_element;
+      event.name = get_qualified_name(prefix, name);
+      event.attributes.clear();
+      event.content.clear();
+      event.depth = --handler._depth;
+      handler.emit();
+    });
+  }
+
+  static void on_characters(void *context, const xmlChar *data, int size)
+  {
+    guard(context, [&](Handler &handler) { handler.append_text(Pipeline::Event::Type::text, data, size); });
+  }
+
+  static void on_cdata(void *context, const xmlChar *data, int size)
+  {
+    guard(context, [&](Handler &handler) { handler.append_text(Pipeline::Event::Type::cdata, data, size); });
+  }
+
+  static void on_comment(void *context, const xmlChar *content)
+  {
+    // Comments of the internal DTD subset are not part of the content
+    if (static_cast<xmlParserCtxtPtr>(context)->inSubset != 0)
+    {
+      return;
+    }
+    guard(context, [&](Handler &handler) { handler.emit_content(Pipeline::Event::Type::comment, NULL, content); });
+  }
+
+  static void on_processing_instruction(void *context, const xmlChar *target, const xmlChar *data)
+  {
+    if (static_cast<xmlParserCtxtPtr>(context)->inSubset != 0)
+    {
+      return;
+    }
+    guard(context, [&](Handler &handler) {
+      handler.emit_content(Pipeline::Event::Type::processing_instruction, target, data);
+    });
+  }
+
+  static xmlEntityPtr refuse_external(void *context, const xmlChar *name)
+  {
+    guard(context, [&](Handler &) {
+      throw std::runtime_error("External entity '" + std::string((const char *)name) + "' is not loaded");
+    });
+    return NULL;
+  }
+
+  /**
+   * References are substituted (XML_PARSE_NOENT), which would read external
+   * entities from the file system. They are refused instead. Lookups while
+   * declaring entities inside the DTD are let through.
+   */
+  static xmlEntityPtr on_get_entity(void *context, const xmlChar *name)
+  {
+    xmlEntityPtr entity = xmlSAX2GetEntity(context, name);
+    if (entity != NULL && entity->etype == XML_EXTERNAL_GENERAL_PARSED_ENTITY &&
+        static_cast<xmlParserCtxtPtr>(context)->inSubset == 0)
+    {
+      return refuse_external(context, name);
+    }
+    return entity;
+  }
+
+  static xmlEntityPtr on_get_parameter_entity(void *context, const xmlChar *name)
+  {
+    xmlEntityPtr entity = xmlSAX2GetParameterEntity(context, name);
+    if (entity != NULL && entity->etype == XML_EXTERNAL_PARAMETER_ENTITY)
+    {
+      return refuse_external(context, name);
+    }
+    return entity;
+  }
+
+  void release()
+  {
+    if (this->_context != NULL)
+    {
+      // Holds the DTD only, elements are never linked into it
+      xmlFreeDoc(this->_context->myDoc);
+      this->_context->myDoc = NULL;
+      xmlFreeParserCtxt(this->_context);
+      this->_context = NULL;
+    }
+    this->_links.clear();
+    this->_first = NULL;
+    this->_error = nullptr;
+    this->_text.clear();
+    this->_is_text_pending = false;
+  }
+
+  void check(int result)
+  {
+    if (this->_error != nullptr)
+    {
+      std::exception_ptr error = this->_error;
+      this->release();
+      std::rethrow_exception(error);
+    }
+    if (result != 0)
+    {
+      std::string message = this->_context->lastError.message == NULL ? "Cannot parse data"
+                                                                        : this->_context->lastError.message;
+      while (!message.empty() && message.back() == '\n')
+      {
+        message.pop_back();
+      }
+      this->release();
+      throw std::runtime_error(message);
+    }
+  }
+
+public:
+  Handler() : _first(NULL), _context(NULL), _depth(0), _is_text_pending(false), _text_type() {}
+
+  ~Handler()
+  {
+    this->release();
+  }
+
+  Handler(const Handler &) = delete;
+  Handler &operator=(const Handler &) = delete;
+
+  void add(const std::shared_ptr<Pipeline::Stage> &stage)
+  {
+    this->_stages.push_back(stage);
+  }
+
+  void begin(Pipeline::Sink &sink, const char *path = NULL)
+  {
+    this->release();
+    xmlInitParser();
+
+    xmlSAXHandler sax;
+    xmlSAXVersion(&sax, 2);
+    sax.startElementNs = on_start_element;
+    sax.endElementNs = on_end_element;
+    sax.characters = on_characters;
+    sax.ignorableWhitespace = on_characters;
+    sax.cdataBlock = on_cdata;
+    sax.comment = on_comment;
+    sax.processingInstruction = on_processing_instruction;
+    sax.getEntity = on_get_entity;
+    sax.getParameterEntity = on_get_parameter_entity;
+
+    this->_context = xmlCreatePushParserCtxt(&sax, NULL, NULL, 0, path);
+    if (this->_context == NULL)
+    {
+      throw std::runtime_error("xmlCreatePushParserCtxt failed");
+    }
+    xmlCtxtUseOptions(this->_context, parse_options);
+    this->_context->_private = this;
+
+    Pipeline::Sink *next = &sink;
+    for (auto i = this->_stages.rbegin(); i != this->_stages.rend(); ++i)
+    {
+      (*i)->reset();
+      this->_links.emplace_back(new Link(**i, *next));
+      next = this->_links.back().get();
+    }
+    this->_first = next;
+    this->_depth = 0;
+  }
+
+  void push(const char *data, std::size_t size)
+  {
+    if (this->_context == NULL)
+    {
+      throw std::runtime_error("No pass began");
+    }
+
+    // libxml2 refuses chunks over its lookup limit and sizes are int
+    for (std::size_t offset = 0; offset < size; offset += ReadAheadFile::default_chunk_size)
+    {
+      std::size_t chunk = std::min(size - offset, ReadAheadFile::default_chunk_size);
+      this->check(xmlParseChunk(this->_context, data + offset, static_cast<int>(chunk), 0));
+    }
+  }
+
+  void end()
+  {
+    if (this->_context == NULL)
+    {
+      throw std::runtime_error("No pass began");
+    }
+    this->check(xmlParseChunk(this->_context, NULL, 0, 1));
+
+    Pipeline::Sink *first = this->_first;
+    try
+    {
+      this->flush_text();
+      first->on_end();
+    }
+    catch (...)
+    {
+      this->release();
+      throw;
+    }
+    this->release();
+  }
+
+  void run_file(const char *path, Pipeline::Sink &sink)
+  {
+    Document::Compression compression = CompressedFile::detect(path);
+    if (compression != Document::Compression::none)
+    {
+      CompressedFile::Reader reader(path, compression);
+      std::vector<char> buffer(ReadAheadFile::default_chunk_size);
+      this->begin(sink, path);
+      for (std::size_t size = reader.read(buffer.data(), buffer.size()); size > 0;
+           size = reader.read(buffer.data(), buffer.size()))
+      {
+        this->push(buffer.data(), size);
+      }
+      this->end();
+      return;
+    }
+
+    ReadAheadFile file(path);
+    this->begin(sink, path);
+    for (std::string_view chunk = file.next(); !chunk.empty(); chunk = file.next())
+    {
+      this->push(chunk.data(), chunk.size());
+    }
+    this->end();
+  }
+};
+
+class Pipeline::Serializer::Handler
+{
+private:
+  Pipeline::Serializer::Write _write;
+  std::size_t _buffer_size;
+  std::string _buffer;
+
+  // Output written to directly instead of through the buffer
+  std::string *_target;
+
+  std::unique_ptr<CompressedFile::Writer> _file;
+
+  // Start tag written without its closing '>'
+  bool _is_start_open;
+
+  std::string &output()
+  {
+    return this->_target == NULL ? this->_buffer : *this->_target;
+  }
+
+  static void append_escaped(std::string &output, const std::string &text, bool is_attribute)
+  {
+    const char *special = is_attribute ? "&<>\"\t\n\r" : "&<>\r";
+    std::size_t start = 0;
+    for (std::size_t i = text.find_first_of(special); i != std::string::npos;
+         i = text.find_first_of(special, i + 1))
+    {
+      output.append(text, start, i - start);
+      switch (text[i])
+      {
+      case '&':
+        output += "&amp;";
+        break;
+      case '<':
+        output += "&lt;";
+        break;
+      case '>':
+        output += "&gt;";
+        break;
+      case '"':
+        output += "&quot;";
+        break;
+      case '\t':
+        output += "&#9;";
+        break;
+      case '\n':
+        output += "&#10;";
+        break;
+      default:
+        output += "&#13;";
+        break;
+      }
+      start = i + 1;
+    }
+    output.append(text, start, std::string::npos);
+  }
+
+public:
+  Handler(const Pipeline::Serializer::Write &write, std::size_t buffer_size)
+    : _write(write), _buffer_size(buffer_size), _target(NULL), _is_start_open(false)
+  {
+    this->_buffer.reserve(buffer_size);
+  }
+
+  explicit Handler(std::string &output) : _buffer_size(0), _target(&output), _is_start_open(false) {}
+
+  Handler(const char *path, Document::Compression compression)
+    : _buffer_size(Pipeline::Serializer::default_buffer_size), _target(NULL), _is_start_open(false)
+  {
+    if (compression == Document::Compression::by_extension)
+    {
+      compression = CompressedFile::from_extension(path);
+    }
+    this->_file.reset(new CompressedFile::Writer(path, compression));
+    CompressedFile::Writer *file = this->_file.get();
+    this->_write = [file](const char *data, std::size_t size) { file->write(data, size); };
+    this->_buffer.reserve(this->_buffer_size);
+  }
+
+  void on_event(const Pipeline::Event &event)
+  {
+    std::string &output = this->output();
+    if (this->_is_start_open)
+    {
+      this->_is_start_open = false;
+      if (event.type == Pipeline::Event::Type::end_element)
+      {
+        output += "/>";
+        return;
+      }
+      output += '>';
+    }
+
+    switch (event.type)
+    {
+    case Pipeline::Event::Type::start_element:
+      output += '<';
+      output += event.name;
+      for (const Pipeline::Attribute &attribute : event.attributes)
+      {
+        output += ' ';
+        output += attribute.name;
+        output += "=\"";
+        append_escaped(output, attribute.value, true);
+        output += '"';
+      }
+      this->_is_start_open = true;
+      break;
+    case Pipeline::Event::Type::end_element:
+      output += "</";
+      output += event.name;
+      output += '>';
+      break;
+    case Pipeline::Event::Type::text:
+      append_escaped(output, event.content, false);
+      break;
+    case Pipeline::Event::Type::cdata:
+    {
+      // "]]>" cannot appear inside a section, it is split over two
+      output += "<![CDATA[";
+      std::size_t start = 0;
+      for (std::size_t i = event.content.find("]]>"); i != std::string::npos; i = event.content.find("]]>", i + 1))
+      {
+        output.append(event.content, start, i + 2 - start);
+        output += "]]><![CDATA[";
+        start = i + 2;
+      }
+      output.append(event.content, start, std::string::npos);
+      output += "]]>";
+      break;
+    }
+    case Pipeline::Event::Type::comment:
+      output += "<!--";
+      output += event.content;
+      output += "-->";
+      break;
+    case Pipeline::Event::Type::processing_instruction:
+      output += "<?";
+      output += event.name;
+      if (!event.content.empty())
+      {
+        output += ' ';
+        output += event.content;
+      }
+      output += "?>";
+      break;
+    }
+
+    if (this->_target == NULL && this->_buffer.size() >= this->_buffer_size)
+    {
+      this->flush();
+    }
+  }
+
+  void flush()
+  {
+    if (this->_target != NULL || this->_buffer.empty())
+    {
+      return;
+    }
+    if (!this->_write)
+    {
+      throw std::runtime_error("Serializer is closed");
+    }
+    this->_write(this->_buffer.data(), this->_buffer.size());
+    this->_buffer.clear();
+  }
+
+  void on_end()
+  {
+    if (this->_is_start_open)
+    {
+      this->_is_start_open = false;
+      this->output() += '>';
+    }
+    this->flush();
+    if (this->_file != nullptr)
+    {
+      this->_write = nullptr;
+      std::unique_ptr<CompressedFile::Writer> file = std::move(this->_file);
+      file->close();
+    }
+  }
+};
+
+Pipeline::Serializer::Serializer(const Write &write, std::size_t buffer_size)
+  : handler(std::make_shared<Pipeline::Serializer::Handler>(write, buffer_size)) {}
+
+Pipeline::Serializer::Serializer(std::string &output)
+  : handler(std::make_shared<Pipeline::Serializer::Handler>(output)) {}
+
+Pipeline::Serializer::Serializer(std::ostream &output, std::size_t buffer_size)
+  : handler(std::make_shared<Pipeline::Serializer::Handler>(
+        [&output](const char *data, std::size_t size) {
+          output.write(data, static_cast<std::streamsize>(size));
+        },
+        buffer_size)) {}
+
+Pipeline::Serializer::Serializer(const char *path, Document::Compression compression)
+  : handler(std::make_shared<Pipeline::Serializer::Handler>(path, compression)) {}
+
+void Pipeline::Serializer::on_event(Event &event)
+{
+  this->handler->on_event(event);
+}
+
+void Pipeline::Serializer::on_end()
+{
+  this->handler->on_end();
+}
+
+void Pipeline::Serializer::flush()
+{
+  this->handler->flush();
+}
+
+Pipeline::Pipeline() : handler(std::make_shared<Pipeline::Handler>()) {}
+
+Pipeline &Pipeline::add(const std::shared_ptr<Stage> &stage)
+{
+  this->handler->add(stage);
+  return *this;
+}
+
+Pipeline &Pipeline::filter(const std::function<bool(const Event &event)> &keep)
+{
+  return this->add(std::make_shared<FilterStage>(keep));
+}
+
+Pipeline &Pipeline::map(const std::function<void(Event &event)> &change)
+{
+  return this->add(std::make_shared<MapStage>(change));
+}
+
+Pipeline &Pipeline::drop(const std::string &name)
+{
+  return this->filter([name](const Event &event) {
+    return event.type != Event::Type::start_element || event.name != name;
+  });
+}
+
+Pipeline &Pipeline::rename(const std::string &from, const std::string &to)
+{
+  return this->map([from, to](Event &event) {
+    if (event.type == Event::Type::start_element && event.name == from)
+    {
+      event.name = to;
+    }
+  });
+}
+
+void Pipeline::run(const char *data, std::size_t size, Sink &sink)
+{
+  this->handler->begin(sink);
+  this->handler->push(data, size);
+  this->handler->end();
+}
+
+void Pipeline::run_file(const char *path, Sink &sink)
+{
+  this->handler->run_file(path, sink);
+}
+
+void Pipeline::begin(Sink &sink)
+{
+  this->handler->begin(sink);
+}
+
+void Pipeline::push(const char *data, std::size_t size)
+{
+  this->handler->push(data, size);
+}
+
+void Pipeline::end()
+{
+  this->handler->end();
+}
+
+}
@@ -0,0 +1,121 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file QualifiedPath.cpp
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief Namespace qualified element paths compiled once
+ */
+
+#include <Xml/Dom/QualifiedPath.h>
+#include "NodeHandlerLibxml2.h"
+#include <stdexcept>
+
+namespace un::Xml::Dom
+{
+
+QualifiedPath::QualifiedPath() {}
+
+QualifiedPath::QualifiedPath(const std::string &path, const Prefixes &prefixes)
+{
+  std::size_t start = 0;
+  while (true)
+  {
+    std::size_t end = path.find('/', start);
+    std::string segment = path.substr(start, end == std::string::npos ? std::string::npos : end - start);
+    if (segment.empty())
+    {
+      throw std::runtime_error("Empty segment in path: " + path);
+    }
+
+    std::size_t colon = segment.find(':');
+    std::string prefix = colon == std::string::npos ? std::string() : segment.substr(0, colon);
+    std::string name = colon == std::string::npos ? segment : segment.substr(colon + 1);
+    if (name == "*")
+    {
+      name.clear();
+    }
+
+    const std::pair<std::string, std::string> *binding = NULL;
+    for (const std::pair<std::string, std::string> &i : prefixes)
+    {
+      if (i.first == prefix)
+      {
+        binding = &i;
+        break;
+      }
+    }
+
+    if (segment == "*")
+    {
+      this->append_any_namespace(name);
+    }
+    else if (binding != NULL)
+    {
+      this->append(binding->second, name);
+    }
+    else if (prefix.empty())
+    {
+      this->append(std::string(), name);
+    }
+    else
+    {
+      throw std::runtime_error("Unbound prefix in path: " + segment);
+    }
+
+    if (end == std::string::npos)
+    {
+      break;
+    }
+    start = end + 1;
+  }
+}
+
+QualifiedPath &QualifiedPath::append(const std::string &uri, const std::string &name)
+{
+  Step step;
+  step.uri = no_namespace;
+  step.name = name;
+  if (!uri.empty())
+  {
+    for (step.uri = 0; step.uri < this->uris.size() && this->uris[step.uri] != uri; ++step.uri)
+    {
+    }
+    if (step.uri == this->uris.size())
+    {
+      this->uris.push_back(uri);
+    }
+  }
+  this->steps.push_back(step);
+  return *this;
+}
+
+QualifiedPath &QualifiedPath::append_any_namespace(const std::string &name)
+{
+  Step step;
+  step.uri = any_namespace;
+  step.name = name;
+  this->steps.push_back(step);
+  return *this;
+}
+
+Node QualifiedPath::select(const Node &node) const
+{
+  std::vector<Node> result;
+  if (node.handler != nullptr)
+  {
+    node.handler->select(*this, result, true);
+  }
+  return result.empty() ? Node(std::shared_ptr<Node::Handler>()) : result.front();
+}
+
+std::vector<Node> QualifiedPath::select_all(const Node &node) const
+{
+  std::vector<Node> result;
+  if (node.handler != nullptr)
+  {
+    node.handler->select(*this, result, false);
+  }
+  return result;
+}
+
+}
@@ -0,0 +1,132 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file ReadAheadFile.h
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief Chunked file reader reading the next chunk in the background
+ *
+ * Two buffers are used in turns: while the caller works on the chunk it got,
+ * the next one is read into the other buffer by one reader thread that lives
+ * as long as the file, so disk reads overlap with parsing.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <exception>
+#include <semaphore>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace un::Xml::Dom
+{
+
+class ReadAheadFile
+{
+private:
+  FILE *_file;
+  std::vector<char> _buffers[2];
+  std::size_t _sizes[2];
+  std::exception_ptr _error;
+
+  // Buffers the reader may fill and buffers the caller may take
+  std::counting_semaphore<> _free;
+  std::counting_semaphore<> _filled;
+  std::atomic<bool> _is_stopping;
+
+  int _current; // Buffer handed out last, -1 before the first call
+  bool _is_end;
+  std::thread _reader;
+
+  void read()
+  {
+    for (int index = 0;; index ^= 1)
+    {
+      this->_free.acquire();
+      if (this->_is_stopping.load(std::memory_order_relaxed))
+      {
+        return;
+      }
+
+      std::vector<char> &buffer = this->_buffers[index];
+      std::size_t size = std::fread(buffer.data(), 1, buffer.size(), this->_file);
+      this->_sizes[index] = size;
+      bool is_last = size < buffer.size();
+      if (is_last && std::ferror(this->_file))
+      {
+        this->_error = std::make_exception_ptr(std::runtime_error("Cannot read file"));
+      }
+      this->_filled.release();
+      if (is_last)
+      {
+        return;
+      }
+    }
+  }
+
+public:
+  static constexpr std::size_t default_chunk_size = 1024 * 1024;
+
+  explicit ReadAheadFile(const char *path, std::size_t chunk_size = default_chunk_size)
+      : _file(std::fopen(path, "rb")), _sizes{0, 0}, _free(2), _filled(0), _is_stopping(false), _current(-1),
+        _is_end(false)
+  {
+    if (this->_file == NULL)
+    {
+      throw std::runtime_error(std::string("Cannot open file: ") + path);
+    }
+    this->_buffers[0].resize(chunk_size);
+    this->_buffers[1].resize(chunk_size);
+    this->_reader = std::thread([this]() { this->read(); });
+  }
+
+  ~ReadAheadFile()
+  {
+    // Wakes the reader if it waits for a buffer, it may also be done already
+    this->_is_stopping.store(true, std::memory_order_relaxed);
+    this->_free.release();
+    this->_reader.join();
+    std::fclose(this->_file);
+  }
+
+  ReadAheadFile(const ReadAheadFile &) = delete;
+  ReadAheadFile &operator=(const ReadAheadFile &) = delete;
+
+  /**
+   * Next chunk, empty at the end of file. Chunk stays valid until the next
+   * call.
+   *
+   * @throw std::runtime_error if file cannot be read
+   */
+  std::string_view next()
+  {
+    if (this->_is_end)
+    {
+      return std::string_view();
+    }
+    if (this->_current >= 0)
+    {
+      this->_free.release();
+    }
+
+    this->_filled.acquire();
+    this->_current = this->_current < 0 ? 0 : this->_current ^ 1;
+    std::size_t size = this->_sizes[this->_current];
+    if (size < this->_buffers[this->_current].size())
+    {
+      this->_is_end = true;
+      if (this->_error)
+      {
+        std::rethrow_exception(this->_error);
+      }
+    }
+    return std::string_view(this->_buffers[this->_current].data(), size);
+  }
+};
+
+}
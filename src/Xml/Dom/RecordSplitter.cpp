@@ -0,0 +1,191 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file RecordSplitter.cpp
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief Splits flat record files and parses records in parallel
+ */
+
+#include <Xml/Dom/RecordSplitter.h>
+#include "DocumentHandlerLibxml2.h"
+#include "MappedFile.h"
+#include "Scanner.h"
+#include "WorkStealingScheduler.h"
+#include <stdexcept>
+
+namespace un::Xml::Dom
+{
+
+class RecordSplitter::Handler
+{
+private:
+  std::unique_ptr<MappedFile> _file;
+  const char *_data;
+  std::size_t _size;
+  std::vector<RecordSplitter::Record> _records;
+
+  /// Number of records a parse task takes at once
+  static const std::size_t parse_chunk_size = 16;
+
+  void scan()
+  {
+    const char *p = this->_data;
+    const char *const end = this->_data + this->_size;
+    const char *record = NULL;
+    int depth = 0;
+
+    for (;;)
+    {
+      p = Scanner::find(p, end, '<');
+      if (p == end)
+      {
+        break;
+      }
+
+      const char *tag = p;
+
+      if (Scanner::starts_with(p, end, "<!--"))
+      {
+        p = Scanner::find(p + 4, end, "-->");
+        p = p == end ? end : p + 3;
+        continue;
+      }
+
+      if (Scanner::starts_with(p, end, "<![CDATA["))
+      {
+        p = Scanner::find(p + 9, end, "]]>");
+        p = p == end ? end : p + 3;
+        continue;
+      }
+
+      if (Scanner::starts_with(p, end, "<?"))
+      {
+        p = Scanner::find(p + 2, end, "?>");
+        p = p == end ? end : p + 2;
+        continue;
+      }
+
+      if (Scanner::starts_with(p, end, "<!"))
+      {
+        p = Scanner::skip_declaration(p + 2, end);
+        p = p == end ? end : p + 1;
+        continue;
+      }
+
+      p = Scanner::skip_tag(p + 1, end);
+      if (p == end)
+      {
+        throw std::runtime_error("Unterminated tag");
+      }
+      ++p;
+
+      if (tag[1] == '/')
+      {
+        if (--depth < 0)
+        {
+          throw std::runtime_error("Unbalanced end tag");
+        }
+
+        if (depth == 1)
+        {
+          this->_records.push_back({record, static_cast<std::size_t>(p - record)});
+        }
+      }
+      else if (p[-2] == '/')
+      {
+        if (depth == 1)
+        {
+          this->_records.push_back({tag, static_cast<std::size_t>(p - tag)});
+        }
+      }
+      else
+      {
+        if (depth == 1)
+        {
+          record = tag;
+        }
+        ++depth;
+      }
+    }
+
+    if (depth != 0)
+    {
+      throw std::runtime_error("Document is not closed");
+    }
+  }
+
+public:
+  explicit Handler(const char *path)
+    : _file(new MappedFile(path)), _data(_file->get_data()), _size(_file->get_size())
+  {
+    this->scan();
+  }
+
+  Handler(const char *data, std::size_t size) : _data(data), _size(size)
+  {
+    this->scan();
+  }
+
+  std::size_t get_count() const { return this->_records.size(); }
+
+  RecordSplitter::Record get_record(std::size_t index) const
+  {
+    if (index >= this->_records.size())
+    {
+      throw std::runtime_error("Out of range");
+    }
+    return this->_records[index];
+  }
+
+  void parse(const RecordSplitter::Callback &callback, std::size_t thread_count) const
+  {
+    Document::Handler::initialize_threads();
+
+    WorkStealingScheduler scheduler(thread_count);
+    for (std::size_t first = 0; first < this->_records.size(); first += parse_chunk_size)
+    {
+      std::size_t last = std::min(first + parse_chunk_size, this->_records.size());
+      scheduler.submit([this, first, last, &callback]() {
+        for (std::size_t i = first; i < last; ++i)
+        {
+          Document document;
+          document.parse(this->_records[i].data, this->_records[i].size);
+          callback(i, document);
+        }
+      });
+    }
+    scheduler.wait();
+  }
+};
+
+RecordSplitter::RecordSplitter(const char *path)
+  : handler(new RecordSplitter::Handler(path)) {}
+
+RecordSplitter::RecordSplitter(const std::string &path)
+  : handler(new RecordSplitter::Handler(path.c_str())) {}
+
+RecordSplitter::RecordSplitter(const char *data, std::size_t size)
+  : handler(new RecordSplitter::Handler(data, size)) {}
+
+std::size_t RecordSplitter::get_count() const { return this->handler->get_count(); }
+
+RecordSplitter::Record RecordSplitter::operator[](std::size_t index) const
+{
+  return this->handler->get_record(index);
+}
+
+void RecordSplitter::parse(const RecordSplitter::Callback &callback, std::size_t thread_count) const
+{
+  this->handler->parse(callback, thread_count);
+}
+
+std::vector<Document> RecordSplitter::parse(std::size_t thread_count) const
+{
+  std::vector<Document> result(this->handler->get_count());
+  this->handler->parse(
+      [&result](std::size_t index, Document &record) { result[index] = record; },
+      thread_count);
+  return result;
+}
+
+}
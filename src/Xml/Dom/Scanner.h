@@ -0,0 +1,346 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file Scanner.h
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief SIMD accelerated byte scanning helpers for xml markup
+ *
+ * Markup boundaries are found by searching a small set of bytes ('<', '>',
+ * quotes ...). On x86-64 with GCC or Clang the search uses AVX2 when the CPU
+ * supports it and SSE2 otherwise, other compilers and platforms use a scalar
+ * loop. Implementation is selected once
+ * at runtime.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+
+// Needs GCC or Clang for target attributes and CPU feature builtins
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define UN_XML_SCANNER_X86 1
+#include <immintrin.h>
+#endif
+
+namespace un::Xml::Dom::Scanner
+{
+
+/// Up to four bytes to search for. Unused slots repeat the first byte.
+struct ByteSet
+{
+  char bytes[4];
+
+  ByteSet(char a) : bytes{a, a, a, a} {}
+  ByteSet(char a, char b) : bytes{a, b, a, a} {}
+  ByteSet(char a, char b, char c) : bytes{a, b, c, a} {}
+  ByteSet(char a, char b, char c, char d) : bytes{a, b, c, d} {}
+
+  inline bool contains(char c) const
+  {
+    return c == bytes[0] || c == bytes[1] || c == bytes[2] || c == bytes[3];
+  }
+};
+
+typedef const char *(*FindFunction)(const char *, const char *, const ByteSet &);
+
+/// Control characters (below 0x20) match when with_controls is set
+template <bool with_controls>
+inline const char *find_scalar(const char *begin, const char *end, const ByteSet &set)
+{
+  for (; begin != end; ++begin)
+  {
+    if (set.contains(*begin) ||
+        (with_controls && static_cast<unsigned char>(*begin) < 0x20))
+    {
+      return begin;
+    }
+  }
+  return end;
+}
+
+#ifdef UN_XML_SCANNER_X86
+
+template <bool with_controls>
+inline const char *find_sse2(const char *begin, const char *end, const ByteSet &set)
+{
+  const __m128i a = _mm_set1_epi8(set.bytes[0]);
+  const __m128i b = _mm_set1_epi8(set.bytes[1]);
+  const __m128i c = _mm_set1_epi8(set.bytes[2]);
+  const __m128i d = _mm_set1_epi8(set.bytes[3]);
+  const __m128i control = _mm_set1_epi8(0x1f);
+
+  for (; end - begin >= 16; begin += 16)
+  {
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+    __m128i hits = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(block, a), _mm_cmpeq_epi8(block, b)),
+        _mm_or_si128(_mm_cmpeq_epi8(block, c), _mm_cmpeq_epi8(block, d)));
+    if (with_controls)
+    {
+      // max(x, 0x1f) == 0x1f only for unsigned x <= 0x1f
+      hits = _mm_or_si128(hits, _mm_cmpeq_epi8(_mm_max_epu8(block, control), control));
+    }
+    int mask = _mm_movemask_epi8(hits);
+    if (mask != 0)
+    {
+      return begin + __builtin_ctz(static_cast<unsigned>(mask));
+    }
+  }
+
+  return find_scalar<with_controls>(begin, end, set);
+}
+
+template <bool with_controls>
+__attribute__((target("avx2"))) inline const char *
+find_avx2(const char *begin, const char *end, const ByteSet &set)
+{
+  const __m256i a = _mm256_set1_epi8(set.bytes[0]);
+  const __m256i b = _mm256_set1_epi8(set.bytes[1]);
+  const __m256i c = _mm256_set1_epi8(set.bytes[2]);
+  const __m256i d = _mm256_set1_epi8(set.bytes[3]);
+  const __m256i control = _mm256_set1_epi8(0x1f);
+
+  for (; end - begin >= 32; begin += 32)
+  {
+    __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+    __m256i hits = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(block, a), _mm256_cmpeq_epi8(block, b)),
+        _mm256_or_si256(_mm256_cmpeq_epi8(block, c), _mm256_cmpeq_epi8(block, d)));
+    if (with_controls)
+    {
+      hits = _mm256_or_si256(
+          hits, _mm256_cmpeq_epi8(_mm256_max_epu8(block, control), control));
+    }
+    unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(hits));
+    if (mask != 0)
+    {
+      return begin + __builtin_ctz(mask);
+    }
+  }
+
+  return find_sse2<with_controls>(begin, end, set);
+}
+
+#endif
+
+/// Implementation picked for the running CPU
+template <bool with_controls>
+inline FindFunction select()
+{
+#ifdef UN_XML_SCANNER_X86
+  if (__builtin_cpu_supports("avx2"))
+  {
+    return find_avx2<with_controls>;
+  }
+  return find_sse2<with_controls>;
+#else
+  return find_scalar<with_controls>;
+#endif
+}
+
+/**
+ * Returns first byte in [begin, end) which is in set, end if there is none.
+ */
+inline const char *find(const char *begin, const char *end, const ByteSet &set)
+{
+  static const FindFunction implementation = select<false>();
+  return implementation(begin, end, set);
+}
+
+/**
+ * Returns first byte in [begin, end) which is in set or is a control character
+ * (tab, new line ...), end if there is none.
+ */
+inline const char *find_with_controls(const char *begin, const char *end, const ByteSet &set)
+{
+  static const FindFunction implementation = select<true>();
+  return implementation(begin, end, set);
+}
+
+typedef const char *(*FindRangeFunction)(const char *, const char *);
+
+inline const char *find_control_or_non_ascii_scalar(const char *begin, const char *end)
+{
+  for (; begin != end; ++begin)
+  {
+    unsigned char c = static_cast<unsigned char>(*begin);
+    if ((c < 0x20 && c != '\t' && c != '\n' && c != '\r') || c >= 0x80)
+    {
+      return begin;
+    }
+  }
+  return end;
+}
+
+#ifdef UN_XML_SCANNER_X86
+
+// Bytes from 0x80 are negative in signed comparison, so one compare finds
+// both, white space is masked out afterwards
+
+inline const char *find_control_or_non_ascii_sse2(const char *begin, const char *end)
+{
+  const __m128i limit = _mm_set1_epi8(0x20);
+  const __m128i tab = _mm_set1_epi8('\t');
+  const __m128i new_line = _mm_set1_epi8('\n');
+  const __m128i carriage_return = _mm_set1_epi8('\r');
+  for (; end - begin >= 16; begin += 16)
+  {
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+    __m128i space = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, tab), _mm_cmpeq_epi8(block, new_line)),
+                                 _mm_cmpeq_epi8(block, carriage_return));
+    int mask = _mm_movemask_epi8(_mm_andnot_si128(space, _mm_cmplt_epi8(block, limit)));
+    if (mask != 0)
+    {
+      return begin + __builtin_ctz(static_cast<unsigned>(mask));
+    }
+  }
+  return find_control_or_non_ascii_scalar(begin, end);
+}
+
+__attribute__((target("avx2"))) inline const char *
+find_control_or_non_ascii_avx2(const char *begin, const char *end)
+{
+  const __m256i limit = _mm256_set1_epi8(0x20);
+  const __m256i tab = _mm256_set1_epi8('\t');
+  const __m256i new_line = _mm256_set1_epi8('\n');
+  const __m256i carriage_return = _mm256_set1_epi8('\r');
+  for (; end - begin >= 32; begin += 32)
+  {
+    __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+    __m256i space = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(block, tab), _mm256_cmpeq_epi8(block, new_line)),
+                                    _mm256_cmpeq_epi8(block, carriage_return));
+    unsigned mask =
+        static_cast<unsigned>(_mm256_movemask_epi8(_mm256_andnot_si256(space, _mm256_cmpgt_epi8(limit, block))));
+    if (mask != 0)
+    {
+      return begin + __builtin_ctz(mask);
+    }
+  }
+  return find_control_or_non_ascii_sse2(begin, end);
+}
+
+#endif
+
+/**
+ * Returns first byte in [begin, end) which is a control character other than
+ * tab, new line or carriage return or is not ASCII (part of a UTF-8
+ * sequence), end if there is none.
+ */
+inline const char *find_control_or_non_ascii(const char *begin, const char *end)
+{
+#ifdef UN_XML_SCANNER_X86
+  static const FindRangeFunction implementation =
+      __builtin_cpu_supports("avx2") ? find_control_or_non_ascii_avx2 : find_control_or_non_ascii_sse2;
+#else
+  static const FindRangeFunction implementation = find_control_or_non_ascii_scalar;
+#endif
+  return implementation(begin, end);
+}
+
+/**
+ * Returns first occurrence of c in [begin, end), end if there is none.
+ */
+inline const char *find(const char *begin, const char *end, char c)
+{
+  const void *result = std::memchr(begin, c, end - begin);
+  return result == NULL ? end : static_cast<const char *>(result);
+}
+
+/**
+ * Returns first occurrence of pattern in [begin, end), end if there is none.
+ */
+inline const char *find(const char *begin, const char *end, const char *pattern,
+                        std::size_t pattern_size)
+{
+  while (static_cast<std::size_t>(end - begin) >= pattern_size)
+  {
+    begin = find(begin, end - pattern_size + 1, pattern[0]);
+    if (static_cast<std::size_t>(end - begin) < pattern_size)
+    {
+      break;
+    }
+    if (std::memcmp(begin, pattern, pattern_size) == 0)
+    {
+      return begin;
+    }
+    ++begin;
+  }
+  return end;
+}
+
+template <std::size_t size>
+inline const char *find(const char *begin, const char *end, const char (&pattern)[size])
+{
+  return find(begin, end, pattern, size - 1);
+}
+
+template <std::size_t size>
+inline bool starts_with(const char *begin, const char *end, const char (&pattern)[size])
+{
+  return static_cast<std::size_t>(end - begin) >= size - 1 &&
+         std::memcmp(begin, pattern, size - 1) == 0;
+}
+
+/**
+ * Skips a start or end tag beginning at p ('<'), honoring quoted attribute
+ * values. Returns pointer to the closing '>' or end if tag is not closed.
+ */
+inline const char *skip_tag(const char *p, const char *end)
+{
+  for (;;)
+  {
+    p = find(p, end, ByteSet('>', '"', '\''));
+    if (p == end || *p == '>')
+    {
+      return p;
+    }
+
+    p = find(p + 1, end, *p);
+    if (p == end)
+    {
+      return end;
+    }
+    ++p;
+  }
+}
+
+/**
+ * Skips a markup declaration starting with "<!" which is not a comment or
+ * CDATA section (e.g. DOCTYPE with internal subset). Returns pointer to the
+ * closing '>' or end.
+ */
+inline const char *skip_declaration(const char *p, const char *end)
+{
+  // Declarations are rare and short, a scalar loop is enough
+  int brackets = 0;
+  for (; p != end; ++p)
+  {
+    switch (*p)
+    {
+    case '[':
+      ++brackets;
+      break;
+    case ']':
+      --brackets;
+      break;
+    case '>':
+      if (brackets <= 0)
+      {
+        return p;
+      }
+      break;
+    case '"':
+    case '\'':
+      p = find(p + 1, end, *p);
+      if (p == end)
+      {
+        return end;
+      }
+      break;
+    }
+  }
+  return end;
+}
+
+}
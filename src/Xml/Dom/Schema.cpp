@@ -0,0 +1,405 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file Schema.cpp
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief XSD and RelaxNG schemas compiled once and validated against many times
+ */
+
+#include <Xml/Dom/Schema.h>
+#include "DocumentHandlerLibxml2.h"
+#include <cstring>
+#include <libxml/parser.h>
+#include <libxml/relaxng.h>
+#include <libxml/xmlreader.h>
+#include <libxml/xmlschemas.h>
+#include <mutex>
+#include <stdexcept>
+
+namespace un::Xml::Dom
+{
+
+class Schema::Handler
+{
+private:
+  static constexpr const char *xsd_namespace = "http://www.w3.org/2001/XMLSchema";
+  static constexpr const char *relaxng_namespace = "http://relaxng.org/ns/structure/1.0";
+
+  Schema::Language _language;
+
+  // Kept for the lifetime of the compiled schema, which points into it
+  xmlDocPtr _doc;
+  xmlSchemaPtr _xsd;
+  xmlRelaxNGPtr _relaxng;
+
+  // Idle validation contexts of one language
+  std::vector<void *> _contexts;
+  std::mutex _mutex;
+
+  static void on_error(void *data, xmlErrorPtr error)
+  {
+    std::vector<std::string> &errors = *static_cast<std::vector<std::string> *>(data);
+    std::string message = error->message == NULL ? "Unknown error" : error->message;
+    while (!message.empty() && message.back() == '\n')
+    {
+      message.pop_back();
+    }
+    if (error->line > 0)
+    {
+      message = "line " + std::to_string(error->line) + ": " + message;
+    }
+    errors.push_back(message);
+  }
+
+  static std::string join(const std::vector<std::string> &errors)
+  {
+    std::string result;
+    for (const std::string &error : errors)
+    {
+      result += result.empty() ? "" : "\n";
+      result += error;
+    }
+    return result;
+  }
+
+  /**
+   * Validation context taken from the pool, returned on destruction. A
+   * context that saw an error may hold state of the failed pass and is freed
+   * instead.
+   */
+  class Context
+  {
+  private:
+    Handler &_owner;
+    void *_context;
+
+  public:
+    bool is_reusable;
+
+    Context(Handler &owner, std::vector<std::string> &errors)
+      : _owner(owner), _context(owner.take()), is_reusable(false)
+    {
+      if (this->_owner._language == Schema::Language::xsd)
+      {
+        xmlSchemaSetValidStructuredErrors(this->get_xsd(), on_error, &errors);
+      }
+      else
+      {
+        xmlRelaxNGSetValidStructuredErrors(this->get_relaxng(), on_error, &errors);
+      }
+    }
+
+    ~Context()
+    {
+      this->_owner.give_back(this->_context, this->is_reusable);
+    }
+
+    xmlSchemaValidCtxtPtr get_xsd() const
+    {
+      return static_cast<xmlSchemaValidCtxtPtr>(this->_context);
+    }
+
+    xmlRelaxNGValidCtxtPtr get_relaxng() const
+    {
+      return static_cast<xmlRelaxNGValidCtxtPtr>(this->_context);
+    }
+  };
+
+  void *take()
+  {
+    {
+      std::lock_guard<std::mutex> lock(this->_mutex);
+      if (!this->_contexts.empty())
+      {
+        void *context = this->_contexts.back();
+        this->_contexts.pop_back();
+        return context;
+      }
+    }
+
+    void *context = this->_language == Schema::Language::xsd ? (void *)xmlSchemaNewValidCtxt(this->_xsd)
+                                                            : (void *)xmlRelaxNGNewValidCtxt(this->_relaxng);
+    if (context == NULL)
+    {
+      throw std::runtime_error("Cannot create validation context");
+    }
+    return context;
+  }
+
+  void free(void *context)
+  {
+    if (this->_language == Schema::Language::xsd)
+    {
+      xmlSchemaFreeValidCtxt(static_cast<xmlSchemaValidCtxtPtr>(context));
+    }
+    else
+    {
+      xmlRelaxNGFreeValidCtxt(static_cast<xmlRelaxNGValidCtxtPtr>(context));
+    }
+  }
+
+  void give_back(void *context, bool is_reusable)
+  {
+    if (is_reusable)
+    {
+      std::lock_guard<std::mutex> lock(this->_mutex);
+      this->_contexts.push_back(context);
+      return;
+    }
+    this->free(context);
+  }
+
+  /// Compile schema from doc, takes ownership of doc
+  void compile(xmlDocPtr doc)
+  {
+    this->_doc = doc;
+    xmlNodePtr root = xmlDocGetRootElement(doc);
+    const char *uri = root == NULL || root->ns == NULL ? "" : (const char *)root->ns->href;
+
+    std::vector<std::string> errors;
+    if (std::strcmp(uri, xsd_namespace) == 0)
+    {
+      this->_language = Schema::Language::xsd;
+      xmlSchemaParserCtxtPtr context = xmlSchemaNewDocParserCtxt(doc);
+      if (context == NULL)
+      {
+        throw std::runtime_error("xmlSchemaNewDocParserCtxt failed");
+      }
+      xmlSchemaSetParserStructuredErrors(context, on_error, &errors);
+      this->_xsd = xmlSchemaParse(context);
+      xmlSchemaFreeParserCtxt(context);
+      if (this->_xsd == NULL)
+      {
+        throw std::runtime_error("Cannot compile XSD schema: " + join(errors));
+      }
+    }
+    else if (std::strcmp(uri, relaxng_namespace) == 0)
+    {
+      this->_language = Schema::Language::relaxng;
+      xmlRelaxNGParserCtxtPtr context = xmlRelaxNGNewDocParserCtxt(doc);
+      if (context == NULL)
+      {
+        throw std::runtime_error("xmlRelaxNGNewDocParserCtxt failed");
+      }
+      xmlRelaxNGSetParserStructuredErrors(context, on_error, &errors);
+      this->_relaxng = xmlRelaxNGParse(context);
+      xmlRelaxNGFreeParserCtxt(context);
+      if (this->_relaxng == NULL)
+      {
+        throw std::runtime_error("Cannot compile RelaxNG schema: " + join(errors));
+      }
+    }
+    else
+    {
+      throw std::runtime_error("Root element is not an XSD or RelaxNG schema");
+    }
+  }
+
+  static xmlDocPtr check_parsed(xmlDocPtr doc)
+  {
+    if (doc == NULL)
+    {
+      xmlErrorPtr err = xmlGetLastError();
+      throw std::runtime_error(err == NULL ? "Cannot parse schema" : err->message);
+    }
+    return doc;
+  }
+
+  void release()
+  {
+    for (void *context : this->_contexts)
+    {
+      this->free(context);
+    }
+    this->_contexts.clear();
+    if (this->_xsd != NULL)
+    {
+      xmlSchemaFree(this->_xsd);
+    }
+    if (this->_relaxng != NULL)
+    {
+      xmlRelaxNGFree(this->_relaxng);
+    }
+    if (this->_doc != NULL)
+    {
+      xmlFreeDoc(this->_doc);
+    }
+  }
+
+  /// Read everything from reader made by open, validating with a pooled context
+  template <typename Open>
+  bool validate_stream(const Open &open, std::vector<std::string> &errors)
+  {
+    std::size_t error_count = errors.size();
+
+    // Reader is freed first, detaching the context before it goes back to the pool
+    Context context(*this, errors);
+    xmlTextReaderPtr reader = open();
+    if (reader == NULL)
+    {
+      throw std::runtime_error("Cannot create reader");
+    }
+    std::shared_ptr<xmlTextReader> guard(reader, xmlFreeTextReader);
+
+    // Parse errors, validation errors are relayed here as well
+    xmlTextReaderSetStructuredErrorHandler(reader, on_error, &errors);
+
+    int result = this->_language == Schema::Language::xsd
+                     ? xmlTextReaderSchemaValidateCtxt(reader, context.get_xsd(), 0)
+                     : xmlTextReaderRelaxNGValidateCtxt(reader, context.get_relaxng(), 0);
+    if (result != 0)
+    {
+      throw std::runtime_error("Cannot attach validation context to reader");
+    }
+
+    while ((result = xmlTextReaderRead(reader)) == 1)
+    {
+    }
+
+    bool is_valid = result == 0 && xmlTextReaderIsValid(reader) == 1 && errors.size() == error_count;
+    if (!is_valid && errors.size() == error_count)
+    {
+      errors.push_back("Document is not valid");
+    }
+
+    context.is_reusable = is_valid;
+    return is_valid;
+  }
+
+public:
+  explicit Handler(xmlDocPtr doc)
+    : _language(Schema::Language::xsd), _doc(NULL), _xsd(NULL), _relaxng(NULL)
+  {
+    xmlInitParser();
+    try
+    {
+      this->compile(doc);
+    }
+    catch (...)
+    {
+      this->release();
+      throw;
+    }
+  }
+
+  static std::shared_ptr<Handler> from_file(const char *path)
+  {
+    xmlInitParser();
+    return std::make_shared<Handler>(check_parsed(xmlReadFile(path, NULL, 0)));
+  }
+
+  static std::shared_ptr<Handler> from_memory(const char *data, std::size_t size)
+  {
+    xmlInitParser();
+    return std::make_shared<Handler>(check_parsed(xmlReadMemory(data, static_cast<int>(size), NULL, NULL, 0)));
+  }
+
+  static std::shared_ptr<Handler> from_document(const Document &document)
+  {
+    std::shared_ptr<xmlDoc> source = document.handler->get_output_doc();
+    xmlDocPtr doc = xmlCopyDoc(source.get(), 1);
+    if (doc == NULL)
+    {
+      throw std::runtime_error("xmlCopyDoc failed");
+    }
+    return std::make_shared<Handler>(doc);
+  }
+
+  ~Handler()
+  {
+    this->release();
+  }
+
+  inline Schema::Language get_language() const
+  {
+    return this->_language;
+  }
+
+  bool validate(const Document &document, std::vector<std::string> &errors)
+  {
+    std::shared_ptr<xmlDoc> doc = document.handler->get_output_doc();
+    if (xmlDocGetRootElement(doc.get()) == NULL)
+    {
+      errors.push_back("Document has no root element");
+      return false;
+    }
+
+    std::size_t error_count = errors.size();
+    Context context(*this, errors);
+    int result = this->_language == Schema::Language::xsd ? xmlSchemaValidateDoc(context.get_xsd(), doc.get())
+                                                          : xmlRelaxNGValidateDoc(context.get_relaxng(), doc.get());
+    if (result != 0 && errors.size() == error_count)
+    {
+      errors.push_back("Document is not valid");
+    }
+    context.is_reusable = result == 0;
+    return result == 0;
+  }
+
+  bool validate(const char *data, std::size_t size, std::vector<std::string> &errors)
+  {
+    return this->validate_stream(
+        [data, size]() { return xmlReaderForMemory(data, static_cast<int>(size), NULL, NULL, 0); }, errors);
+  }
+
+  bool validate_file(const char *path, std::vector<std::string> &errors)
+  {
+    return this->validate_stream([path]() { return xmlReaderForFile(path, NULL, 0); }, errors);
+  }
+
+  static void check(bool is_valid, const std::vector<std::string> &errors)
+  {
+    if (!is_valid)
+    {
+      throw std::runtime_error(join(errors));
+    }
+  }
+};
+
+Schema::Schema(const char *path) : handler(Schema::Handler::from_file(path)) {}
+
+Schema::Schema(const std::string &path) : handler(Schema::Handler::from_file(path.c_str())) {}
+
+Schema::Schema(const char *data, std::size_t size) : handler(Schema::Handler::from_memory(data, size)) {}
+
+Schema::Schema(const Document &document) : handler(Schema::Handler::from_document(document)) {}
+
+Schema::Language Schema::get_language() const
+{
+  return this->handler->get_language();
+}
+
+bool Schema::validate(const Document &document, std::vector<std::string> &errors) const
+{
+  return this->handler->validate(document, errors);
+}
+
+void Schema::validate(const Document &document) const
+{
+  std::vector<std::string> errors;
+  Schema::Handler::check(this->handler->validate(document, errors), errors);
+}
+
+bool Schema::validate(const char *data, std::size_t size, std::vector<std::string> &errors) const
+{
+  return this->handler->validate(data, size, errors);
+}
+
+void Schema::validate(const char *data, std::size_t size) const
+{
+  std::vector<std::string> errors;
+  Schema::Handler::check(this->handler->validate(data, size, errors), errors);
+}
+
+bool Schema::validate_file(const char *path, std::vector<std::string> &errors) const
+{
+  return this->handler->validate_file(path, errors);
+}
+
+void Schema::validate_file(const char *path) const
+{
+  std::vector<std::string> errors;
+  Schema::Handler::check(this->handler->validate_file(path, errors), errors);
+}
+
+}
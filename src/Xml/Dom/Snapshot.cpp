@@ -0,0 +1,215 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file Snapshot.cpp
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief Binary snapshot files of compact trees
+ */
+
+#include "Snapshot.h"
+#include "MappedFile.h"
+#include "TemporaryFile.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace un::Xml::Dom::Snapshot
+{
+
+namespace
+{
+
+const char magic[8] = {'U', 'N', 'X', 'M', 'L', 'S', 'N', 'P'};
+
+const uint32_t byte_order_mark = 0x01020304;
+
+struct Header
+{
+  char magic[8];
+  uint32_t format_version;
+  uint32_t byte_order_mark;
+  CompactTree::Counts counts;
+  uint64_t declaration_size; // Padded to 8 bytes
+  uint64_t checksum;         // Of declaration and tree buffer
+};
+
+static_assert(sizeof(Header) % 8 == 0, "Tree buffer must stay 8 byte aligned");
+
+inline uint64_t rotate(uint64_t value, int bits)
+{
+  return (value << bits) | (value >> (64 - bits));
+}
+
+/// Four independent lanes over 8 byte words, fast enough to not matter next to disk reads
+class Checksum
+{
+private:
+  static const uint64_t prime1 = 0x9e3779b185ebca87ULL;
+  static const uint64_t prime2 = 0xc2b2ae3d27d4eb4fULL;
+  uint64_t _lanes[4];
+  uint64_t _size;
+
+  static inline uint64_t round(uint64_t lane, uint64_t word)
+  {
+    return rotate(lane + word * prime2, 31) * prime1;
+  }
+
+public:
+  Checksum() : _lanes{prime1, prime2, 0, ~prime1}, _size(0) {}
+
+  /// Size must be a multiple of 8
+  void update(const char *data, std::size_t size)
+  {
+    const char *const end = data + size;
+    for (; data + 32 <= end; data += 32)
+    {
+      for (int lane = 0; lane < 4; ++lane)
+      {
+        uint64_t word;
+        std::memcpy(&word, data + lane * 8, 8);
+        this->_lanes[lane] = round(this->_lanes[lane], word);
+      }
+    }
+    for (; data < end; data += 8)
+    {
+      uint64_t word;
+      std::memcpy(&word, data, 8);
+      this->_lanes[0] = round(this->_lanes[0], word);
+    }
+    this->_size += size;
+  }
+
+  uint64_t get_value() const
+  {
+    uint64_t result = this->_size * prime1;
+    for (int lane = 0; lane < 4; ++lane)
+    {
+      result = rotate(result ^ round(0, this->_lanes[lane]), 27) * prime1 + prime2;
+    }
+    return result;
+  }
+};
+
+/// version\0encoding\0 padded with zeros to 8 bytes
+std::string encode(const Declaration &declaration)
+{
+  std::string result = declaration.version;
+  result.push_back('\0');
+  result += declaration.encoding;
+  result.push_back('\0');
+  result.resize((result.size() + 7) & ~static_cast<std::size_t>(7), '\0');
+  return result;
+}
+
+} // namespace
+
+void save(const char *path, const CompactTree &tree, const Declaration &declaration)
+{
+  std::string encoded = encode(declaration);
+  std::size_t size = tree.get_buffer_size();
+
+  Checksum checksum;
+  checksum.update(encoded.data(), encoded.size());
+  checksum.update(tree.get_buffer(), size);
+
+  Header header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, magic, sizeof(magic));
+  header.format_version = format_version;
+  header.byte_order_mark = byte_order_mark;
+  header.counts = tree.get_counts();
+  header.declaration_size = encoded.size();
+  header.checksum = checksum.get_value();
+
+  std::string temporary = TemporaryFile::get_path(path);
+  {
+    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+    if (!file)
+    {
+      throw std::runtime_error("Cannot open file: " + temporary);
+    }
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(encoded.data(), encoded.size());
+    file.write(tree.get_buffer(), size);
+    file.flush();
+
+    if (!file)
+    {
+      file.close();
+      std::remove(temporary.c_str());
+      throw std::runtime_error("Cannot write file: " + temporary);
+    }
+  }
+
+  if (std::rename(temporary.c_str(), path) != 0)
+  {
+    std::remove(temporary.c_str());
+    throw std::runtime_error(std::string("Cannot rename snapshot to: ") + path);
+  }
+}
+
+std::shared_ptr<const CompactTree> load(const char *path, Declaration &declaration)
+{
+  std::shared_ptr<MappedFile> file(new MappedFile(path));
+  const char *data = file->get_data();
+  std::size_t size = file->get_size();
+
+  Header header;
+  if (size < sizeof(header))
+  {
+    throw std::runtime_error(std::string("Not a snapshot file: ") + path);
+  }
+  std::memcpy(&header, data, sizeof(header));
+
+  if (std::memcmp(header.magic, magic, sizeof(magic)) != 0)
+  {
+    throw std::runtime_error(std::string("Not a snapshot file: ") + path);
+  }
+  if (header.byte_order_mark != byte_order_mark)
+  {
+    throw std::runtime_error(std::string("Snapshot has different byte order: ") + path);
+  }
+  if (header.format_version != format_version)
+  {
+    throw std::runtime_error(std::string("Unsupported snapshot version: ") + path);
+  }
+
+  std::size_t body_size = size - sizeof(header);
+  if (header.declaration_size % 8 != 0 || header.declaration_size > body_size ||
+      body_size - header.declaration_size != CompactTree::get_buffer_size(header.counts))
+  {
+    throw std::runtime_error(std::string("Snapshot size mismatch: ") + path);
+  }
+
+  const char *body = data + sizeof(header);
+  // Same chunks as save, lanes depend on where updates start
+  Checksum checksum;
+  checksum.update(body, header.declaration_size);
+  checksum.update(body + header.declaration_size, body_size - header.declaration_size);
+  if (checksum.get_value() != header.checksum)
+  {
+    throw std::runtime_error(std::string("Snapshot checksum mismatch: ") + path);
+  }
+
+  const char *encoded = body;
+  const char *const encoded_end = body + header.declaration_size;
+  std::size_t version_size = strnlen(encoded, encoded_end - encoded);
+  if (encoded + version_size == encoded_end)
+  {
+    throw std::runtime_error(std::string("Snapshot declaration is corrupt: ") + path);
+  }
+  declaration.version.assign(encoded, version_size);
+  encoded += version_size + 1;
+  declaration.encoding.assign(encoded, strnlen(encoded, encoded_end - encoded));
+
+  const char *buffer = encoded_end;
+  std::shared_ptr<const CompactTree> tree =
+    CompactTree::bind(header.counts, buffer, body_size - header.declaration_size, file);
+  // Checksum only catches accidents, indices are used unchecked later
+  tree->validate();
+  return tree;
+}
+
+}
@@ -0,0 +1,51 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file Snapshot.h
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief Binary snapshot files of compact trees
+ *
+ * A snapshot is a fixed header, the xml declaration strings and the compact
+ * tree buffer written verbatim. Everything is an offset, so the file is mapped
+ * and used in place without parsing or per-node allocation, and processes
+ * mapping the same file share its pages.
+ *
+ * Header carries a magic, a format version, a byte order mark and a checksum of
+ * everything that follows it. Snapshots are written to a temporary file and
+ * renamed, readers never see a partial file (see TemporaryFile.h).
+ */
+
+#pragma once
+
+#include "CompactTree.h"
+#include <memory>
+#include <string>
+
+namespace un::Xml::Dom::Snapshot
+{
+
+/// Bumped whenever header or compact tree layout changes
+const uint32_t format_version = 1;
+
+/// Declaration of the snapshotted document
+struct Declaration
+{
+  std::string version;
+  std::string encoding;
+};
+
+/**
+ * Write snapshot of tree to file
+ *
+ * @throw std::runtime_error if file cannot be written
+ */
+void save(const char *path, const CompactTree &tree, const Declaration &declaration);
+
+/**
+ * Map snapshot file, returned tree keeps the mapping alive
+ *
+ * @throw std::runtime_error if file is not a valid snapshot of this format
+ */
+std::shared_ptr<const CompactTree> load(const char *path, Declaration &declaration);
+
+}
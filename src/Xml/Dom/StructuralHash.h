@@ -0,0 +1,70 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file StructuralHash.h
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief Building blocks of Node::hash
+ *
+ * Libxml2 and compact trees feed the same values in the same order, so a
+ * subtree hashes the same in both. A node hash is
+ *
+ *   combine(type, name, namespace URI, sum of attribute hashes, text or
+ *           child hashes in order)
+ *
+ * Attribute hashes are summed, which makes the hash independent of attribute
+ * order. Namespace prefixes and declarations are left out. Finished hashes
+ * are never 0 so 0 can mark a missing cache entry.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace un::Xml::Dom::StructuralHash
+{
+
+inline uint64_t bytes(const char *data, std::size_t size)
+{
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    hash = (hash ^ static_cast<unsigned char>(data[i])) * 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+inline uint64_t string(const char *text)
+{
+  return text == nullptr ? 0 : bytes(text, std::char_traits<char>::length(text));
+}
+
+inline uint64_t combine(uint64_t hash, uint64_t value)
+{
+  return hash ^ (value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2));
+}
+
+/// Node start, name is element name or PI target, NULL for others
+inline uint64_t start(int type, const char *name, const char *ns)
+{
+  return combine(combine(static_cast<uint64_t>(type), string(name)), string(ns));
+}
+
+inline uint64_t attribute(const char *name, const char *ns, std::string_view value)
+{
+  return combine(combine(string(name), string(ns)), bytes(value.data(), value.size()));
+}
+
+inline uint64_t finish(uint64_t hash)
+{
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ULL;
+  hash ^= hash >> 33;
+  return hash == 0 ? 1 : hash;
+}
+
+}
@@ -0,0 +1,30 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file TemporaryFile.h
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief Names of temporary files renamed over their target when complete
+ *
+ * The temporary file is created next to its target, so the rename stays on
+ * one file system and is atomic. Process id and a counter make the name
+ * unique, so threads and processes saving the same path concurrently do not
+ * write into each other's file; the last rename wins.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <unistd.h>
+
+namespace un::Xml::Dom::TemporaryFile
+{
+
+inline std::string get_path(const char *path)
+{
+  static std::atomic<unsigned long> counter(0);
+  return std::string(path) + ".tmp." + std::to_string(getpid()) + "." +
+         std::to_string(counter.fetch_add(1, std::memory_order_relaxed));
+}
+
+}
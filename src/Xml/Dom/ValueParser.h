@@ -0,0 +1,123 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file ValueParser.h
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief Locale independent parsing of typed values from text
+ *
+ * Numbers are parsed with std::from_chars straight from the text, without
+ * copying it. Following XML Schema lexical forms, white space around the value
+ * and a leading '+' are accepted, booleans are true, false, 1 or 0 and the
+ * special floating point values are INF, -INF and NaN only.
+ */
+
+#pragma once
+
+#include <charconv>
+#include <limits>
+#include <string_view>
+#include <type_traits>
+
+namespace un::Xml::Dom::ValueParser
+{
+
+inline bool is_space(char c)
+{
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+inline std::string_view trim(std::string_view text)
+{
+  while (!text.empty() && is_space(text.front()))
+  {
+    text.remove_prefix(1);
+  }
+  while (!text.empty() && is_space(text.back()))
+  {
+    text.remove_suffix(1);
+  }
+  return text;
+}
+
+/**
+ * Parse whole text as value
+ *
+ * @return false if text is not a valid T, value is untouched then
+ */
+template <class T>
+bool parse(std::string_view text, T &value)
+{
+  static_assert(std::is_arithmetic<T>::value, "Only arithmetic types can be parsed");
+
+  text = trim(text);
+  if (text.size() > 1 && text.front() == '+' && text[1] != '-')
+  {
+    text.remove_prefix(1);
+  }
+
+  if constexpr (std::is_floating_point<T>::value)
+  {
+    if (text == "INF" || text == "-INF")
+    {
+      value = text.front() == '-' ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::infinity();
+      return true;
+    }
+    if (text == "NaN")
+    {
+      value = std::numeric_limits<T>::quiet_NaN();
+      return true;
+    }
+
+    // std::from_chars also takes inf, infinity and nan in any case
+    std::size_t first = !text.empty() && text.front() == '-' ? 1 : 0;
+    if (first < text.size() && ((text[first] | 0x20) == 'i' || (text[first] | 0x20) == 'n'))
+    {
+      return false;
+    }
+  }
+
+  // std::from_chars also stores the value of a valid prefix
+  T result;
+  const char *const end = text.data() + text.size();
+  std::from_chars_result parsed = std::from_chars(text.data(), end, result);
+  if (parsed.ec != std::errc() || parsed.ptr != end)
+  {
+    return false;
+  }
+  value = result;
+  return true;
+}
+
+template <>
+inline bool parse<bool>(std::string_view text, bool &value)
+{
+  text = trim(text);
+  if (text == "true" || text == "1")
+  {
+    value = true;
+    return true;
+  }
+  if (text == "false" || text == "0")
+  {
+    value = false;
+    return true;
+  }
+  return false;
+}
+
+/// Name of type for error messages
+template <class T>
+const char *get_type_name()
+{
+  if (std::is_same<T, bool>::value)
+  {
+    return "bool";
+  }
+  if (std::is_floating_point<T>::value)
+  {
+    return "floating point";
+  }
+  return std::is_signed<T>::value ? "signed integer" : "unsigned integer";
+}
+
+}
@@ -0,0 +1,225 @@
+// Copyright 2016 Abdurrahim Cakar
+/**
+ * @file WorkStealingScheduler.h
+ * @date Oct 19, 2026
+ * @author Abdurrahim Cakar <abdurrahimcakar@gmail.com>
+ * @brief Small work stealing task scheduler used by parallel algorithms
+ *
+ * Every worker owns a task deque. Workers pop their own tasks from the back and
+ * steal from the front of other workers' deques when they run dry. Tasks
+ * submitted from a worker go to its own deque so recursive splitting keeps the
+ * work local until somebody needs to steal it.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace un::Xml::Dom
+{
+
+class WorkStealingScheduler
+{
+public:
+  typedef std::function<void()> Task;
+
+private:
+  struct Worker
+  {
+    std::mutex lock;
+    std::deque<Task> tasks;
+  };
+
+  std::vector<std::unique_ptr<Worker>> _workers;
+  std::vector<std::thread> _threads;
+  std::atomic<std::size_t> _pending;
+  std::atomic<std::size_t> _next_worker;
+  std::atomic<bool> _is_cancelled;
+  std::mutex _error_lock;
+  std::exception_ptr _error;
+
+  struct Current
+  {
+    WorkStealingScheduler *scheduler;
+    std::size_t index;
+  };
+
+  static Current &current()
+  {
+    static thread_local Current result = {NULL, 0};
+    return result;
+  }
+
+  bool pop(std::size_t index, Task &task)
+  {
+    Worker &own = *this->_workers[index];
+    {
+      std::lock_guard<std::mutex> guard(own.lock);
+      if (!own.tasks.empty())
+      {
+        task = std::move(own.tasks.back());
+        own.tasks.pop_back();
+        return true;
+      }
+    }
+
+    for (std::size_t i = 1; i < this->_workers.size(); ++i)
+    {
+      Worker &victim = *this->_workers[(index + i) % this->_workers.size()];
+      std::lock_guard<std::mutex> guard(victim.lock);
+      if (!victim.tasks.empty())
+      {
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  void execute(Task &task)
+  {
+    if (!this->_is_cancelled.load(std::memory_order_relaxed))
+    {
+      try
+      {
+        task();
+      }
+      catch (...)
+      {
+        std::lock_guard<std::mutex> guard(this->_error_lock);
+        if (!this->_error)
+        {
+          this->_error = std::current_exception();
+        }
+        this->_is_cancelled.store(true, std::memory_order_relaxed);
+      }
+    }
+
+    this->_pending.fetch_sub(1, std::memory_order_acq_rel);
+  }
+
+  void run(std::size_t index)
+  {
+    Current previous = current();
+    current() = {this, index};
+
+    Task task;
+    while (this->_pending.load(std::memory_order_acquire) != 0)
+    {
+      if (this->pop(index, task))
+      {
+        this->execute(task);
+        task = nullptr;
+      }
+      else
+      {
+        std::this_thread::yield();
+      }
+    }
+
+    current() = previous;
+  }
+
+public:
+  /**
+   * Creates scheduler. Calling thread takes part in the work on wait() so
+   * thread_count - 1 additional threads are created.
+   *
+   * @param thread_count Number of workers, 0 for hardware concurrency
+   */
+  explicit WorkStealingScheduler(std::size_t thread_count = 0)
+    : _pending(0), _next_worker(0), _is_cancelled(false)
+  {
+    if (thread_count == 0)
+    {
+      thread_count = std::thread::hardware_concurrency();
+    }
+
+    if (thread_count == 0)
+    {
+      thread_count = 1;
+    }
+
+    for (std::size_t i = 0; i < thread_count; ++i)
+    {
+      this->_workers.emplace_back(new Worker());
+    }
+  }
+
+  ~WorkStealingScheduler()
+  {
+    this->_is_cancelled.store(true);
+    for (std::thread &thread : this->_threads)
+    {
+      thread.join();
+    }
+  }
+
+  WorkStealingScheduler(const WorkStealingScheduler &) = delete;
+  WorkStealingScheduler &operator=(const WorkStealingScheduler &) = delete;
+
+  std::size_t get_thread_count() const { return this->_workers.size(); }
+
+  /**
+   * Adds new task. Tasks may submit further tasks.
+   */
+  void submit(Task task)
+  {
+    std::size_t index;
+    if (current().scheduler == this)
+    {
+      index = current().index;
+    }
+    else
+    {
+      index = this->_next_worker.fetch_add(1, std::memory_order_relaxed) %
+              this->_workers.size();
+    }
+
+    this->_pending.fetch_add(1, std::memory_order_acq_rel);
+
+    Worker &worker = *this->_workers[index];
+    std::lock_guard<std::mutex> guard(worker.lock);
+    worker.tasks.push_back(std::move(task));
+  }
+
+  /**
+   * Runs all submitted tasks (and the tasks they submit) to completion. First
+   * exception thrown by a task cancels remaining tasks and is rethrown here.
+   */
+  void wait()
+  {
+    for (std::size_t i = this->_threads.size() + 1; i < this->_workers.size(); ++i)
+    {
+      this->_threads.emplace_back(&WorkStealingScheduler::run, this, i);
+    }
+
+    this->run(0);
+
+    for (std::thread &thread : this->_threads)
+    {
+      thread.join();
+    }
+    this->_threads.clear();
+
+    if (this->_error)
+    {
+      std::exception_ptr error = this->_error;
+      this->_error = nullptr;
+      this->_is_cancelled.store(false);
+      std::rethrow_exception(error);
+    }
+  }
+};
+
+}
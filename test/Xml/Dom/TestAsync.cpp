@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+#include <Xml/Dom/Async.h>
+#include <Xml/Dom/Document.h>
+#include <cstdio>
+#include <future>
+#include <string>
+#include <thread>
+
+using namespace un::Xml::Dom;
+using namespace std;
+
+namespace
+{
+
+/// Coroutine started right away, completion is reported through a future
+struct Job
+{
+  struct promise_type
+  {
+    std::promise<void> done;
+
+    Job get_return_object() { return Job{done.get_future()}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() { done.set_value(); }
+    void unhandled_exception() { done.set_exception(std::current_exception()); }
+  };
+
+  std::future<void> finished;
+};
+
+/// Runs tasks on the calling thread
+class InlineExecutor : public Executor
+{
+public:
+  int count = 0;
+
+  void execute(Task task)
+  {
+    ++count;
+    task();
+  }
+};
+
+Job parse_and_save(const string &source, const string &target, string &result, thread::id &resumed_on)
+{
+  Document document = co_await async_parse_file(source);
+  resumed_on = this_thread::get_id();
+  document.root_node["b"].content = "changed";
+  co_await async_save(document, target);
+
+  Document loaded = co_await async_parse_file(target, Document::Parser::native);
+  result = co_await async_to_string(loaded);
+}
+
+TEST(Async, parse_and_save)
+{
+  const char *source = "async_source.xml";
+  const char *target = "async_target.xml.gz";
+  string text = "<root>";
+  for (int i = 0; i < 100000; ++i)
+  {
+    text += "<a>" + to_string(i) + "</a>";
+  }
+  text += "<b>old</b></root>";
+  {
+    Document document;
+    document.parse(text);
+    document.save_file(source);
+  }
+
+  string result;
+  thread::id resumed_on;
+  parse_and_save(source, target, result, resumed_on).finished.get();
+  EXPECT_NE(resumed_on, this_thread::get_id());
+  EXPECT_EQ(result.size(), text.size() + 4);
+  EXPECT_EQ(result.substr(result.size() - 21), "<b>changed</b></root>");
+
+  std::remove(source);
+  std::remove(target);
+}
+
+Job parse_missing(Executor &executor, bool &failed)
+{
+  try
+  {
+    co_await async_parse_file("async_missing.xml", Document::Parser::libxml2, executor);
+  }
+  catch (const std::runtime_error &)
+  {
+    failed = true;
+  }
+}
+
+TEST(Async, executor)
+{
+  InlineExecutor executor;
+  bool failed = false;
+  parse_missing(executor, failed).finished.get();
+  EXPECT_TRUE(failed);
+  EXPECT_EQ(executor.count, 1);
+
+  ThreadPoolExecutor pool(2);
+  EXPECT_EQ(pool.get_thread_count(), 2u);
+  failed = false;
+  parse_missing(pool, failed).finished.get();
+  EXPECT_TRUE(failed);
+}
+
+} // namespace
@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+#include <Xml/Dom/Binding.h>
+#include <Xml/Dom/Document.h>
+
+using namespace un::Xml::Dom;
+using namespace std;
+
+namespace
+{
+
+struct Price
+{
+  string currency;
+  double amount;
+};
+
+struct Book
+{
+  string id;
+  string title;
+  int64_t year;
+  bool available;
+  vector<string> authors;
+  Price price;
+  vector<Price> offers;
+};
+
+} // namespace
+
+template <>
+struct un::Xml::Dom::Binding<Price>
+{
+  static constexpr auto fields =
+      std::make_tuple(field("@currency", &Price::currency), field("amount", &Price::amount));
+};
+
+template <>
+struct un::Xml::Dom::Binding<Book>
+{
+  static constexpr auto fields = std::make_tuple(
+      field("@id", &Book::id), UN_XML_FIELD(Book, title), UN_XML_FIELD(Book, year),
+      field("@available", &Book::available), field("author", &Book::authors),
+      UN_XML_FIELD(Book, price), field("offer", &Book::offers));
+};
+
+namespace
+{
+
+TEST(Binding, attributes)
+{
+  Document document;
+  document.parse("<book id=\"bk1\" available=\"true\" unknown=\"x\"/>");
+  Book book = extract<Book>(document.root_node);
+  EXPECT_EQ(book.id, "bk1");
+  EXPECT_TRUE(book.available);
+}
+
+TEST(Binding, elements)
+{
+  Document document;
+  document.parse("<book><title>T &amp; U</title><year> 1999 </year><skipped>1</skipped></book>");
+  Book book = extract<Book>(document.root_node);
+  EXPECT_EQ(book.title, "T & U");
+  EXPECT_EQ(book.year, 1999);
+}
+
+TEST(Binding, missing_fields)
+{
+  Document document;
+  document.parse("<book><title>T</title></book>");
+  Book book;
+  book.id = "kept";
+  book.year = 7;
+  extract(document.root_node, book);
+  EXPECT_EQ(book.title, "T");
+  EXPECT_EQ(book.id, "kept");
+  EXPECT_EQ(book.year, 7);
+}
+
+TEST(Binding, repeated_elements)
+{
+  // Other elements between repeated ones and fields out of declaration order
+  Document document;
+  document.parse("<book><author>A</author><title>T</title><author>B</author>"
+                 "<offer currency=\"EUR\"><amount>8</amount></offer>"
+                 "<offer currency=\"GBP\"><amount>7.25</amount></offer></book>");
+  Book book = extract<Book>(document.root_node);
+  EXPECT_EQ(book.authors, (vector<string>{"A", "B"}));
+  EXPECT_EQ(book.title, "T");
+  ASSERT_EQ(book.offers.size(), 2u);
+  EXPECT_EQ(book.offers[0].currency, "EUR");
+  EXPECT_DOUBLE_EQ(book.offers[1].amount, 7.25);
+}
+
+TEST(Binding, nested_struct)
+{
+  Document document;
+  document.parse("<book><price currency=\"USD\"><amount>9.5</amount></price></book>");
+  Book book = extract<Book>(document.root_node);
+  EXPECT_EQ(book.price.currency, "USD");
+  EXPECT_DOUBLE_EQ(book.price.amount, 9.5);
+}
+
+TEST(Binding, compact)
+{
+  Document document;
+  document.parse("<book id=\"bk1\"><author>A</author><price currency=\"USD\"><amount>9.5</amount></price></book>");
+  document.compact();
+  Book book = extract<Book>(document.root_node);
+  EXPECT_EQ(book.id, "bk1");
+  EXPECT_EQ(book.authors, (vector<string>{"A"}));
+  EXPECT_DOUBLE_EQ(book.price.amount, 9.5);
+}
+
+TEST(Binding, serialize)
+{
+  Book book;
+  book.id = "bk1";
+  book.title = "T & U <V>";
+  book.year = 1999;
+  book.available = true;
+  book.authors = {"A", "B"};
+  book.price = Price{"USD", 9.5};
+  book.offers = {Price{"EUR", 8}};
+
+  Document written;
+  written.root_node = serialize(book, "book");
+  EXPECT_EQ(written.to_string(),
+            "<book id=\"bk1\" available=\"true\"><title>T &amp; U &lt;V&gt;</title><year>1999</year>"
+            "<author>A</author><author>B</author>"
+            "<price currency=\"USD\"><amount>9.5</amount></price>"
+            "<offer currency=\"EUR\"><amount>8</amount></offer></book>");
+
+  Book read = extract<Book>(written.root_node);
+  EXPECT_EQ(read.title, book.title);
+  EXPECT_EQ(read.authors, book.authors);
+  EXPECT_EQ(read.offers[0].currency, "EUR");
+}
+
+TEST(Binding, invalid_content)
+{
+  Document document;
+  document.parse("<book><year>soon</year></book>");
+  EXPECT_THROW(extract<Book>(document.root_node), std::runtime_error);
+}
+
+} // namespace
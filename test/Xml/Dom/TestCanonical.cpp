@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include <Xml/Dom/Canonical.h>
+#include <Xml/Dom/Document.h>
+#include <string>
+
+using namespace un::Xml::Dom;
+using namespace std;
+
+namespace
+{
+
+TEST(Canonical, sha256)
+{
+  Sha256 sha;
+  EXPECT_EQ(Sha256::to_hex(sha.finish()), "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+  sha.update("abc", 3);
+  EXPECT_EQ(Sha256::to_hex(sha.finish()), "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+
+  // Split updates across block boundaries
+  string text = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+  for (size_t i = 0; i < text.size(); i += 7)
+  {
+    sha.update(text.data() + i, min<size_t>(7, text.size() - i));
+  }
+  EXPECT_EQ(Sha256::to_hex(sha.finish()), "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+}
+
+TEST(Canonical, document)
+{
+  Document document;
+  document.parse("<?xml version=\"1.0\"?>\n<root b='2' a=\"1\"><!--c--><x/>&#x41;&amp;</root>");
+  EXPECT_EQ(to_canonical_string(document), "<root a=\"1\" b=\"2\"><x></x>A&amp;</root>");
+  EXPECT_EQ(to_canonical_string(document, Canonicalization(Canonicalization::Method::c14n_1_0, true)),
+            "<root a=\"1\" b=\"2\"><!--c--><x></x>A&amp;</root>");
+
+  Document reordered;
+  reordered.parse("<root a=\"1\"  b=\"2\"><x></x>A&amp;</root>");
+  EXPECT_EQ(canonical_sha256(document), canonical_sha256(reordered));
+
+  size_t chunks = 0;
+  string streamed;
+  canonicalize(document, [&](const char *data, size_t size) {
+    ++chunks;
+    streamed.append(data, size);
+  });
+  EXPECT_GT(chunks, 0u);
+  EXPECT_EQ(streamed, to_canonical_string(document));
+
+  reordered.compact();
+  EXPECT_EQ(canonical_sha256(document), canonical_sha256(reordered));
+
+  EXPECT_THROW(canonicalize(document, [](const char *, size_t) { throw std::runtime_error("sink"); }),
+               std::runtime_error);
+}
+
+TEST(Canonical, entities)
+{
+  Document document;
+  document.parse("<!DOCTYPE r [<!ENTITY e \"v\">]><r>a&e;<x>&e;b</x></r>");
+  EXPECT_EQ(to_canonical_string(document), "<r>av<x>vb</x></r>");
+  EXPECT_EQ(to_canonical_string(document.root_node["x"]), "<x>vb</x>");
+
+  // Source keeps its entity references
+  EXPECT_EQ(document.to_string(true, true), "<!DOCTYPE r [\n<!ENTITY e \"v\">\n]>\n<r>a&e;<x>&e;b</x></r>\n");
+
+  Document compact;
+  compact.parse("<!DOCTYPE r [<!ENTITY e \"v\">]><r>a&e;<x>&e;b</x></r>");
+  compact.compact();
+  EXPECT_EQ(canonical_sha256(document), canonical_sha256(compact));
+}
+
+TEST(Canonical, node)
+{
+  Document document;
+  document.parse("<root xmlns=\"urn:d\" xmlns:p=\"urn:p\" xmlns:q=\"urn:q\"><p:a k=\"v\"><b/></p:a></root>");
+  Node a = document.root_node["a"];
+
+  EXPECT_EQ(to_canonical_string(a),
+            "<p:a xmlns=\"urn:d\" xmlns:p=\"urn:p\" xmlns:q=\"urn:q\" k=\"v\"><b></b></p:a>");
+  Canonicalization exclusive(Canonicalization::Method::exclusive_1_0);
+  EXPECT_EQ(to_canonical_string(a, exclusive), "<p:a xmlns:p=\"urn:p\" k=\"v\"><b xmlns=\"urn:d\"></b></p:a>");
+  exclusive.inclusive_prefixes.push_back("q");
+  EXPECT_EQ(to_canonical_string(a, exclusive),
+            "<p:a xmlns:p=\"urn:p\" xmlns:q=\"urn:q\" k=\"v\"><b xmlns=\"urn:d\"></b></p:a>");
+
+  string hash = canonical_sha256(a, Canonicalization(Canonicalization::Method::exclusive_1_0));
+  EXPECT_EQ(canonical_sha256(a.clone(), Canonicalization(Canonicalization::Method::exclusive_1_0)), hash);
+  document.compact();
+  EXPECT_EQ(canonical_sha256(document.root_node["a"], Canonicalization(Canonicalization::Method::exclusive_1_0)),
+            hash);
+
+  Node null_node;
+  EXPECT_THROW(to_canonical_string(null_node), std::runtime_error);
+}
+
+} // namespace
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include <Xml/Dom/ColumnExtractor.h>
+#include <Xml/Dom/Document.h>
+
+using namespace un::Xml::Dom;
+using namespace std;
+
+namespace
+{
+
+TEST(ColumnExtractor, record_path)
+{
+  // Only records under every matching parent, other elements are skipped
+  ColumnExtractor extractor("rows/row");
+  extractor.add_column("@id", ColumnExtractor::Type::int64);
+
+  Document document;
+  document.parse("<root><meta>ignored</meta><rows><row id=\"1\"/><other id=\"99\"/><row id=\"2\"/></rows>"
+                 "<rows><row id=\"3\"/></rows></root>");
+  ColumnExtractor::Table table = extractor.extract(document.root_node);
+  ASSERT_EQ(table.row_count, 3u);
+  EXPECT_EQ(table["@id"].int64_values, (vector<int64_t>{1, 2, 3}));
+  EXPECT_THROW(table["missing"], std::runtime_error);
+}
+
+TEST(ColumnExtractor, numbers)
+{
+  ColumnExtractor extractor("row");
+  extractor.add_column("price", ColumnExtractor::Type::float64).add_column("qty", ColumnExtractor::Type::int64);
+
+  Document document;
+  document.parse("<root><row><price>9.5</price><qty>3</qty></row><row><price>1e2</price></row>"
+                 "<row><price>0.25</price><price>7</price></row></root>");
+  ColumnExtractor::Table table = extractor.extract(document.root_node);
+
+  // First value wins, missing ones are 0 and not valid
+  EXPECT_EQ(table["price"].float64_values, (vector<double>{9.5, 100, 0.25}));
+  EXPECT_EQ(table["qty"].int64_values, (vector<int64_t>{3, 0, 0}));
+  EXPECT_EQ(table["qty"].valid, (vector<uint8_t>{1, 0, 0}));
+}
+
+TEST(ColumnExtractor, strings)
+{
+  ColumnExtractor extractor("row");
+  extractor.add_column("name", ColumnExtractor::Type::string);
+
+  Document document;
+  document.parse("<root><row><name>first</name></row><row/><row><name>second &amp; more</name></row></root>");
+  ColumnExtractor::Table table = extractor.extract(document.root_node);
+  const ColumnExtractor::Column &name = table["name"];
+
+  EXPECT_EQ(name.arena, "firstsecond & more");
+  EXPECT_EQ(name.offsets, (vector<uint64_t>{0, 5, 5, 18}));
+  EXPECT_EQ(name.get_string(1), "");
+  EXPECT_EQ(name.get_string(2), "second & more");
+  EXPECT_EQ(name.valid, (vector<uint8_t>{1, 0, 1}));
+}
+
+TEST(ColumnExtractor, nested_paths)
+{
+  ColumnExtractor extractor("row");
+  extractor.add_column("item/@sku", ColumnExtractor::Type::string).add_column("item/qty", ColumnExtractor::Type::int64);
+
+  Document document;
+  document.parse("<root><row><item sku=\"a\"><qty>3</qty></item></row><row><item sku=\"c\"/></row></root>");
+  ColumnExtractor::Table table = extractor.extract(document.root_node);
+
+  EXPECT_EQ(table["item/@sku"].arena, "ac");
+  EXPECT_EQ(table["item/qty"].int64_values, (vector<int64_t>{3, 0}));
+  EXPECT_EQ(table["item/qty"].valid, (vector<uint8_t>{1, 0}));
+}
+
+TEST(ColumnExtractor, compact)
+{
+  ColumnExtractor extractor("row");
+  extractor.add_column("@id", ColumnExtractor::Type::int64)
+      .add_column("price", ColumnExtractor::Type::float64)
+      .add_column("item/@sku", ColumnExtractor::Type::string);
+
+  Document document;
+  document.parse("<root><row id=\"1\"><price>9.5</price><item sku=\"a\"/></row><row id=\"2\"/></root>");
+  document.compact();
+  ColumnExtractor::Table table = extractor.extract(document.root_node);
+
+  EXPECT_EQ(table["@id"].int64_values, (vector<int64_t>{1, 2}));
+  EXPECT_EQ(table["price"].valid, (vector<uint8_t>{1, 0}));
+  EXPECT_EQ(table["item/@sku"].get_string(0), "a");
+}
+
+TEST(ColumnExtractor, nested_content)
+{
+  // Elements with columns below them are scanned, their own content is a column too
+  ColumnExtractor extractor("row");
+  extractor.add_column("item", ColumnExtractor::Type::string).add_column("item/@sku", ColumnExtractor::Type::string);
+
+  Document document;
+  document.parse("<root><row><item sku=\"a\">plain</item></row><row><item sku=\"b\">x<b>y</b>z</item></row></root>");
+  for (int pass = 0; pass < 2; ++pass)
+  {
+    ColumnExtractor::Table table = extractor.extract(document.root_node);
+    EXPECT_EQ(table["item"].get_string(0), "plain");
+    EXPECT_EQ(table["item"].get_string(1), "xyz");
+    EXPECT_EQ(table["item/@sku"].arena, "ab");
+    document.compact();
+  }
+}
+
+TEST(ColumnExtractor, errors)
+{
+  ColumnExtractor extractor("row");
+  extractor.add_column("@id", ColumnExtractor::Type::int64);
+  EXPECT_THROW(extractor.add_column("@id", ColumnExtractor::Type::string), std::runtime_error);
+  EXPECT_THROW(extractor.add_column("@a/b", ColumnExtractor::Type::string), std::runtime_error);
+  EXPECT_THROW(extractor.add_column("a//b", ColumnExtractor::Type::string), std::runtime_error);
+  EXPECT_THROW(extractor.add_column("a/@k/c", ColumnExtractor::Type::string), std::runtime_error);
+
+  Document document;
+  document.parse("<root><row id=\"1\"/><row id=\"x\"/></root>");
+  EXPECT_THROW(extractor.extract(document.root_node), std::runtime_error);
+}
+
+} // namespace
@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+#include <Xml/Dom/Document.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace un::Xml::Dom;
+using namespace std;
+
+namespace
+{
+
+string read_file(const char *path)
+{
+  ifstream file(path, ios::binary);
+  ostringstream content;
+  content << file.rdbuf();
+  return content.str();
+}
+
+/// Saves document, false if the format was left out of the build
+bool try_save(const Document &document, const char *path, Document::Compression compression)
+{
+  try
+  {
+    document.save_file(path, false, compression);
+    return true;
+  }
+  catch (const std::runtime_error &error)
+  {
+    if (string(error.what()).find("Built without") == string::npos)
+    {
+      throw;
+    }
+    return false;
+  }
+}
+
+TEST(CompressedFile, round_trip)
+{
+  Document document;
+  string text = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<root>";
+  for (int i = 0; i < 5000; ++i)
+  {
+    text += "<item id=\"" + to_string(i) + "\">value " + to_string(i) + "</item>";
+  }
+  text += "</root>";
+  document.parse(text);
+
+  const char *paths[] = {"compressed_round_trip.xml.gz", "compressed_round_trip.xml.zst",
+                         "compressed_round_trip.xml.xz"};
+  for (const char *path : paths)
+  {
+    if (!try_save(document, path, Document::Compression::by_extension))
+    {
+      continue;
+    }
+    string stored = read_file(path);
+    EXPECT_LT(stored.size(), text.size() / 4) << path;
+
+    for (Document::Parser parser : {Document::Parser::libxml2, Document::Parser::native})
+    {
+      Document loaded(parser);
+      loaded.parse_file(path);
+      EXPECT_EQ(loaded.to_string(false, false), document.to_string(false, false)) << path;
+      EXPECT_EQ(loaded.root_node.count, 5000);
+    }
+    std::remove(path);
+  }
+
+  // Magic bytes win over extension
+  const char *plain = "compressed_round_trip.xml";
+  if (try_save(document, plain, Document::Compression::gzip))
+  {
+    Document loaded;
+    loaded.parse_file(plain);
+    EXPECT_EQ(loaded.root_node.count, 5000);
+  }
+  document.save_file(plain);
+  EXPECT_EQ(read_file(plain).substr(0, 5), "<?xml");
+  std::remove(plain);
+}
+
+TEST(CompressedFile, concurrent_saves)
+{
+  const char *path = "compressed_concurrent.xml";
+
+  vector<thread> threads;
+  for (int i = 0; i < 8; ++i)
+  {
+    threads.emplace_back([path, i]() {
+      Document document;
+      document.parse("<root><a>" + string(100000, 'a' + i) + "</a></root>");
+      for (int j = 0; j < 10; ++j)
+      {
+        document.save_file(path);
+      }
+    });
+  }
+  for (thread &i : threads)
+  {
+    i.join();
+  }
+
+  Document loaded;
+  loaded.parse_file(path);
+  string content = loaded.root_node["a"].content;
+  ASSERT_EQ(content.size(), 100000u);
+  EXPECT_EQ(content.find_first_not_of(content[0]), string::npos);
+
+  std::remove(path);
+}
+
+TEST(CompressedFile, corrupt)
+{
+  const char *path = "compressed_corrupt.xml.gz";
+  Document document;
+  document.parse("<root><a>some text to compress</a><a>some text to compress</a></root>");
+  if (!try_save(document, path, Document::Compression::by_extension))
+  {
+    return;
+  }
+
+  string stored = read_file(path);
+  {
+    ofstream file(path, ios::binary | ios::trunc);
+    file.write(stored.data(), stored.size() / 2);
+  }
+  for (Document::Parser parser : {Document::Parser::libxml2, Document::Parser::native})
+  {
+    Document loaded(parser);
+    EXPECT_THROW(loaded.parse_file(path), std::runtime_error);
+  }
+  std::remove(path);
+
+  EXPECT_THROW(document.save_file("missing_directory/file.xml.gz"), std::runtime_error);
+}
+
+} // namespace
@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include <Xml/Dom/Diff.h>
+#include <Xml/Dom/Document.h>
+#include <string>
+
+using namespace un::Xml::Dom;
+using namespace std;
+
+namespace
+{
+
+/// Diffs from and to, applies the script to a fresh copy of from
+void check_round_trip(const string &from_text, const string &to_text, size_t max_edits)
+{
+  Document from;
+  from.parse(from_text);
+  Document to;
+  to.parse(to_text);
+
+  EditScript script = diff(from, to);
+  EXPECT_LE(script.edits.size(), max_edits) << script.to_string();
+
+  EditScript sent = EditScript::from_string(script.to_string());
+  ASSERT_EQ(sent.edits.size(), script.edits.size());
+
+  Document replica;
+  replica.parse(from_text);
+  replica.apply(sent);
+  EXPECT_EQ(replica.to_string(), to.to_string()) << script.to_string();
+}
+
+TEST(Diff, identical)
+{
+  Document from;
+  from.parse("<root><a x=\"1\">text</a><!--c--></root>");
+  Document to;
+  to.parse("<root><a x=\"1\">text</a><!--c--></root>");
+  EXPECT_TRUE(diff(from, to).empty());
+}
+
+TEST(Diff, edits)
+{
+  check_round_trip("<root><a x=\"1\" y=\"2\">text</a></root>", "<root><a x=\"3\" z=\"&amp;\">text</a></root>", 3);
+  check_round_trip("<root><a>old</a></root>", "<root><a>new &lt;value&gt;</a></root>", 1);
+  check_round_trip("<root><a/><b/><c/></root>", "<root><a/><c/></root>", 1);
+  check_round_trip("<root><a/><c/></root>", "<root><a/><b k=\"v\">x</b><c/></root>", 1);
+  check_round_trip("<root><a/></root>", "<other><a/></other>", 1);
+  check_round_trip("<root><a/>tail</root>", "<root><!--note-->tail<b/></root>", 2);
+  check_round_trip("<root><a><b>1</b></a></root>", "<root><a><b>2</b><c/></a></root>", 2);
+  check_round_trip("<root xmlns:p=\"urn:p\"><p:a p:k=\"1\"/></root>",
+                   "<root xmlns:p=\"urn:p\"><p:a p:k=\"2\"/><p:b/></root>", 2);
+  check_round_trip("<root>  <a/>\n  <b/>\n</root>", "<root>\n  <b/>\n  <a/>\n</root>", 6);
+}
+
+TEST(Diff, large_document)
+{
+  string from = "<config>";
+  string to = "<config>";
+  for (int i = 0; i < 1000; ++i)
+  {
+    string item = "<item id=\"" + to_string(i) + "\"><value>" + to_string(i) + "</value></item>";
+    from += item;
+    if (i == 500)
+    {
+      to += "<item id=\"500\"><value>changed</value></item>";
+    }
+    else if (i != 700)
+    {
+      to += item;
+    }
+  }
+  from += "</config>";
+  to += "<item id=\"new\"/></config>";
+
+  check_round_trip(from, to, 3);
+}
+
+TEST(Diff, moved_child)
+{
+  string items;
+  for (int i = 1; i < 1000; ++i)
+  {
+    items += "<item id=\"" + to_string(i) + "\"/>";
+  }
+  string first = "<item id=\"0\"/>";
+
+  check_round_trip("<config>" + first + items + "</config>", "<config>" + items + first + "</config>", 2);
+  check_round_trip("<config>" + items + first + "</config>", "<config>" + first + items + "</config>", 2);
+}
+
+TEST(Diff, nodes)
+{
+  Document document;
+  document.parse("<root><a><b>1</b></a><c><b>2</b><d/></c></root>");
+  Node a = document.root_node["a"];
+  EditScript script = diff(a, document.root_node["c"]);
+
+  Node copy = a.clone();
+  patch(copy, script);
+  Document result;
+  result.root_node = copy;
+  EXPECT_EQ(result.to_string(), "<c><b>2</b><d/></c>");
+
+  patch(a, script);
+  EXPECT_EQ(document.to_string(), "<root><c><b>2</b><d/></c><c><b>2</b><d/></c></root>");
+
+  document.compact();
+  EXPECT_TRUE(diff(document.root_node["c"], copy).empty());
+  EXPECT_THROW(patch(document.root_node, script), std::runtime_error);
+}
+
+TEST(Diff, replace_root)
+{
+  Document from;
+  from.parse("<root xmlns=\"urn:a\"><a/></root>");
+  from.enable_indexes();
+  Document to;
+  to.parse("<root xmlns=\"urn:b\" id=\"r\"><b/></root>");
+
+  from.apply(diff(from, to));
+  EXPECT_EQ(from.to_string(), to.to_string());
+  EXPECT_TRUE(from.get_element_by_id("r") == from.root_node);
+}
+
+TEST(Diff, invalid)
+{
+  Document document;
+  document.parse("<root><a/></root>");
+
+  EditScript script;
+  script.edits.push_back(EditScript::Edit{EditScript::Type::remove, {5}, "", ""});
+  EXPECT_THROW(document.apply(script), std::runtime_error);
+  EXPECT_THROW(EditScript::from_string("<edits><move path=\"0\"/></edits>"), std::runtime_error);
+  EXPECT_THROW(EditScript::from_string("<edits><remove path=\"a\"/></edits>"), std::runtime_error);
+  EXPECT_THROW(EditScript::from_string("not xml"), std::runtime_error);
+}
+
+} // namespace
@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
 #include <Xml/Dom/Document.h>
+#include <atomic>
+#include <thread>
+#include <vector>
 
 using namespace un::Xml::Dom;
 using namespace std;
@@ -7,6 +10,18 @@ using namespace std;
 namespace
 {
 
+/// Tests which parse run with every parser
+class DocumentTest : public testing::TestWithParam<Document::Parser>
+{
+};
+
+class NodeTest : public testing::TestWithParam<Document::Parser>
+{
+};
+
+INSTANTIATE_TEST_SUITE_P(Parsers, DocumentTest, testing::Values(Document::Parser::libxml2, Document::Parser::native));
+INSTANTIATE_TEST_SUITE_P(Parsers, NodeTest, testing::Values(Document::Parser::libxml2, Document::Parser::native));
+
 // Test simple XML creation and string casting
 TEST(Document, DocumentToString)
 {
@@ -20,9 +35,9 @@ TEST(Document, DocumentToString)
   EXPECT_EQ(asString2, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<test>content<pushBack/></test>");
 }
 
-TEST(Document, DocumentFromString)
+TEST_P(DocumentTest, DocumentFromString)
 {
-  Document document;
+  Document document(GetParam());
   document.parse("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<test>content</test>");
   string asString = (string)document;
   EXPECT_EQ(document.root_node.name, "test");
@@ -70,6 +85,235 @@ TEST(Node, push_front)
   EXPECT_EQ(asString, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<test><pushFront>dummy</pushFront>content</test>");
 }
 
+TEST_P(NodeTest, append_range)
+{
+  Document document(GetParam());
+  document.parse("<root><a/></root>");
+  document.enable_indexes();
+  Node &root = document.root_node;
+
+  vector<Node> nodes;
+  for (int i = 0; i < 3; ++i)
+  {
+    Node node("b");
+    node.attributes.push_back("id", to_string(i));
+    nodes.push_back(node);
+  }
+  root.append_range(nodes);
+  EXPECT_EQ(root.count, 4);
+  EXPECT_EQ((string)document, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<root><a/><b id=\"0\"/><b id=\"1\"/><b id=\"2\"/></root>");
+  EXPECT_TRUE(document.get_element_by_id("1") == nodes[1]);
+  EXPECT_EQ(document.get_elements_by_name("b").size(), 3u);
+
+  // Nothing is linked when one of the nodes is already owned
+  vector<Node> owned = {Node("c"), nodes[0]};
+  EXPECT_THROW(root.append_range(owned), std::runtime_error);
+  vector<Node> twice = {Node("c")};
+  twice.push_back(twice[0]);
+  EXPECT_THROW(root.append_range(twice), std::runtime_error);
+  EXPECT_EQ(root.count, 4);
+  root.append_range(vector<Node>(1, twice[0]));
+  EXPECT_EQ(root.count, 5);
+
+  Node free("free");
+  EXPECT_THROW(free.push_back(root), std::runtime_error);
+  EXPECT_THROW(free.append_range(vector<Node>(1, free)), std::runtime_error);
+}
+
+TEST_P(NodeTest, insert_before_after)
+{
+  Document document(GetParam());
+  document.parse("<root><a/><b/></root>");
+  Node &root = document.root_node;
+
+  Node::iterator b = root.begin();
+  ++b;
+  root.insert_before(b, Node("x"));
+  root.insert_after(root.begin(), vector<Node>{Node("y"), Node("z")});
+  root.insert_before(root.end(), Node("last"));
+  root.insert_before(root.begin(), vector<Node>{Node("first")});
+  EXPECT_EQ((string)document,
+            "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<root><first/><a/><y/><z/><x/><b/><last/></root>");
+
+  EXPECT_THROW(root.insert_after(root.end(), Node("c")), std::runtime_error);
+  Node other("other");
+  other.push_back(Node("child"));
+  EXPECT_THROW(root.insert_before(other.begin(), Node("c")), std::runtime_error);
+}
+
+TEST_P(NodeTest, splice)
+{
+  Document document(GetParam());
+  document.parse("<root><a><x/><y/></a><b/></root>");
+  document.enable_indexes();
+  Node &root = document.root_node;
+
+  Node a = root["a"];
+  root.splice(root.end(), a);
+  EXPECT_EQ((string)document, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<root><a/><b/><x/><y/></root>");
+  EXPECT_EQ(document.get_elements_by_name("x").size(), 1u);
+
+  Node built("built");
+  built.append_range(vector<Node>{Node("p"), Node("q")});
+  Node::iterator b = root.begin();
+  ++b;
+  root.splice(b, built);
+  EXPECT_EQ(built.count, 0);
+  EXPECT_EQ((string)document, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<root><a/><p/><q/><b/><x/><y/></root>");
+  EXPECT_EQ(document.get_elements_by_name("q").size(), 1u);
+
+  EXPECT_THROW(root["a"].splice(root["a"].end(), root), std::runtime_error);
+
+  {
+    Document other(GetParam());
+    other.parse("<other><c k=\"v\">text</c></other>");
+    root.splice(root.end(), other.root_node);
+    EXPECT_EQ(other.root_node.count, 0);
+    EXPECT_EQ((string)other, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<other/>");
+  }
+  // Moved children outlive the document they came from
+  EXPECT_EQ(document.get_elements_by_name("c").size(), 1u);
+  EXPECT_EQ((string)document, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                              "<root><a/><p/><q/><b/><x/><y/><c k=\"v\">text</c></root>");
+}
+
+TEST_P(NodeTest, clone)
+{
+  Document document(GetParam());
+  document.parse("<root xmlns:p=\"urn:p\"><p:a k=\"v\">text<b/></p:a></root>");
+  Node copy = document.root_node["a"].clone();
+  copy.attributes["k"].value = "w";
+  copy.push_back(Node("c"));
+
+  Document target;
+  target.root_node = copy;
+  EXPECT_EQ((string)target, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                            "<p:a xmlns:p=\"urn:p\" k=\"w\">text<b/><c/></p:a>");
+  EXPECT_EQ((string)document, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                              "<root xmlns:p=\"urn:p\"><p:a k=\"v\">text<b/></p:a></root>");
+
+  document.compact();
+  Node compact_copy = document.root_node["a"].clone();
+  compact_copy.push_back(Node("d"));
+  EXPECT_EQ(compact_copy.count, 2);
+  EXPECT_EQ(compact_copy.content, "text");
+
+  Node null_node;
+  EXPECT_THROW(null_node.clone(), std::runtime_error);
+}
+
+TEST_P(NodeTest, hash)
+{
+  Document a(GetParam());
+  a.parse("<root xmlns:p=\"urn:p\"><p:a x=\"1\" y=\"2\">text<!--c--></p:a><b/></root>");
+  Document b(GetParam());
+  b.parse("<root xmlns:q=\"urn:p\"><q:a y=\"2\" x=\"1\">text<!--c--></q:a><b/></root>");
+
+  EXPECT_EQ(a.root_node.hash(), b.root_node.hash());
+  EXPECT_TRUE(a.root_node.deep_equal(b.root_node));
+  EXPECT_FALSE(a.root_node.deep_equal(b.root_node, true));
+  EXPECT_TRUE(a.root_node["a"].deep_equal(a.root_node["a"], true));
+  EXPECT_NE(a.root_node["a"].hash(), a.root_node["b"].hash());
+
+  uint64_t before = a.root_node.hash();
+  a.root_node["a"].attributes["x"].value = "3";
+  EXPECT_NE(a.root_node.hash(), before);
+  EXPECT_FALSE(a.root_node.deep_equal(b.root_node));
+  a.root_node["a"].attributes["x"].value = "1";
+  EXPECT_EQ(a.root_node.hash(), before);
+
+  a.root_node["b"].push_back(Node("c"));
+  EXPECT_NE(a.root_node.hash(), before);
+  a.root_node["b"].content = "";
+  EXPECT_EQ(a.root_node.hash(), before);
+  a.root_node["a"].content = "other";
+  EXPECT_NE(a.root_node.hash(), before);
+
+  b.compact();
+  Document c(GetParam());
+  c.parse("<root xmlns:q=\"urn:p\"><q:a y=\"2\" x=\"1\">text<!--c--></q:a><b/></root>");
+  EXPECT_EQ(b.root_node.hash(), c.root_node.hash());
+  EXPECT_EQ(b.root_node["a"].hash(), c.root_node["a"].hash());
+  EXPECT_TRUE(b.root_node.deep_equal(c.root_node, true));
+  EXPECT_FALSE(b.root_node.deep_equal(a.root_node));
+}
+
+TEST_P(DocumentTest, clone)
+{
+  Document document(GetParam());
+  document.parse("<!DOCTYPE root [<!ENTITY e \"entity\">]><root><a id=\"x\">&e;</a></root>");
+  document.enable_indexes();
+  document.freeze();
+
+  Document copy = document.clone();
+  EXPECT_FALSE(copy.is_frozen());
+  EXPECT_TRUE(copy.has_indexes());
+  EXPECT_EQ(copy.get_element_by_id("x").name, "a");
+  EXPECT_EQ(copy.to_string(), document.to_string());
+
+  copy.root_node["a"].attributes["id"].value = "y";
+  copy.root_node.push_back(Node("b"));
+  EXPECT_TRUE(copy.get_element_by_id("x") == nullptr);
+  EXPECT_EQ(document.get_element_by_id("x").name, "a");
+  EXPECT_EQ(document.root_node.count, 1);
+
+  Document compact(GetParam());
+  compact.parse("<root><a>1</a><b/></root>");
+  compact.compact();
+  Document expanded = compact.clone();
+  EXPECT_FALSE(expanded.is_compact());
+  expanded.root_node.pop_back();
+  EXPECT_EQ((string)expanded, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<root><a>1</a></root>");
+  EXPECT_EQ(compact.root_node.count, 2);
+
+  Document empty(GetParam());
+  EXPECT_THROW(empty.clone().root_node.get_node(), std::runtime_error);
+
+  Document shared = document.clone(true);
+  EXPECT_EQ(shared.to_string(), document.to_string());
+}
+
+TEST_P(DocumentTest, clone_concurrent_writes)
+{
+  Document document(GetParam());
+  document.parse("<root><a id=\"x\">1</a></root>");
+  document.freeze();
+
+  std::vector<Document> copies;
+  for (int t = 0; t < 4; ++t)
+  {
+    copies.push_back(document.clone());
+  }
+
+  std::vector<std::thread> writers;
+  for (int t = 0; t < 4; ++t)
+  {
+    writers.emplace_back([&copies, t]() {
+      Node &root_node = copies[t].root_node;
+      for (int i = 0; i < 500; ++i)
+      {
+        std::string name = "n" + std::to_string(t) + "_" + std::to_string(i);
+        Node node(name);
+        root_node.push_back(node);
+        root_node[name].attributes.push_back("k" + std::to_string(i), "v");
+        root_node[name].name = name + "x";
+      }
+    });
+  }
+
+  for (std::thread &writer : writers)
+  {
+    writer.join();
+  }
+
+  for (int t = 0; t < 4; ++t)
+  {
+    EXPECT_EQ(copies[t].root_node.count, 501);
+    EXPECT_EQ(copies[t].root_node[500].name, "n" + std::to_string(t) + "_499x");
+  }
+  EXPECT_EQ(document.root_node.count, 1);
+}
+
 TEST(NodeAttributes, push_back)
 {
   Document document("1.0");
@@ -134,6 +378,303 @@ TEST(NodeAttributes, reference_update)
   EXPECT_EQ((string)document, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<root test=\"hello world\"/>");
 }
 
+TEST_P(DocumentTest, freeze)
+{
+  Document document(GetParam());
+  document.parse("<root><a>1</a><b>2</b><c>3</c></root>");
+  EXPECT_FALSE(document.is_frozen());
+
+  document.freeze();
+  EXPECT_TRUE(document.is_frozen());
+
+  EXPECT_EQ(document.root_node["b"].content, "2");
+  EXPECT_TRUE(document.root_node["b"] == document.root_node[1]);
+  EXPECT_TRUE(document.root_node["missing"] == nullptr);
+  EXPECT_THROW(document.root_node[5], std::runtime_error);
+  EXPECT_THROW(document.root_node["a"][3], std::runtime_error);
+
+  EXPECT_THROW(document.root_node.push_back(Node("d")), std::runtime_error);
+  EXPECT_THROW(document.root_node["a"].content = "x", std::runtime_error);
+  EXPECT_THROW(document.root_node.attributes.push_back("k", "v"), std::runtime_error);
+  EXPECT_THROW(document.parse("<root/>"), std::runtime_error);
+  EXPECT_EQ((string)document, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<root><a>1</a><b>2</b><c>3</c></root>");
+}
+
+TEST_P(DocumentTest, freeze_concurrent_reads)
+{
+  Document document(GetParam());
+  document.parse("<root><a>1</a><b>2</b><c>3</c></root>");
+  document.freeze();
+
+  std::atomic<int> failures(0);
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 4; ++t)
+  {
+    readers.emplace_back([&]() {
+      for (int i = 0; i < 1000; ++i)
+      {
+        std::size_t visited = 0;
+        for (Node &child : document.root_node)
+        {
+          visited += ((string)child.content).size();
+        }
+        if (visited != 3 || document.root_node["c"].content != "3")
+        {
+          ++failures;
+        }
+      }
+    });
+  }
+
+  for (std::thread &reader : readers)
+  {
+    reader.join();
+  }
+
+  EXPECT_EQ(failures, 0);
+}
+
+TEST_P(DocumentTest, compact)
+{
+  const char *xml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                    "<root xmlns:p=\"urn:p\" id=\"r\"><a k=\"1\" p:k=\"2\">x<!--c--><![CDATA[y]]></a>"
+                    "<p:b>2</p:b><c><d>deep</d></c><?pi data?></root>";
+  Document document(GetParam());
+  document.parse(xml);
+  string expected = (string)document;
+
+  document.compact();
+  EXPECT_TRUE(document.is_compact());
+  EXPECT_TRUE(document.is_frozen());
+  EXPECT_EQ((string)document, expected);
+
+  Node &root = document.root_node;
+  EXPECT_EQ(root.name, "root");
+  EXPECT_EQ(root.count, 4);
+  EXPECT_EQ(root["a"].content, "xy");
+  EXPECT_EQ(root["b"].content, "2");
+  EXPECT_EQ(root["c/d"].content, "deep");
+  EXPECT_TRUE(root["c/missing"] == nullptr);
+  EXPECT_TRUE(root["c"] == root[2]);
+  EXPECT_FALSE(root["c"] == root[1]);
+
+  EXPECT_EQ(root.attributes.count, 1);
+  EXPECT_EQ((string)root.attributes["id"].value, "r");
+  EXPECT_EQ(root["a"].attributes.count, 2);
+  EXPECT_EQ((string)root["a"].attributes[1].value, "2");
+
+  vector<string> names;
+  for (Node &child : root)
+  {
+    names.push_back(child.name);
+  }
+  EXPECT_EQ(names, (vector<string>{"a", "b", "c", "pi"}));
+
+  int elements = 0;
+  root.visit([&](const Node &) { ++elements; });
+  EXPECT_EQ(elements, 5);
+
+  EXPECT_THROW(root.push_back(Node("e")), std::runtime_error);
+  EXPECT_THROW(root["a"].content = "z", std::runtime_error);
+  EXPECT_THROW(root.attributes["id"].value = "z", std::runtime_error);
+  EXPECT_THROW(document.parse("<root/>"), std::runtime_error);
+}
+
+TEST_P(DocumentTest, indexes)
+{
+  Document document(GetParam());
+  document.parse("<root><a id=\"x\"><b id=\"y\"/></a><b/><c id=\"z\"/></root>");
+  EXPECT_THROW(document.get_element_by_id("x"), std::runtime_error);
+
+  document.enable_indexes();
+  EXPECT_TRUE(document.has_indexes());
+  EXPECT_EQ(document.get_element_by_id("y").name, "b");
+  EXPECT_TRUE(document.get_element_by_id("missing") == nullptr);
+  EXPECT_EQ(document.get_elements_by_name("b").size(), 2u);
+
+  Node &root = document.root_node;
+  Node d("d");
+  d.attributes.push_back("id", "w");
+  Node e("b");
+  d.push_back(e);
+  root.push_back(d);
+  EXPECT_TRUE(document.get_element_by_id("w") == root["d"]);
+  EXPECT_EQ(document.get_elements_by_name("b").size(), 3u);
+
+  root.remove(root["a"]);
+  EXPECT_TRUE(document.get_element_by_id("x") == nullptr);
+  EXPECT_TRUE(document.get_element_by_id("y") == nullptr);
+  EXPECT_EQ(document.get_elements_by_name("b").size(), 2u);
+
+  root["c"].attributes["id"].value = "v";
+  EXPECT_TRUE(document.get_element_by_id("z") == nullptr);
+  EXPECT_EQ(document.get_element_by_id("v").name, "c");
+
+  root["c"].name = "renamed";
+  EXPECT_TRUE(document.get_elements_by_name("c").empty());
+  EXPECT_EQ(document.get_elements_by_name("renamed").size(), 1u);
+
+  root.attributes.push_back("id", "r");
+  EXPECT_TRUE(document.get_element_by_id("r") == root);
+  root.attributes.remove("id");
+  EXPECT_TRUE(document.get_element_by_id("r") == nullptr);
+
+  root.pop_back();
+  EXPECT_TRUE(document.get_element_by_id("w") == nullptr);
+
+  document.parse("<root><a id=\"p\"/></root>");
+  EXPECT_EQ(document.get_element_by_id("p").name, "a");
+
+  document.compact();
+  EXPECT_EQ(document.get_element_by_id("p").name, "a");
+  EXPECT_EQ(document.get_elements_by_name("root").size(), 1u);
+
+  document.disable_indexes();
+  EXPECT_THROW(document.get_elements_by_name("a"), std::runtime_error);
+}
+
+TEST_P(DocumentTest, indexes_duplicate_ids)
+{
+  Document document(GetParam());
+  document.parse("<root><a id=\"x\"/><b id=\"x\"/><c id=\"x\"/></root>");
+  document.enable_indexes();
+  Node &root = document.root_node;
+  EXPECT_EQ(document.get_element_by_id("x").name, "a");
+
+  root.remove(root["a"]);
+  string name = document.get_element_by_id("x").name;
+  EXPECT_TRUE(name == "b" || name == "c");
+
+  root["b"].attributes["id"].value = "y";
+  root["c"].attributes["id"].value = "z";
+  EXPECT_TRUE(document.get_element_by_id("x") == nullptr);
+  EXPECT_EQ(document.get_element_by_id("y").name, "b");
+}
+
+TEST_P(DocumentTest, indexes_set_content)
+{
+  Document document(GetParam());
+  document.parse("<root><a><b id=\"x\"/><b/></a></root>");
+  document.enable_indexes();
+  Node &root = document.root_node;
+  EXPECT_EQ(document.get_elements_by_name("b").size(), 2u);
+
+  // Replaced children are freed, indexes must not keep them
+  root["a"].content = "text";
+  EXPECT_TRUE(document.get_element_by_id("x") == nullptr);
+  EXPECT_TRUE(document.get_elements_by_name("b").empty());
+
+  Node b("b");
+  b.attributes.push_back("id", "x");
+  root.push_back(b);
+  EXPECT_TRUE(document.get_element_by_id("x") == root["b"]);
+  EXPECT_EQ(document.get_elements_by_name("b").size(), 1u);
+}
+
+TEST_P(DocumentTest, normalize)
+{
+  Document document(GetParam());
+  document.parse("<root>\n  <a>x</a>y\n  <b xml:space=\"preserve\"> </b>\n  <c> </c>\n</root>");
+  document.enable_journal();
+  string original = document.to_string();
+
+  Node &root = document.root_node;
+  Node::iterator position = root.begin();
+  ++position;
+  Node a = root["a"];
+  root.splice(position, a);
+  string spliced = document.to_string();
+
+  document.normalize();
+  string merged = "<root>\n  <a/>xy\n  <b xml:space=\"preserve\"> </b>\n  <c> </c>\n</root>";
+  EXPECT_EQ(document.to_string(), merged);
+  EXPECT_FALSE(document.is_normalized());
+
+  // Blank text of root is kept, root has other text
+  document.normalize(true);
+  EXPECT_EQ(document.to_string(), "<root>\n  <a/>xy\n  <b xml:space=\"preserve\"> </b>\n  <c/>\n</root>");
+  EXPECT_FALSE(document.is_normalized());
+  document.undo();
+  EXPECT_EQ(document.to_string(), merged);
+  document.undo();
+  EXPECT_EQ(document.to_string(), spliced);
+
+  document.parse("<p><b>Hello</b> <i>world</i></p>");
+  document.normalize();
+  EXPECT_EQ(string(document.root_node.content), "Hello world");
+  document.parse("<p>Say <b>Hello</b> <i>world</i></p>");
+  document.normalize(true);
+  EXPECT_EQ(string(document.root_node.content), "Say Hello world");
+
+  document.set_normalize_on_parse(true);
+  document.parse("<root>\n  <a>1</a>\n  <b/>\n</root>");
+  EXPECT_TRUE(document.is_normalized());
+  EXPECT_EQ(document.to_string(), "<root><a>1</a><b/></root>");
+  size_t count = 0;
+  for (Node &child : document.root_node)
+  {
+    EXPECT_FALSE(string(child.name).empty());
+    ++count;
+  }
+  EXPECT_EQ(count, 2u);
+  EXPECT_TRUE(document.clone().is_normalized());
+
+  document.root_node.push_back(Node("c"));
+  EXPECT_FALSE(document.is_normalized());
+}
+
+TEST_P(NodeTest, visit)
+{
+  Document document(GetParam());
+  document.parse("<root><a><b/>text<c/></a><d/></root>");
+
+  string order;
+  document.root_node.visit([&order](const Node &node) { order += (string)node.name; });
+  EXPECT_EQ(order, "rootabcd");
+
+  EXPECT_THROW(document.root_node.visit([](const Node &) {}, Node::ExecutionPolicy::parallel),
+               std::runtime_error);
+}
+
+TEST_P(NodeTest, visit_parallel)
+{
+  string xml = "<root>";
+  for (int i = 0; i < 500; ++i)
+  {
+    xml += "<item><value>" + std::to_string(i) + "</value></item>";
+  }
+  xml += "</root>";
+
+  Document document(GetParam());
+  document.parse(xml);
+  document.freeze();
+
+  std::atomic<int> elements(0);
+  std::atomic<int> sum(0);
+  document.root_node.visit(
+      [&](const Node &node) {
+        ++elements;
+        if (node.name == "value")
+        {
+          sum += std::stoi((string)node.content);
+        }
+      },
+      Node::ExecutionPolicy::parallel, 4);
+
+  EXPECT_EQ(elements, 1001);
+  EXPECT_EQ(sum, 499 * 500 / 2);
+
+  EXPECT_THROW(document.root_node.visit(
+                   [](const Node &node) {
+                     if (node.name == "value")
+                     {
+                       throw std::runtime_error("stop");
+                     }
+                   },
+                   Node::ExecutionPolicy::parallel, 4),
+               std::runtime_error);
+}
+
 } // namespace
 
 int main(int ac, char *av[])
@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include <Xml/Dom/DocumentCache.h>
+#include <cstdio>
+#include <fstream>
+
+using namespace un::Xml::Dom;
+using namespace std;
+
+namespace
+{
+
+void write_file(const char *path, const string &content)
+{
+  ofstream file(path, ios::binary | ios::trunc);
+  file << content;
+}
+
+TEST(DocumentCache, hit_and_revalidate)
+{
+  const char *path = "document_cache_test.xml";
+  write_file(path, "<root><a>1</a></root>");
+
+  DocumentCache cache;
+  std::shared_ptr<const Document> first = cache.get(path);
+  EXPECT_EQ(first->root_node["a"].content, "1");
+  EXPECT_TRUE(first->is_frozen());
+  EXPECT_EQ(cache.get_count(), 1u);
+  EXPECT_GT(cache.get_memory_usage(), 0u);
+
+  EXPECT_EQ(cache.get(path), first);
+
+  // Different size changes the stamp even within one mtime tick
+  write_file(path, "<root><a>22</a></root>");
+  std::shared_ptr<const Document> second = cache.get(path);
+  EXPECT_NE(second, first);
+  EXPECT_EQ(second->root_node["a"].content, "22");
+  EXPECT_EQ(first->root_node["a"].content, "1");
+  EXPECT_EQ(cache.get_count(), 1u);
+
+  cache.remove(path);
+  EXPECT_EQ(cache.get_count(), 0u);
+  EXPECT_EQ(cache.get_memory_usage(), 0u);
+
+  std::remove(path);
+  EXPECT_THROW(cache.get(path), std::runtime_error);
+}
+
+TEST(DocumentCache, evict_least_recently_used)
+{
+  const char *paths[] = {"document_cache_1.xml", "document_cache_2.xml", "document_cache_3.xml"};
+  for (const char *path : paths)
+  {
+    write_file(path, "<root><a>text</a><b>text</b></root>");
+  }
+
+  DocumentCache cache;
+  cache.get(paths[0]);
+  std::size_t size = cache.get_memory_usage();
+  cache.set_memory_budget(size * 2);
+
+  std::shared_ptr<const Document> second = cache.get(paths[1]);
+  cache.get(paths[0]);
+  cache.get(paths[2]);
+
+  // paths[1] was least recently used
+  EXPECT_EQ(cache.get_count(), 2u);
+  EXPECT_EQ(cache.get_memory_usage(), size * 2);
+  EXPECT_NE(cache.get(paths[1]), second);
+  EXPECT_EQ(second->root_node["b"].content, "text");
+
+  cache.set_memory_budget(0);
+  EXPECT_EQ(cache.get_count(), 0u);
+  EXPECT_EQ(cache.get(paths[0])->root_node.name, "root");
+  EXPECT_EQ(cache.get_count(), 0u);
+
+  for (const char *path : paths)
+  {
+    std::remove(path);
+  }
+}
+
+} // namespace
@@ -0,0 +1,187 @@
+#include <gtest/gtest.h>
+#include <Xml/Dom/Diff.h>
+#include <Xml/Dom/Document.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace un::Xml::Dom;
+using namespace std;
+
+namespace
+{
+
+TEST(Journal, undo_redo)
+{
+  Document document;
+  document.parse("<root><a x=\"1\">text</a><b/><c/></root>");
+  EXPECT_THROW(document.undo(), std::runtime_error);
+  document.enable_journal();
+  EXPECT_FALSE(document.can_undo());
+
+  vector<string> states;
+  states.push_back(document.to_string());
+
+  Node &root = document.root_node;
+  Node d("d");
+  d.push_back(Node("e"));
+  root.push_back(d);
+  states.push_back(document.to_string());
+
+  root.remove(root["b"]);
+  states.push_back(document.to_string());
+
+  root["a"].attributes["x"].value = "2";
+  states.push_back(document.to_string());
+
+  root["a"].attributes.push_back("y", "3");
+  states.push_back(document.to_string());
+
+  root["c"].name = "renamed";
+  states.push_back(document.to_string());
+
+  root["a"].content = "new";
+  states.push_back(document.to_string());
+
+  root["a"].begin()->content = "newer";
+  states.push_back(document.to_string());
+
+  for (size_t i = states.size() - 1; i > 0; --i)
+  {
+    EXPECT_TRUE(document.undo());
+    EXPECT_EQ(document.to_string(), states[i - 1]);
+  }
+  EXPECT_FALSE(document.undo());
+
+  for (size_t i = 1; i < states.size(); ++i)
+  {
+    EXPECT_TRUE(document.redo());
+    EXPECT_EQ(document.to_string(), states[i]);
+  }
+  EXPECT_FALSE(document.redo());
+
+  // New mutation drops what could be redone
+  document.undo();
+  root.push_back(Node("f"));
+  EXPECT_FALSE(document.can_redo());
+  document.undo();
+  EXPECT_EQ(document.to_string(), states[states.size() - 2]);
+}
+
+TEST(Journal, attributes)
+{
+  Document document;
+  document.parse("<root a=\"1\" b=\"2\" c=\"3\"/>");
+  document.enable_journal();
+  string original = document.to_string();
+
+  Node &root = document.root_node;
+  Node::Attribute a = root.attributes["a"];
+  Node::Attribute c = root.attributes["c"];
+  root.attributes["b"].value = "20";
+  root.attributes.remove("b");
+  root.attributes.push_back("d", "4");
+  string changed = document.to_string();
+
+  // Other attributes are left alone, handles to them stay valid
+  for (int i = 0; i < 3; ++i)
+  {
+    document.undo();
+  }
+  EXPECT_EQ(document.to_string(), original);
+  EXPECT_EQ(string(a.value), "1");
+  EXPECT_EQ(string(c.value), "3");
+
+  Node::Attribute b = root.attributes["b"];
+  document.redo();
+  EXPECT_EQ(string(b.value), "20");
+  document.redo();
+  document.redo();
+  EXPECT_EQ(document.to_string(), changed);
+  EXPECT_EQ(string(c.value), "3");
+}
+
+TEST(Journal, transactions)
+{
+  Document document;
+  document.parse("<root><a/><b/></root>");
+  document.enable_journal();
+  document.enable_indexes();
+  string original = document.to_string();
+
+  Node &root = document.root_node;
+  document.begin_transaction();
+  root.push_back(Node("c"));
+  document.begin_transaction();
+  root["a"].attributes.push_back("id", "x");
+  root.remove(root["b"]);
+  document.commit_transaction();
+  EXPECT_THROW(document.undo(), std::runtime_error);
+  document.commit_transaction();
+  EXPECT_THROW(document.commit_transaction(), std::runtime_error);
+  string changed = document.to_string();
+  EXPECT_EQ(document.get_element_by_id("x").name, "a");
+
+  EXPECT_TRUE(document.undo());
+  EXPECT_EQ(document.to_string(), original);
+  EXPECT_FALSE(document.can_undo());
+  EXPECT_TRUE(document.get_element_by_id("x") == nullptr);
+  EXPECT_EQ(document.get_elements_by_name("b").size(), 1u);
+
+  EXPECT_TRUE(document.redo());
+  EXPECT_EQ(document.to_string(), changed);
+  EXPECT_EQ(document.get_element_by_id("x").name, "a");
+
+  document.begin_transaction();
+  root.push_back(Node("d"));
+  root["a"].name = "z";
+  document.rollback_transaction();
+  EXPECT_EQ(document.to_string(), changed);
+  EXPECT_FALSE(document.can_redo());
+
+  // Script applied by diff is one step, replaced root is rebound
+  Document target;
+  target.parse("<other><a/></other>");
+  document.apply(diff(document, target));
+  EXPECT_EQ(document.root_node.name, "other");
+  EXPECT_TRUE(document.undo());
+  EXPECT_EQ(document.root_node.name, "root");
+  EXPECT_EQ(document.to_string(), changed);
+  EXPECT_TRUE(document.redo());
+  EXPECT_EQ(document.to_string(), target.to_string());
+
+  document.parse("<root/>");
+  EXPECT_FALSE(document.can_undo());
+  document.disable_journal();
+  EXPECT_FALSE(document.has_journal());
+}
+
+TEST(Journal, ranges)
+{
+  Document document;
+  document.parse("<root><a/><b>1<c/>2</b></root>");
+  document.enable_journal();
+  string original = document.to_string();
+
+  Node &root = document.root_node;
+  vector<Node> nodes;
+  nodes.push_back(Node("x"));
+  nodes.push_back(Node("y"));
+  nodes.push_back(Node("z"));
+  root.insert_before(root.begin(), nodes);
+  string inserted = document.to_string();
+
+  Node a = root["a"];
+  a.splice(a.end(), root["b"]);
+  string spliced = document.to_string();
+
+  document.undo();
+  EXPECT_EQ(document.to_string(), inserted);
+  document.undo();
+  EXPECT_EQ(document.to_string(), original);
+  document.redo();
+  document.redo();
+  EXPECT_EQ(document.to_string(), spliced);
+}
+
+} // namespace
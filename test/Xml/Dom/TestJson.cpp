@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+#include <Xml/Dom/Document.h>
+#include <Xml/Dom/Json.h>
+#include <Xml/Dom/Pipeline.h>
+#include <stdexcept>
+#include <string>
+
+using namespace un::Xml::Dom;
+using namespace std;
+
+namespace
+{
+
+const char order[] = "<order id=\"7\">\n"
+                     "  <item>a</item>\n"
+                     "  <item>b \"q\"</item>\n"
+                     "  <note lang=\"en\">fast</note>\n"
+                     "  <empty/>\n"
+                     "</order>";
+
+TEST(Json, objects)
+{
+  Document document;
+  document.parse(order);
+  EXPECT_EQ(to_json(document), "{\"order\":{\"@id\":\"7\",\"item\":[\"a\",\"b \\\"q\\\"\"],"
+                               "\"note\":{\"@lang\":\"en\",\"#text\":\"fast\"},\"empty\":\"\"}}");
+
+  // Compact documents and subtrees
+  std::string output = "old";
+  document.compact();
+  to_json(document.root_node["note"], output);
+  EXPECT_EQ(output, "{\"note\":{\"@lang\":\"en\",\"#text\":\"fast\"}}");
+
+  JsonConvention convention;
+  convention.attribute_prefix = "-";
+  convention.text_key = "_";
+  convention.array_elements = {"note"};
+  EXPECT_EQ(to_json(document, convention), "{\"order\":{\"-id\":\"7\",\"item\":[\"a\",\"b \\\"q\\\"\"],"
+                                           "\"note\":[{\"-lang\":\"en\",\"_\":\"fast\"}],\"empty\":\"\"}}");
+
+  // Same names are one member even when other elements come between them
+  Document mixed;
+  mixed.parse("<r><a>1</a><b/><a>2</a>x<p:c xmlns:p=\"urn:p\"/><c/><a>3</a></r>");
+  EXPECT_EQ(to_json(mixed), "{\"r\":{\"a\":[\"1\",\"2\",\"3\"],\"b\":\"\",\"p:c\":{\"@xmlns:p\":\"urn:p\"},"
+                            "\"c\":\"\",\"#text\":\"x\"}}");
+}
+
+TEST(Json, ordered)
+{
+  Document document;
+  document.parse("<p class=\"x\">Hello <b>big</b> world<br/></p>");
+  JsonConvention convention(JsonConvention::Layout::ordered);
+  string json = to_json(document, convention);
+  EXPECT_EQ(json, "[\"p\",{\"class\":\"x\"},\"Hello \",[\"b\",\"big\"],\" world\",[\"br\"]]");
+
+  Document back = from_json(json, convention);
+  EXPECT_EQ(back.to_string(), document.to_string());
+}
+
+TEST(Json, events)
+{
+  JsonConvention convention;
+  convention.array_elements = {"item"};
+  string output;
+  JsonWriter writer(output, convention);
+  Pipeline().run(order, writer);
+  EXPECT_EQ(output, "{\"order\":{\"@id\":\"7\",\"item\":[\"a\",\"b \\\"q\\\"\"],"
+                    "\"note\":{\"@lang\":\"en\",\"#text\":\"fast\"},\"empty\":\"\"}}");
+
+  // Every document is one line
+  Pipeline().run("<a>1</a>", writer);
+  EXPECT_EQ(output.substr(output.find('\n')), "\n{\"a\":\"1\"}");
+
+  // Same as the tree conversion in ordered layout
+  JsonConvention ordered(JsonConvention::Layout::ordered);
+  string streamed;
+  JsonWriter ordered_writer(streamed, ordered);
+  Pipeline().run(order, ordered_writer);
+  Document document;
+  document.parse(order);
+  EXPECT_EQ(streamed, to_json(document, ordered));
+}
+
+TEST(Json, from_json)
+{
+  Document document = from_json("{\"order\": {\"@id\": 7, \"item\": [\"a\", \"b\\u00e9 &<\"], "
+                                "\"note\": {\"#text\": \"x\", \"@lang\": \"en\"}, \"n\": null, \"t\": true}}");
+  EXPECT_EQ(document.to_string(), "<order id=\"7\"><item>a</item><item>b\xc3\xa9 &amp;&lt;</item>"
+                                  "<note lang=\"en\">x</note><n/><t>true</t></order>");
+
+  // Round trip
+  Document parsed;
+  parsed.parse(order);
+  EXPECT_EQ(to_json(from_json(to_json(parsed))), to_json(parsed));
+
+  // Namespaces
+  Document ns = from_json("{\"s:env\": {\"@xmlns:s\": \"urn:s\", \"s:body\": \"x\"}}");
+  EXPECT_EQ(ns.root_node.get_namespace_uri(), "urn:s");
+  EXPECT_EQ(ns.root_node.get_child("urn:s", "body").get_namespace_uri(), "urn:s");
+  EXPECT_EQ(to_json(ns), "{\"s:env\":{\"@xmlns:s\":\"urn:s\",\"s:body\":\"x\"}}");
+}
+
+TEST(Json, errors)
+{
+  EXPECT_THROW(from_json("{\"a\": 1, \"b\": 2}"), std::runtime_error);
+  EXPECT_THROW(from_json("{\"a\": [1, 2]}"), std::runtime_error);
+  EXPECT_THROW(from_json("{\"a\": {\"b\": tru}}"), std::runtime_error);
+  EXPECT_THROW(from_json("{\"a b\": 1}"), std::runtime_error);
+  EXPECT_THROW(from_json("{\"a\": \"x\"} x"), std::runtime_error);
+  EXPECT_THROW(from_json("[\"a\", \"x\", {\"b\": 1}]", JsonConvention(JsonConvention::Layout::ordered)),
+               std::runtime_error);
+  string deep;
+  for (int i = 0; i < 1000; ++i)
+  {
+    deep += "[\"a\",";
+  }
+  deep += "\"x\"" + string(1000, ']');
+  EXPECT_THROW(from_json(deep, JsonConvention(JsonConvention::Layout::ordered)), std::runtime_error);
+
+  // Only characters xml allows
+  EXPECT_THROW(from_json("{\"a\": \"\\u0001\"}"), std::runtime_error);
+  EXPECT_THROW(from_json("{\"a\": \"a\\u0000b\"}"), std::runtime_error);
+  EXPECT_THROW(from_json("{\"a\": \"\\uFFFE\"}"), std::runtime_error);
+  EXPECT_THROW(from_json("{\"a\": \"\\ud800\"}"), std::runtime_error);
+  EXPECT_THROW(from_json("{\"a\": \"\\ud800x\"}"), std::runtime_error);
+  EXPECT_THROW(from_json("{\"a\": \"\\udc00\"}"), std::runtime_error);
+  EXPECT_THROW(from_json("{\"a\": \"\\b\"}"), std::runtime_error);
+  EXPECT_THROW(from_json("{\"a\": \"x\x01y\"}"), std::runtime_error);
+  EXPECT_THROW(from_json("{\"a\": \"x\ny\"}"), std::runtime_error);
+  EXPECT_THROW(from_json("{\"a\": \"\xff\xfe\"}"), std::runtime_error);
+  EXPECT_THROW(from_json("{\"a\": \"\xc3\"}"), std::runtime_error);
+  EXPECT_THROW(from_json("{\"a\": \"\xc0\xaf\"}"), std::runtime_error);
+  EXPECT_THROW(from_json("{\"a\": \"\xed\xa0\x80\"}"), std::runtime_error);
+  EXPECT_THROW(from_json("{\"a\x01\": \"x\"}"), std::runtime_error);
+  EXPECT_EQ(from_json("{\"a\": \"\\ud83d\\ude00\xc3\xa9\xf0\x9f\x98\x80\\t\"}").root_node.content,
+            "\xf0\x9f\x98\x80\xc3\xa9\xf0\x9f\x98\x80\t");
+
+  Document empty;
+  EXPECT_THROW(to_json(empty), std::runtime_error);
+}
+
+} // namespace
@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+#include <Xml/Dom/Document.h>
+
+using namespace un::Xml::Dom;
+using namespace std;
+
+namespace
+{
+
+// Native parser must build the same tree as libxml2
+void expect_same_tree(const string &xml)
+{
+  Document expected(Document::Parser::libxml2);
+  expected.parse(xml);
+
+  Document actual(Document::Parser::native);
+  actual.parse(xml);
+
+  EXPECT_EQ(actual.to_string(false, false), expected.to_string(false, false)) << xml;
+}
+
+TEST(NativeParser, same_tree_as_libxml2)
+{
+  expect_same_tree("<test>content</test>");
+  expect_same_tree("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<test>content</test>");
+  expect_same_tree("<?xml version=\"1.0\" standalone=\"yes\"?><a/>");
+  expect_same_tree("\xEF\xBB\xBF<a>bom</a>");
+  expect_same_tree("<root>\n  <a x=\"1\" y='2'>text</a>\n  <b/>\n</root>\n");
+  expect_same_tree("<a>&lt;&gt;&amp;&apos;&quot;&#65;&#x42;&#x20AC;</a>");
+  expect_same_tree("<a v=\"&lt;x&gt; &#10; tab\there\nline\"/>");
+  expect_same_tree("<a>line\r\nend\rmore</a>");
+  expect_same_tree("<!-- head --><?pi data?><a><!-- c --><![CDATA[<raw> & ]]>tail<?p?></a><!-- end -->");
+  expect_same_tree("<r xmlns=\"urn:d\" xmlns:p=\"urn:p\"><p:a p:x=\"1\" y=\"2\"><b/></p:a><c xmlns=\"\"/></r>");
+  expect_same_tree("<a xml:lang=\"en\"><q:b/></a>");
+  expect_same_tree("<a>\xC3\xA7\xC3\xB6\xE2\x82\xAC</a>");
+  expect_same_tree("<a>x]y]]z] ]>\xF0\x9F\x98\x80</a>");
+}
+
+TEST(NativeParser, node_api)
+{
+  Document document(Document::Parser::native);
+  document.parse("<root><a id=\"1\">one</a><b>two</b></root>");
+
+  EXPECT_EQ(document.root_node.name, "root");
+  EXPECT_EQ(document.root_node.count, 2);
+  EXPECT_EQ(document.root_node["b"].content, "two");
+  EXPECT_EQ(document.root_node["a"].attributes["id"], "1");
+
+  document.root_node.push_back(Node("c", "three"));
+  document.root_node["a"].attributes["id"].value = "2";
+  EXPECT_EQ((string)document, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                              "<root><a id=\"2\">one</a><b>two</b><c>three</c></root>");
+}
+
+TEST(NativeParser, fallback_to_libxml2)
+{
+  Document document(Document::Parser::native);
+  document.parse("<!DOCTYPE a [<!ENTITY e \"entity\">]><a>&e;</a>");
+  EXPECT_EQ(document.root_node.content, "entity");
+
+  // Declarations libxml2 skips
+  expect_same_tree("<a xmlns:xml=\"http://www.w3.org/XML/1998/namespace\"><b/></a>");
+  expect_same_tree("<a xmlns:p=\"urn:p\" xmlns:q=\"urn:p\" p:x=\"1\" q:x=\"2\"/>");
+}
+
+TEST(NativeParser, malformed)
+{
+  const char *inputs[] = {
+      "<a>",
+      "<a></b>",
+      "<a><b></a></b>",
+      "<a x=\"1\" x=\"2\"/>",
+      "<a x=1/>",
+      "<a x=\"<\"/>",
+      "<a>&unknown;</a>",
+      "<a>&#0;</a>",
+      "<a/><b/>",
+      "<a/>text",
+      "<a><!-- x -- y --></a>",
+      "<a><![CDATA[x</a>",
+      "<1a/>",
+      "<a>x]]>y</a>",
+      "<a>x\x01y</a>",
+      "<a b=\"\x01\"/>",
+      "<a><!--\x0C--></a>",
+      "<a>\xFF\xFE</a>",
+      "<a>\xC3</a>",
+      "<a>\xC0\xAF</a>",
+      "<a>\xED\xA0\x80</a>",
+      "<a>\xEF\xBF\xBE</a>",
+      "<a\xFF/>",
+  };
+
+  for (const char *input : inputs)
+  {
+    Document document(Document::Parser::native);
+    EXPECT_THROW(document.parse(string(input)), std::runtime_error) << input;
+  }
+}
+
+} // namespace
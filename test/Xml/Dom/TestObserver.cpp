@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+#include <Xml/Dom/Document.h>
+#include <Xml/Dom/Observer.h>
+#include <string>
+#include <vector>
+
+using namespace un::Xml::Dom;
+using namespace std;
+
+namespace
+{
+
+/// Records events as short strings
+struct Recorder : public Observer
+{
+  vector<string> events;
+
+  static string name_of(const Node &node)
+  {
+    return node == nullptr ? string("null") : node.name;
+  }
+
+  void on_child_inserted(const Node &parent, const Node &child)
+  {
+    events.push_back("inserted " + name_of(parent) + " " + name_of(child));
+  }
+
+  void on_child_removing(const Node &parent, const Node &child)
+  {
+    events.push_back("removing " + name_of(parent) + " " + name_of(child));
+  }
+
+  void on_content_changed(const Node &node)
+  {
+    events.push_back("content " + string(node.content));
+  }
+
+  void on_attribute_set(const Node &element, const string &name, const string &value)
+  {
+    events.push_back("set " + name_of(element) + " " + name + "=" + value);
+  }
+
+  void on_attribute_removed(const Node &element, const string &name)
+  {
+    events.push_back("unset " + name_of(element) + " " + name);
+  }
+
+  void on_name_changed(const Node &element, const string &old_name)
+  {
+    events.push_back("renamed " + old_name + " " + name_of(element));
+  }
+};
+
+/// Removes itself and another observer on the first insertion
+struct Remover : public Recorder
+{
+  Document &document;
+  Observer &other;
+
+  Remover(Document &document, Observer &other) : document(document), other(other) {}
+
+  void on_child_inserted(const Node &parent, const Node &child)
+  {
+    Recorder::on_child_inserted(parent, child);
+    document.remove_observer(other);
+    document.remove_observer(*this);
+  }
+};
+
+TEST(Observer, events)
+{
+  Document document;
+  document.parse("<root><a x=\"1\">text</a><b/></root>");
+  Recorder recorder;
+  document.add_observer(recorder);
+
+  Node &root = document.root_node;
+  root.push_back(Node("c"));
+  root.remove(root["b"]);
+  root["a"].attributes["x"].value = "2";
+  root["a"].attributes.push_back("y", "3");
+  root["a"].attributes.remove("x");
+  root["c"].name = "d";
+  root["a"].begin()->content = "new";
+
+  vector<string> expected = {
+      "inserted root c", "removing root b", "set a x=2", "set a y=3",
+      "unset a x",       "renamed c d",     "content new",
+  };
+  EXPECT_EQ(recorder.events, expected);
+
+  recorder.events.clear();
+  document.remove_observer(recorder);
+  root.push_back(Node("e"));
+  EXPECT_TRUE(recorder.events.empty());
+}
+
+TEST(Observer, undo)
+{
+  Document document;
+  document.parse("<root><a/></root>");
+  document.enable_journal();
+  Recorder recorder;
+  document.add_observer(recorder);
+
+  Node &root = document.root_node;
+  root["a"].name = "b";
+  document.undo();
+  document.redo();
+
+  Node other("other");
+  document.root_node = other;
+
+  vector<string> expected = {
+      "renamed a b", "renamed b a", "renamed a b", "removing null root", "inserted null other",
+  };
+  EXPECT_EQ(recorder.events, expected);
+}
+
+TEST(Observer, remove_in_callback)
+{
+  Document document;
+  document.parse("<root/>");
+  Recorder first;
+  Recorder last;
+  Remover remover(document, last);
+  document.add_observer(first);
+  document.add_observer(remover);
+  document.add_observer(last);
+
+  Node &root = document.root_node;
+  root.push_back(Node("a"));
+  root.push_back(Node("b"));
+
+  EXPECT_EQ(first.events, (vector<string>{"inserted root a", "inserted root b"}));
+  EXPECT_EQ(remover.events, (vector<string>{"inserted root a"}));
+  EXPECT_TRUE(last.events.empty());
+}
+
+} // namespace
@@ -0,0 +1,173 @@
+#include <gtest/gtest.h>
+#include <Xml/Dom/Pipeline.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+using namespace un::Xml::Dom;
+using namespace std;
+
+namespace
+{
+
+TEST(Pipeline, transform)
+{
+  Pipeline pipeline;
+  pipeline.drop("debug").rename("old", "new").map([](Pipeline::Event &event) {
+    if (event.type == Pipeline::Event::Type::start_element && event.name == "item")
+    {
+      event.set_attribute("seen", "1");
+      event.remove_attribute("secret");
+    }
+  });
+
+  string output;
+  Pipeline::Serializer serializer(output);
+  pipeline.run("<root><debug><item/>x</debug><old a=\"1\">text</old>"
+               "<item secret=\"s\" id=\"2\"/></root>",
+               serializer);
+  EXPECT_EQ(output, "<root><new a=\"1\">text</new><item id=\"2\" seen=\"1\"/></root>");
+}
+
+TEST(Pipeline, round_trip)
+{
+  const string input = "<?pi data?><!--c--><r xmlns=\"urn:d\" xmlns:p=\"urn:p\" p:a=\"&amp;&quot;&#10;\">"
+                       "a &lt; b &amp; c<e/><![CDATA[x]]]]><![CDATA[>y]]><p:e>t</p:e></r>";
+  string output;
+  Pipeline::Serializer serializer(output);
+  Pipeline().run(input, serializer);
+  EXPECT_EQ(output, input);
+
+  // Same events when fed byte by byte
+  string pushed;
+  Pipeline::Serializer push_serializer(pushed);
+  Pipeline pipeline;
+  pipeline.begin(push_serializer);
+  for (char c : input)
+  {
+    pipeline.push(&c, 1);
+  }
+  pipeline.end();
+  EXPECT_EQ(pushed, input);
+}
+
+TEST(Pipeline, depth)
+{
+  string depths;
+  Pipeline pipeline;
+  pipeline.filter([&depths](const Pipeline::Event &event) {
+    depths += to_string(event.depth);
+    return true;
+  });
+  string output;
+  Pipeline::Serializer serializer(output);
+  pipeline.run("<a><b>t</b><c/></a>", serializer);
+  EXPECT_EQ(depths, "0121");
+}
+
+TEST(Pipeline, files)
+{
+  const char *input_path = "pipeline_files.xml";
+  const char *output_path = "pipeline_files_out.xml";
+  {
+    ofstream input(input_path);
+    input << "<records>";
+    for (int i = 0; i < 10000; ++i)
+    {
+      input << "<record id=\"" << i << "\"><drop/>value</record>";
+    }
+    input << "</records>";
+  }
+
+  Pipeline pipeline;
+  pipeline.drop("drop");
+  {
+    Pipeline::Serializer serializer(output_path);
+    pipeline.run_file(input_path, serializer);
+  }
+
+  ifstream result(output_path);
+  ostringstream content;
+  content << result.rdbuf();
+  EXPECT_EQ(content.str().find("<drop"), string::npos);
+  EXPECT_NE(content.str().find("<record id=\"9999\">value</record></records>"), string::npos);
+
+  remove(input_path);
+  remove(output_path);
+}
+
+TEST(Pipeline, large_memory_input)
+{
+  // Above the lookup limit libxml2 has for a single chunk
+  string input = "<records>";
+  while (input.size() < 12 * 1024 * 1024)
+  {
+    input += "<record id=\"1\">value</record>";
+  }
+  input += "</records>";
+
+  string output;
+  Pipeline::Serializer serializer(output);
+  Pipeline().run(input, serializer);
+  EXPECT_EQ(output, input);
+}
+
+TEST(Pipeline, entities)
+{
+  const char *secret_path = "pipeline_secret.txt";
+  {
+    ofstream secret(secret_path);
+    secret << "SECRET";
+  }
+
+  string output;
+  Pipeline::Serializer serializer(output);
+  Pipeline().run("<!DOCTYPE r [<!ENTITY i \"in<b>x</b>\">]><r>&i;&i;</r>", serializer);
+  EXPECT_EQ(output, "<r>in<b>x</b>in<b>x</b></r>");
+
+  string external = string("<!DOCTYPE r [<!ENTITY x SYSTEM \"") + secret_path + "\">]>";
+  string leaked;
+  Pipeline::Serializer leak_serializer(leaked);
+  EXPECT_THROW(Pipeline().run(external + "<r>&x;</r>", leak_serializer), std::runtime_error);
+  EXPECT_EQ(leaked.find("SECRET"), string::npos);
+
+  // Declared but unused external entities do no harm
+  string unused;
+  Pipeline::Serializer unused_serializer(unused);
+  Pipeline().run(external + "<r/>", unused_serializer);
+  EXPECT_EQ(unused, "<r/>");
+
+  string parameter = string("<!DOCTYPE r [<!ENTITY % p SYSTEM \"") + secret_path + "\"> %p;]><r/>";
+  string parameter_output;
+  Pipeline::Serializer parameter_serializer(parameter_output);
+  EXPECT_THROW(Pipeline().run(parameter, parameter_serializer), std::runtime_error);
+
+  remove(secret_path);
+}
+
+TEST(Pipeline, errors)
+{
+  Pipeline pipeline;
+  string output;
+  Pipeline::Serializer serializer(output);
+  EXPECT_THROW(pipeline.run("<a><b></a>", serializer), std::runtime_error);
+  EXPECT_THROW(pipeline.push("<a/>", 4), std::runtime_error);
+
+  pipeline.map([](Pipeline::Event &event) {
+    if (event.name == "bad")
+    {
+      throw std::logic_error("bad element");
+    }
+  });
+  EXPECT_THROW(pipeline.run("<a><bad/></a>", serializer), std::logic_error);
+
+  // Pipeline is usable after a failed pass
+  string retried;
+  Pipeline::Serializer retry_serializer(retried);
+  pipeline.run("<a><b/></a>", retry_serializer);
+  EXPECT_EQ(retried, "<a><b/></a>");
+}
+
+} // namespace
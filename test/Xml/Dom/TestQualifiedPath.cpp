@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include <Xml/Dom/Document.h>
+#include <Xml/Dom/QualifiedPath.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace un::Xml::Dom;
+using namespace std;
+
+namespace
+{
+
+const string soap = "http://www.w3.org/2003/05/soap-envelope";
+
+const char *message = "<env:Envelope xmlns:env=\"http://www.w3.org/2003/05/soap-envelope\">"
+                      "<env:Header><Body/></env:Header>"
+                      "<env:Body xmlns=\"urn:m\" xmlns:x=\"urn:x\">"
+                      "<GetPrice x:id=\"1\" id=\"2\"><Item>a</Item></GetPrice>"
+                      "<x:GetPrice><Item>b</Item></x:GetPrice>"
+                      "<m:GetPrice xmlns:m=\"urn:m\"><Item>c</Item></m:GetPrice>"
+                      "</env:Body></env:Envelope>";
+
+void check_lookups(Document &document)
+{
+  Node &root = document.root_node;
+  EXPECT_EQ(root.get_namespace_uri(), soap);
+
+  QualifiedPath::Prefixes prefixes = {{"s", soap}, {"p", "urn:m"}};
+  QualifiedPath items("s:Body/p:GetPrice/p:Item", prefixes);
+  vector<Node> found = items.select_all(root);
+  ASSERT_EQ(found.size(), 2u);
+  EXPECT_EQ(string(found[0].content), "a");
+  EXPECT_EQ(string(found[1].content), "c");
+
+  EXPECT_TRUE(QualifiedPath("Body", prefixes).select(root) == nullptr);
+  EXPECT_EQ(QualifiedPath("s:Header/Body", prefixes).select_all(root).size(), 1u);
+  EXPECT_EQ(QualifiedPath("s:Body/*", prefixes).select_all(root).size(), 3u);
+  EXPECT_EQ(QualifiedPath("s:Body/p:*", {{"s", soap}, {"p", "urn:m"}}).select_all(root).size(), 2u);
+  EXPECT_EQ(string(QualifiedPath("s:Body/GetPrice/p:Item", {{"s", soap}, {"", "urn:x"}, {"p", "urn:m"}}).select(root).content), "b");
+
+  Node body = root.get_child(soap, "Body");
+  ASSERT_TRUE(body != nullptr);
+  Node price = body.get_child("urn:m", "GetPrice");
+  ASSERT_TRUE(price != nullptr);
+  EXPECT_EQ(string(price.attributes.get("urn:x", "id").value), "1");
+  EXPECT_EQ(string(price.attributes.get("", "id").value), "2");
+  EXPECT_TRUE(price.attributes.get("urn:m", "id") == nullptr);
+  EXPECT_TRUE(body.get_child("", "GetPrice") == nullptr);
+}
+
+TEST(QualifiedPath, select)
+{
+  Document document;
+  document.parse(message);
+  check_lookups(document);
+
+  document.compact();
+  check_lookups(document);
+
+  EXPECT_THROW(QualifiedPath("q:a", {}), std::runtime_error);
+  EXPECT_THROW(QualifiedPath("a//b", {}), std::runtime_error);
+}
+
+TEST(QualifiedPath, construct)
+{
+  Document document;
+  Node envelope(Namespace(soap, "env"), "Envelope");
+  document.root_node = envelope;
+  Node &root = document.root_node;
+
+  Node body(Namespace(soap, "env"), "Body");
+  root.push_back(body);
+  Node price(Namespace("urn:m"), "GetPrice");
+  body.push_back(price);
+  price.attributes.push_back(Namespace("urn:x", "x"), "id", "7");
+  EXPECT_THROW(price.attributes.push_back(Namespace("urn:x"), "id", "7"), std::runtime_error);
+
+  EXPECT_EQ(document.to_string(),
+            "<env:Envelope xmlns:env=\"http://www.w3.org/2003/05/soap-envelope\">"
+            "<env:Body xmlns:env=\"http://www.w3.org/2003/05/soap-envelope\">"
+            "<GetPrice xmlns=\"urn:m\" xmlns:x=\"urn:x\" x:id=\"7\"/></env:Body></env:Envelope>");
+
+  QualifiedPath path;
+  path.append(soap, "Body").append("urn:m", "GetPrice");
+  Node found = path.select(root);
+  EXPECT_EQ(string(found.attributes.get("urn:x", "id").value), "7");
+}
+
+TEST(QualifiedPath, prefix_conflict)
+{
+  Document document;
+  document.parse("<p:a xmlns:p=\"http://x\"><p:b/></p:a>");
+  Node b = document.root_node.get_child("http://x", "b");
+  b.attributes.push_back(Namespace("http://y", "p"), "k", "1");
+  b.attributes.push_back(Namespace("http://z", "p"), "k", "2");
+
+  EXPECT_EQ(b.get_namespace_uri(), "http://x");
+  EXPECT_EQ(string(b.attributes.get("http://y", "k").value), "1");
+  EXPECT_EQ(string(b.attributes.get("http://z", "k").value), "2");
+  EXPECT_EQ(document.to_string(), "<p:a xmlns:p=\"http://x\"><p:b xmlns:p1=\"http://y\" xmlns:p2=\"http://z\" p1:k=\"1\" p2:k=\"2\"/></p:a>");
+}
+
+TEST(QualifiedPath, undo_declaration)
+{
+  Document document;
+  document.parse("<a/>");
+  document.enable_journal();
+  string original = document.to_string();
+
+  document.root_node.attributes.push_back(Namespace("urn:x", "x"), "id", "7");
+  string changed = document.to_string();
+
+  // Declaration is part of the change it was made for
+  EXPECT_TRUE(document.undo());
+  EXPECT_EQ(document.to_string(), original);
+  EXPECT_TRUE(document.redo());
+  EXPECT_EQ(document.to_string(), changed);
+}
+
+} // namespace
@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+#include <Xml/Dom/RecordSplitter.h>
+#include <cstdio>
+#include <fstream>
+
+using namespace un::Xml::Dom;
+using namespace std;
+
+namespace
+{
+
+TEST(RecordSplitter, split)
+{
+  const char xml[] =
+      "<?xml version=\"1.0\"?>\n"
+      "<!DOCTYPE root [ <!ELEMENT root ANY> ]>\n"
+      "<root>\n"
+      "  <rec id=\"1\"><a>x &gt; y</a></rec>\n"
+      "  <!-- <rec id=\"fake\"/> -->\n"
+      "  <rec id=\"2\" note='a > b'/>\n"
+      "  <rec id=\"3\"><![CDATA[</rec><rec>]]></rec>\n"
+      "  <?pi <rec/> ?>\n"
+      "</root>\n";
+
+  RecordSplitter splitter(xml, sizeof(xml) - 1);
+  ASSERT_EQ(splitter.get_count(), 3u);
+  EXPECT_EQ((string)splitter[0], "<rec id=\"1\"><a>x &gt; y</a></rec>");
+  EXPECT_EQ((string)splitter[1], "<rec id=\"2\" note='a > b'/>");
+  EXPECT_EQ((string)splitter[2], "<rec id=\"3\"><![CDATA[</rec><rec>]]></rec>");
+}
+
+TEST(RecordSplitter, unbalanced)
+{
+  const char xml[] = "<root><rec></root>";
+  EXPECT_THROW(RecordSplitter(xml, sizeof(xml) - 1), std::runtime_error);
+}
+
+TEST(RecordSplitter, parse_file)
+{
+  const char *path = "record_splitter_test.xml";
+  {
+    std::ofstream file(path);
+    file << "<root>";
+    for (int i = 0; i < 100; ++i)
+    {
+      file << "<rec><value>" << i << "</value></rec>";
+    }
+    file << "</root>";
+  }
+
+  RecordSplitter splitter(path);
+  std::vector<Document> records = splitter.parse(4);
+  ASSERT_EQ(records.size(), 100u);
+  for (int i = 0; i < 100; ++i)
+  {
+    EXPECT_EQ(records[i].root_node.name, "rec");
+    EXPECT_EQ(records[i].root_node["value"].content, std::to_string(i));
+  }
+
+  std::remove(path);
+}
+
+} // namespace
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include <Xml/Dom/Schema.h>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace un::Xml::Dom;
+using namespace std;
+
+namespace
+{
+
+const char xsd[] = "<xs:schema xmlns:xs=\"http://www.w3.org/2001/XMLSchema\">"
+                   "<xs:element name=\"order\">"
+                   "<xs:complexType><xs:sequence>"
+                   "<xs:element name=\"item\" type=\"xs:string\" maxOccurs=\"unbounded\"/>"
+                   "</xs:sequence>"
+                   "<xs:attribute name=\"id\" type=\"xs:int\" use=\"required\"/>"
+                   "</xs:complexType>"
+                   "</xs:element>"
+                   "</xs:schema>";
+
+const char relaxng[] = "<element name=\"order\" xmlns=\"http://relaxng.org/ns/structure/1.0\">"
+                       "<attribute name=\"id\"/>"
+                       "<oneOrMore><element name=\"item\"><text/></element></oneOrMore>"
+                       "</element>";
+
+const string valid = "<order id=\"7\"><item>a</item><item>b</item></order>";
+const string invalid = "<order id=\"x\"><other/></order>";
+
+void check_schema(const Schema &schema)
+{
+  Document document;
+  document.parse(valid);
+  EXPECT_NO_THROW(schema.validate(document));
+
+  document.parse(invalid);
+  vector<string> errors;
+  EXPECT_FALSE(schema.validate(document, errors));
+  EXPECT_FALSE(errors.empty());
+  EXPECT_THROW(schema.validate(document), std::runtime_error);
+
+  // Context of the failed pass is not reused
+  document.parse(valid);
+  document.compact();
+  EXPECT_NO_THROW(schema.validate(document));
+
+  // Streaming
+  EXPECT_NO_THROW(schema.validate(valid.data(), valid.size()));
+  errors.clear();
+  EXPECT_FALSE(schema.validate(invalid.data(), invalid.size(), errors));
+  EXPECT_FALSE(errors.empty());
+  string malformed = "<order id=\"7\"><item>a</order>";
+  EXPECT_THROW(schema.validate(malformed.data(), malformed.size()), std::runtime_error);
+  EXPECT_NO_THROW(schema.validate(valid.data(), valid.size()));
+}
+
+TEST(Schema, xsd)
+{
+  Schema schema(xsd, sizeof(xsd) - 1);
+  EXPECT_EQ(schema.get_language(), Schema::Language::xsd);
+  check_schema(schema);
+
+  Document source;
+  source.parse(xsd);
+  Schema from_document(source);
+  EXPECT_EQ(from_document.get_language(), Schema::Language::xsd);
+  check_schema(from_document);
+}
+
+TEST(Schema, relaxng)
+{
+  Schema schema(relaxng, sizeof(relaxng) - 1);
+  EXPECT_EQ(schema.get_language(), Schema::Language::relaxng);
+  check_schema(schema);
+}
+
+TEST(Schema, files)
+{
+  const char *schema_path = "schema_files.xsd";
+  const char *document_path = "schema_files.xml";
+  ofstream(schema_path) << xsd;
+  ofstream(document_path) << valid;
+
+  Schema schema(schema_path);
+  EXPECT_NO_THROW(schema.validate_file(document_path));
+  EXPECT_THROW(schema.validate_file("schema_files_missing.xml"), std::runtime_error);
+
+  remove(schema_path);
+  remove(document_path);
+}
+
+TEST(Schema, errors)
+{
+  string not_schema = "<root/>";
+  EXPECT_THROW(Schema(not_schema.data(), not_schema.size()), std::runtime_error);
+
+  string broken = "<xs:schema xmlns:xs=\"http://www.w3.org/2001/XMLSchema\">"
+                  "<xs:element name=\"a\" type=\"undefined\"/></xs:schema>";
+  EXPECT_THROW(Schema(broken.data(), broken.size()), std::runtime_error);
+}
+
+TEST(Schema, threads)
+{
+  const Schema schema(xsd, sizeof(xsd) - 1);
+  Document document;
+  document.parse(valid);
+  document.freeze();
+
+  atomic<int> valid_count(0);
+  atomic<int> invalid_count(0);
+  vector<thread> threads;
+  for (int i = 0; i < 4; ++i)
+  {
+    threads.emplace_back([&]() {
+      vector<string> errors;
+      for (int j = 0; j < 100; ++j)
+      {
+        valid_count += schema.validate(document, errors) ? 1 : 0;
+        invalid_count += schema.validate(invalid.data(), invalid.size(), errors) ? 0 : 1;
+      }
+    });
+  }
+  for (thread &i : threads)
+  {
+    i.join();
+  }
+  EXPECT_EQ(valid_count, 400);
+  EXPECT_EQ(invalid_count, 400);
+}
+
+} // namespace
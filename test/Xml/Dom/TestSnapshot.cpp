@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include <Xml/Dom/Document.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace un::Xml::Dom;
+using namespace std;
+
+namespace
+{
+
+TEST(Snapshot, round_trip)
+{
+  const char *path = "snapshot_round_trip.bin";
+
+  Document document;
+  document.parse("<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+                 "<root xmlns:p=\"urn:p\" id=\"r\"><a p:k=\"1\">text</a><!--c--><b>2</b></root>");
+  string expected = (string)document;
+  document.save_snapshot(path);
+  EXPECT_FALSE(document.is_compact());
+
+  Document loaded;
+  loaded.load_snapshot(path);
+  EXPECT_TRUE(loaded.is_compact());
+  EXPECT_TRUE(loaded.is_frozen());
+  EXPECT_EQ((string)loaded, expected);
+  EXPECT_EQ(loaded.root_node["a"].content, "text");
+  EXPECT_EQ((string)loaded.root_node.attributes["id"].value, "r");
+
+  // Compact documents snapshot their buffer as is
+  const char *second = "snapshot_round_trip_2.bin";
+  loaded.save_snapshot(second);
+  Document reloaded;
+  reloaded.load_snapshot(second);
+  EXPECT_EQ((string)reloaded, expected);
+
+  std::remove(path);
+  std::remove(second);
+}
+
+TEST(Snapshot, concurrent_saves)
+{
+  const char *path = "snapshot_concurrent.bin";
+
+  vector<thread> threads;
+  for (int i = 0; i < 8; ++i)
+  {
+    threads.emplace_back([path, i]() {
+      Document document;
+      document.parse("<root><a>" + string(100000, 'a' + i) + "</a></root>");
+      for (int j = 0; j < 10; ++j)
+      {
+        document.save_snapshot(path);
+      }
+    });
+  }
+  for (thread &i : threads)
+  {
+    i.join();
+  }
+
+  Document loaded;
+  loaded.load_snapshot(path);
+  string content = loaded.root_node["a"].content;
+  ASSERT_EQ(content.size(), 100000u);
+  EXPECT_EQ(content.find_first_not_of(content[0]), string::npos);
+
+  std::remove(path);
+}
+
+TEST(Snapshot, corrupt)
+{
+  const char *path = "snapshot_corrupt.bin";
+
+  Document document;
+  document.parse("<root><a>text</a></root>");
+  document.save_snapshot(path);
+
+  string content;
+  {
+    ifstream file(path, ios::binary);
+    stringstream buffer;
+    buffer << file.rdbuf();
+    content = buffer.str();
+  }
+
+  content[content.size() - 3] ^= 0x20;
+  {
+    ofstream file(path, ios::binary | ios::trunc);
+    file << content;
+  }
+  Document corrupted;
+  EXPECT_THROW(corrupted.load_snapshot(path), std::runtime_error);
+
+  {
+    ofstream file(path, ios::binary | ios::trunc);
+    file << content.substr(0, content.size() - 8);
+  }
+  EXPECT_THROW(corrupted.load_snapshot(path), std::runtime_error);
+
+  {
+    ofstream file(path, ios::binary | ios::trunc);
+    file << "<root/>";
+  }
+  EXPECT_THROW(corrupted.load_snapshot(path), std::runtime_error);
+
+  // Header is not checksummed. One name less keeps the layout of the even
+  // name count, but the last name id then points past the names.
+  document.parse("<root><a>text</a><b/></root>");
+  document.save_snapshot(path);
+  {
+    ifstream file(path, ios::binary);
+    stringstream buffer;
+    buffer << file.rdbuf();
+    content = buffer.str();
+  }
+  const size_t names_offset = 16 + 3 * sizeof(uint64_t);
+  uint64_t names;
+  memcpy(&names, content.data() + names_offset, sizeof(names));
+  ASSERT_EQ(names % 2, 0u);
+  --names;
+  memcpy(&content[names_offset], &names, sizeof(names));
+  {
+    ofstream file(path, ios::binary | ios::trunc);
+    file << content;
+  }
+  EXPECT_THROW(corrupted.load_snapshot(path), std::runtime_error);
+
+  std::remove(path);
+}
+
+} // namespace
@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+#include <Xml/Dom/Document.h>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace un::Xml::Dom;
+using namespace std;
+
+namespace
+{
+
+TEST(TypedContent, integers)
+{
+  Document document;
+  document.parse("<root><i>-17</i><i> +3 </i><i>9000000000</i><i>+-1</i></root>");
+  Node &root = document.root_node;
+
+  EXPECT_EQ(root[0].content.as<int64_t>(), -17);
+  EXPECT_EQ(root[1].content.as<int32_t>(), 3);
+  EXPECT_EQ(root[2].content.as<int64_t>(), 9000000000LL);
+  EXPECT_THROW(root[2].content.as<int32_t>(), std::runtime_error);
+  EXPECT_THROW(root[0].content.as<uint32_t>(), std::runtime_error);
+  EXPECT_THROW(root[3].content.as<int32_t>(), std::runtime_error);
+}
+
+TEST(TypedContent, floating_point)
+{
+  Document document;
+  document.parse("<root><d>2.5e3</d><d>INF</d><d>-INF</d><d>NaN</d>"
+                 "<d>inf</d><d>nan</d><d>-Infinity</d></root>");
+  Node &root = document.root_node;
+
+  EXPECT_DOUBLE_EQ(root[0].content.as<double>(), 2500.0);
+  EXPECT_EQ(root[0].content.try_as<float>().value_or(0), 2500.0f);
+  EXPECT_TRUE(std::isinf(root[1].content.as<double>()) && root[1].content.as<double>() > 0);
+  EXPECT_TRUE(std::isinf(root[2].content.as<float>()) && root[2].content.as<float>() < 0);
+  EXPECT_TRUE(std::isnan(root[3].content.as<double>()));
+
+  // Spellings std::from_chars takes but XML Schema does not
+  EXPECT_FALSE(root[4].content.try_as<double>().has_value());
+  EXPECT_FALSE(root[5].content.try_as<double>().has_value());
+  EXPECT_FALSE(root[6].content.try_as<double>().has_value());
+}
+
+TEST(TypedContent, booleans)
+{
+  Document document;
+  document.parse("<root><b>0</b><b> true </b><b>yes</b></root>");
+  Node &root = document.root_node;
+
+  EXPECT_FALSE(root[0].content.as<bool>());
+  EXPECT_TRUE(root[1].content.as<bool>());
+  EXPECT_THROW(root[2].content.as<bool>(), std::runtime_error);
+}
+
+TEST(TypedContent, invalid_content)
+{
+  Document document;
+  document.parse("<root><text>abc</text><prefix>12x</prefix><empty/></root>");
+  Node &root = document.root_node;
+
+  EXPECT_FALSE(root["text"].content.try_as<double>().has_value());
+  EXPECT_FALSE(root["prefix"].content.try_as<int32_t>().has_value());
+  EXPECT_FALSE(root["empty"].content.try_as<int64_t>().has_value());
+  EXPECT_THROW(root["prefix"].content.as<int32_t>(), std::runtime_error);
+}
+
+TEST(TypedContent, mixed_content)
+{
+  Document document;
+  document.parse("<root><mixed>1<!--c-->2</mixed></root>");
+  EXPECT_EQ(document.root_node["mixed"].content.as<int>(), 12);
+}
+
+TEST(TypedContent, attributes)
+{
+  Document document;
+  document.parse("<root count=\"42\" ratio=\" 0.5 \" flag=\"true\" bad=\"12x\"/>");
+  Node &root = document.root_node;
+
+  EXPECT_EQ(root.attributes["count"].as<uint64_t>(), 42u);
+  EXPECT_DOUBLE_EQ(root.attributes["ratio"].as<double>(), 0.5);
+  EXPECT_TRUE(root.attributes["flag"].as<bool>());
+  EXPECT_FALSE(root.attributes["bad"].try_as<int32_t>().has_value());
+  EXPECT_THROW(root.attributes["bad"].as<int32_t>(), std::runtime_error);
+}
+
+TEST(TypedContent, children_as)
+{
+  Document document;
+  document.parse("<root><i>1</i><x/><i>2</i><i>9000000000</i></root>");
+  Node &root = document.root_node;
+
+  vector<int64_t> values{7};
+  EXPECT_EQ(root.children_as("i", values), 3u);
+  EXPECT_EQ(values, (vector<int64_t>{7, 1, 2, 9000000000LL}));
+  EXPECT_EQ(root.children_as("missing", values), 0u);
+
+  // Values parsed before the invalid child are not left behind
+  vector<int32_t> narrow{7};
+  EXPECT_THROW(root.children_as("i", narrow), std::runtime_error);
+  EXPECT_EQ(narrow, (vector<int32_t>{7}));
+}
+
+TEST(TypedContent, compact)
+{
+  Document document;
+  document.parse("<root count=\"42\"><i>-17</i><i>3</i><mixed>1<!--c-->2</mixed></root>");
+  document.compact();
+  Node &root = document.root_node;
+
+  EXPECT_EQ(root["i"].content.as<int64_t>(), -17);
+  EXPECT_EQ(root["mixed"].content.as<int>(), 12);
+  EXPECT_EQ(root.attributes["count"].as<uint64_t>(), 42u);
+
+  vector<int64_t> values;
+  EXPECT_EQ(root.children_as("i", values), 2u);
+  EXPECT_EQ(values, (vector<int64_t>{-17, 3}));
+}
+
+} // namespace